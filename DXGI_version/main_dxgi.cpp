@@ -1,6 +1,12 @@
 // Windows Desktop Capture with DXGI Desktop Duplication
-// Captures 1920x1080 from FIRST monitor, scales down to 1440x1080, composites into 1920x1080 buffer with black padding on right
-// Displays in fullscreen borderless window on FIRST monitor using D3D11
+// Captures the source monitor (by default the one at the desktop origin), scales it into a 4:3 area
+// on the left of the output monitor with black padding on the right (1920x1080 -> 1440x1080)
+// Displays in fullscreen borderless window on the output monitor using D3D11
+// Geometry is planned from the display topology at startup and again after display changes;
+// both renderers build a new plan (the CPU renderer also a new scale mode, Ctrl+Insert) off the
+// frame thread and switch to it between frames without stopping
+// Between frames the loop sleeps in one wait on messages and the frame deadline; hotkeys, display
+// changes and (while idle) raw input end the sleep early
 // Uses SetWindowDisplayAffinity to exclude self from capture (Windows 10 2004+)
 
 #define WIN32_LEAN_AND_MEAN
@@ -11,72 +17,48 @@
 #include <d3dcompiler.h>
 #include <mmsystem.h>
 #include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+#include <thread>
+
+#include "capture_geometry.h"
+#include "cursor_blend.h"
+#include "cursor_shape.h"
+#include "display_info.h"
+#include "display_topology.h"
+#include "event_loop.h"
+#include "frame_arena.h"
+#include "frame_memory.h"
+#include "frame_pacer.h"
+#include "frame_rate.h"
+#include "heap_counter.h"
+#include "idle_policy.h"
+#include "mirror_pipeline.h"
+#include "quality_governor.h"
+#include "source_recovery.h"
+#include "vsync_scheduler.h"
+#include "worker_pool.h"
 
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "dxgi.lib")
 #pragma comment(lib, "d3dcompiler.lib")
 #pragma comment(lib, "winmm.lib")
 
-// DPI awareness - must be set before any window/GDI calls
-typedef BOOL (WINAPI *PFN_SetProcessDPIAware)(void);
-typedef HRESULT (WINAPI *PFN_SetProcessDpiAwareness)(int);
-typedef BOOL (WINAPI *PFN_SetProcessDpiAwarenessContext)(HANDLE);
+// Source/output monitors and geometry (--source-monitor=<n> / --output-monitor=<n>), rebuilt
+// from the topology on WM_DISPLAYCHANGE
+static CapturePlanOptions g_PlanOptions;
+static CapturePlan g_Plan;
+static CapturePlan g_GpuPlan;       // Plan the GPU objects are built for; lags g_Plan during a rebuild
+static bool g_DisplayChanged = false;
 
-#ifndef DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2
-#define DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2 ((HANDLE)-4)
+#ifndef WM_DPICHANGED
+#define WM_DPICHANGED 0x02E0
 #endif
-#define PROCESS_PER_MONITOR_DPI_AWARE 2
 
-void EnableDPIAwareness()
-{
-    HMODULE hUser32 = GetModuleHandleA("user32.dll");
-    if (hUser32)
-    {
-        auto pSetProcessDpiAwarenessContext = (PFN_SetProcessDpiAwarenessContext)
-            GetProcAddress(hUser32, "SetProcessDpiAwarenessContext");
-        if (pSetProcessDpiAwarenessContext)
-        {
-            if (pSetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2))
-                return;
-        }
-    }
-    
-    HMODULE hShcore = LoadLibraryA("shcore.dll");
-    if (hShcore)
-    {
-        auto pSetProcessDpiAwareness = (PFN_SetProcessDpiAwareness)
-            GetProcAddress(hShcore, "SetProcessDpiAwareness");
-        if (pSetProcessDpiAwareness)
-        {
-            if (SUCCEEDED(pSetProcessDpiAwareness(PROCESS_PER_MONITOR_DPI_AWARE)))
-            {
-                FreeLibrary(hShcore);
-                return;
-            }
-        }
-        FreeLibrary(hShcore);
-    }
-    
-    if (hUser32)
-    {
-        auto pSetProcessDPIAware = (PFN_SetProcessDPIAware)
-            GetProcAddress(hUser32, "SetProcessDPIAware");
-        if (pSetProcessDPIAware)
-        {
-            pSetProcessDPIAware();
-        }
-    }
-}
-
-// Constants
-constexpr int SOURCE_WIDTH = 1920;
-constexpr int SOURCE_HEIGHT = 1080;
-constexpr int RENDER_WIDTH = 1440;
-constexpr int RENDER_HEIGHT = 1080;
-constexpr int OUTPUT_WIDTH = 1920;
-constexpr int OUTPUT_HEIGHT = 1080;
-constexpr int TARGET_FPS = 60;
-constexpr int FRAME_TIME_MS = 1000 / TARGET_FPS;
+// Capture and present clocks (discovered from the displays, overridable with --capture-hz / --present-hz)
+static FrameRate g_CaptureRate;
+static FrameRate g_PresentRate;
 
 // Display affinity constant
 #ifndef WDA_EXCLUDEFROMCAPTURE
@@ -87,6 +69,7 @@ constexpr int FRAME_TIME_MS = 1000 / TARGET_FPS;
 static bool g_Running = true;
 static HWND g_hWnd = nullptr;
 static bool g_UseExcludeFromCapture = false;
+static bool g_LinearLight = false;  // --linear-light: cursor blend and CPU scaling in linear light
 
 // Shell/Taskbar handles for hiding
 static HWND g_hTaskbar = nullptr;
@@ -138,35 +121,64 @@ void ShowWindowsShell()
 // Cursor rendering
 static ID3D11Texture2D* g_CursorTexture = nullptr;
 static ID3D11ShaderResourceView* g_CursorSRV = nullptr;
-static BYTE* g_CursorBuffer = nullptr;
-static int g_CursorWidth = 0;
-static int g_CursorHeight = 0;
-static int g_CursorHotspotX = 0;
-static int g_CursorHotspotY = 0;
+static ID3D11Texture2D* g_CursorStaging = nullptr;  // Cursor-sized read-back of the pixels under the cursor
+static UINT g_CursorStagingWidth = 0;
+static UINT g_CursorStagingHeight = 0;
+static CursorSprite g_Cursor;  // Decoded shape (premultiplied BGRA + XOR mask)
 static bool g_CursorVisible = true;
 static POINT g_CursorPosition = {0, 0};
 
+// Skip composite/present when nothing changed, slow polling down when idle
+static IdlePolicy g_Idle;
+static DWORD g_LastInputTick = 0;
+
+// Trades filter quality and capture rate for time when frames blow the refresh budget
+static QualityGovernor g_Governor;
+
+// Scratch memory for one frame (pointer shape buffers, cursor bitmaps), reset after each frame.
+// Debug builds count operator new and report the first steady-state frame that allocates.
+static FrameArena g_FrameArena;
+static const int STEADY_STATE_FRAMES = 120;
+
 // D3D11/DXGI objects
 static ID3D11Device* g_Device = nullptr;
 static ID3D11DeviceContext* g_Context = nullptr;
 static IDXGISwapChain1* g_SwapChain = nullptr;
 static ID3D11RenderTargetView* g_RenderTargetView = nullptr;
 static ID3D11Texture2D* g_BackBuffer = nullptr;
-static IDXGIOutputDuplication* g_DeskDupl = nullptr;
-static ID3D11Texture2D* g_StagingTexture = nullptr;
+static IDXGIOutputDuplication* g_DeskDupl = nullptr;       // Null while a lost duplication is rebuilt
+static ID3D11Texture2D* g_StagingTexture = nullptr;         // Last good frame; survives a lost duplication
 static ID3D11Texture2D* g_ScaledTexture = nullptr;
 
 // Shader for scaling
 static ID3D11VertexShader* g_VertexShader = nullptr;
 static ID3D11PixelShader* g_PixelShader = nullptr;
 static ID3D11SamplerState* g_SamplerState = nullptr;
+static ID3D11SamplerState* g_PointSamplerState = nullptr;  // Fast-filter quality level
 static ID3D11ShaderResourceView* g_DesktopSRV = nullptr;
 static ID3D11InputLayout* g_InputLayout = nullptr;
 static ID3D11Buffer* g_VertexBuffer = nullptr;
 
-// Monitor position
-constexpr int FIRST_MONITOR_X = 0;
-constexpr int FIRST_MONITOR_Y = 0;
+// CPU fallback when D3D11 / Desktop Duplication is unavailable (headless, remote, no driver):
+// GDI capture, the shader's bilinear sampler emulated on the CPU, GDI present
+static bool g_CpuFallback = false;
+static HDC g_hdcScreen = nullptr;
+static HDC g_hdcWindow = nullptr;
+static WorkerPool* g_CpuWorkers = nullptr;
+static MirrorPipeline* g_CpuPipeline = nullptr;  // Output frame, composer, cursor sprite and idle state
+
+// The CPU pipeline tracks idleness itself
+static IdlePolicy& ActiveIdlePolicy()
+{
+    return g_CpuPipeline ? g_CpuPipeline->Idle() : g_Idle;
+}
+
+// Event-driven wait between frames (duplication has no frame-available handle, so capture still
+// polls on the deadline). g_FrameDue is set by events that want a frame before it.
+static EventLoop g_EventLoop;
+static bool g_FrameDue = false;
+static bool g_InputWake = false;    // Raw input registered (only while idle-throttled)
+static const int64_t WAKEUP_REPORT_NS = 10000000000LL;
 
 // SetWindowBand API and window band constants
 // These are undocumented Windows z-order bands
@@ -233,15 +245,12 @@ PS_INPUT VS(VS_INPUT input)
 
 float4 PS(PS_INPUT input) : SV_TARGET
 {
-    // Only sample from the scaled region (left 1440 pixels of 1920)
-    // Map UV from [0, 0.75] x [0, 1] for the left side
-    float2 scaledUV = input.tex;
-    
-    // Check if we're in the render area (left 1440 pixels = 75% of width)
-    if (input.tex.x <= 0.75f)
+    // Only sample from the scaled region at the top left of the output
+    // RENDER_U / RENDER_V are the plan's render size over the output size (0.75 x 1 for 1440 of 1920)
+    if (input.tex.x <= RENDER_U && input.tex.y <= RENDER_V)
     {
-        // Remap UV.x from [0, 0.75] to [0, 1] for sampling full source
-        scaledUV.x = input.tex.x / 0.75f;
+        // Remap UV from [0, RENDER_U] x [0, RENDER_V] to [0, 1] for sampling full source
+        float2 scaledUV = input.tex / float2(RENDER_U, RENDER_V);
         return desktopTex.Sample(samplerState, scaledUV);
     }
     else
@@ -258,12 +267,42 @@ bool InitWindow(HINSTANCE hInstance);
 bool InitD3D();
 bool InitDesktopDuplication();
 bool InitShaders();
+bool InitCpuFallback();
+bool RefreshCapturePlan();
+bool ApplyCapturePlan();
+void ReleaseD3D();
 void Cleanup();
-void CaptureAndRender();
+bool CaptureAndRender(bool captureDue);
+void DiscoverFrameRates(const char* cmdLine);
+void PollInputActivity();
+void SetInputWake(bool enable);
+bool PumpMessages();
+void ReportWakeups(int64_t nowNs);
+void ReportSourceRecovery();
+bool FinishPlanRebuild();
+void TrackPresentTiming(VsyncScheduler& scheduler, int64_t targetVblankNs);
+
+// Wakes during the pacer's sleep: messages are pumped at once, and the sleep ends when one of them
+// (hotkey, display change, input) wants a frame now or the app is quitting
+class MessageWaitHandler : public EventHandler
+{
+public:
+    bool OnEvent(EventWake wake, int) override
+    {
+        if (wake == WAKE_MESSAGE)
+            PumpMessages();
+        return g_Running && !g_FrameDue;
+    }
+};
 
-int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int)
+int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR lpCmdLine, int)
 {
     EnableDPIAwareness();
+
+    g_LinearLight = strstr(lpCmdLine, "--linear-light") != nullptr;
+
+    ParseCapturePlanOptions(lpCmdLine, &g_PlanOptions);
+    RefreshCapturePlan();
     
     if (!InitWindow(hInstance))
     {
@@ -271,32 +310,31 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int)
         return 1;
     }
 
-    if (!InitD3D())
+    if (!InitD3D() || !InitDesktopDuplication() || !InitShaders())
     {
-        MessageBoxA(nullptr, "Failed to initialize Direct3D 11", "Error", MB_OK | MB_ICONERROR);
-        Cleanup();
-        return 1;
-    }
-
-    if (!InitDesktopDuplication())
-    {
-        MessageBoxA(nullptr, "Failed to initialize Desktop Duplication.\nMake sure you're running Windows 8 or later.", "Error", MB_OK | MB_ICONERROR);
-        Cleanup();
-        return 1;
+        // No GPU path (headless or remote session, missing driver): same image rendered on the CPU
+        OutputDebugStringA("DesktopCapture: Direct3D 11 / Desktop Duplication unavailable, using the CPU renderer\n");
+        ReleaseD3D();
+        if (!InitCpuFallback())
+        {
+            MessageBoxA(nullptr, "Failed to initialize Direct3D 11 or the CPU fallback renderer", "Error", MB_OK | MB_ICONERROR);
+            Cleanup();
+            return 1;
+        }
+        g_CpuFallback = true;
     }
+    g_GpuPlan = g_Plan;
 
-    if (!InitShaders())
-    {
-        MessageBoxA(nullptr, "Failed to initialize shaders", "Error", MB_OK | MB_ICONERROR);
-        Cleanup();
-        return 1;
-    }
+    DiscoverFrameRates(lpCmdLine);
+    ReserveCursorSprite(&g_Cursor);
 
     // Register Insert key as global hotkey to exit (use window handle)
     if (!RegisterHotKey(g_hWnd, 1, 0, VK_INSERT))
     {
         MessageBoxA(nullptr, "Failed to register hotkey (Insert).", "Warning", MB_OK | MB_ICONWARNING);
     }
+    // Ctrl+Insert toggles linear-light scaling and cursor blending
+    RegisterHotKey(g_hWnd, 2, MOD_CONTROL, VK_INSERT);
 
     timeBeginPeriod(1);
 
@@ -306,32 +344,91 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int)
     // Hide Windows shell elements (taskbar, Start) so our window is truly on top
     HideWindowsShell();
 
-    LARGE_INTEGER frequency, lastTime, currentTime;
-    QueryPerformanceFrequency(&frequency);
-    QueryPerformanceCounter(&lastTime);
+    // Loop runs on the present clock; the converter decides which ticks also capture
+    FramePacer pacer(1000000000LL * g_PresentRate.den, g_PresentRate.num);
+    RateConverter converter(g_CaptureRate, g_PresentRate);
+    BudgetMonitor budget(g_PresentRate.PeriodNs());
+
+    // Start each frame just in time for the next vblank once refresh phase is known
+    VsyncSchedulerConfig schedulerConfig;
+    schedulerConfig.nominalPeriodNs = g_PresentRate.PeriodNs();
+    VsyncScheduler scheduler(schedulerConfig);
+    int64_t targetVblankNs = 0;
+
+    g_Governor.SetBudget(g_PresentRate.PeriodNs());
+    uint64_t captureTicks = 0;
+    uint64_t framesRun = 0;
+    bool allocationReported = false;
+
+    // Messages are handled as they arrive during the pacer's sleep, not only once per frame
+    MessageWaitHandler waitHandler;
+    g_EventLoop.SetHandler(&waitHandler);
+    pacer.SetWaiter(&g_EventLoop);
+    int64_t wakeupReportNs = pacer.Clock()->NowNs() + WAKEUP_REPORT_NS;
 
-    MSG msg = {};
     while (g_Running)
     {
-        while (PeekMessageA(&msg, nullptr, 0, 0, PM_REMOVE))
+        g_FrameDue = false;
+        if (!PumpMessages())
+            break;
+
+        if (g_Running && g_DisplayChanged)
         {
-            if (msg.message == WM_QUIT)
-            {
-                g_Running = false;
-                break;
-            }
-            if (msg.message == WM_HOTKEY && msg.wParam == 1)
+            g_DisplayChanged = false;
+            if (RefreshCapturePlan())
             {
-                g_Running = false;
-                break;
+                if (!ApplyCapturePlan())
+                {
+                    MessageBoxA(nullptr, "Failed to rebuild the capture for the new display layout", "Error", MB_OK | MB_ICONERROR);
+                    g_Running = false;
+                    break;
+                }
+
+                // New refresh rates: restart pacing and scheduling on the new clocks
+                DiscoverFrameRates(lpCmdLine);
+                pacer.SetPeriod(1000000000LL * g_PresentRate.den, g_PresentRate.num);
+                converter = RateConverter(g_CaptureRate, g_PresentRate);
+                budget.SetBudget(g_PresentRate.PeriodNs());
+                g_Governor.SetBudget(g_PresentRate.PeriodNs());
+                schedulerConfig.nominalPeriodNs = g_PresentRate.PeriodNs();
+                scheduler = VsyncScheduler(schedulerConfig);
+                targetVblankNs = 0;
             }
-            TranslateMessage(&msg);
-            DispatchMessageA(&msg);
+        }
+
+        // A GPU rebuild for a new plan finishes between frames
+        if (g_Running && !FinishPlanRebuild())
+        {
+            MessageBoxA(nullptr, "Failed to rebuild the capture for the new display layout", "Error", MB_OK | MB_ICONERROR);
+            g_Running = false;
+            break;
         }
 
         if (g_Running)
         {
-            CaptureAndRender();
+            PollInputActivity();
+
+            int64_t frameStartNs = pacer.Clock()->NowNs();
+            bool captureDue = converter.OnPresentTick(targetVblankNs ? targetVblankNs : frameStartNs);
+            if (captureDue && ++captureTicks % g_Governor.Settings().captureDivisor != 0)
+                captureDue = false;  // Reduced-rate quality level: repeat the previous capture
+            uint64_t allocationsBefore = HeapAllocationCount();
+            bool presented = CaptureAndRender(captureDue);
+            g_FrameArena.Reset();
+
+            uint64_t allocations = HeapAllocationCount() - allocationsBefore;
+            if (++framesRun > STEADY_STATE_FRAMES && allocations && !allocationReported)
+            {
+                char buf[256];
+                sprintf(buf, "DesktopCapture: steady-state frame %llu made %llu heap allocations\n",
+                    (unsigned long long)framesRun, (unsigned long long)allocations);
+                OutputDebugStringA(buf);
+                allocationReported = true;
+            }
+            if (presented && !g_CpuFallback)
+            {
+                TrackPresentTiming(scheduler, targetVblankNs);
+            }
 
             // Aggressively maintain topmost status
             SetWindowPos(g_hWnd, HWND_TOPMOST, 0, 0, 0, 0, 
@@ -343,20 +440,79 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int)
                 g_pSetWindowBand(g_hWnd, HWND_TOPMOST, ZBID_ABOVELOCK_UX);
             }
 
-            QueryPerformanceCounter(&currentTime);
-            double elapsedMs = (double)(currentTime.QuadPart - lastTime.QuadPart) * 1000.0 / frequency.QuadPart;
-            
-            if (elapsedMs < FRAME_TIME_MS)
+            int64_t nowNs = pacer.Clock()->NowNs();
+            if (presented)
             {
-                Sleep((DWORD)(FRAME_TIME_MS - elapsedMs));
+                scheduler.AddWorkSample(nowNs - frameStartNs);
+
+                if (budget.AddFrame(nowNs - frameStartNs))
+                {
+                    char buf[256];
+                    sprintf(buf, "DesktopCapture: p99 frame time %.2f ms exceeds the %.2f ms budget at %.2f Hz\n",
+                        budget.PredictedWorkNs() / 1e6, budget.BudgetNs() / 1e6, g_PresentRate.Hz());
+                    OutputDebugStringA(buf);
+                }
+
+                if (g_Governor.AddFrame(nowNs - frameStartNs, nowNs))
+                {
+                    char buf[128];
+                    sprintf(buf, "DesktopCapture: quality level -> %s\n", g_Governor.Settings().name);
+                    OutputDebugStringA(buf);
+                }
+            }
+
+            if (nowNs >= wakeupReportNs)
+            {
+                ReportWakeups(nowNs);
+                wakeupReportNs = nowNs + WAKEUP_REPORT_NS;
+            }
+
+            SetInputWake(ActiveIdlePolicy().IsThrottled());
+
+            int64_t startNs;
+            if (g_FrameDue)
+            {
+                // Set during this frame (a message dispatched by a window call): run the next one now
+                targetVblankNs = 0;
+                pacer.Reset();
+            }
+            else if (ActiveIdlePolicy().IsThrottled())
+            {
+                // Idle: sleep through several refresh periods per poll
+                targetVblankNs = 0;
+                pacer.WaitForNextFrame(ActiveIdlePolicy().PollDivisor());
+            }
+            else if (scheduler.PlanNextFrame(nowNs, &startNs, &targetVblankNs))
+            {
+                pacer.WaitUntil(startNs);
+                if (pacer.WasInterrupted())
+                    targetVblankNs = 0;     // Started early for an event, off the vblank plan
+            }
+            else
+            {
+                targetVblankNs = 0;
+                pacer.WaitForNextFrame();
             }
-            
-            QueryPerformanceCounter(&lastTime);
         }
     }
 
     UnregisterHotKey(g_hWnd, 1);
+    UnregisterHotKey(g_hWnd, 2);
+    SetInputWake(false);
+    pacer.SetWaiter(nullptr);
+    g_EventLoop.SetHandler(nullptr);
     timeEndPeriod(1);
+    ReportWakeups(GetSystemFrameClock()->NowNs());
+
+    // Report how long each quality level was in use
+    char report[256];
+    g_Governor.Flush(GetSystemFrameClock()->NowNs());
+    FormatQualityReport(g_Governor, report, sizeof(report));
+    OutputDebugStringA("DesktopCapture: ");
+    OutputDebugStringA(report);
+    OutputDebugStringA("\n");
+
+    ReportSourceRecovery();
 
     // Restore Windows shell elements
     ShowWindowsShell();
@@ -372,6 +528,17 @@ LRESULT CALLBACK WindowProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
     case WM_DESTROY:
         PostQuitMessage(0);
         return 0;
+    case WM_DISPLAYCHANGE:
+    case WM_DPICHANGED:
+        // Re-planned before the next frame, which runs at once
+        g_DisplayChanged = true;
+        g_FrameDue = true;
+        return 0;
+    case WM_INPUT:
+        // Registered only while idle: leave throttling now rather than at the next slow poll
+        ActiveIdlePolicy().OnInput(GetSystemFrameClock()->NowNs());
+        g_FrameDue = true;
+        break;  // DefWindowProc releases the raw input buffer
     }
     return DefWindowProcA(hWnd, msg, wParam, lParam);
 }
@@ -407,8 +574,8 @@ bool InitWindow(HINSTANCE hInstance)
             L"DesktopCaptureDXGIClass",
             L"Desktop Capture DXGI",
             WS_POPUP,
-            FIRST_MONITOR_X, FIRST_MONITOR_Y,
-            OUTPUT_WIDTH, OUTPUT_HEIGHT,
+            g_Plan.outputX, g_Plan.outputY,
+            g_Plan.geometry.outputWidth, g_Plan.geometry.outputHeight,
             nullptr, nullptr, hInstance, nullptr,
             ZBID_ABOVELOCK_UX
         );
@@ -421,8 +588,8 @@ bool InitWindow(HINSTANCE hInstance)
                 L"DesktopCaptureDXGIClass",
                 L"Desktop Capture DXGI",
                 WS_POPUP,
-                FIRST_MONITOR_X, FIRST_MONITOR_Y,
-                OUTPUT_WIDTH, OUTPUT_HEIGHT,
+                g_Plan.outputX, g_Plan.outputY,
+                g_Plan.geometry.outputWidth, g_Plan.geometry.outputHeight,
                 nullptr, nullptr, hInstance, nullptr,
                 ZBID_SYSTEM_TOOLS
             );
@@ -437,8 +604,8 @@ bool InitWindow(HINSTANCE hInstance)
             "DesktopCaptureDXGIClass",
             "Desktop Capture DXGI",
             WS_POPUP,
-            FIRST_MONITOR_X, FIRST_MONITOR_Y,
-            OUTPUT_WIDTH, OUTPUT_HEIGHT,
+            g_Plan.outputX, g_Plan.outputY,
+            g_Plan.geometry.outputWidth, g_Plan.geometry.outputHeight,
             nullptr, nullptr, hInstance, nullptr
         );
     }
@@ -473,6 +640,42 @@ bool InitWindow(HINSTANCE hInstance)
     return true;
 }
 
+// Back buffer, render target view and viewport for a swap chain of the given size
+static bool CreateRenderTarget(int width, int height)
+{
+    HRESULT hr = g_SwapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)&g_BackBuffer);
+    if (FAILED(hr))
+        return false;
+
+    hr = g_Device->CreateRenderTargetView(g_BackBuffer, nullptr, &g_RenderTargetView);
+    if (FAILED(hr))
+        return false;
+
+    D3D11_VIEWPORT viewport = {};
+    viewport.Width = (float)width;
+    viewport.Height = (float)height;
+    viewport.MinDepth = 0.0f;
+    viewport.MaxDepth = 1.0f;
+    g_Context->RSSetViewports(1, &viewport);
+    return true;
+}
+
+// Frame thread: the swap chain's buffers at a new output size (no-op when it is unchanged)
+static bool ResizeSwapChain(int width, int height)
+{
+    DXGI_SWAP_CHAIN_DESC1 desc;
+    if (SUCCEEDED(g_SwapChain->GetDesc1(&desc)) && (int)desc.Width == width && (int)desc.Height == height)
+        return true;
+
+    // ResizeBuffers needs every reference to the old buffers gone
+    g_Context->OMSetRenderTargets(0, nullptr, nullptr);
+    if (g_RenderTargetView) { g_RenderTargetView->Release(); g_RenderTargetView = nullptr; }
+    if (g_BackBuffer) { g_BackBuffer->Release(); g_BackBuffer = nullptr; }
+    if (FAILED(g_SwapChain->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN, 0)))
+        return false;
+    return CreateRenderTarget(width, height);
+}
+
 bool InitD3D()
 {
     HRESULT hr;
@@ -522,8 +725,8 @@ bool InitD3D()
 
     // Create swap chain (windowed mode for desktop duplication compatibility)
     DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
-    swapChainDesc.Width = OUTPUT_WIDTH;
-    swapChainDesc.Height = OUTPUT_HEIGHT;
+    swapChainDesc.Width = g_Plan.geometry.outputWidth;
+    swapChainDesc.Height = g_Plan.geometry.outputHeight;
     swapChainDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
     swapChainDesc.SampleDesc.Count = 1;
     swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
@@ -547,27 +750,12 @@ bool InitD3D()
     if (FAILED(hr))
         return false;
 
-    // Get back buffer and create render target view
-    hr = g_SwapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)&g_BackBuffer);
-    if (FAILED(hr))
-        return false;
-
-    hr = g_Device->CreateRenderTargetView(g_BackBuffer, nullptr, &g_RenderTargetView);
-    if (FAILED(hr))
-        return false;
-
-    // Set viewport
-    D3D11_VIEWPORT viewport = {};
-    viewport.Width = (float)OUTPUT_WIDTH;
-    viewport.Height = (float)OUTPUT_HEIGHT;
-    viewport.MinDepth = 0.0f;
-    viewport.MaxDepth = 1.0f;
-    g_Context->RSSetViewports(1, &viewport);
-
-    return true;
+    return CreateRenderTarget(g_Plan.geometry.outputWidth, g_Plan.geometry.outputHeight);
 }
 
-bool InitDesktopDuplication()
+// Duplicates the output whose desktop rect starts at (sourceX, sourceY) (else the adapter's first).
+// Only touches the device, so the recovery thread can call it while frames render.
+static bool CreateDuplication(int sourceX, int sourceY, IDXGIOutputDuplication** dupl)
 {
     HRESULT hr;
 
@@ -583,11 +771,21 @@ bool InitDesktopDuplication()
     if (FAILED(hr))
         return false;
 
-    // Get primary output (monitor)
     IDXGIOutput* dxgiOutput = nullptr;
-    hr = dxgiAdapter->EnumOutputs(0, &dxgiOutput);
+    for (UINT i = 0; SUCCEEDED(dxgiAdapter->EnumOutputs(i, &dxgiOutput)); i++)
+    {
+        DXGI_OUTPUT_DESC outputDesc;
+        if (SUCCEEDED(dxgiOutput->GetDesc(&outputDesc)) &&
+            outputDesc.DesktopCoordinates.left == sourceX &&
+            outputDesc.DesktopCoordinates.top == sourceY)
+            break;
+        dxgiOutput->Release();
+        dxgiOutput = nullptr;
+    }
+    if (!dxgiOutput)
+        dxgiAdapter->EnumOutputs(0, &dxgiOutput);
     dxgiAdapter->Release();
-    if (FAILED(hr))
+    if (!dxgiOutput)
         return false;
 
     IDXGIOutput1* dxgiOutput1 = nullptr;
@@ -597,15 +795,20 @@ bool InitDesktopDuplication()
         return false;
 
     // Create desktop duplication
-    hr = dxgiOutput1->DuplicateOutput(g_Device, &g_DeskDupl);
+    hr = dxgiOutput1->DuplicateOutput(g_Device, dupl);
     dxgiOutput1->Release();
-    if (FAILED(hr))
-        return false;
+    return SUCCEEDED(hr);
+}
+
+// Texture each acquired frame is copied into, and the view the scaling shader samples
+static bool CreateSourceTexture(UINT width, UINT height, ID3D11Texture2D** texture, ID3D11ShaderResourceView** srv)
+{
+    HRESULT hr;
 
     // Create staging texture for CPU access if needed
     D3D11_TEXTURE2D_DESC stagingDesc = {};
-    stagingDesc.Width = SOURCE_WIDTH;
-    stagingDesc.Height = SOURCE_HEIGHT;
+    stagingDesc.Width = width;
+    stagingDesc.Height = height;
     stagingDesc.MipLevels = 1;
     stagingDesc.ArraySize = 1;
     stagingDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
@@ -613,7 +816,7 @@ bool InitDesktopDuplication()
     stagingDesc.Usage = D3D11_USAGE_DEFAULT;
     stagingDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
     
-    hr = g_Device->CreateTexture2D(&stagingDesc, nullptr, &g_StagingTexture);
+    hr = g_Device->CreateTexture2D(&stagingDesc, nullptr, texture);
     if (FAILED(hr))
         return false;
 
@@ -623,13 +826,166 @@ bool InitDesktopDuplication()
     srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
     srvDesc.Texture2D.MipLevels = 1;
     
-    hr = g_Device->CreateShaderResourceView(g_StagingTexture, &srvDesc, &g_DesktopSRV);
+    hr = g_Device->CreateShaderResourceView(*texture, &srvDesc, srv);
     if (FAILED(hr))
+    {
+        (*texture)->Release();
+        *texture = nullptr;
         return false;
+    }
 
     return true;
 }
 
+bool InitDesktopDuplication()
+{
+    return CreateDuplication(g_Plan.geometry.sourceX, g_Plan.geometry.sourceY, &g_DeskDupl) &&
+           CreateSourceTexture(g_Plan.geometry.sourceWidth, g_Plan.geometry.sourceHeight, &g_StagingTexture, &g_DesktopSRV);
+}
+
+// Staged by the recovery thread, swapped in on the frame thread by Resume
+static IDXGIOutputDuplication* g_PendingDupl = nullptr;
+static ID3D11Texture2D* g_PendingStaging = nullptr;         // Only when the mode size changed
+static ID3D11ShaderResourceView* g_PendingSRV = nullptr;
+
+// Rebuilds a lost duplication off the frame thread. The device, swap chain, shaders and staging
+// texture survive DXGI_ERROR_ACCESS_LOST, so only the duplication is recreated (and the staging
+// texture when the new mode has a different size).
+class DuplicationRecovery : public RecoverableSource
+{
+public:
+    // Frame thread, before SourceRecovery::OnLost: the monitor to duplicate again. Reinitialize
+    // reads it unlocked, so no attempt may be in flight (SourceRecovery::Cancel first).
+    void SetSource(int x, int y)
+    {
+        m_SourceX = x;
+        m_SourceY = y;
+    }
+
+    // Frame thread, after SourceRecovery::Cancel: objects a cancelled attempt staged
+    void DiscardStaged()
+    {
+        if (g_PendingSRV) { g_PendingSRV->Release(); g_PendingSRV = nullptr; }
+        if (g_PendingStaging) { g_PendingStaging->Release(); g_PendingStaging = nullptr; }
+        if (g_PendingDupl) { g_PendingDupl->Release(); g_PendingDupl = nullptr; }
+    }
+
+    bool Reinitialize() override
+    {
+        IDXGIOutputDuplication* dupl = nullptr;
+        if (!CreateDuplication(m_SourceX, m_SourceY, &dupl))
+            return false;
+
+        DXGI_OUTDUPL_DESC duplDesc;
+        D3D11_TEXTURE2D_DESC stagingDesc;
+        dupl->GetDesc(&duplDesc);
+        g_StagingTexture->GetDesc(&stagingDesc);
+        if ((duplDesc.ModeDesc.Width != stagingDesc.Width || duplDesc.ModeDesc.Height != stagingDesc.Height) &&
+            !CreateSourceTexture(duplDesc.ModeDesc.Width, duplDesc.ModeDesc.Height, &g_PendingStaging, &g_PendingSRV))
+        {
+            dupl->Release();
+            return false;
+        }
+
+        g_PendingDupl = dupl;
+        return true;
+    }
+
+    void Resume() override;
+
+private:
+    int m_SourceX = 0;
+    int m_SourceY = 0;
+};
+
+static DuplicationRecovery g_DuplRecovery;
+static SourceRecovery g_SourceRecovery(&g_DuplRecovery);
+
+void DuplicationRecovery::Resume()
+{
+    g_DeskDupl = g_PendingDupl;
+    g_PendingDupl = nullptr;
+    if (g_PendingStaging)
+    {
+        g_DesktopSRV->Release();
+        g_StagingTexture->Release();
+        g_StagingTexture = g_PendingStaging;
+        g_DesktopSRV = g_PendingSRV;
+        g_PendingStaging = nullptr;
+        g_PendingSRV = nullptr;
+    }
+
+    // The held frame may be stale, or a blank new staging texture: present the next poll
+    g_Idle.Reset(GetSystemFrameClock()->NowNs());
+
+    char buf[128];
+    sprintf(buf, "DesktopCapture: desktop duplication restored after %.1f ms\n",
+        g_SourceRecovery.OutageNs(GetSystemFrameClock()->NowNs()) / 1e6);
+    OutputDebugStringA(buf);
+}
+
+// Outages over the whole run, at exit
+void ReportSourceRecovery()
+{
+    const SourceRecoveryStats& recovery = g_SourceRecovery.Stats();
+    if (!recovery.outages)
+        return;
+
+    char buf[256];
+    sprintf(buf, "DesktopCapture: %llu duplication outages, %.1f ms total, %.1f ms longest, %llu frames held, %llu re-init attempts\n",
+        (unsigned long long)recovery.outages, recovery.totalOutageNs / 1e6, recovery.maxOutageNs / 1e6,
+        (unsigned long long)recovery.heldFrames, (unsigned long long)recovery.attempts);
+    OutputDebugStringA(buf);
+}
+
+// Pixel shader with the plan's render area baked in. Only touches the device, so a plan rebuild
+// can compile it off the frame thread.
+static bool CreatePlanPixelShader(const CapturePlan& plan, ID3D11PixelShader** pixelShader)
+{
+    HRESULT hr;
+    ID3DBlob* errorBlob = nullptr;
+    char renderU[32];
+    char renderV[32];
+    sprintf(renderU, "%.9gf", plan.renderU);
+    sprintf(renderV, "%.9gf", plan.renderV);
+    D3D_SHADER_MACRO psMacros[] = {
+        { "RENDER_U", renderU },
+        { "RENDER_V", renderV },
+        { nullptr, nullptr }
+    };
+
+    ID3DBlob* psBlob = nullptr;
+    hr = D3DCompile(
+        g_ShaderSource,
+        strlen(g_ShaderSource),
+        "shader",
+        psMacros,
+        nullptr,
+        "PS",
+        "ps_4_0",
+        0, 0,
+        &psBlob,
+        &errorBlob
+    );
+    
+    if (FAILED(hr))
+    {
+        // May run on the plan rebuild thread: a modal box would stall it, so the failure is
+        // logged and reported through the result
+        OutputDebugStringA("DesktopCapture: pixel shader compile failed\n");
+        if (errorBlob)
+        {
+            OutputDebugStringA((char*)errorBlob->GetBufferPointer());
+            errorBlob->Release();
+        }
+        return false;
+    }
+
+    hr = g_Device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, pixelShader);
+    psBlob->Release();
+    return SUCCEEDED(hr);
+}
+
 bool InitShaders()
 {
     HRESULT hr;
@@ -679,34 +1035,7 @@ bool InitShaders()
     if (FAILED(hr))
         return false;
 
-    // Compile pixel shader
-    ID3DBlob* psBlob = nullptr;
-    hr = D3DCompile(
-        g_ShaderSource,
-        strlen(g_ShaderSource),
-        "shader",
-        nullptr,
-        nullptr,
-        "PS",
-        "ps_4_0",
-        0, 0,
-        &psBlob,
-        &errorBlob
-    );
-    
-    if (FAILED(hr))
-    {
-        if (errorBlob)
-        {
-            MessageBoxA(nullptr, (char*)errorBlob->GetBufferPointer(), "PS Compile Error", MB_OK);
-            errorBlob->Release();
-        }
-        return false;
-    }
-
-    hr = g_Device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &g_PixelShader);
-    psBlob->Release();
-    if (FAILED(hr))
+    if (!CreatePlanPixelShader(g_Plan, &g_PixelShader))
         return false;
 
     // Create sampler state (bilinear filtering for smooth scaling)
@@ -723,6 +1052,12 @@ bool InitShaders()
     if (FAILED(hr))
         return false;
 
+    // Point sampler for the governor's fast-filter level
+    samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_POINT;
+    hr = g_Device->CreateSamplerState(&samplerDesc, &g_PointSamplerState);
+    if (FAILED(hr))
+        return false;
+
     // Create fullscreen quad vertex buffer
     Vertex vertices[] = {
         { -1.0f,  1.0f, 0.0f, 0.0f },  // Top-left
@@ -746,210 +1081,285 @@ bool InitShaders()
     return true;
 }
 
+// GPU objects a capture plan needs beyond the device; null where the plan kept the current ones
+struct PlanObjects
+{
+    ID3D11PixelShader* pixelShader = nullptr;
+    IDXGIOutputDuplication* dupl = nullptr;
+    ID3D11Texture2D* staging = nullptr;
+    ID3D11ShaderResourceView* srv = nullptr;
+
+    void Release()
+    {
+        if (srv) { srv->Release(); srv = nullptr; }
+        if (staging) { staging->Release(); staging = nullptr; }
+        if (dupl) { dupl->Release(); dupl = nullptr; }
+        if (pixelShader) { pixelShader->Release(); pixelShader = nullptr; }
+    }
+};
+
+// Builds the objects for a new plan on a thread of its own while the frame thread keeps presenting
+// the current one; FinishPlanRebuild swaps them in between frames. The device survives a display
+// change, so only what the plan changes is rebuilt: the pixel shader (render area), the duplication
+// when the source monitor moved, the staging texture when the source rect changed. An output is
+// duplicated once per process, so a source that stays put keeps its duplication (a mode change
+// loses it and SourceRecovery rebuilds it at the new size).
+class PlanRebuild
+{
+public:
+    ~PlanRebuild() { Cancel(); }
+
+    // Frame thread: abandons a build in flight and starts one for plan
+    void Start(const CapturePlan& plan, const CapturePlan& current)
+    {
+        Cancel();
+        const MirrorGeometry& next = plan.geometry;
+        const MirrorGeometry& now = current.geometry;
+        m_Plan = plan;
+        m_NewSource = next.sourceX != now.sourceX || next.sourceY != now.sourceY;
+        m_NewStaging = m_NewSource || next.sourceWidth != now.sourceWidth || next.sourceHeight != now.sourceHeight;
+        m_Ok = false;
+        m_Done.store(false, std::memory_order_relaxed);
+        m_Thread = std::thread(&PlanRebuild::ThreadMain, this);
+    }
+
+    // Frame thread: a build has finished, successfully or not
+    bool Ready() const { return m_Thread.joinable() && m_Done.load(std::memory_order_acquire); }
+
+    // Frame thread, once Ready: hands over the objects and the plan they were built for, and
+    // returns whether the build succeeded. After a failure the plan is still handed over but the
+    // objects are all null (the build thread released what it had made).
+    bool Take(PlanObjects* objects, CapturePlan* plan)
+    {
+        m_Thread.join();
+        *objects = m_Objects;
+        m_Objects = PlanObjects();
+        *plan = m_Plan;
+        return m_Ok;
+    }
+
+    // Frame thread: waits out a build in flight and releases what it made
+    void Cancel()
+    {
+        if (!m_Thread.joinable())
+            return;
+        m_Thread.join();
+        m_Objects.Release();
+    }
+
+private:
+    void ThreadMain()
+    {
+        const MirrorGeometry& g = m_Plan.geometry;
+        m_Ok = CreatePlanPixelShader(m_Plan, &m_Objects.pixelShader) &&
+               (!m_NewSource || CreateDuplication(g.sourceX, g.sourceY, &m_Objects.dupl)) &&
+               (!m_NewStaging || CreateSourceTexture(g.sourceWidth, g.sourceHeight, &m_Objects.staging, &m_Objects.srv));
+        if (!m_Ok)
+            m_Objects.Release();
+        m_Done.store(true, std::memory_order_release);
+    }
+
+    CapturePlan m_Plan;
+    bool m_NewSource = false;
+    bool m_NewStaging = false;
+    PlanObjects m_Objects;
+    bool m_Ok = false;
+    std::thread m_Thread;
+    std::atomic<bool> m_Done{false};
+};
+
+static PlanRebuild g_PlanRebuild;
+
 void DrawCursorOnTexture(ID3D11Texture2D* destTexture, int cursorX, int cursorY)
 {
-    if (!g_CursorBuffer || g_CursorWidth == 0 || g_CursorHeight == 0)
+    if (g_Cursor.width == 0 || g_Cursor.height == 0)
         return;
     
     // Adjust cursor position by hotspot
-    int drawX = cursorX - g_CursorHotspotX;
-    int drawY = cursorY - g_CursorHotspotY;
+    int drawX = cursorX - g_Cursor.hotspotX;
+    int drawY = cursorY - g_Cursor.hotspotY;
     
-    // Create a staging texture for CPU write
+    // Only the pixels under the cursor round-trip through the CPU
     D3D11_TEXTURE2D_DESC desc;
     destTexture->GetDesc(&desc);
     
-    ID3D11Texture2D* stagingTex = nullptr;
-    D3D11_TEXTURE2D_DESC stagingDesc = desc;
-    stagingDesc.Usage = D3D11_USAGE_STAGING;
-    stagingDesc.BindFlags = 0;
-    stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ | D3D11_CPU_ACCESS_WRITE;
-    
-    if (FAILED(g_Device->CreateTexture2D(&stagingDesc, nullptr, &stagingTex)))
+    int left = drawX < 0 ? 0 : drawX;
+    int top = drawY < 0 ? 0 : drawY;
+    int right = drawX + g_Cursor.width < (int)desc.Width ? drawX + g_Cursor.width : (int)desc.Width;
+    int bottom = drawY + g_Cursor.height < (int)desc.Height ? drawY + g_Cursor.height : (int)desc.Height;
+    if (left >= right || top >= bottom)
         return;
+    UINT width = (UINT)(right - left);
+    UINT height = (UINT)(bottom - top);
     
-    g_Context->CopyResource(stagingTex, destTexture);
+    // Kept across frames; recreated only when a bigger cursor needs more room
+    if (!g_CursorStaging || width > g_CursorStagingWidth || height > g_CursorStagingHeight)
+    {
+        if (g_CursorStaging) { g_CursorStaging->Release(); g_CursorStaging = nullptr; }
+        
+        D3D11_TEXTURE2D_DESC stagingDesc = desc;
+        stagingDesc.Width = width > (UINT)CURSOR_MAX_SIZE ? width : (UINT)CURSOR_MAX_SIZE;
+        stagingDesc.Height = height > (UINT)CURSOR_MAX_SIZE ? height : (UINT)CURSOR_MAX_SIZE;
+        stagingDesc.MipLevels = 1;
+        stagingDesc.ArraySize = 1;
+        stagingDesc.Usage = D3D11_USAGE_STAGING;
+        stagingDesc.BindFlags = 0;
+        stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ | D3D11_CPU_ACCESS_WRITE;
+        stagingDesc.MiscFlags = 0;
+        
+        if (FAILED(g_Device->CreateTexture2D(&stagingDesc, nullptr, &g_CursorStaging)))
+            return;
+        g_CursorStagingWidth = stagingDesc.Width;
+        g_CursorStagingHeight = stagingDesc.Height;
+    }
+    
+    D3D11_BOX region = { (UINT)left, (UINT)top, 0, (UINT)right, (UINT)bottom, 1 };
+    g_Context->CopySubresourceRegion(g_CursorStaging, 0, 0, 0, 0, destTexture, 0, &region);
     
     D3D11_MAPPED_SUBRESOURCE mapped;
-    if (SUCCEEDED(g_Context->Map(stagingTex, 0, D3D11_MAP_READ_WRITE, 0, &mapped)))
+    if (SUCCEEDED(g_Context->Map(g_CursorStaging, 0, D3D11_MAP_READ_WRITE, 0, &mapped)))
     {
-        BYTE* destData = (BYTE*)mapped.pData;
+        // The staging copy holds the clipped rect at its origin; the back buffer is B8G8R8A8
+        ImageView<FormatBGRA8> region(mapped.pData, (int)width, (int)height, mapped.RowPitch);
+        BlendCursor(region, g_Cursor, drawX - left, drawY - top, g_LinearLight);
         
-        for (int y = 0; y < g_CursorHeight; y++)
-        {
-            int destY = drawY + y;
-            if (destY < 0 || destY >= (int)desc.Height)
-                continue;
-            
-            for (int x = 0; x < g_CursorWidth; x++)
-            {
-                int destX = drawX + x;
-                if (destX < 0 || destX >= (int)desc.Width)
-                    continue;
-                
-                int srcIdx = (y * g_CursorWidth + x) * 4;
-                int destIdx = destY * mapped.RowPitch + destX * 4;
-                
-                BYTE srcA = g_CursorBuffer[srcIdx + 3];
-                if (srcA > 0)
-                {
-                    BYTE srcB = g_CursorBuffer[srcIdx + 0];
-                    BYTE srcG = g_CursorBuffer[srcIdx + 1];
-                    BYTE srcR = g_CursorBuffer[srcIdx + 2];
-                    
-                    if (srcA == 255)
-                    {
-                        destData[destIdx + 0] = srcB;
-                        destData[destIdx + 1] = srcG;
-                        destData[destIdx + 2] = srcR;
-                        destData[destIdx + 3] = 255;
-                    }
-                    else
-                    {
-                        // Alpha blend
-                        BYTE destB = destData[destIdx + 0];
-                        BYTE destG = destData[destIdx + 1];
-                        BYTE destR = destData[destIdx + 2];
-                        
-                        destData[destIdx + 0] = (srcB * srcA + destB * (255 - srcA)) / 255;
-                        destData[destIdx + 1] = (srcG * srcA + destG * (255 - srcA)) / 255;
-                        destData[destIdx + 2] = (srcR * srcA + destR * (255 - srcA)) / 255;
-                        destData[destIdx + 3] = 255;
-                    }
-                }
-            }
-        }
+        g_Context->Unmap(g_CursorStaging, 0);
         
-        g_Context->Unmap(stagingTex, 0);
-        g_Context->CopyResource(destTexture, stagingTex);
+        D3D11_BOX cursorBox = { 0, 0, 0, width, height, 1 };
+        g_Context->CopySubresourceRegion(destTexture, 0, (UINT)left, (UINT)top, 0, g_CursorStaging, 0, &cursorBox);
     }
-    
-    stagingTex->Release();
 }
 
 void UpdateCursorShape(DXGI_OUTDUPL_POINTER_SHAPE_INFO* shapeInfo, BYTE* shapeBuffer)
 {
-    if (g_CursorBuffer)
+    g_Cursor.hotspotX = shapeInfo->HotSpot.x;
+    g_Cursor.hotspotY = shapeInfo->HotSpot.y;
+    
+    // Monochrome / masked color shapes are expanded 8 mask bits at a time
+    if (!DecodeCursorShape((CursorShapeType)shapeInfo->Type, shapeInfo->Width, shapeInfo->Height,
+                           shapeInfo->Pitch, shapeBuffer, &g_Cursor))
     {
-        delete[] g_CursorBuffer;
-        g_CursorBuffer = nullptr;
+        g_Cursor.width = 0;
+        g_Cursor.height = 0;
     }
-    
-    g_CursorWidth = shapeInfo->Width;
-    g_CursorHeight = shapeInfo->Height;
-    g_CursorHotspotX = shapeInfo->HotSpot.x;
-    g_CursorHotspotY = shapeInfo->HotSpot.y;
-    
-    if (shapeInfo->Type == DXGI_OUTDUPL_POINTER_SHAPE_TYPE_MONOCHROME)
+}
+
+// While idle-throttled, raw keyboard/mouse input from any window (RIDEV_INPUTSINK) wakes the loop;
+// at full rate the per-frame GetLastInputInfo check is soon enough and raw input would only add wakeups
+void SetInputWake(bool enable)
+{
+    if (enable == g_InputWake || !g_hWnd)
+        return;
+
+    RAWINPUTDEVICE devices[2] = {};
+    devices[0].usUsagePage = 0x01;  // Generic desktop
+    devices[0].usUsage = 0x02;      // Mouse
+    devices[1].usUsagePage = 0x01;
+    devices[1].usUsage = 0x06;      // Keyboard
+    for (RAWINPUTDEVICE& device : devices)
     {
-        // Monochrome cursor: height is 2x (AND mask + XOR mask)
-        g_CursorHeight = shapeInfo->Height / 2;
-        g_CursorBuffer = new BYTE[g_CursorWidth * g_CursorHeight * 4];
-        
-        int widthBytes = (g_CursorWidth + 7) / 8;
-        
-        for (int y = 0; y < g_CursorHeight; y++)
-        {
-            for (int x = 0; x < g_CursorWidth; x++)
-            {
-                int byteIdx = y * shapeInfo->Pitch + x / 8;
-                int bitIdx = 7 - (x % 8);
-                
-                int andBit = (shapeBuffer[byteIdx] >> bitIdx) & 1;
-                int xorBit = (shapeBuffer[byteIdx + g_CursorHeight * shapeInfo->Pitch] >> bitIdx) & 1;
-                
-                int destIdx = (y * g_CursorWidth + x) * 4;
-                
-                if (andBit == 0 && xorBit == 0)
-                {
-                    // Black
-                    g_CursorBuffer[destIdx + 0] = 0;
-                    g_CursorBuffer[destIdx + 1] = 0;
-                    g_CursorBuffer[destIdx + 2] = 0;
-                    g_CursorBuffer[destIdx + 3] = 255;
-                }
-                else if (andBit == 0 && xorBit == 1)
-                {
-                    // White
-                    g_CursorBuffer[destIdx + 0] = 255;
-                    g_CursorBuffer[destIdx + 1] = 255;
-                    g_CursorBuffer[destIdx + 2] = 255;
-                    g_CursorBuffer[destIdx + 3] = 255;
-                }
-                else if (andBit == 1 && xorBit == 0)
-                {
-                    // Transparent
-                    g_CursorBuffer[destIdx + 0] = 0;
-                    g_CursorBuffer[destIdx + 1] = 0;
-                    g_CursorBuffer[destIdx + 2] = 0;
-                    g_CursorBuffer[destIdx + 3] = 0;
-                }
-                else
-                {
-                    // Inverse (render as semi-transparent white)
-                    g_CursorBuffer[destIdx + 0] = 255;
-                    g_CursorBuffer[destIdx + 1] = 255;
-                    g_CursorBuffer[destIdx + 2] = 255;
-                    g_CursorBuffer[destIdx + 3] = 128;
-                }
-            }
-        }
+        device.dwFlags = enable ? RIDEV_INPUTSINK : RIDEV_REMOVE;
+        device.hwndTarget = enable ? g_hWnd : nullptr;
     }
-    else if (shapeInfo->Type == DXGI_OUTDUPL_POINTER_SHAPE_TYPE_COLOR)
+    if (RegisterRawInputDevices(devices, 2, sizeof(RAWINPUTDEVICE)) || !enable)
+        g_InputWake = enable;
+}
+
+// Drains the thread's message queue; false once the app is quitting
+bool PumpMessages()
+{
+    MSG msg;
+    while (PeekMessageA(&msg, nullptr, 0, 0, PM_REMOVE))
     {
-        // 32-bit BGRA cursor
-        g_CursorBuffer = new BYTE[g_CursorWidth * g_CursorHeight * 4];
-        
-        for (int y = 0; y < g_CursorHeight; y++)
+        if (msg.message == WM_QUIT || (msg.message == WM_HOTKEY && msg.wParam == 1))
         {
-            memcpy(g_CursorBuffer + y * g_CursorWidth * 4,
-                   shapeBuffer + y * shapeInfo->Pitch,
-                   g_CursorWidth * 4);
+            g_Running = false;
+            return false;
         }
-    }
-    else if (shapeInfo->Type == DXGI_OUTDUPL_POINTER_SHAPE_TYPE_MASKED_COLOR)
-    {
-        // Masked color cursor
-        g_CursorBuffer = new BYTE[g_CursorWidth * g_CursorHeight * 4];
-        
-        for (int y = 0; y < g_CursorHeight; y++)
+        if (msg.message == WM_HOTKEY && msg.wParam == 2)
         {
-            for (int x = 0; x < g_CursorWidth; x++)
-            {
-                int srcIdx = y * shapeInfo->Pitch + x * 4;
-                int destIdx = (y * g_CursorWidth + x) * 4;
-                
-                BYTE mask = shapeBuffer[srcIdx + 3];
-                if (mask)
-                {
-                    // XOR with screen - render as semi-transparent
-                    g_CursorBuffer[destIdx + 0] = shapeBuffer[srcIdx + 0];
-                    g_CursorBuffer[destIdx + 1] = shapeBuffer[srcIdx + 1];
-                    g_CursorBuffer[destIdx + 2] = shapeBuffer[srcIdx + 2];
-                    g_CursorBuffer[destIdx + 3] = 128;
-                }
-                else
-                {
-                    // Opaque
-                    g_CursorBuffer[destIdx + 0] = shapeBuffer[srcIdx + 0];
-                    g_CursorBuffer[destIdx + 1] = shapeBuffer[srcIdx + 1];
-                    g_CursorBuffer[destIdx + 2] = shapeBuffer[srcIdx + 2];
-                    g_CursorBuffer[destIdx + 3] = 255;
-                }
-            }
+            // The GPU path reads the flag per frame; the CPU pipeline rebuilds its kernel in the background
+            // and forces a present when it adopts it. On the GPU path nothing on screen changed, so the
+            // idle skip would hide the toggle: present as if input had arrived.
+            g_LinearLight = !g_LinearLight;
+            if (g_CpuFallback)
+                g_CpuPipeline->Reconfigure(g_Plan.geometry, g_LinearLight);
+            else
+                g_Idle.OnInput(GetSystemFrameClock()->NowNs());
+            g_FrameDue = true;
+            continue;
         }
+        TranslateMessage(&msg);
+        DispatchMessageA(&msg);
     }
+    return true;
 }
 
-void CaptureAndRender()
+void ReportWakeups(int64_t nowNs)
 {
-    HRESULT hr;
+    char report[192];
+    g_EventLoop.FormatWakeupReport(nowNs, report, sizeof(report));
+    OutputDebugStringA("DesktopCapture: ");
+    OutputDebugStringA(report);
+    OutputDebugStringA("\n");
+}
+
+// Keyboard/mouse input anywhere in the session ends idle throttling immediately
+void PollInputActivity()
+{
+    LASTINPUTINFO lii = {};
+    lii.cbSize = sizeof(LASTINPUTINFO);
+    if (GetLastInputInfo(&lii) && lii.dwTime != g_LastInputTick)
+    {
+        g_LastInputTick = lii.dwTime;
+        ActiveIdlePolicy().OnInput(GetSystemFrameClock()->NowNs());
+    }
+}
+
+void DiscoverFrameRates(const char* cmdLine)
+{
+    // Source rate from the duplicated output's mode (exact rational), present rate from our monitor
+    DXGI_OUTDUPL_DESC duplDesc = {};
+    if (g_DeskDupl)
+        g_DeskDupl->GetDesc(&duplDesc);
+    if (duplDesc.ModeDesc.RefreshRate.Numerator > 0 && duplDesc.ModeDesc.RefreshRate.Denominator > 0)
+    {
+        g_CaptureRate.num = duplDesc.ModeDesc.RefreshRate.Numerator;
+        g_CaptureRate.den = duplDesc.ModeDesc.RefreshRate.Denominator;
+    }
+    else
+    {
+        g_CaptureRate = g_Plan.sourceRate;
+    }
+    g_PresentRate = g_Plan.outputRate;
+
+    ParseFrameRateOption(cmdLine, "capture-hz", &g_CaptureRate);
+    ParseFrameRateOption(cmdLine, "present-hz", &g_PresentRate);
+}
+
+// Returns true if a new frame was presented.
+// captureDue is false on present ticks between capture-clock ticks (the previous capture repeats).
+bool CaptureAndRender(bool captureDue)
+{
+    if (g_CpuFallback)
+        return g_CpuPipeline->RunFrame(captureDue);
+
+    HRESULT hr = DXGI_ERROR_WAIT_TIMEOUT;
+    bool contentChanged = false;
+    bool cursorChanged = false;
 
     // Acquire next frame from desktop duplication
     DXGI_OUTDUPL_FRAME_INFO frameInfo;
     IDXGIResource* desktopResource = nullptr;
+
+    // While a lost duplication is rebuilt, the staging texture keeps the last good frame on screen
+    int64_t frameNs = GetSystemFrameClock()->NowNs();
+    bool sourceUp = g_SourceRecovery.BeginFrame(frameNs);
     
-    hr = g_DeskDupl->AcquireNextFrame(0, &frameInfo, &desktopResource);
+    if (captureDue && sourceUp)
+    {
+        hr = g_DeskDupl->AcquireNextFrame(0, &frameInfo, &desktopResource);
+    }
     
     if (hr == DXGI_ERROR_WAIT_TIMEOUT)
     {
@@ -957,6 +1367,11 @@ void CaptureAndRender()
     }
     else if (SUCCEEDED(hr))
     {
+        g_SourceRecovery.OnCaptureOk();
+
+        // LastPresentTime is zero when only the mouse moved
+        contentChanged = frameInfo.LastPresentTime.QuadPart != 0;
+        
         // Get the desktop texture
         ID3D11Texture2D* desktopTexture = nullptr;
         hr = desktopResource->QueryInterface(__uuidof(ID3D11Texture2D), (void**)&desktopTexture);
@@ -971,32 +1386,49 @@ void CaptureAndRender()
         // Update cursor shape if changed
         if (frameInfo.PointerShapeBufferSize > 0)
         {
-            BYTE* shapeBuffer = new BYTE[frameInfo.PointerShapeBufferSize];
-            UINT bufferSizeRequired;
-            DXGI_OUTDUPL_POINTER_SHAPE_INFO shapeInfo;
-            
-            hr = g_DeskDupl->GetFramePointerShape(frameInfo.PointerShapeBufferSize,
-                                                   shapeBuffer, &bufferSizeRequired, &shapeInfo);
-            if (SUCCEEDED(hr))
+            BYTE* shapeBuffer = g_FrameArena.AllocateArray<BYTE>(frameInfo.PointerShapeBufferSize);
+            if (shapeBuffer)
             {
-                UpdateCursorShape(&shapeInfo, shapeBuffer);
+                UINT bufferSizeRequired;
+                DXGI_OUTDUPL_POINTER_SHAPE_INFO shapeInfo;
+                hr = g_DeskDupl->GetFramePointerShape(frameInfo.PointerShapeBufferSize,
+                                                       shapeBuffer, &bufferSizeRequired, &shapeInfo);
+                if (SUCCEEDED(hr))
+                {
+                    UpdateCursorShape(&shapeInfo, shapeBuffer);
+                    cursorChanged = true;
+                }
             }
-            
-            delete[] shapeBuffer;
         }
         
         desktopResource->Release();
         g_DeskDupl->ReleaseFrame();
     }
-    else if (hr == DXGI_ERROR_ACCESS_LOST)
+    else if (hr == DXGI_ERROR_ACCESS_LOST || g_SourceRecovery.OnTransientError())
     {
-        // Desktop duplication was lost, need to recreate
+        // Mode change, UAC prompt, fullscreen app (or errors that keep repeating): the duplication
+        // is dead. Release it so the output can be duplicated again, and rebuild in the background.
         g_DeskDupl->Release();
         g_DeskDupl = nullptr;
-        InitDesktopDuplication();
-        return;
+        g_SourceRecovery.Cancel();
+        g_DuplRecovery.DiscardStaged();
+        g_DuplRecovery.SetSource(g_GpuPlan.geometry.sourceX, g_GpuPlan.geometry.sourceY);
+        g_SourceRecovery.OnLost(frameNs);
+        OutputDebugStringA("DesktopCapture: desktop duplication lost, holding the last frame\n");
     }
     
+    POINT cursorPos = {};
+    bool cursorValid = GetCursorPos(&cursorPos) != FALSE;
+    if (cursorValid && (cursorPos.x != g_CursorPosition.x || cursorPos.y != g_CursorPosition.y))
+    {
+        g_CursorPosition = cursorPos;
+        cursorChanged = true;
+    }
+    
+    // Nothing new: the last presented frame is still on screen
+    if (!g_Idle.Update(contentChanged, cursorChanged, frameNs))
+        return false;
+    
     // Clear the render target to black
     float clearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
     g_Context->ClearRenderTargetView(g_RenderTargetView, clearColor);
@@ -1006,7 +1438,7 @@ void CaptureAndRender()
     g_Context->VSSetShader(g_VertexShader, nullptr, 0);
     g_Context->PSSetShader(g_PixelShader, nullptr, 0);
     g_Context->PSSetShaderResources(0, 1, &g_DesktopSRV);
-    g_Context->PSSetSamplers(0, 1, &g_SamplerState);
+    g_Context->PSSetSamplers(0, 1, g_Governor.Settings().fastFilter ? &g_PointSamplerState : &g_SamplerState);
     g_Context->IASetInputLayout(g_InputLayout);
     
     UINT stride = sizeof(Vertex);
@@ -1023,21 +1455,21 @@ void CaptureAndRender()
 
     // Draw cursor on the BACK BUFFER (after desktop render) using real-time cursor position
     // This avoids feedback loop since we're drawing on output, not source
-    POINT cursorPos;
-    if (GetCursorPos(&cursorPos))
+    if (cursorValid)
     {
         // Adjust for monitor position (cursor is in virtual screen coordinates)
-        int cursorX = cursorPos.x - FIRST_MONITOR_X;
-        int cursorY = cursorPos.y - FIRST_MONITOR_Y;
+        const MirrorGeometry& geometry = g_GpuPlan.geometry;
+        int cursorX = cursorPos.x - geometry.sourceX;
+        int cursorY = cursorPos.y - geometry.sourceY;
         
         // Only draw if cursor is within our capture area
-        if (cursorX >= 0 && cursorX < SOURCE_WIDTH && cursorY >= 0 && cursorY < SOURCE_HEIGHT)
+        if (cursorX >= 0 && cursorX < geometry.sourceWidth && cursorY >= 0 && cursorY < geometry.sourceHeight)
         {
-            if (g_CursorBuffer)
+            if (g_Cursor.width > 0)
             {
-                // Scale cursor position: source 1920 -> output 1440 (left 75% of screen)
-                int scaledCursorX = (cursorX * RENDER_WIDTH) / SOURCE_WIDTH;
-                int scaledCursorY = cursorY; // Y doesn't change
+                // Scale cursor position onto the render area (1920 -> 1440 by default)
+                int scaledCursorX = geometry.ToRenderX(cursorX);
+                int scaledCursorY = geometry.ToRenderY(cursorY);
                 
                 DrawCursorOnTexture(g_BackBuffer, scaledCursorX, scaledCursorY);
             }
@@ -1046,15 +1478,414 @@ void CaptureAndRender()
 
     // Present
     g_SwapChain->Present(1, 0);  // VSync enabled
+    return true;
+}
+
+// Memory DC with a top-down 32-bit DIB section selected
+static HDC CreateDibDC(int width, int height, HBITMAP* bitmap, HBITMAP* oldBitmap, void** bits)
+{
+    HDC hdc = CreateCompatibleDC(g_hdcScreen);
+    if (!hdc)
+        return nullptr;
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = width;
+    bmi.bmiHeader.biHeight = -height;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    *bitmap = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, bits, NULL, 0);
+    if (!*bitmap)
+    {
+        DeleteDC(hdc);
+        return nullptr;
+    }
+
+    *oldBitmap = (HBITMAP)SelectObject(hdc, *bitmap);
+    return hdc;
+}
+
+// Cursor handle -> the same sprite DXGI shapes decode to: the GDI mask/colour bitmaps are
+// re-packed as a monochrome, color or masked-color pointer shape buffer
+static bool DecodeCursorHandle(HCURSOR cursor, CursorSprite* sprite)
+{
+    ICONINFO iconInfo = {};
+    if (!GetIconInfo(cursor, &iconInfo))
+        return false;
+
+    BITMAP mask = {};
+    bool ok = GetObject(iconInfo.hbmMask, sizeof(mask), &mask) != 0;
+    int width = mask.bmWidth;
+    int maskHeight = mask.bmHeight;
+    int maskPitch = ((width + 31) / 32) * 4;
+
+    struct
+    {
+        BITMAPINFOHEADER header;
+        RGBQUAD colors[2];
+    } bmi = {};
+    bmi.header.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.header.biWidth = width;
+    bmi.header.biHeight = -maskHeight;
+    bmi.header.biPlanes = 1;
+    bmi.header.biBitCount = 1;
+    bmi.header.biCompression = BI_RGB;
+
+    // Both bitmaps are frame scratch
+    uint8_t* maskBits = ok ? g_FrameArena.AllocateArray<uint8_t>((size_t)maskPitch * maskHeight) : nullptr;
+    ok = maskBits && GetDIBits(g_hdcScreen, iconInfo.hbmMask, 0, maskHeight, maskBits, (BITMAPINFO*)&bmi, DIB_RGB_COLORS);
+
+    if (ok && !iconInfo.hbmColor)
+    {
+        // AND mask over XOR mask, exactly DXGI's monochrome layout
+        ok = DecodeCursorShape(CURSOR_SHAPE_MONOCHROME, width, maskHeight, maskPitch, maskBits, sprite);
+    }
+    else if (ok)
+    {
+        size_t pixelCount = (size_t)width * maskHeight;
+        uint32_t* color = g_FrameArena.AllocateArray<uint32_t>(pixelCount);
+        bmi.header.biBitCount = 32;
+        ok = color && GetDIBits(g_hdcScreen, iconInfo.hbmColor, 0, maskHeight, color, (BITMAPINFO*)&bmi, DIB_RGB_COLORS) != 0;
+
+        bool hasAlpha = false;
+        for (size_t i = 0; ok && i < pixelCount; i++)
+            hasAlpha |= (color[i] >> 24) != 0;
+
+        if (!hasAlpha)
+        {
+            // No alpha channel: the AND mask picks XOR (0xFF) or replace (0x00) per pixel
+            for (int y = 0; y < maskHeight; y++)
+                for (int x = 0; x < width; x++)
+                    if (maskBits[(size_t)y * maskPitch + x / 8] & (0x80 >> (x & 7)))
+                        color[(size_t)y * width + x] |= 0xFF000000;
+        }
+        ok = ok && DecodeCursorShape(hasAlpha ? CURSOR_SHAPE_COLOR : CURSOR_SHAPE_MASKED_COLOR,
+                                     width, maskHeight, width * 4, (const uint8_t*)color, sprite);
+    }
+
+    sprite->hotspotX = iconInfo.xHotspot;
+    sprite->hotspotY = iconInfo.yHotspot;
+    if (iconInfo.hbmMask) DeleteObject(iconInfo.hbmMask);
+    if (iconInfo.hbmColor) DeleteObject(iconInfo.hbmColor);
+    return ok;
+}
+
+// GDI capture of the source rect into a DIB section; the pipeline composes straight from it
+class GdiScreenSource : public MirrorSource
+{
+public:
+    bool Create(int width, int height)
+    {
+        m_hdc = CreateDibDC(width, height, &m_Bitmap, &m_OldBitmap, &m_Bits);
+        m_Width = width;
+        m_Height = height;
+        m_Pitch = width * 4;
+        return m_hdc != nullptr;
+    }
+
+    void Destroy()
+    {
+        if (m_hdc)
+        {
+            SelectObject(m_hdc, m_OldBitmap);
+            DeleteObject(m_Bitmap);
+            DeleteDC(m_hdc);
+            m_hdc = nullptr;
+        }
+    }
+
+    bool Capture(const MirrorGeometry& geometry, const uint8_t** pixels, int* pitch) override
+    {
+        if (!g_UseExcludeFromCapture)
+            SetWindowPos(g_hWnd, NULL, 0, 0, 0, 0,
+                SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_HIDEWINDOW | SWP_NOACTIVATE);
+
+        BOOL ok = BitBlt(m_hdc, 0, 0, geometry.sourceWidth, geometry.sourceHeight,
+                         g_hdcScreen, geometry.sourceX, geometry.sourceY, SRCCOPY);
+        GdiFlush();
+
+        if (!g_UseExcludeFromCapture)
+            SetWindowPos(g_hWnd, HWND_TOPMOST, 0, 0, 0, 0,
+                SWP_NOMOVE | SWP_NOSIZE | SWP_SHOWWINDOW | SWP_NOACTIVATE);
+
+        *pixels = (const uint8_t*)m_Bits;
+        *pitch = m_Pitch;
+        return ok != FALSE;
+    }
+
+    // A new source size needs a new DIB; a failure shows up as failed captures
+    void OnGeometryChanged(const MirrorGeometry& geometry) override
+    {
+        if (geometry.sourceWidth == m_Width && geometry.sourceHeight == m_Height)
+            return;
+        Destroy();
+        Create(geometry.sourceWidth, geometry.sourceHeight);
+    }
+
+    bool QueryCursor(MirrorCursor* cursor, CursorSprite* sprite) override
+    {
+        CURSORINFO ci = {};
+        ci.cbSize = sizeof(CURSORINFO);
+        bool showing = GetCursorInfo(&ci) && (ci.flags & CURSOR_SHOWING);
+        HCURSOR shown = showing ? ci.hCursor : nullptr;
+        cursor->x = ci.ptScreenPos.x;
+        cursor->y = ci.ptScreenPos.y;
+        cursor->visible = shown != nullptr;
+
+        // Decode only when the shape changes
+        if (shown != m_LastCursor)
+        {
+            if (!shown || !DecodeCursorHandle(shown, sprite))
+            {
+                sprite->width = 0;
+                sprite->height = 0;
+            }
+            m_LastCursor = shown;
+            cursor->shapeChanged = true;
+        }
+        return true;
+    }
+
+private:
+    HDC m_hdc = nullptr;
+    HBITMAP m_Bitmap = nullptr;
+    HBITMAP m_OldBitmap = nullptr;
+    void* m_Bits = nullptr;
+    int m_Width = 0;
+    int m_Height = 0;
+    int m_Pitch = 0;
+    HCURSOR m_LastCursor = nullptr;
+};
+
+// Presents composed frames into our window with SetDIBitsToDevice
+class GdiWindowSink : public MirrorSink
+{
+public:
+    bool Present(const uint8_t* pixels, int pitch, int width, int height) override
+    {
+        // Padded pitch expressed as a wider top-down DIB; only width columns are drawn
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmi.bmiHeader.biWidth = pitch / 4;
+        bmi.bmiHeader.biHeight = -height;
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+        return SetDIBitsToDevice(g_hdcWindow, 0, 0, width, height, 0, 0, 0, height,
+                                 pixels, &bmi, DIB_RGB_COLORS) != 0;
+    }
+
+    // The window moves with the first frame composed for the new plan, not before
+    void OnGeometryChanged(const MirrorGeometry& geometry) override
+    {
+        SetWindowPos(g_hWnd, HWND_TOPMOST, g_Plan.outputX, g_Plan.outputY,
+            geometry.outputWidth, geometry.outputHeight, SWP_NOACTIVATE);
+    }
+};
+
+static GdiScreenSource g_CpuSource;
+static GdiWindowSink g_CpuSink;
+
+bool InitCpuFallback()
+{
+    g_hdcScreen = GetDC(NULL);
+    g_hdcWindow = GetDC(g_hWnd);
+    if (!g_hdcScreen || !g_hdcWindow)
+        return false;
+
+    // Source monitor to the left of the window; the right-hand padding is rewritten black every
+    // frame, as in the shader
+    const MirrorGeometry& geometry = g_Plan.geometry;
+    if (!g_CpuSource.Create(geometry.sourceWidth, geometry.sourceHeight))
+        return false;
+
+    g_CpuWorkers = new WorkerPool();
+    g_CpuPipeline = new MirrorPipeline(&g_CpuSource, &g_CpuSink, g_CpuWorkers);
+    if (!g_CpuPipeline->Configure(geometry, g_LinearLight))
+        return false;
+
+    const FrameBuffer& output = g_CpuPipeline->Output();
+    const FrameMemoryStats& memory = g_CpuPipeline->MemoryStats();
+    char buf[256];
+    sprintf(buf, "DesktopCapture: output frame %zu KB, pitch %d, %s pages%s, prefault %.1f ms (%llu faults)\n",
+        output.bytes / 1024, output.pitch,
+        output.pageSize >= FRAME_LARGE_PAGE_SIZE ? "large" : "small",
+        output.locked ? ", locked" : "",
+        memory.prefaultNs / 1e6, (unsigned long long)memory.prefaultFaults);
+    OutputDebugStringA(buf);
+    return true;
+}
+
+// Topology -> g_Plan. Returns true when the plan changed; on failure the current plan stays
+// (the default layout at startup).
+bool RefreshCapturePlan()
+{
+    DisplayTopology topology;
+    CapturePlan plan;
+    if (!QueryDisplayTopology(&topology) || !PlanCapture(topology, g_PlanOptions, &plan))
+    {
+        OutputDebugStringA("DesktopCapture: no usable display topology, keeping the current layout\n");
+        return false;
+    }
+    if (plan.SameAs(g_Plan))
+        return false;
+
+    g_Plan = plan;
+    const MirrorGeometry& g = plan.geometry;
+    char buf[256];
+    sprintf(buf, "DesktopCapture: %s %dx%d at (%d, %d) -> %s, %dx%d of %dx%d at (%d, %d), %d dpi\n",
+        topology.monitors[plan.sourceIndex].name, g.sourceWidth, g.sourceHeight, g.sourceX, g.sourceY,
+        topology.monitors[plan.outputIndex].name, g.renderWidth, g.renderHeight, g.outputWidth, g.outputHeight,
+        plan.outputX, plan.outputY, plan.outputDpi);
+    OutputDebugStringA(buf);
+    return true;
+}
+
+// Switch to the new plan. Both paths keep presenting the old plan while the new one is built off
+// the frame thread, and move the window when they swap: the CPU pipeline at the start of a
+// RunFrame, the GPU path in FinishPlanRebuild.
+bool ApplyCapturePlan()
+{
+    if (g_CpuFallback)
+        return g_CpuPipeline->Reconfigure(g_Plan.geometry, g_LinearLight);
+
+    g_PlanRebuild.Start(g_Plan, g_GpuPlan);
+    return true;
+}
+
+// Frame thread, between frames: swaps in a finished GPU rebuild, falling back to the CPU renderer
+// if it failed. False only when neither could be brought up.
+bool FinishPlanRebuild()
+{
+    if (g_CpuFallback || !g_PlanRebuild.Ready())
+        return true;
+
+    PlanObjects objects;
+    CapturePlan plan;
+    bool ok = g_PlanRebuild.Take(&objects, &plan);
+    const MirrorGeometry& g = plan.geometry;
+    if (ok)
+    {
+        // No recovery attempt may read the staging texture or the source position across the swap
+        g_SourceRecovery.Cancel();
+        g_DuplRecovery.DiscardStaged();
+        ok = ResizeSwapChain(g.outputWidth, g.outputHeight);
+    }
+    if (!ok)
+    {
+        objects.Release();
+        OutputDebugStringA("DesktopCapture: Direct3D 11 rebuild failed, using the CPU renderer\n");
+        ReleaseD3D();
+        g_CpuFallback = InitCpuFallback();
+        return g_CpuFallback;
+    }
+
+    g_PixelShader->Release();
+    g_PixelShader = objects.pixelShader;
+    if (objects.dupl)
+    {
+        if (g_DeskDupl)
+            g_DeskDupl->Release();
+        g_DeskDupl = objects.dupl;
+    }
+    if (objects.staging)
+    {
+        g_DesktopSRV->Release();
+        g_StagingTexture->Release();
+        g_StagingTexture = objects.staging;
+        g_DesktopSRV = objects.srv;
+    }
+    g_GpuPlan = plan;
+    SetWindowPos(g_hWnd, HWND_TOPMOST, plan.outputX, plan.outputY, g.outputWidth, g.outputHeight,
+        SWP_NOACTIVATE);
+
+    // The same source lost its duplication to the mode change before (or during) the rebuild
+    int64_t nowNs = GetSystemFrameClock()->NowNs();
+    if (!g_DeskDupl)
+    {
+        g_DuplRecovery.SetSource(g.sourceX, g.sourceY);
+        g_SourceRecovery.OnLost(nowNs);
+    }
+
+    // Resized buffers and possibly a blank staging texture: present the next poll
+    g_Idle.Reset(nowNs);
+    return true;
+}
+
+// QPC ticks -> nanoseconds, same time base as the frame pacer's system clock
+static int64_t QpcToNs(int64_t ticks)
+{
+    static LARGE_INTEGER frequency = {};
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    return (ticks / frequency.QuadPart) * 1000000000 + (ticks % frequency.QuadPart) * 1000000000 / frequency.QuadPart;
+}
+
+// Feed swap chain statistics to the scheduler: vblank timing for the phase estimate,
+// and for each present that reached the screen, whether it made the vblank it targeted
+void TrackPresentTiming(VsyncScheduler& scheduler, int64_t targetVblankNs)
+{
+    static UINT s_PresentIds[8] = {};
+    static int64_t s_PresentTargets[8] = {};
+
+    UINT presentCount = 0;
+    if (SUCCEEDED(g_SwapChain->GetLastPresentCount(&presentCount)))
+    {
+        s_PresentIds[presentCount % 8] = presentCount;
+        s_PresentTargets[presentCount % 8] = targetVblankNs;
+    }
+
+    DXGI_FRAME_STATISTICS stats;
+    if (FAILED(g_SwapChain->GetFrameStatistics(&stats)))
+        return;
+
+    int64_t syncNs = QpcToNs(stats.SyncQPCTime.QuadPart);
+    scheduler.Vsync().AddVblank(stats.SyncRefreshCount, syncNs);
+
+    UINT slot = stats.PresentCount % 8;
+    if (s_PresentIds[slot] == stats.PresentCount && s_PresentTargets[slot] != 0)
+    {
+        scheduler.OnPresented(s_PresentTargets[slot], syncNs);
+        s_PresentTargets[slot] = 0;
+    }
 }
 
 void Cleanup()
 {
-    if (g_CursorBuffer) { delete[] g_CursorBuffer; g_CursorBuffer = nullptr; }
+    ReleaseD3D();
+
+    delete g_CpuPipeline;
+    g_CpuPipeline = nullptr;
+    delete g_CpuWorkers;
+    g_CpuWorkers = nullptr;
+    g_CpuSource.Destroy();
+    if (g_hdcScreen) { ReleaseDC(NULL, g_hdcScreen); g_hdcScreen = nullptr; }
+    if (g_hdcWindow) { ReleaseDC(g_hWnd, g_hdcWindow); g_hdcWindow = nullptr; }
+
+    if (g_hWnd)
+    {
+        DestroyWindow(g_hWnd);
+        g_hWnd = nullptr;
+    }
+}
+
+void ReleaseD3D()
+{
+    // No rebuild may be using the device while it goes away
+    g_PlanRebuild.Cancel();
+    g_SourceRecovery.Cancel();
+    g_DuplRecovery.DiscardStaged();
+
     if (g_CursorSRV) { g_CursorSRV->Release(); g_CursorSRV = nullptr; }
+    if (g_CursorStaging) { g_CursorStaging->Release(); g_CursorStaging = nullptr; }
+    g_CursorStagingWidth = 0;
+    g_CursorStagingHeight = 0;
     if (g_CursorTexture) { g_CursorTexture->Release(); g_CursorTexture = nullptr; }
     if (g_VertexBuffer) { g_VertexBuffer->Release(); g_VertexBuffer = nullptr; }
     if (g_InputLayout) { g_InputLayout->Release(); g_InputLayout = nullptr; }
+    if (g_PointSamplerState) { g_PointSamplerState->Release(); g_PointSamplerState = nullptr; }
     if (g_SamplerState) { g_SamplerState->Release(); g_SamplerState = nullptr; }
     if (g_PixelShader) { g_PixelShader->Release(); g_PixelShader = nullptr; }
     if (g_VertexShader) { g_VertexShader->Release(); g_VertexShader = nullptr; }
@@ -1067,10 +1898,4 @@ void Cleanup()
     if (g_SwapChain) { g_SwapChain->Release(); g_SwapChain = nullptr; }
     if (g_Context) { g_Context->Release(); g_Context = nullptr; }
     if (g_Device) { g_Device->Release(); g_Device = nullptr; }
-    
-    if (g_hWnd)
-    {
-        DestroyWindow(g_hWnd);
-        g_hWnd = nullptr;
-    }
 }
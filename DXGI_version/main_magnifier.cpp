@@ -1,6 +1,8 @@
 // Windows Desktop Capture using Magnification API
 // The Magnification API renders above EVERYTHING including cursor, taskbar, and Start menu
-// Captures 1920x1080 from FIRST monitor, scales down to 1440x1080, displays with black padding
+// Magnifies the source monitor into a 4:3 area on the output monitor (1920x1080 -> 1440x1080 by
+// default), displays with black padding; the layout is re-planned after display changes
+// Between updates the loop sleeps in one wait on messages and the update deadline
 
 #define WIN32_LEAN_AND_MEAN
 #define NOMINMAX
@@ -9,80 +11,33 @@
 #include <mmsystem.h>
 #include <stdio.h>
 
+#include "capture_geometry.h"
+#include "display_info.h"
+#include "display_topology.h"
+#include "event_loop.h"
+#include "frame_pacer.h"
+#include "frame_rate.h"
+
 #pragma comment(lib, "magnification.lib")
 #pragma comment(lib, "user32.lib")
 #pragma comment(lib, "gdi32.lib")
 #pragma comment(lib, "winmm.lib")
 
-// DPI awareness
-typedef BOOL (WINAPI *PFN_SetProcessDPIAware)(void);
-typedef HRESULT (WINAPI *PFN_SetProcessDpiAwareness)(int);
-typedef BOOL (WINAPI *PFN_SetProcessDpiAwarenessContext)(HANDLE);
-
-#ifndef DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2
-#define DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2 ((HANDLE)-4)
-#endif
-#define PROCESS_PER_MONITOR_DPI_AWARE 2
-
-void EnableDPIAwareness()
-{
-    HMODULE hUser32 = GetModuleHandleA("user32.dll");
-    if (hUser32)
-    {
-        auto pSetProcessDpiAwarenessContext = (PFN_SetProcessDpiAwarenessContext)
-            GetProcAddress(hUser32, "SetProcessDpiAwarenessContext");
-        if (pSetProcessDpiAwarenessContext)
-        {
-            if (pSetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2))
-                return;
-        }
-    }
-    
-    HMODULE hShcore = LoadLibraryA("shcore.dll");
-    if (hShcore)
-    {
-        auto pSetProcessDpiAwareness = (PFN_SetProcessDpiAwareness)
-            GetProcAddress(hShcore, "SetProcessDpiAwareness");
-        if (pSetProcessDpiAwareness)
-        {
-            if (SUCCEEDED(pSetProcessDpiAwareness(PROCESS_PER_MONITOR_DPI_AWARE)))
-            {
-                FreeLibrary(hShcore);
-                return;
-            }
-        }
-        FreeLibrary(hShcore);
-    }
-    
-    if (hUser32)
-    {
-        auto pSetProcessDPIAware = (PFN_SetProcessDPIAware)
-            GetProcAddress(hUser32, "SetProcessDPIAware");
-        if (pSetProcessDPIAware)
-        {
-            pSetProcessDPIAware();
-        }
-    }
-}
-
-// Constants
-constexpr int SOURCE_WIDTH = 1920;
-constexpr int SOURCE_HEIGHT = 1080;
-constexpr int RENDER_WIDTH = 1440;
-constexpr int RENDER_HEIGHT = 1080;
-constexpr int OUTPUT_WIDTH = 1920;
-constexpr int OUTPUT_HEIGHT = 1080;
-constexpr int TARGET_FPS = 60;
-constexpr int FRAME_TIME_MS = 1000 / TARGET_FPS;
-constexpr int FIRST_MONITOR_X = 0;
-constexpr int FIRST_MONITOR_Y = 0;
-
 // Global state
 static bool g_Running = true;
 static HWND g_hHostWnd = nullptr;      // Host window (magnifier container)
 static HWND g_hMagWnd = nullptr;       // Magnifier control window
 static HWND g_hBlackWnd = nullptr;     // Black padding window on the right
 
+// Source/output monitors (--source-monitor=<n> / --output-monitor=<n>), rebuilt on WM_DISPLAYCHANGE
+static CapturePlanOptions g_PlanOptions;
+static CapturePlan g_Plan;
+static bool g_DisplayChanged = false;
+
+// Event-driven wait between updates; g_FrameDue is set by events that want one before the deadline
+static EventLoop g_EventLoop;
+static bool g_FrameDue = false;
+
 // Window class name for magnifier host
 const wchar_t* MAGNIFIER_HOST_CLASS = L"MagnifierHostClass";
 const wchar_t* BLACK_WINDOW_CLASS = L"BlackPaddingClass";
@@ -94,6 +49,10 @@ LRESULT CALLBACK HostWndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
     case WM_DESTROY:
         PostQuitMessage(0);
         return 0;
+    case WM_DISPLAYCHANGE:
+        g_DisplayChanged = true;
+        g_FrameDue = true;
+        return 0;
     }
     return DefWindowProcW(hWnd, msg, wParam, lParam);
 }
@@ -118,6 +77,45 @@ LRESULT CALLBACK BlackWndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
     return DefWindowProcW(hWnd, msg, wParam, lParam);
 }
 
+// Topology -> g_Plan. Returns true when the plan changed; on failure the current plan stays.
+bool RefreshCapturePlan()
+{
+    DisplayTopology topology;
+    CapturePlan plan;
+    if (!QueryDisplayTopology(&topology) || !PlanCapture(topology, g_PlanOptions, &plan) || plan.SameAs(g_Plan))
+    {
+        return false;
+    }
+    g_Plan = plan;
+    return true;
+}
+
+// Places the host and padding windows on the output monitor and sets the scale for the plan
+void ApplyMagnifierLayout()
+{
+    const MirrorGeometry& g = g_Plan.geometry;
+    SetWindowPos(g_hHostWnd, HWND_TOPMOST, g_Plan.outputX, g_Plan.outputY,
+        g.renderWidth, g.outputHeight, SWP_NOACTIVATE);
+    SetWindowPos(g_hMagWnd, nullptr, 0, 0, g.renderWidth, g.outputHeight, SWP_NOZORDER | SWP_NOACTIVATE);
+    if (g_hBlackWnd)
+    {
+        SetWindowPos(g_hBlackWnd, HWND_TOPMOST, g_Plan.outputX + g.renderWidth, g_Plan.outputY,
+            g.outputWidth - g.renderWidth, g.outputHeight, SWP_NOACTIVATE);
+    }
+
+    // Magnification matrix (3x3), scale factors on the diagonal (1920 -> 1440 is 0.75 x 1.0)
+    MAGTRANSFORM transform;
+    memset(&transform, 0, sizeof(transform));
+    transform.v[0][0] = g_Plan.scaleX;
+    transform.v[1][1] = g_Plan.scaleY;
+    transform.v[2][2] = 1.0f;
+
+    if (!MagSetWindowTransform(g_hMagWnd, &transform))
+    {
+        // Transform not supported, use default (1:1)
+    }
+}
+
 bool InitMagnifier(HINSTANCE hInstance)
 {
     // Initialize the Magnification API
@@ -158,15 +156,16 @@ bool InitMagnifier(HINSTANCE hInstance)
     if (!RegisterClassExW(&wcBlack))
         return false;
 
-    // Create the host window for the magnifier (covers left 1440 pixels)
+    // Create the host window for the magnifier (covers the render area)
     // WS_EX_TOPMOST alone isn't enough, but the magnifier control will be above everything
+    const MirrorGeometry& g = g_Plan.geometry;
     g_hHostWnd = CreateWindowExW(
         WS_EX_TOPMOST | WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_TOOLWINDOW,
         MAGNIFIER_HOST_CLASS,
         L"Magnifier Host",
         WS_POPUP,
-        FIRST_MONITOR_X, FIRST_MONITOR_Y,
-        RENDER_WIDTH, OUTPUT_HEIGHT,
+        g_Plan.outputX, g_Plan.outputY,
+        g.renderWidth, g.outputHeight,
         nullptr, nullptr, hInstance, nullptr
     );
 
@@ -187,7 +186,7 @@ bool InitMagnifier(HINSTANCE hInstance)
         L"Magnifier",
         WS_CHILD | WS_VISIBLE | MS_SHOWMAGNIFIEDCURSOR,
         0, 0,
-        RENDER_WIDTH, OUTPUT_HEIGHT,
+        g.renderWidth, g.outputHeight,
         g_hHostWnd, nullptr, hInstance, nullptr
     );
 
@@ -197,14 +196,14 @@ bool InitMagnifier(HINSTANCE hInstance)
         return false;
     }
 
-    // Create black padding window on the right (480 pixels)
+    // Create black padding window on the right (the rest of the output)
     g_hBlackWnd = CreateWindowExW(
         WS_EX_TOPMOST | WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_TOOLWINDOW,
         BLACK_WINDOW_CLASS,
         L"Black Padding",
         WS_POPUP | WS_VISIBLE,
-        FIRST_MONITOR_X + RENDER_WIDTH, FIRST_MONITOR_Y,
-        OUTPUT_WIDTH - RENDER_WIDTH, OUTPUT_HEIGHT,
+        g_Plan.outputX + g.renderWidth, g_Plan.outputY,
+        g.outputWidth - g.renderWidth, g.outputHeight,
         nullptr, nullptr, hInstance, nullptr
     );
 
@@ -214,23 +213,7 @@ bool InitMagnifier(HINSTANCE hInstance)
     }
 
     // Set up the magnification transformation
-    // We want to scale 1920 -> 1440, so factor = 1440/1920 = 0.75
-    MAGTRANSFORM transform;
-    memset(&transform, 0, sizeof(transform));
-    
-    // Magnification matrix (3x3)
-    // Scale factors on diagonal
-    float scaleX = (float)RENDER_WIDTH / (float)SOURCE_WIDTH;  // 0.75
-    float scaleY = (float)RENDER_HEIGHT / (float)SOURCE_HEIGHT; // 1.0
-    
-    transform.v[0][0] = scaleX;
-    transform.v[1][1] = scaleY;
-    transform.v[2][2] = 1.0f;
-
-    if (!MagSetWindowTransform(g_hMagWnd, &transform))
-    {
-        // Transform not supported, use default (1:1)
-    }
+    ApplyMagnifierLayout();
 
     return true;
 }
@@ -238,12 +221,13 @@ bool InitMagnifier(HINSTANCE hInstance)
 void UpdateMagnifier()
 {
     // Set the source rectangle - the area of the screen to magnify
-    // We capture the full first monitor (1920x1080)
+    // We capture the full source monitor
+    const MirrorGeometry& g = g_Plan.geometry;
     RECT sourceRect;
-    sourceRect.left = FIRST_MONITOR_X;
-    sourceRect.top = FIRST_MONITOR_Y;
-    sourceRect.right = FIRST_MONITOR_X + SOURCE_WIDTH;
-    sourceRect.bottom = FIRST_MONITOR_Y + SOURCE_HEIGHT;
+    sourceRect.left = g.sourceX;
+    sourceRect.top = g.sourceY;
+    sourceRect.right = g.sourceX + g.sourceWidth;
+    sourceRect.bottom = g.sourceY + g.sourceHeight;
 
     // Update the magnifier source
     MagSetWindowSource(g_hMagWnd, sourceRect);
@@ -275,10 +259,42 @@ void Cleanup()
     MagUninitialize();
 }
 
-int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int)
+// Drains the thread's message queue; false once the app is quitting
+bool PumpMessages()
+{
+    MSG msg;
+    while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE))
+    {
+        if (msg.message == WM_QUIT || (msg.message == WM_HOTKEY && msg.wParam == 1))
+        {
+            g_Running = false;
+            return false;
+        }
+        TranslateMessage(&msg);
+        DispatchMessageW(&msg);
+    }
+    return true;
+}
+
+// Messages are pumped as they arrive during the pacer's sleep; a display change or quit ends it
+class MessageWaitHandler : public EventHandler
+{
+public:
+    bool OnEvent(EventWake wake, int) override
+    {
+        if (wake == WAKE_MESSAGE)
+            PumpMessages();
+        return g_Running && !g_FrameDue;
+    }
+};
+
+int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR lpCmdLine, int)
 {
     EnableDPIAwareness();
 
+    ParseCapturePlanOptions(lpCmdLine, &g_PlanOptions);
+    RefreshCapturePlan();
+
     if (!InitMagnifier(hInstance))
     {
         Cleanup();
@@ -296,27 +312,30 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int)
     ShowWindow(g_hHostWnd, SW_SHOWNOACTIVATE);
     UpdateWindow(g_hHostWnd);
 
-    LARGE_INTEGER frequency, lastTime, currentTime;
-    QueryPerformanceFrequency(&frequency);
-    QueryPerformanceCounter(&lastTime);
+    // The magnifier captures internally; only the update rate is ours (--present-hz overrides)
+    FrameRate presentRate = g_Plan.outputRate;
+    ParseFrameRateOption(lpCmdLine, "present-hz", &presentRate);
+    FramePacer pacer(1000000000LL * presentRate.den, presentRate.num);
+    MessageWaitHandler waitHandler;
+    g_EventLoop.SetHandler(&waitHandler);
+    pacer.SetWaiter(&g_EventLoop);
 
-    MSG msg = {};
     while (g_Running)
     {
-        while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE))
+        g_FrameDue = false;
+        if (!PumpMessages())
+            break;
+
+        if (g_Running && g_DisplayChanged)
         {
-            if (msg.message == WM_QUIT)
+            g_DisplayChanged = false;
+            if (RefreshCapturePlan())
             {
-                g_Running = false;
-                break;
+                ApplyMagnifierLayout();
+                presentRate = g_Plan.outputRate;
+                ParseFrameRateOption(lpCmdLine, "present-hz", &presentRate);
+                pacer.SetPeriod(1000000000LL * presentRate.den, presentRate.num);
             }
-            if (msg.message == WM_HOTKEY && msg.wParam == 1)
-            {
-                g_Running = false;
-                break;
-            }
-            TranslateMessage(&msg);
-            DispatchMessageW(&msg);
         }
 
         if (g_Running)
@@ -332,20 +351,23 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int)
                     SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE);
             }
 
-            QueryPerformanceCounter(&currentTime);
-            double elapsedMs = (double)(currentTime.QuadPart - lastTime.QuadPart) * 1000.0 / frequency.QuadPart;
-            
-            if (elapsedMs < FRAME_TIME_MS)
-            {
-                Sleep((DWORD)(FRAME_TIME_MS - elapsedMs));
-            }
-            
-            QueryPerformanceCounter(&lastTime);
+            if (g_FrameDue)
+                pacer.Reset();
+            else
+                pacer.WaitForNextFrame();
         }
     }
 
     UnregisterHotKey(g_hHostWnd, 1);
+    pacer.SetWaiter(nullptr);
+    g_EventLoop.SetHandler(nullptr);
     timeEndPeriod(1);
+
+    char report[192];
+    g_EventLoop.FormatWakeupReport(pacer.Clock()->NowNs(), report, sizeof(report));
+    OutputDebugStringA("DesktopCapture: ");
+    OutputDebugStringA(report);
+    OutputDebugStringA("\n");
     Cleanup();
     
     return 0;
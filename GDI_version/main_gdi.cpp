@@ -1,6 +1,10 @@
 // Windows Desktop Capture with GDI (MinGW Compatible)
-// Captures 1920x1080 from FIRST monitor, scales down to 1440x1080, composites into 1920x1080 buffer with black padding on right
-// Displays in fullscreen borderless window on FIRST monitor at 60 Hz
+// Captures the source monitor (by default the one at the desktop origin), scales it into a 4:3 area
+// on the left of the output monitor with black padding on the right (1920x1080 -> 1440x1080)
+// Displays in fullscreen borderless window on the output monitor at its refresh rate
+// Geometry is planned from the display topology at startup and again after display changes
+// Between frames the loop sleeps in one wait on messages and the frame deadline; the hotkey,
+// display changes and (while idle) raw input end the sleep early
 // Uses SetWindowDisplayAffinity to exclude self from capture (Windows 10 2004+)
 
 #define WIN32_LEAN_AND_MEAN
@@ -8,77 +12,27 @@
 #include <windows.h>
 #include <mmsystem.h>  // For timeBeginPeriod/timeEndPeriod
 #include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "box_scaler.h"
+#include "capture_geometry.h"
+#include "display_info.h"
+#include "display_topology.h"
+#include "event_loop.h"
+#include "frame_pacer.h"
+#include "frame_pool.h"
+#include "frame_rate.h"
+#include "idle_policy.h"
+#include "quality_governor.h"
+#include "stream_store.h"
+#include "tile_scheduler.h"
 
 #pragma comment(lib, "gdi32.lib")
 #pragma comment(lib, "user32.lib")
 #pragma comment(lib, "winmm.lib")
 
-// DPI awareness - must be set before any window/GDI calls
-// Function pointer types for DPI functions (not in older MinGW headers)
-typedef BOOL (WINAPI *PFN_SetProcessDPIAware)(void);
-typedef HRESULT (WINAPI *PFN_SetProcessDpiAwareness)(int);
-typedef BOOL (WINAPI *PFN_SetProcessDpiAwarenessContext)(HANDLE);
-
-// DPI awareness constants
-#ifndef DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2
-#define DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2 ((HANDLE)-4)
-#endif
-#define PROCESS_PER_MONITOR_DPI_AWARE 2
-
-void EnableDPIAwareness()
-{
-    // Try SetProcessDpiAwarenessContext first (Windows 10 1703+)
-    HMODULE hUser32 = GetModuleHandleA("user32.dll");
-    if (hUser32)
-    {
-        auto pSetProcessDpiAwarenessContext = (PFN_SetProcessDpiAwarenessContext)
-            GetProcAddress(hUser32, "SetProcessDpiAwarenessContext");
-        if (pSetProcessDpiAwarenessContext)
-        {
-            if (pSetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2))
-                return;
-        }
-    }
-    
-    // Try SetProcessDpiAwareness (Windows 8.1+)
-    HMODULE hShcore = LoadLibraryA("shcore.dll");
-    if (hShcore)
-    {
-        auto pSetProcessDpiAwareness = (PFN_SetProcessDpiAwareness)
-            GetProcAddress(hShcore, "SetProcessDpiAwareness");
-        if (pSetProcessDpiAwareness)
-        {
-            if (SUCCEEDED(pSetProcessDpiAwareness(PROCESS_PER_MONITOR_DPI_AWARE)))
-            {
-                FreeLibrary(hShcore);
-                return;
-            }
-        }
-        FreeLibrary(hShcore);
-    }
-    
-    // Fall back to SetProcessDPIAware (Windows Vista+)
-    if (hUser32)
-    {
-        auto pSetProcessDPIAware = (PFN_SetProcessDPIAware)
-            GetProcAddress(hUser32, "SetProcessDPIAware");
-        if (pSetProcessDPIAware)
-        {
-            pSetProcessDPIAware();
-        }
-    }
-}
-
-// Constants
-constexpr int SOURCE_WIDTH = 1920;   // Full first monitor width to capture
-constexpr int SOURCE_HEIGHT = 1080;  // Full first monitor height to capture
-constexpr int RENDER_WIDTH = 1440;   // Scaled-down width for display
-constexpr int RENDER_HEIGHT = 1080;  // Height stays the same
-constexpr int OUTPUT_WIDTH = 1920;
-constexpr int OUTPUT_HEIGHT = 1080;
-constexpr int TARGET_FPS = 60;
-constexpr int FRAME_TIME_MS = 1000 / TARGET_FPS; // ~16.67ms
-
 // Display affinity constant (not in MinGW headers)
 #ifndef WDA_EXCLUDEFROMCAPTURE
 #define WDA_EXCLUDEFROMCAPTURE 0x00000011
@@ -86,6 +40,9 @@ constexpr int FRAME_TIME_MS = 1000 / TARGET_FPS; // ~16.67ms
 #ifndef WDA_NONE
 #define WDA_NONE 0x00000000
 #endif
+#ifndef WM_DPICHANGED
+#define WM_DPICHANGED 0x02E0
+#endif
 
 // Function pointer for GetCursorFrameInfo (not in MinGW headers)
 typedef HCURSOR (WINAPI *PFN_GetCursorFrameInfo)(HCURSOR hCursor, LPCWSTR name, DWORD istep, DWORD *rate, DWORD *steps);
@@ -103,26 +60,83 @@ static HHOOK g_KeyboardHook = nullptr;
 typedef BOOL (WINAPI *PFN_SetWindowBand)(HWND hWnd, HWND hwndInsertAfter, DWORD dwBand);
 static PFN_SetWindowBand g_pSetWindowBand = nullptr;
 
-// Monitor positions (hardcoded for performance)
-// First monitor at origin (both capture source and output destination) - 1920x1080
-constexpr int FIRST_MONITOR_X = 0;
-constexpr int FIRST_MONITOR_Y = 0;
-
 // GDI objects
 static HDC g_hdcScreen = nullptr;
-static HDC g_hdcMemory = nullptr;
 static HDC g_hdcWindow = nullptr;  // Cached window DC
-static HBITMAP g_hBitmap = nullptr;
-static HBITMAP g_hOldBitmap = nullptr;
-static void* g_pBitmapBits = nullptr;
 static HRGN g_hClipRgn = nullptr;  // Reusable clipping region
 
+// Output frames are DIB sections from a refcounted pool, shared with whoever presents or records
+// them instead of copied. Each frame is drawn on top of the previous one: normally in the same
+// buffer, and when a consumer still holds that one, in a free buffer first brought up to date
+// with the tiles written since it last held a frame.
+constexpr int FRAME_POOL_BUFFERS = 2;
+constexpr int FRAME_POOL_MAX_BUFFERS = 4;
+static FramePool g_FramePool;
+static FrameRef g_Frame;                        // Frame being drawn / last drawn
+static uint64_t g_FrameNumber = 0;
+static std::vector<uint64_t> g_TileWritten;     // Frame number that last wrote each tile's pixels
+
+// Unscaled copy of the source monitor, one tile BitBlt at a time. Tiles are hashed here and
+// stretched into the frame only if they changed, so settled tiles keep their high-quality
+// (area-averaged) pixels; refinement box-filters settled tiles from it on the CPU in idle time.
+static HDC g_hdcSource = nullptr;
+static HBITMAP g_hSourceBitmap = nullptr;
+static HBITMAP g_hOldSourceBitmap = nullptr;
+static void* g_pSourceBits = nullptr;
+static BoxScaler g_BoxScaler;
+static bool g_LinearLight = false;  // --linear-light: refinement averages in linear light
+
+// Pixels under the last drawn cursor, put back before the next frame (unchanged tiles are not rescaled)
+constexpr int CURSOR_SAVE_SIZE = 256;  // Largest cursor Windows draws
+static HDC g_hdcSaveUnder = nullptr;
+static HBITMAP g_hSaveBitmap = nullptr;
+static HBITMAP g_hOldSaveBitmap = nullptr;
+static RECT g_SaveRect = {};
+
 // Cursor caching
 static HCURSOR g_lastCursor = nullptr;
 static DWORD g_cursorFrameCount = 0;
 static DWORD g_cursorFrameRate = 0;
 static DWORD g_cachedHotspotX = 0;
 static DWORD g_cachedHotspotY = 0;
+static int g_cachedCursorWidth = 32;
+static int g_cachedCursorHeight = 32;
+
+// Idle detection: GDI has no damage info, so compare a signature of each source tile
+static IdlePolicy g_Idle;
+static std::vector<uint64_t> g_TileHashes;
+static POINT g_LastCursorPos = {};
+static DWORD g_LastInputTick = 0;
+
+// Event-driven wait between frames; g_FrameDue is set by events that want a frame before the deadline
+static EventLoop g_EventLoop;
+static bool g_FrameDue = false;
+static bool g_InputWake = false;    // Raw input registered (only while idle-throttled)
+static const int64_t WAKEUP_REPORT_NS = 10000000000LL;
+
+// Source/output monitors and geometry (--source-monitor=<n> / --output-monitor=<n>), rebuilt
+// from the topology on WM_DISPLAYCHANGE
+static CapturePlanOptions g_PlanOptions;
+static CapturePlan g_Plan;
+static bool g_DisplayChanged = false;
+
+// Capture rate (source monitor) and present rate (our window's monitor), from the capture plan
+// Override with --capture-hz=<hz> / --present-hz=<hz>
+static FrameRate g_CaptureRate;
+static FrameRate g_PresentRate;
+
+// Steps refinement on -> off with a shorter tile pass -> half-rate capture when frames blow the budget
+static QualityGovernor g_Governor;
+
+// Fast-filter rung: share of the time to the deadline the tile pass may use. Tiles past it are
+// carried (least important first), so stepping down lowers the measured frame time itself;
+// refinement runs after the measured frame and turning it off alone would not.
+constexpr int FAST_FILTER_TILE_PERCENT = 70;
+
+// Scale pass split into tiles, cursor region first; tiles that miss the deadline keep last frame's pixels.
+// COLORONCOLOR first pass for every tile, exact area-average refinement in idle time once a tile has settled.
+// Rebuilt for the plan's geometry by InitGDI.
+static TileScheduler g_Tiles(SOURCE_WIDTH, SOURCE_HEIGHT, RENDER_WIDTH, RENDER_HEIGHT);
 
 // Function pointer for SetWindowDisplayAffinity (Windows 10+)
 typedef BOOL (WINAPI *PFN_SetWindowDisplayAffinity)(HWND, DWORD);
@@ -132,13 +146,42 @@ static PFN_SetWindowDisplayAffinity g_pSetWindowDisplayAffinity = nullptr;
 LRESULT CALLBACK WindowProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 bool InitWindow(HINSTANCE hInstance);
 bool InitGDI();
+void ReleaseGDI();
 void Cleanup();
-void CaptureAndRender();
+bool RefreshCapturePlan();
+void ClipCursorToOutput();
+void CaptureAndRender(int64_t deadlineNs);
+void RefineSettledTiles(int64_t untilNs);
+HDC CreateDibDC(int width, int height, HBITMAP* bitmap, HBITMAP* oldBitmap, void** bits);
+bool PrepareFrame();
+void PollInputActivity();
+void SetInputWake(bool enable);
+bool PumpMessages();
+void ReportWakeups(int64_t nowNs);
+void ApplyQualitySettings();
 
-int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int)
+// Wakes during the pacer's sleep: messages are pumped at once, and the sleep ends when one of them
+// (hotkey, display change, input) wants a frame now or the app is quitting
+class MessageWaitHandler : public EventHandler
+{
+public:
+    bool OnEvent(EventWake wake, int) override
+    {
+        if (wake == WAKE_MESSAGE)
+            PumpMessages();
+        return g_Running && !g_FrameDue;
+    }
+};
+
+int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR lpCmdLine, int)
 {
     // Enable DPI awareness FIRST, before any window/GDI operations
     EnableDPIAwareness();
+
+    g_LinearLight = strstr(lpCmdLine, "--linear-light") != nullptr;
+
+    ParseCapturePlanOptions(lpCmdLine, &g_PlanOptions);
+    RefreshCapturePlan();
     
     // Initialize window
     if (!InitWindow(hInstance))
@@ -172,61 +215,129 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int)
     while (ShowCursor(FALSE) >= 0) {}
     
     // Clip cursor to our window to prevent it from showing at edges
-    RECT clipRect = { FIRST_MONITOR_X, FIRST_MONITOR_Y, 
-                      FIRST_MONITOR_X + OUTPUT_WIDTH, FIRST_MONITOR_Y + OUTPUT_HEIGHT };
-    ClipCursor(&clipRect);
+    ClipCursorToOutput();
+
+    // Capture and present rates default to the source and output monitors' refresh rates
+    g_CaptureRate = g_Plan.sourceRate;
+    g_PresentRate = g_Plan.outputRate;
+    ParseFrameRateOption(lpCmdLine, "capture-hz", &g_CaptureRate);
+    ParseFrameRateOption(lpCmdLine, "present-hz", &g_PresentRate);
 
-    // High-resolution timer for frame timing
-    LARGE_INTEGER frequency, lastTime, currentTime;
-    QueryPerformanceFrequency(&frequency);
-    QueryPerformanceCounter(&lastTime);
+    // Frame timing against absolute deadlines on the present clock (no drift)
+    FramePacer pacer(1000000000LL * g_PresentRate.den, g_PresentRate.num);
+
+    // Captures happen on capture-clock ticks; in between, the window keeps the last frame
+    RateConverter converter(g_CaptureRate, g_PresentRate);
+    BudgetMonitor budget(g_PresentRate.PeriodNs());
+    g_Governor.SetBudget(g_PresentRate.PeriodNs());
+    uint64_t captureTicks = 0;
+
+    // Messages are handled as they arrive during the pacer's sleep, not only once per frame
+    MessageWaitHandler waitHandler;
+    g_EventLoop.SetHandler(&waitHandler);
+    pacer.SetWaiter(&g_EventLoop);
+    int64_t wakeupReportNs = pacer.Clock()->NowNs() + WAKEUP_REPORT_NS;
 
     // Main loop
-    MSG msg = {};
     while (g_Running)
     {
-        // Process all pending messages
-        while (PeekMessageA(&msg, nullptr, 0, 0, PM_REMOVE))
+        g_FrameDue = false;
+        if (!PumpMessages())
+            break;
+
+        if (g_Running && g_DisplayChanged)
         {
-            if (msg.message == WM_QUIT)
+            g_DisplayChanged = false;
+            if (RefreshCapturePlan())
             {
-                g_Running = false;
-                break;
-            }
-            // Check for Insert hotkey
-            if (msg.message == WM_HOTKEY && msg.wParam == 1)
-            {
-                g_Running = false;
-                break;
+                // New geometry: move the window and rebuild the frames and tiles for it
+                ReleaseGDI();
+                SetWindowPos(g_hWnd, HWND_TOPMOST, g_Plan.outputX, g_Plan.outputY,
+                    g_Plan.geometry.outputWidth, g_Plan.geometry.outputHeight, SWP_NOACTIVATE);
+                ClipCursorToOutput();
+                if (!InitGDI())
+                {
+                    MessageBoxA(nullptr, "Failed to rebuild GDI resources for the new display layout", "Error", MB_OK | MB_ICONERROR);
+                    g_Running = false;
+                    break;
+                }
+                g_Idle.Reset(pacer.Clock()->NowNs());
+
+                g_CaptureRate = g_Plan.sourceRate;
+                g_PresentRate = g_Plan.outputRate;
+                ParseFrameRateOption(lpCmdLine, "capture-hz", &g_CaptureRate);
+                ParseFrameRateOption(lpCmdLine, "present-hz", &g_PresentRate);
+                pacer.SetPeriod(1000000000LL * g_PresentRate.den, g_PresentRate.num);
+                converter = RateConverter(g_CaptureRate, g_PresentRate);
+                budget.SetBudget(g_PresentRate.PeriodNs());
+                g_Governor.SetBudget(g_PresentRate.PeriodNs());
             }
-            TranslateMessage(&msg);
-            DispatchMessageA(&msg);
         }
 
         if (g_Running)
         {
+            // Any input ends idle throttling before this frame
+            PollInputActivity();
+
             // Capture and render frame
-            CaptureAndRender();
+            int64_t frameStartNs = pacer.Clock()->NowNs();
+            if (converter.OnPresentTick(frameStartNs) &&
+                ++captureTicks % g_Governor.Settings().captureDivisor == 0)
+            {
+                int64_t tileDeadlineNs = pacer.NextDeadlineNs();
+                if (g_Governor.Settings().fastFilter && tileDeadlineNs > frameStartNs)
+                    tileDeadlineNs = frameStartNs + (tileDeadlineNs - frameStartNs) * FAST_FILTER_TILE_PERCENT / 100;
+                CaptureAndRender(tileDeadlineNs);
+
+                int64_t frameEndNs = pacer.Clock()->NowNs();
+                if (g_Governor.AddFrame(frameEndNs - frameStartNs, frameEndNs))
+                {
+                    ApplyQualitySettings();
+                }
+
+                // Report once if this CPU cannot sustain the configured rate
+                if (budget.AddFrame(frameEndNs - frameStartNs))
+                {
+                    char buf[256];
+                    sprintf(buf, "DesktopCapture: p99 frame time %.2f ms exceeds the %.2f ms budget at %.2f Hz\n",
+                        budget.PredictedWorkNs() / 1e6, budget.BudgetNs() / 1e6, g_PresentRate.Hz());
+                    OutputDebugStringA(buf);
+                }
+            }
 
             // Keep window at the very top (above taskbar, tooltips, etc.)
             SetWindowPos(g_hWnd, HWND_TOPMOST, 0, 0, 0, 0, 
                 SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE);
 
-            // Frame timing (target 60 FPS)
-            QueryPerformanceCounter(&currentTime);
-            double elapsedMs = (double)(currentTime.QuadPart - lastTime.QuadPart) * 1000.0 / frequency.QuadPart;
-            
-            if (elapsedMs < FRAME_TIME_MS)
+            // Idle slack until the next wake sharpens settled tiles; not part of the frame's
+            // measured time, so refinement never pushes the governor down
+            if (!g_FrameDue && !g_Governor.Settings().fastFilter)
             {
-                Sleep((DWORD)(FRAME_TIME_MS - elapsedMs));
+                RefineSettledTiles(pacer.NextDeadlineNs() + (g_Idle.PollDivisor() - 1) * pacer.PeriodNs());
             }
-            
-            QueryPerformanceCounter(&lastTime);
+
+            int64_t nowNs = pacer.Clock()->NowNs();
+            if (nowNs >= wakeupReportNs)
+            {
+                ReportWakeups(nowNs);
+                wakeupReportNs = nowNs + WAKEUP_REPORT_NS;
+            }
+
+            // Full rate while things change, progressively slower polling when idle
+            SetInputWake(g_Idle.IsThrottled());
+            if (g_FrameDue)
+                pacer.Reset();  // Set during this frame (a message dispatched by a window call): next one now
+            else
+                pacer.WaitForNextFrame(g_Idle.PollDivisor());
         }
     }
 
     // Unregister hotkey
     UnregisterHotKey(NULL, 1);
+    SetInputWake(false);
+    pacer.SetWaiter(nullptr);
+    g_EventLoop.SetHandler(nullptr);
+    ReportWakeups(pacer.Clock()->NowNs());
 
     // Restore timer resolution
     timeEndPeriod(1);
@@ -238,10 +349,30 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int)
     // Release cursor clip
     ClipCursor(NULL);
 
+    // Report how long each quality level was in use
+    char report[256];
+    g_Governor.Flush(pacer.Clock()->NowNs());
+    FormatQualityReport(g_Governor, report, sizeof(report));
+    OutputDebugStringA("DesktopCapture: ");
+    OutputDebugStringA(report);
+    OutputDebugStringA("\n");
+
     Cleanup();
     return 0;
 }
 
+void ApplyQualitySettings()
+{
+    // The first pass is COLORONCOLOR at every level (HALFTONE was replaced by progressive refinement).
+    // fastFilter turns the area-average refinement off and shortens the tile pass
+    // (FAST_FILTER_TILE_PERCENT); the main loop reads both every frame
+    const QualitySettings& settings = g_Governor.Settings();
+
+    char buf[128];
+    sprintf(buf, "DesktopCapture: quality level -> %s\n", settings.name);
+    OutputDebugStringA(buf);
+}
+
 LRESULT CALLBACK WindowProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
     switch (msg)
@@ -253,6 +384,17 @@ LRESULT CALLBACK WindowProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
     case WM_DESTROY:
         PostQuitMessage(0);
         return 0;
+    case WM_DISPLAYCHANGE:
+    case WM_DPICHANGED:
+        // Re-planned before the next frame, which runs at once
+        g_DisplayChanged = true;
+        g_FrameDue = true;
+        return 0;
+    case WM_INPUT:
+        // Registered only while idle: leave throttling now rather than at the next slow poll
+        g_Idle.OnInput(GetSystemFrameClock()->NowNs());
+        g_FrameDue = true;
+        break;  // DefWindowProc releases the raw input buffer
     }
     return DefWindowProcA(hWnd, msg, wParam, lParam);
 }
@@ -283,15 +425,15 @@ bool InitWindow(HINSTANCE hInstance)
         return false;
     }
 
-    // Create borderless fullscreen window covering first monitor (1920x1080)
+    // Create borderless fullscreen window covering the output monitor
     // WS_EX_TRANSPARENT + WS_EX_LAYERED makes mouse clicks pass through to desktop
     g_hWnd = CreateWindowExA(
         WS_EX_TOPMOST | WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_NOACTIVATE,
         "DesktopCaptureClass",
         "Desktop Capture",
         WS_POPUP,               // Borderless
-        FIRST_MONITOR_X, FIRST_MONITOR_Y,  // Position at first monitor (0,0)
-        OUTPUT_WIDTH, OUTPUT_HEIGHT,        // Hardcoded 1920x1080
+        g_Plan.outputX, g_Plan.outputY,     // Output monitor's rect
+        g_Plan.geometry.outputWidth, g_Plan.geometry.outputHeight,
         nullptr,
         nullptr,
         hInstance,
@@ -328,6 +470,59 @@ bool InitWindow(HINSTANCE hInstance)
     return true;
 }
 
+// Pooled frame backed by a DIB section selected into its own memory DC, so GDI can draw into it
+struct DibSurface
+{
+    HDC hdc;
+    HBITMAP bitmap;
+    HBITMAP oldBitmap;
+    RECT cursorRect;    // Where the cursor was drawn when this buffer last held a frame
+};
+
+class DibFrameAllocator : public FrameAllocator
+{
+public:
+    bool Allocate(int width, int height, FrameBuffer* buffer, void** user) override
+    {
+        DibSurface* surface = new DibSurface();
+        void* bits = nullptr;
+        surface->hdc = CreateDibDC(width, height, &surface->bitmap, &surface->oldBitmap, &bits);
+        if (!surface->hdc)
+        {
+            delete surface;
+            return false;
+        }
+
+        // Opaque black (ARGB format), bypassing the cache when the frame is larger; the padding
+        // on the right is never drawn again
+        FillPixels((uint32_t*)bits, (size_t)width * height, 0xFF000000);
+
+        // First pass into the frame: COLORONCOLOR drops pixels instead of averaging them,
+        // several times cheaper than HALFTONE
+        SetStretchBltMode(surface->hdc, COLORONCOLOR);
+
+        buffer->data = (uint8_t*)bits;
+        buffer->width = width;
+        buffer->height = height;
+        buffer->pitch = width * 4;      // Top-down DIB (negative biHeight): row 0 is the top row
+        buffer->bytes = (size_t)buffer->pitch * height;
+        *user = surface;
+        return true;
+    }
+
+    void Free(FrameBuffer* buffer, void* user) override
+    {
+        DibSurface* surface = (DibSurface*)user;
+        SelectObject(surface->hdc, surface->oldBitmap);
+        DeleteObject(surface->bitmap);
+        DeleteDC(surface->hdc);
+        delete surface;
+        *buffer = FrameBuffer();
+    }
+};
+
+static DibFrameAllocator g_DibAllocator;
+
 bool InitGDI()
 {
     // Get screen DC
@@ -337,54 +532,209 @@ bool InitGDI()
         return false;
     }
 
-    // Create memory DC compatible with screen
-    g_hdcMemory = CreateCompatibleDC(g_hdcScreen);
-    if (!g_hdcMemory)
+    const MirrorGeometry& geometry = g_Plan.geometry;
+    g_Tiles = TileScheduler(geometry.sourceWidth, geometry.sourceHeight, geometry.renderWidth, geometry.renderHeight);
+
+    // Output frames (32-bit BGRA DIB sections); grows past two only while consumers hold frames
+    FramePoolConfig poolConfig;
+    poolConfig.width = geometry.outputWidth;
+    poolConfig.height = geometry.outputHeight;
+    poolConfig.buffers = FRAME_POOL_BUFFERS;
+    poolConfig.maxBuffers = FRAME_POOL_MAX_BUFFERS;
+    poolConfig.policy = POOL_GROW;
+    if (!g_FramePool.Create(poolConfig, &g_DibAllocator))
+    {
+        return false;
+    }
+
+    // Create reusable clipping region for cursor
+    g_hClipRgn = CreateRectRgn(0, 0, geometry.renderWidth, geometry.renderHeight);
+
+    // Unscaled source copy the tiles are captured into
+    g_hdcSource = CreateDibDC(geometry.sourceWidth, geometry.sourceHeight,
+                              &g_hSourceBitmap, &g_hOldSourceBitmap, &g_pSourceBits);
+    if (!g_hdcSource)
+    {
+        return false;
+    }
+
+    // Refinement reconfigures the box scaler per tile; allocate once for the largest tile
+    int maxSrcWidth = 0, maxSrcHeight = 0, maxDstWidth = 0, maxDstHeight = 0;
+    for (int i = 0; i < g_Tiles.TileCount(); i++)
+    {
+        const TileRect& t = g_Tiles.Tile(i);
+        maxSrcWidth = t.srcWidth > maxSrcWidth ? t.srcWidth : maxSrcWidth;
+        maxSrcHeight = t.srcHeight > maxSrcHeight ? t.srcHeight : maxSrcHeight;
+        maxDstWidth = t.dstWidth > maxDstWidth ? t.dstWidth : maxDstWidth;
+        maxDstHeight = t.dstHeight > maxDstHeight ? t.dstHeight : maxDstHeight;
+    }
+    g_BoxScaler.Reserve(maxSrcWidth, maxSrcHeight, maxDstWidth, maxDstHeight);
+
+    g_hdcSaveUnder = CreateDibDC(CURSOR_SAVE_SIZE, CURSOR_SAVE_SIZE, &g_hSaveBitmap, &g_hOldSaveBitmap, nullptr);
+    if (!g_hdcSaveUnder)
+    {
+        return false;
+    }
+
+    g_TileHashes.assign(g_Tiles.TileCount(), 0);
+    g_TileWritten.assign(g_Tiles.TileCount(), 0);
+
+    return true;
+}
+
+// Makes g_Frame a buffer no consumer holds, showing the previous frame
+bool PrepareFrame()
+{
+    if (g_Frame.Unique())
+    {
+        return true;
+    }
+
+    // Every buffer busy and the pool at its cap: skip this frame
+    FrameRef next = g_FramePool.Acquire(0);
+    if (!next)
     {
         return false;
     }
 
-    // Create DIB section for direct pixel access (1920x1080, 32-bit BGRA)
+    if (g_Frame)
+    {
+        // Bring it forward: tiles written since it last held a frame, and the old cursor it still shows
+        HDC hdcPrevious = ((DibSurface*)g_Frame.User())->hdc;
+        DibSurface* surface = (DibSurface*)next.User();
+        for (int i = 0; i < g_Tiles.TileCount(); i++)
+        {
+            if (g_TileWritten[i] > next.Sequence())
+            {
+                const TileRect& t = g_Tiles.Tile(i);
+                BitBlt(surface->hdc, t.dstX, t.dstY, t.dstWidth, t.dstHeight, hdcPrevious, t.dstX, t.dstY, SRCCOPY);
+            }
+        }
+
+        const RECT& r = surface->cursorRect;
+        if (!IsRectEmpty(&r))
+        {
+            BitBlt(surface->hdc, r.left, r.top, r.right - r.left, r.bottom - r.top, hdcPrevious, r.left, r.top, SRCCOPY);
+        }
+    }
+
+    g_Frame = std::move(next);
+    return true;
+}
+
+// Memory DC with a top-down 32-bit DIB section selected
+HDC CreateDibDC(int width, int height, HBITMAP* bitmap, HBITMAP* oldBitmap, void** bits)
+{
+    HDC hdc = CreateCompatibleDC(g_hdcScreen);
+    if (!hdc)
+    {
+        return nullptr;
+    }
+
     BITMAPINFO bmi = {};
     bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth = OUTPUT_WIDTH;
-    bmi.bmiHeader.biHeight = -OUTPUT_HEIGHT;  // Negative for top-down bitmap
+    bmi.bmiHeader.biWidth = width;
+    bmi.bmiHeader.biHeight = -height;
     bmi.bmiHeader.biPlanes = 1;
     bmi.bmiHeader.biBitCount = 32;
     bmi.bmiHeader.biCompression = BI_RGB;
 
-    g_hBitmap = CreateDIBSection(g_hdcMemory, &bmi, DIB_RGB_COLORS, &g_pBitmapBits, NULL, 0);
-    if (!g_hBitmap)
+    void* pixels = nullptr;
+    *bitmap = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, &pixels, NULL, 0);
+    if (!*bitmap)
     {
-        return false;
+        DeleteDC(hdc);
+        return nullptr;
     }
 
-    // Select bitmap into memory DC
-    g_hOldBitmap = (HBITMAP)SelectObject(g_hdcMemory, g_hBitmap);
+    *oldBitmap = (HBITMAP)SelectObject(hdc, *bitmap);
+    if (bits)
+    {
+        *bits = pixels;
+    }
+    return hdc;
+}
 
-    // Create reusable clipping region for cursor
-    g_hClipRgn = CreateRectRgn(0, 0, RENDER_WIDTH, RENDER_HEIGHT);
+// While idle-throttled, raw keyboard/mouse input from any window (RIDEV_INPUTSINK) wakes the loop;
+// at full rate the per-frame GetLastInputInfo check is soon enough
+void SetInputWake(bool enable)
+{
+    if (enable == g_InputWake || !g_hWnd)
+        return;
 
-    // Set stretch mode for high-quality scaling
-    SetStretchBltMode(g_hdcMemory, HALFTONE);
-    SetBrushOrgEx(g_hdcMemory, 0, 0, NULL);
+    RAWINPUTDEVICE devices[2] = {};
+    devices[0].usUsagePage = 0x01;  // Generic desktop
+    devices[0].usUsage = 0x02;      // Mouse
+    devices[1].usUsagePage = 0x01;
+    devices[1].usUsage = 0x06;      // Keyboard
+    for (RAWINPUTDEVICE& device : devices)
+    {
+        device.dwFlags = enable ? RIDEV_INPUTSINK : RIDEV_REMOVE;
+        device.hwndTarget = enable ? g_hWnd : nullptr;
+    }
+    if (RegisterRawInputDevices(devices, 2, sizeof(RAWINPUTDEVICE)) || !enable)
+        g_InputWake = enable;
+}
 
-    // Pre-fill the entire buffer with opaque black
-    if (g_pBitmapBits)
+// Drains the thread's message queue; false once the app is quitting
+bool PumpMessages()
+{
+    MSG msg;
+    while (PeekMessageA(&msg, nullptr, 0, 0, PM_REMOVE))
     {
-        DWORD* pixels = (DWORD*)g_pBitmapBits;
-        constexpr int totalPixels = OUTPUT_WIDTH * OUTPUT_HEIGHT;
-        for (int i = 0; i < totalPixels; i++)
+        // Quit, or the Insert hotkey
+        if (msg.message == WM_QUIT || (msg.message == WM_HOTKEY && msg.wParam == 1))
         {
-            pixels[i] = 0xFF000000;  // Opaque black (ARGB format)
+            g_Running = false;
+            return false;
         }
+        TranslateMessage(&msg);
+        DispatchMessageA(&msg);
     }
-
     return true;
 }
 
-void CaptureAndRender()
+void ReportWakeups(int64_t nowNs)
+{
+    char report[192];
+    g_EventLoop.FormatWakeupReport(nowNs, report, sizeof(report));
+    OutputDebugStringA("DesktopCapture: ");
+    OutputDebugStringA(report);
+    OutputDebugStringA("\n");
+}
+
+void PollInputActivity()
 {
+    LASTINPUTINFO lii = {};
+    lii.cbSize = sizeof(LASTINPUTINFO);
+    if (GetLastInputInfo(&lii) && lii.dwTime != g_LastInputTick)
+    {
+        g_LastInputTick = lii.dwTime;
+        g_Idle.OnInput(GetSystemFrameClock()->NowNs());
+    }
+}
+
+void CaptureAndRender(int64_t deadlineNs)
+{
+    if (!PrepareFrame())
+    {
+        return;
+    }
+    DibSurface* surface = (DibSurface*)g_Frame.User();
+    HDC hdcFrame = surface->hdc;
+    g_FrameNumber++;
+
+    CURSORINFO ci = {};
+    ci.cbSize = sizeof(CURSORINFO);
+    bool cursorShowing = GetCursorInfo(&ci) && (ci.flags & CURSOR_SHOWING);
+
+    // Tile hashes cover the desktop only, so cursor moves, shape changes and animation count separately
+    bool cursorChanged = ci.ptScreenPos.x != g_LastCursorPos.x || ci.ptScreenPos.y != g_LastCursorPos.y ||
+                         (cursorShowing ? ci.hCursor : nullptr) != g_lastCursor || g_cursorFrameCount > 1;
+    g_LastCursorPos = ci.ptScreenPos;
+    if (!cursorShowing)
+        g_lastCursor = nullptr;  // Re-read the hotspot when it reappears
+
     // If we have WDA_EXCLUDEFROMCAPTURE support, capture directly
     // Otherwise fall back to hide/show method
     if (!g_UseExcludeFromCapture)
@@ -394,25 +744,56 @@ void CaptureAndRender()
             SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_HIDEWINDOW | SWP_NOACTIVATE);
     }
     
-    // Capture the 1920x1080 region from the FIRST monitor and scale it down to 1440x1080
-    // on the left side of our buffer
-    StretchBlt(
-        g_hdcMemory,            // Destination DC (our 1920x1080 buffer)
-        0, 0,                   // Destination x, y
-        RENDER_WIDTH,           // Destination width (1440)
-        RENDER_HEIGHT,          // Destination height (1080)
-        g_hdcScreen,            // Source DC (desktop)
-        FIRST_MONITOR_X,        // Source x (0)
-        FIRST_MONITOR_Y,        // Source y (0)
-        SOURCE_WIDTH,           // Source width (1920)
-        SOURCE_HEIGHT,          // Source height (1080)
-        SRCCOPY                 // Copy operation
-    );
+    // Take the last frame's cursor out again before tiles are drawn and refined
+    if (g_SaveRect.right > g_SaveRect.left && g_SaveRect.bottom > g_SaveRect.top)
+    {
+        BitBlt(hdcFrame, g_SaveRect.left, g_SaveRect.top,
+            g_SaveRect.right - g_SaveRect.left, g_SaveRect.bottom - g_SaveRect.top,
+            g_hdcSaveUnder, 0, 0, SRCCOPY);
+        SetRectEmpty(&g_SaveRect);
+    }
+
+    // Capture the source monitor and scale it into the render area on the left side of our
+    // buffer, one tile at a time in priority order
+    const MirrorGeometry& geometry = g_Plan.geometry;
+    FrameClock* clock = GetSystemFrameClock();
+    bool contentChanged = false;
+    g_Tiles.BeginFrame(ci.ptScreenPos.x - geometry.sourceX, ci.ptScreenPos.y - geometry.sourceY, deadlineNs);
+
+    int tile;
+    TileMode mode;
+    int64_t tileStartNs = clock->NowNs();
+    int sourcePitch = geometry.sourceWidth * 4;
+    while (g_Tiles.NextTile(tileStartNs, &tile, &mode))
+    {
+        const TileRect& t = g_Tiles.Tile(tile);
+
+        // Unscaled copy of the tile; flush so its cost is measured here rather than at the next
+        // batch boundary, and so the bits are there to hash
+        BitBlt(g_hdcSource, t.srcX, t.srcY, t.srcWidth, t.srcHeight,
+            g_hdcScreen, geometry.sourceX + t.srcX, geometry.sourceY + t.srcY, SRCCOPY);
+        GdiFlush();
+        const uint8_t* sourceTile = (const uint8_t*)g_pSourceBits + (size_t)t.srcY * sourcePitch + t.srcX * 4;
+        uint64_t hash = HashFrameRegion(sourceTile, t.srcWidth * 4, t.srcHeight, sourcePitch);
+        bool tileChanged = hash != g_TileHashes[tile];
+        g_TileHashes[tile] = hash;
+
+        // Only changed tiles are scaled; unchanged ones keep whatever they show, including a refined version
+        if (tileChanged)
+        {
+            StretchBlt(hdcFrame, t.dstX, t.dstY, t.dstWidth, t.dstHeight,
+                g_hdcSource, t.srcX, t.srcY, t.srcWidth, t.srcHeight, SRCCOPY);
+            g_TileWritten[tile] = g_FrameNumber;
+            contentChanged = true;
+        }
+
+        int64_t tileEndNs = clock->NowNs();
+        g_Tiles.EndTile(tile, mode, tileEndNs - tileStartNs, tileChanged);
+        tileStartNs = tileEndNs;
+    }
 
     // Draw the mouse cursor onto the captured image
-    CURSORINFO ci = {};
-    ci.cbSize = sizeof(CURSORINFO);
-    if (GetCursorInfo(&ci) && (ci.flags & CURSOR_SHOWING))
+    if (cursorShowing)
     {
         // Cache cursor info when cursor changes (avoid GetIconInfo allocation every frame)
         if (ci.hCursor != g_lastCursor)
@@ -425,6 +806,14 @@ void CaptureAndRender()
             {
                 g_cachedHotspotX = iconInfo.xHotspot;
                 g_cachedHotspotY = iconInfo.yHotspot;
+
+                // Size for the save-under (monochrome cursors stack AND and XOR masks vertically)
+                BITMAP bm = {};
+                if (GetObject(iconInfo.hbmColor ? iconInfo.hbmColor : iconInfo.hbmMask, sizeof(bm), &bm))
+                {
+                    g_cachedCursorWidth = bm.bmWidth;
+                    g_cachedCursorHeight = iconInfo.hbmColor ? bm.bmHeight : bm.bmHeight / 2;
+                }
                 // Clean up allocated bitmaps
                 if (iconInfo.hbmMask) DeleteObject(iconInfo.hbmMask);
                 if (iconInfo.hbmColor) DeleteObject(iconInfo.hbmColor);
@@ -441,23 +830,27 @@ void CaptureAndRender()
             }
         }
         
-        // Calculate cursor position relative to first monitor, scaled down and using cached hotspot
-        // Scale factor: RENDER_WIDTH / SOURCE_WIDTH = 1440 / 1920 = 0.75
-        double scaleX = (double)RENDER_WIDTH / SOURCE_WIDTH;
-        double scaleY = (double)RENDER_HEIGHT / SOURCE_HEIGHT;
-        
-        int cursorX = (int)((ci.ptScreenPos.x - FIRST_MONITOR_X) * scaleX) - (int)(g_cachedHotspotX * scaleX);
-        int cursorY = (int)((ci.ptScreenPos.y - FIRST_MONITOR_Y) * scaleY) - (int)(g_cachedHotspotY * scaleY);
+        // Calculate cursor position relative to the source monitor, scaled down and using cached hotspot
+        int hotspotX = ci.ptScreenPos.x - geometry.sourceX;
+        int hotspotY = ci.ptScreenPos.y - geometry.sourceY;
+        int cursorX = geometry.ToRenderX(hotspotX) - geometry.ToRenderX(g_cachedHotspotX);
+        int cursorY = geometry.ToRenderY(hotspotY) - geometry.ToRenderY(g_cachedHotspotY);
 
-        // Only draw if cursor hotspot is within the first monitor area
-        int hotspotX = ci.ptScreenPos.x - FIRST_MONITOR_X;
-        int hotspotY = ci.ptScreenPos.y - FIRST_MONITOR_Y;
-        
-        if (hotspotX >= 0 && hotspotX < SOURCE_WIDTH && 
-            hotspotY >= 0 && hotspotY < SOURCE_HEIGHT)
+        // Only draw if cursor hotspot is within the source monitor area
+        if (hotspotX >= 0 && hotspotX < geometry.sourceWidth && 
+            hotspotY >= 0 && hotspotY < geometry.sourceHeight)
         {
+            // Remember what the cursor covers so the next frame can restore it
+            RECT cursorRect = { cursorX, cursorY, cursorX + g_cachedCursorWidth, cursorY + g_cachedCursorHeight };
+            RECT renderRect = { 0, 0, geometry.renderWidth, geometry.renderHeight };
+            IntersectRect(&g_SaveRect, &cursorRect, &renderRect);
+            if (g_SaveRect.right - g_SaveRect.left > CURSOR_SAVE_SIZE) g_SaveRect.right = g_SaveRect.left + CURSOR_SAVE_SIZE;
+            if (g_SaveRect.bottom - g_SaveRect.top > CURSOR_SAVE_SIZE) g_SaveRect.bottom = g_SaveRect.top + CURSOR_SAVE_SIZE;
+            BitBlt(g_hdcSaveUnder, 0, 0, g_SaveRect.right - g_SaveRect.left, g_SaveRect.bottom - g_SaveRect.top,
+                hdcFrame, g_SaveRect.left, g_SaveRect.top, SRCCOPY);
+
             // Set clipping region to prevent cursor drawing outside capture area
-            SelectClipRgn(g_hdcMemory, g_hClipRgn);
+            SelectClipRgn(hdcFrame, g_hClipRgn);
             
             // Handle animated cursors using GetCursorFrameInfo
             HCURSOR hCursorToDraw = ci.hCursor;
@@ -481,7 +874,7 @@ void CaptureAndRender()
             }
             
             DrawIconEx(
-                g_hdcMemory,
+                hdcFrame,
                 cursorX,
                 cursorY,
                 hCursorToDraw,
@@ -491,7 +884,7 @@ void CaptureAndRender()
                 DI_NORMAL);
             
             // Remove clipping region
-            SelectClipRgn(g_hdcMemory, NULL);
+            SelectClipRgn(hdcFrame, NULL);
         }
     }
 
@@ -502,50 +895,147 @@ void CaptureAndRender()
             SWP_NOMOVE | SWP_NOSIZE | SWP_SHOWWINDOW | SWP_NOACTIVATE);
     }
 
-    // The remaining pixels on the right stay black (pre-filled during init)
+    // The remaining pixels on the right stay black (pre-filled when the buffer was allocated)
+    surface->cursorRect = g_SaveRect;
+    g_Frame.SetSequence(g_FrameNumber);
+
+    // Skip the present if no tile and no cursor changed
+    if (!g_Idle.Update(contentChanged, cursorChanged, GetSystemFrameClock()->NowNs()))
+    {
+        return;
+    }
 
     // Present the buffer to the window using cached DC
     BitBlt(
         g_hdcWindow,        // Destination (window) - cached DC
         0, 0,               // Destination x, y
-        OUTPUT_WIDTH,       // 1920
-        OUTPUT_HEIGHT,      // 1080
-        g_hdcMemory,        // Source (our buffer)
+        geometry.outputWidth,
+        geometry.outputHeight,
+        hdcFrame,           // Source (our buffer)
         0, 0,               // Source x, y
         SRCCOPY             // Copy operation
     );
 }
 
-void Cleanup()
+// Re-scales settled tiles with an exact area average from the source copy they were last captured
+// into (a settled tile has not changed since), until the next frame has to start. Each refined
+// tile goes to the window at once, since an idle frame may never be presented again.
+void RefineSettledTiles(int64_t untilNs)
+{
+    // Never write into a frame a consumer still holds; tiles under the cursor wait until it
+    // moves away, as the save-under would put the cheap pixels back
+    if (!g_Frame.Unique() || !g_hdcSource)
+    {
+        return;
+    }
+    HDC hdcFrame = ((DibSurface*)g_Frame.User())->hdc;
+    int sourcePitch = g_Plan.geometry.sourceWidth * 4;
+    FrameClock* clock = GetSystemFrameClock();
+
+    // CPU writes into the frame must not overtake GDI calls still batched against it
+    GdiFlush();
+    int tile;
+    int64_t tileStartNs = clock->NowNs();
+    while (g_Tiles.NextRefinement(tileStartNs, untilNs, &tile))
+    {
+        const TileRect& t = g_Tiles.Tile(tile);
+        RECT tileRect = { t.dstX, t.dstY, t.dstX + t.dstWidth, t.dstY + t.dstHeight };
+        RECT overlap;
+        if (IntersectRect(&overlap, &tileRect, &g_SaveRect))
+        {
+            continue;
+        }
+        if (!g_BoxScaler.Configure(t.srcWidth, t.srcHeight, t.dstWidth, t.dstHeight, g_LinearLight))
+        {
+            break;
+        }
+
+        const uint8_t* sourceTile = (const uint8_t*)g_pSourceBits + (size_t)t.srcY * sourcePitch + t.srcX * 4;
+        ImageView<FormatBGRA8> target = g_Frame.View<FormatBGRA8>().Sub(t.dstX, t.dstY, t.dstWidth, t.dstHeight);
+        g_BoxScaler.Scale(sourceTile, sourcePitch, target.Data(), (int)target.Pitch());
+        g_TileWritten[tile] = g_FrameNumber;
+        BitBlt(g_hdcWindow, t.dstX, t.dstY, t.dstWidth, t.dstHeight, hdcFrame, t.dstX, t.dstY, SRCCOPY);
+
+        int64_t tileEndNs = clock->NowNs();
+        g_Tiles.EndRefinement(tile, tileEndNs - tileStartNs);
+        tileStartNs = tileEndNs;
+    }
+}
+
+// Topology -> g_Plan. Returns true when the plan changed; on failure the current plan stays
+// (the default layout at startup).
+bool RefreshCapturePlan()
 {
-    if (g_hdcMemory && g_hOldBitmap)
+    DisplayTopology topology;
+    CapturePlan plan;
+    if (!QueryDisplayTopology(&topology) || !PlanCapture(topology, g_PlanOptions, &plan))
     {
-        SelectObject(g_hdcMemory, g_hOldBitmap);
+        OutputDebugStringA("DesktopCapture: no usable display topology, keeping the current layout\n");
+        return false;
+    }
+    if (plan.SameAs(g_Plan))
+    {
+        return false;
     }
 
+    g_Plan = plan;
+    const MirrorGeometry& g = plan.geometry;
+    char buf[256];
+    sprintf(buf, "DesktopCapture: %s %dx%d at (%d, %d) -> %s, %dx%d of %dx%d at (%d, %d), %d dpi\n",
+        topology.monitors[plan.sourceIndex].name, g.sourceWidth, g.sourceHeight, g.sourceX, g.sourceY,
+        topology.monitors[plan.outputIndex].name, g.renderWidth, g.renderHeight, g.outputWidth, g.outputHeight,
+        plan.outputX, plan.outputY, plan.outputDpi);
+    OutputDebugStringA(buf);
+    return true;
+}
+
+void ClipCursorToOutput()
+{
+    RECT clipRect = { g_Plan.outputX, g_Plan.outputY,
+                      g_Plan.outputX + g_Plan.geometry.outputWidth, g_Plan.outputY + g_Plan.geometry.outputHeight };
+    ClipCursor(&clipRect);
+}
+
+// Everything InitGDI creates (the window and its DC stay)
+void ReleaseGDI()
+{
     if (g_hClipRgn)
     {
         DeleteObject(g_hClipRgn);
         g_hClipRgn = nullptr;
     }
 
-    if (g_hBitmap)
+    if (g_hdcSource)
     {
-        DeleteObject(g_hBitmap);
-        g_hBitmap = nullptr;
+        SelectObject(g_hdcSource, g_hOldSourceBitmap);
+        DeleteObject(g_hSourceBitmap);
+        DeleteDC(g_hdcSource);
+        g_hdcSource = nullptr;
     }
 
-    if (g_hdcMemory)
+    if (g_hdcSaveUnder)
     {
-        DeleteDC(g_hdcMemory);
-        g_hdcMemory = nullptr;
+        SelectObject(g_hdcSaveUnder, g_hOldSaveBitmap);
+        DeleteObject(g_hSaveBitmap);
+        DeleteDC(g_hdcSaveUnder);
+        g_hdcSaveUnder = nullptr;
     }
 
+    // Every frame reference has to go before the pool frees the DIB sections
+    g_Frame.Reset();
+    g_FramePool.Destroy();
+    SetRectEmpty(&g_SaveRect);
+
     if (g_hdcScreen)
     {
         ReleaseDC(NULL, g_hdcScreen);
         g_hdcScreen = nullptr;
     }
+}
+
+void Cleanup()
+{
+    ReleaseGDI();
 
     if (g_hdcWindow && g_hWnd)
     {
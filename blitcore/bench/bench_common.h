@@ -0,0 +1,52 @@
+// Timing helpers shared by the blitcore benchmarks (platform independent)
+// Benchmarks are plain executables (not run by ctest); pass a duration in seconds as the first
+// argument to trade run time for stable numbers, and run them under perf stat / cachegrind for
+// cache-miss counts.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "frame_pacer.h"
+
+inline int64_t BenchNowNs()
+{
+    return GetSystemFrameClock()->NowNs();
+}
+
+// Seconds per measurement from argv[1], default 0.5
+inline double BenchSecondsArg(int argc, char** argv, double fallback = 0.5)
+{
+    double seconds = argc > 1 ? atof(argv[1]) : 0.0;
+    return seconds > 0.0 ? seconds : fallback;
+}
+
+// Calls fn once to warm caches, then repeatedly for at least the given time; returns ns per call
+template <typename Fn>
+double MeasureNs(Fn&& fn, double seconds)
+{
+    fn();
+    int64_t budget = (int64_t)(seconds * 1e9);
+    int64_t start = BenchNowNs();
+    int64_t now = start;
+    uint64_t calls = 0;
+    do
+    {
+        fn();
+        calls++;
+        now = BenchNowNs();
+    } while (now - start < budget);
+    return (double)(now - start) / (double)calls;
+}
+
+// Deterministic, non-constant pixel data so no kernel hits a degenerate fast path
+inline void FillBenchPattern(uint8_t* pixels, size_t bytes, uint32_t seed = 1)
+{
+    uint32_t state = seed ? seed : 1;
+    for (size_t i = 0; i < bytes; i++)
+    {
+        state = state * 1664525u + 1013904223u;
+        pixels[i] = (uint8_t)(state >> 24);
+    }
+}
@@ -0,0 +1,49 @@
+// Cursor shape decode time for the largest (256x256) shapes Windows hands out
+
+#include "bench_common.h"
+
+#include "cursor_shape.h"
+
+#include <stdio.h>
+
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    double seconds = BenchSecondsArg(argc, argv);
+    const int size = CURSOR_MAX_SIZE;
+
+    // Monochrome: AND mask then XOR mask, one bit per pixel; colour shapes: 32-bit BGRA
+    std::vector<uint8_t> mono((size_t)size / 8 * size * 2);
+    std::vector<uint8_t> color((size_t)size * size * 4);
+    FillBenchPattern(mono.data(), mono.size(), 3);
+    FillBenchPattern(color.data(), color.size(), 7);
+
+    CursorSprite sprite;
+    ReserveCursorSprite(&sprite);
+
+    struct Case
+    {
+        const char* name;
+        CursorShapeType type;
+        int height;
+        int pitch;
+        const uint8_t* data;
+    };
+    const Case cases[] = {
+        { "monochrome", CURSOR_SHAPE_MONOCHROME, size * 2, size / 8, mono.data() },
+        { "masked-color", CURSOR_SHAPE_MASKED_COLOR, size, size * 4, color.data() },
+        { "color", CURSOR_SHAPE_COLOR, size, size * 4, color.data() },
+    };
+
+    printf("%-14s %10s %12s\n", "shape", "us/decode", "Mpixel/s");
+    for (const Case& c : cases)
+    {
+        double ns = MeasureNs([&]()
+        {
+            DecodeCursorShape(c.type, size, c.height, c.pitch, c.data, &sprite);
+        }, seconds);
+        printf("%-14s %10.2f %12.1f\n", c.name, ns / 1e3, (double)size * size / ns * 1e3);
+    }
+    return 0;
+}
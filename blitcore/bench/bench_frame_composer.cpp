@@ -0,0 +1,86 @@
+// FrameComposer throughput: 1920x1080 -> 1440x1080 plus padding, by strip height and store mode.
+// After each compose the source is read once more, as the next consumer of the captured frame would:
+// the re-read time shows how much of it the frame's writes evicted from the cache.
+
+#include "bench_common.h"
+
+#include "cache_info.h"
+#include "frame_composer.h"
+#include "frame_memory.h"
+
+#include <stdio.h>
+
+#include <vector>
+
+// Reads every 64-bit word; the sum keeps the loads from being optimised away
+static uint64_t ReadAll(const std::vector<uint8_t>& pixels)
+{
+    const uint64_t* p = (const uint64_t*)pixels.data();
+    size_t count = pixels.size() / 8;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++)
+        sum += p[i];
+    return sum;
+}
+
+int main(int argc, char** argv)
+{
+    double seconds = BenchSecondsArg(argc, argv);
+    const int srcWidth = 1920, srcHeight = 1080, renderWidth = 1440, outWidth = 1920, outHeight = 1080;
+
+    std::vector<uint8_t> src((size_t)srcWidth * srcHeight * 4);
+    FillBenchPattern(src.data(), src.size());
+    FrameMemory memory;
+    FrameBuffer frame;
+    if (!memory.Allocate(&frame, outWidth, outHeight))
+    {
+        fprintf(stderr, "frame allocation failed\n");
+        return 1;
+    }
+
+    FrameComposer composer;
+    composer.Configure(srcWidth, srcHeight, renderWidth, srcHeight, outWidth, outHeight);
+
+    printf("L2 %zu KB, streaming threshold %zu KB\n", PlanningL2Size() / 1024, StreamingThreshold() / 1024);
+    printf("%-10s %-10s %10s %10s %12s\n", "strip", "stores", "ms/frame", "GB/s", "re-read ms");
+
+    const int strips[] = { 0, 1, 2, 4, 8, 16, 32, 64, 128, outHeight };
+    const StoreMode modes[] = { STORE_CACHED, STORE_STREAMING };
+    const char* modeNames[] = { "cached", "streaming" };
+    uint64_t checksum = 0;
+    for (int rows : strips)
+    {
+        composer.SetStripRows(rows);
+        for (int m = 0; m < 2; m++)
+        {
+            composer.SetStoreMode(modes[m]);
+            double ns = MeasureNs([&]()
+            {
+                composer.Compose(src.data(), srcWidth * 4, frame.data, frame.pitch, nullptr, 0, 0);
+            }, seconds);
+
+            // Compose, then time only the source re-read that follows it
+            int64_t readNs = 0;
+            int passes = 0;
+            int64_t start = BenchNowNs();
+            do
+            {
+                composer.Compose(src.data(), srcWidth * 4, frame.data, frame.pitch, nullptr, 0, 0);
+                int64_t readStart = BenchNowNs();
+                checksum += ReadAll(src);
+                readNs += BenchNowNs() - readStart;
+                passes++;
+            } while (BenchNowNs() - start < (int64_t)(seconds * 1e9));
+
+            // One read of the source plus one write of the output
+            double bytes = (double)src.size() + (double)outWidth * outHeight * 4;
+            char strip[16];
+            snprintf(strip, sizeof(strip), rows ? "%d" : "auto(%d)", composer.StripRows());
+            printf("%-10s %-10s %10.3f %10.2f %12.3f\n", strip, modeNames[m], ns / 1e6, bytes / ns,
+                   (double)readNs / passes / 1e6);
+        }
+    }
+
+    memory.Free(&frame);
+    return checksum == 1 ? 2 : 0;
+}
@@ -0,0 +1,167 @@
+// FramePool under contention: N producer threads acquire 1920x1080 frames and fan each one out to
+// N consumer queues; N consumer threads pop, take and drop extra references to the shared frame.
+// For each exhaustion policy and N = 1 .. cores: acquires per second, Acquire latency (p50/p99,
+// including any wait for a release), FrameRef copy and release cost on a contended count, and the
+// pool's counters. An optional second argument overrides the largest N.
+
+#include "bench_common.h"
+
+#include "frame_pool.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+constexpr int QUEUE_DEPTH = 2;
+constexpr int COPIES = 16;                  // References taken and dropped per popped frame
+constexpr size_t MAX_SAMPLES = 1 << 20;     // Acquire latencies kept per producer
+
+static const char* PolicyName(FramePoolPolicy policy)
+{
+    switch (policy)
+    {
+    case POOL_BLOCK: return "block";
+    case POOL_DROP_OLDEST: return "drop-oldest";
+    case POOL_GROW: return "grow";
+    }
+    return "?";
+}
+
+struct ConsumerCounts
+{
+    uint64_t frames = 0;
+    int64_t copyNs = 0;
+    int64_t releaseNs = 0;
+};
+
+static void RunPolicy(FramePoolPolicy policy, int threads, double seconds)
+{
+    FramePoolConfig config;
+    config.width = 1920;
+    config.height = 1080;
+    config.buffers = 3;
+    config.maxBuffers = policy == POOL_GROW ? 3 + threads * QUEUE_DEPTH : 3;
+    config.policy = policy;
+    FramePool pool;
+    if (!pool.Create(config))
+    {
+        printf("%-12s %-8d pool allocation failed\n", PolicyName(policy), threads);
+        return;
+    }
+
+    std::vector<FrameQueue*> queues;
+    for (int i = 0; i < threads; i++)
+        queues.push_back(new FrameQueue(&pool, QUEUE_DEPTH));
+
+    std::atomic<bool> go(false), stopProducers(false), stopConsumers(false);
+    std::vector<std::vector<uint32_t>> samples(threads);
+    std::vector<ConsumerCounts> counts(threads);
+    std::vector<std::thread> producers, consumers;
+
+    for (int i = 0; i < threads; i++)
+    {
+        consumers.emplace_back([&, i] {
+            std::vector<FrameRef> copies(COPIES);
+            ConsumerCounts& c = counts[i];
+            while (!go.load())
+                std::this_thread::yield();
+            while (!stopConsumers.load(std::memory_order_relaxed))
+            {
+                FrameRef frame = queues[i]->Pop(1000000);
+                if (!frame)
+                    continue;
+                int64_t t0 = BenchNowNs();
+                for (FrameRef& copy : copies)
+                    copy = frame;
+                int64_t t1 = BenchNowNs();
+                for (FrameRef& copy : copies)
+                    copy.Reset();
+                int64_t t2 = BenchNowNs();
+                c.copyNs += t1 - t0;
+                c.releaseNs += t2 - t1;
+                c.frames++;
+            }
+        });
+    }
+    for (int i = 0; i < threads; i++)
+    {
+        samples[i].reserve(MAX_SAMPLES);
+        producers.emplace_back([&, i] {
+            uint64_t sequence = 0;
+            while (!go.load())
+                std::this_thread::yield();
+            while (!stopProducers.load(std::memory_order_relaxed))
+            {
+                int64_t t0 = BenchNowNs();
+                FrameRef frame = pool.Acquire(-1);
+                int64_t t1 = BenchNowNs();
+                if (samples[i].size() < MAX_SAMPLES)
+                    samples[i].push_back((uint32_t)std::min<int64_t>(t1 - t0, UINT32_MAX));
+                frame.SetSequence(++sequence * threads + i);
+                for (FrameQueue* queue : queues)
+                    queue->Push(frame);
+            }
+        });
+    }
+
+    int64_t start = BenchNowNs();
+    go = true;
+    std::this_thread::sleep_for(std::chrono::nanoseconds((int64_t)(seconds * 1e9)));
+    // Producers first: one blocked in Acquire needs a consumer to release a buffer
+    stopProducers = true;
+    for (std::thread& thread : producers)
+        thread.join();
+    double elapsed = (double)(BenchNowNs() - start) / 1e9;
+    stopConsumers = true;
+    for (std::thread& thread : consumers)
+        thread.join();
+    for (FrameQueue* queue : queues)
+        delete queue;
+
+    std::vector<uint32_t> all;
+    for (const std::vector<uint32_t>& s : samples)
+        all.insert(all.end(), s.begin(), s.end());
+    std::sort(all.begin(), all.end());
+    uint32_t p50 = all.empty() ? 0 : all[all.size() / 2];
+    uint32_t p99 = all.empty() ? 0 : all[all.size() * 99 / 100];
+
+    ConsumerCounts total;
+    for (const ConsumerCounts& c : counts)
+    {
+        total.frames += c.frames;
+        total.copyNs += c.copyNs;
+        total.releaseNs += c.releaseNs;
+    }
+    double refs = (double)total.frames * COPIES;
+
+    FramePoolStats stats = pool.Stats();
+    printf("%-12s %-8d %12.0f %10u %10u %9.1f %9.1f %9llu %9llu %6llu %7d\n", PolicyName(policy), threads,
+           (double)stats.acquired / elapsed, p50, p99, refs > 0 ? total.copyNs / refs : 0.0,
+           refs > 0 ? total.releaseNs / refs : 0.0, (unsigned long long)stats.waited,
+           (unsigned long long)stats.dropped, (unsigned long long)stats.grown, pool.Capacity());
+}
+
+int main(int argc, char** argv)
+{
+    double seconds = BenchSecondsArg(argc, argv);
+    int cores = (int)std::thread::hardware_concurrency();
+    if (cores <= 0)
+        cores = 1;
+    int maxThreads = argc > 2 && atoi(argv[2]) > 0 ? atoi(argv[2]) : cores;
+
+    printf("%d hardware threads; N producers fan out to N consumers, queue depth %d, %d copies per pop\n",
+           cores, QUEUE_DEPTH, COPIES);
+    printf("%-12s %-8s %12s %10s %10s %9s %9s %9s %9s %6s %7s\n", "policy", "threads", "acquires/s", "p50 ns",
+           "p99 ns", "copy ns", "rel ns", "waited", "dropped", "grown", "buffers");
+
+    const FramePoolPolicy policies[] = { POOL_BLOCK, POOL_DROP_OLDEST, POOL_GROW };
+    for (FramePoolPolicy policy : policies)
+    {
+        for (int n = 1; n <= maxThreads; n++)
+            RunPolicy(policy, n, seconds);
+    }
+    return 0;
+}
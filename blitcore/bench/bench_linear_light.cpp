@@ -0,0 +1,75 @@
+// Cost of linear-light processing relative to the plain sRGB path, per 1920x1080 -> 1440x1080 frame:
+// the row conversions alone, the two scalers, and a fully semi-transparent 256x256 cursor blend
+
+#include "bench_common.h"
+
+#include "bilinear_sampler.h"
+#include "box_scaler.h"
+#include "cursor_blend.h"
+#include "linear_light.h"
+
+#include <stdio.h>
+
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    double seconds = BenchSecondsArg(argc, argv);
+    const int srcWidth = 1920, srcHeight = 1080, dstWidth = 1440, dstHeight = 1080;
+
+    std::vector<uint8_t> src((size_t)srcWidth * srcHeight * 4);
+    std::vector<uint8_t> dst((size_t)dstWidth * dstHeight * 4);
+    std::vector<uint16_t> linear((size_t)srcWidth * 4);
+    FillBenchPattern(src.data(), src.size(), 36);
+
+    BilinearSampler sampler;
+    BoxScaler box;
+
+    // Colour cursor with every alpha value, so every pixel takes the blend path
+    const int cursorSize = CURSOR_MAX_SIZE;
+    std::vector<uint8_t> shape((size_t)cursorSize * cursorSize * 4);
+    FillBenchPattern(shape.data(), shape.size(), 5);
+    for (size_t i = 3; i < shape.size(); i += 4)
+        shape[i] = (uint8_t)(1 + shape[i] % 254);
+    CursorSprite cursor;
+    DecodeCursorShape(CURSOR_SHAPE_COLOR, cursorSize, cursorSize, cursorSize * 4, shape.data(), &cursor);
+    ImageView<FormatBGRA8> view(dst.data(), dstWidth, dstHeight, dstWidth * 4);
+
+    printf("%-22s %10s %10s %8s\n", "kernel", "sRGB ms", "linear ms", "ratio");
+
+    // Conversion only: the overhead every linear kernel pays on top of its arithmetic
+    double toLinear = MeasureNs([&]()
+    {
+        for (int y = 0; y < srcHeight; y++)
+            SrgbRowToLinear(src.data() + (size_t)y * srcWidth * 4, linear.data(), srcWidth);
+    }, seconds);
+    double toSrgb = MeasureNs([&]()
+    {
+        for (int y = 0; y < dstHeight; y++)
+            LinearRowToSrgb(linear.data(), dst.data() + (size_t)y * dstWidth * 4, dstWidth);
+    }, seconds);
+    printf("%-22s %10s %10.2f %8s\n", "sRGB -> linear rows", "-", toLinear / 1e6, "-");
+    printf("%-22s %10s %10.2f %8s\n", "linear -> sRGB rows", "-", toSrgb / 1e6, "-");
+
+    for (int pass = 0; pass < 3; pass++)
+    {
+        const char* names[] = { "bilinear sampler", "box scaler", "cursor blend 256x256" };
+        double ns[2];
+        for (int linearLight = 0; linearLight < 2; linearLight++)
+        {
+            sampler.Configure(srcWidth, srcHeight, dstWidth, dstHeight, linearLight != 0);
+            box.Configure(srcWidth, srcHeight, dstWidth, dstHeight, linearLight != 0);
+            ns[linearLight] = MeasureNs([&]()
+            {
+                if (pass == 0)
+                    sampler.Scale(src.data(), srcWidth * 4, dst.data(), dstWidth * 4);
+                else if (pass == 1)
+                    box.Scale(src.data(), srcWidth * 4, dst.data(), dstWidth * 4);
+                else
+                    BlendCursor(view, cursor, 100, 100, linearLight != 0);
+            }, seconds);
+        }
+        printf("%-22s %10.2f %10.2f %7.2fx\n", names[pass], ns[0] / 1e6, ns[1] / 1e6, ns[1] / ns[0]);
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Several mirror pipelines sharing one WorkerPool: frames per second for N = 1 .. cores pipelines,
+// each unpaced on its own thread (1920x1080 -> 1440x1080 with padding, content changing every frame).
+// An optional second argument overrides the largest N.
+
+#include "bench_common.h"
+
+#include "mirror_pipeline.h"
+#include "worker_pool.h"
+
+#include <stdio.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Alternates between two pre-filled frames so every poll sees new content
+class BenchSource : public MirrorSource
+{
+public:
+    BenchSource()
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            m_Frames[i].resize((size_t)SOURCE_WIDTH * SOURCE_HEIGHT * 4);
+            FillBenchPattern(m_Frames[i].data(), m_Frames[i].size(), i + 1);
+        }
+    }
+
+    bool Capture(const MirrorGeometry&, const uint8_t** pixels, int* pitch) override
+    {
+        m_Next ^= 1;
+        *pixels = m_Frames[m_Next].data();
+        *pitch = SOURCE_WIDTH * 4;
+        return true;
+    }
+
+    bool QueryCursor(MirrorCursor* cursor, CursorSprite*) override
+    {
+        cursor->visible = false;
+        return true;
+    }
+
+private:
+    std::vector<uint8_t> m_Frames[2];
+    int m_Next = 0;
+};
+
+class NullSink : public MirrorSink
+{
+public:
+    bool Present(const uint8_t*, int, int, int) override { return true; }
+};
+
+int main(int argc, char** argv)
+{
+    double seconds = BenchSecondsArg(argc, argv);
+    int cores = (int)std::thread::hardware_concurrency();
+    if (cores <= 0)
+        cores = 1;
+    int maxPipelines = argc > 2 && atoi(argv[2]) > 0 ? atoi(argv[2]) : cores;
+
+    WorkerPool workers;
+    printf("%d hardware threads, pool of %d\n", cores, workers.ThreadCount());
+    printf("%-10s %12s %14s %12s %12s\n", "pipelines", "frames/s", "per pipeline", "ms/frame", "shared jobs");
+
+    MirrorGeometry geometry;
+    for (int n = 1; n <= maxPipelines; n++)
+    {
+        std::vector<BenchSource> sources(n);
+        std::vector<NullSink> sinks(n);
+        std::vector<MirrorPipeline*> pipelines;
+        for (int i = 0; i < n; i++)
+        {
+            pipelines.push_back(new MirrorPipeline(&sources[i], &sinks[i], &workers));
+            pipelines.back()->Configure(geometry);
+            pipelines.back()->RunFrame();           // Warm: first capture and compose
+        }
+
+        uint64_t sharedBefore = workers.SharedJobs();
+        std::atomic<bool> go(false), stop(false);
+        std::vector<uint64_t> frames(n, 0);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < n; i++)
+        {
+            threads.emplace_back([&, i] {
+                while (!go.load())
+                    std::this_thread::yield();
+                while (!stop.load(std::memory_order_relaxed))
+                    frames[i] += pipelines[i]->RunFrame() ? 1 : 0;
+            });
+        }
+
+        int64_t start = BenchNowNs();
+        go = true;
+        std::this_thread::sleep_for(std::chrono::nanoseconds((int64_t)(seconds * 1e9)));
+        stop = true;
+        for (std::thread& thread : threads)
+            thread.join();
+        double elapsed = (double)(BenchNowNs() - start) / 1e9;
+
+        uint64_t total = 0;
+        for (uint64_t count : frames)
+            total += count;
+        double fps = (double)total / elapsed;
+        printf("%-10d %12.1f %14.1f %12.3f %12llu\n", n, fps, fps / n, total ? elapsed * 1e3 * n / total : 0.0,
+               (unsigned long long)(workers.SharedJobs() - sharedBefore));
+
+        for (MirrorPipeline* pipeline : pipelines)
+            delete pipeline;
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+// Planar (SoA) resampler against the interleaved BilinearSampler at the ratios the mirror uses
+// (single thread, full frames)
+
+#include "bench_common.h"
+
+#include "bilinear_sampler.h"
+#include "planar_resampler.h"
+
+#include <stdio.h>
+
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    double seconds = BenchSecondsArg(argc, argv);
+
+    struct Case
+    {
+        int srcWidth, srcHeight, dstWidth, dstHeight;
+    };
+    const Case cases[] = {
+        { 1920, 1080, 1440, 1080 },
+        { 2560, 1440, 1440, 1080 },
+        { 3840, 2160, 1440, 1080 },
+    };
+
+    printf("%-22s %12s %12s %8s %12s\n", "ratio", "sampler ms", "planar ms", "speedup", "planar MP/s");
+    for (const Case& c : cases)
+    {
+        std::vector<uint8_t> src((size_t)c.srcWidth * c.srcHeight * 4);
+        std::vector<uint8_t> dst((size_t)c.dstWidth * c.dstHeight * 4);
+        FillBenchPattern(src.data(), src.size(), 37);
+
+        BilinearSampler sampler;
+        PlanarResampler planar;
+        sampler.Configure(c.srcWidth, c.srcHeight, c.dstWidth, c.dstHeight);
+        if (!planar.Configure(c.srcWidth, c.srcHeight, c.dstWidth, c.dstHeight))
+        {
+            printf("%4dx%-4d -> %4dx%-4d  not periodic enough for the planar path\n",
+                   c.srcWidth, c.srcHeight, c.dstWidth, c.dstHeight);
+            continue;
+        }
+
+        double samplerNs = MeasureNs([&]()
+        {
+            sampler.Scale(src.data(), c.srcWidth * 4, dst.data(), c.dstWidth * 4);
+        }, seconds);
+        double planarNs = MeasureNs([&]()
+        {
+            planar.Scale(src.data(), c.srcWidth * 4, dst.data(), c.dstWidth * 4);
+        }, seconds);
+
+        char ratio[32];
+        snprintf(ratio, sizeof(ratio), "%dx%d -> %dx%d", c.srcWidth, c.srcHeight, c.dstWidth, c.dstHeight);
+        printf("%-22s %12.2f %12.2f %7.2fx %12.1f\n", ratio, samplerNs / 1e6, planarNs / 1e6, samplerNs / planarNs,
+               (double)c.dstWidth * c.dstHeight / planarNs * 1e3);
+    }
+    return 0;
+}
@@ -0,0 +1,254 @@
+// D3D11 bilinear sampler emulation - see bilinear_sampler.h
+
+#include "bilinear_sampler.h"
+#include "linear_light.h"
+#include "stream_store.h"
+#include "worker_pool.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLITCORE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+void BilinearSampler::BuildTaps(std::vector<Tap>& taps, int srcSize, int dstSize)
+{
+    taps.resize(dstSize);
+    for (int i = 0; i < dstSize; i++)
+    {
+        // Single-precision like the shader, then snapped to 1/256 texel
+        float uv = ((float)i + 0.5f) / (float)dstSize;
+        float texel = uv * (float)srcSize - 0.5f;
+        int fixed = (int)floorf(texel * 256.0f + 0.5f);
+
+        int i0 = fixed >> 8;    // Arithmetic shift: floor for the negative edge texels too
+        int frac = fixed & 255;
+        int i1 = i0 + 1;
+        taps[i].i0 = i0 < 0 ? 0 : (i0 >= srcSize ? srcSize - 1 : i0);
+        taps[i].i1 = i1 < 0 ? 0 : (i1 >= srcSize ? srcSize - 1 : i1);
+        taps[i].frac = frac;
+    }
+}
+
+bool BilinearSampler::Configure(int srcWidth, int srcHeight, int dstWidth, int dstHeight, bool linearLight)
+{
+    if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0)
+        return false;
+
+    m_LinearLight = linearLight;
+    if (srcWidth == m_SrcWidth && srcHeight == m_SrcHeight && dstWidth == DstWidth() && dstHeight == DstHeight())
+        return true;
+
+    m_SrcWidth = srcWidth;
+    m_SrcHeight = srcHeight;
+    BuildTaps(m_TapsX, srcWidth, dstWidth);
+    BuildTaps(m_TapsY, srcHeight, dstHeight);
+    return true;
+}
+
+void BilinearSampler::ScaleRows(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch,
+                                int rowBegin, int rowEnd, bool streaming) const
+{
+    if (streaming)
+    {
+        // One row at a time into an L1-resident row, then out past the cache
+        thread_local std::vector<uint8_t> row;
+        size_t bytes = (size_t)DstWidth() * 4;
+        if (row.size() < bytes)
+            row.resize(bytes);
+        for (int y = rowBegin; y < rowEnd; y++)
+        {
+            ScaleRows(src, srcPitch, row.data(), 0, y, y + 1);
+            CopyPixelsUnfenced(dst + (intptr_t)y * dstPitch, row.data(), bytes);
+        }
+        return;
+    }
+
+    if (m_LinearLight)
+    {
+        ScaleRowsLinear(src, srcPitch, dst, dstPitch, rowBegin, rowEnd);
+        return;
+    }
+
+    int dstWidth = DstWidth();
+
+    for (int y = rowBegin; y < rowEnd; y++)
+    {
+        const Tap& ty = m_TapsY[y];
+        const uint8_t* row0 = src + (intptr_t)ty.i0 * srcPitch;
+        const uint8_t* row1 = src + (intptr_t)ty.i1 * srcPitch;
+        uint8_t* out = dst + (intptr_t)y * dstPitch;
+        int x = 0;
+
+        if (ty.frac == 0)
+        {
+            // Texel-aligned row (equal heights): horizontal lerp only, (c0 * (256 - f) + c1 * f + 128) >> 8
+#ifdef BLITCORE_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i round = _mm_set1_epi32(128);
+            for (; x + 2 <= dstWidth; x += 2)
+            {
+                const Tap& a = m_TapsX[x];
+                const Tap& b = m_TapsX[x + 1];
+                int a0, a1, b0, b1;
+                memcpy(&a0, row0 + a.i0 * 4, 4);
+                memcpy(&a1, row0 + a.i1 * 4, 4);
+                memcpy(&b0, row0 + b.i0 * 4, 4);
+                memcpy(&b1, row0 + b.i1 * 4, 4);
+
+                // Interleave each pixel pair per channel (c0, c1) so one madd does both products
+                __m128i pa = _mm_unpacklo_epi8(_mm_unpacklo_epi8(_mm_cvtsi32_si128(a0), _mm_cvtsi32_si128(a1)), zero);
+                __m128i pb = _mm_unpacklo_epi8(_mm_unpacklo_epi8(_mm_cvtsi32_si128(b0), _mm_cvtsi32_si128(b1)), zero);
+                __m128i wa = _mm_set1_epi32((a.frac << 16) | (256 - a.frac));
+                __m128i wb = _mm_set1_epi32((b.frac << 16) | (256 - b.frac));
+                __m128i sa = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(pa, wa), round), 8);
+                __m128i sb = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(pb, wb), round), 8);
+
+                __m128i packed = _mm_packus_epi16(_mm_packs_epi32(sa, sb), zero);
+                _mm_storel_epi64((__m128i*)(out + x * 4), packed);
+            }
+#endif
+            for (; x < dstWidth; x++)
+            {
+                const Tap& tx = m_TapsX[x];
+                const uint8_t* p0 = row0 + tx.i0 * 4;
+                const uint8_t* p1 = row0 + tx.i1 * 4;
+                for (int c = 0; c < 4; c++)
+                    out[x * 4 + c] = (uint8_t)((p0[c] * (256 - tx.frac) + p1[c] * tx.frac + 128) >> 8);
+            }
+            continue;
+        }
+
+        // General case: products of both weights, (sum + 32768) >> 16
+        int wy1 = ty.frac;
+        int wy0 = 256 - wy1;
+        for (; x < dstWidth; x++)
+        {
+            const Tap& tx = m_TapsX[x];
+            int wx1 = tx.frac;
+            int wx0 = 256 - wx1;
+            const uint8_t* p00 = row0 + tx.i0 * 4;
+            const uint8_t* p01 = row0 + tx.i1 * 4;
+            const uint8_t* p10 = row1 + tx.i0 * 4;
+            const uint8_t* p11 = row1 + tx.i1 * 4;
+            for (int c = 0; c < 4; c++)
+            {
+                int top = p00[c] * wx0 + p01[c] * wx1;
+                int bottom = p10[c] * wx0 + p11[c] * wx1;
+                out[x * 4 + c] = (uint8_t)((top * wy0 + bottom * wy1 + 32768) >> 16);
+            }
+        }
+    }
+}
+
+// Same taps on linear values: horizontal lerp rounded back to 15 bits, then the vertical lerp.
+// Source rows are converted once into a per-thread buffer; weights stay 8-bit, so both products
+// fit one signed 16-bit multiply-add.
+void BilinearSampler::ScaleRowsLinear(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch,
+                                      int rowBegin, int rowEnd) const
+{
+    const LinearLightTables& t = GetLinearLightTables();
+    int dstWidth = DstWidth();
+
+    thread_local std::vector<uint16_t> rows;
+    rows.resize((size_t)m_SrcWidth * 8);
+    uint16_t* lin[2] = { rows.data(), rows.data() + (size_t)m_SrcWidth * 4 };
+    int converted[2] = { -1, -1 };
+
+    for (int y = rowBegin; y < rowEnd; y++)
+    {
+        const Tap& ty = m_TapsY[y];
+        int wy1 = ty.frac;
+        int wy0 = 256 - wy1;
+
+        // Reuse converted rows (upscaling revisits them); the second row is skipped at zero weight
+        if (converted[0] != ty.i0 && converted[1] == ty.i0)
+        {
+            uint16_t* swapRow = lin[0]; lin[0] = lin[1]; lin[1] = swapRow;
+            int swapIndex = converted[0]; converted[0] = converted[1]; converted[1] = swapIndex;
+        }
+        if (converted[0] != ty.i0)
+        {
+            SrgbRowToLinear(src + (intptr_t)ty.i0 * srcPitch, lin[0], m_SrcWidth);
+            converted[0] = ty.i0;
+        }
+        if (wy1 && converted[1] != ty.i1)
+        {
+            SrgbRowToLinear(src + (intptr_t)ty.i1 * srcPitch, lin[1], m_SrcWidth);
+            converted[1] = ty.i1;
+        }
+        const uint16_t* top = lin[0];
+        const uint16_t* bottom = wy1 ? lin[1] : lin[0];
+        uint8_t* out = dst + (intptr_t)y * dstPitch;
+
+#ifdef BLITCORE_SSE2
+        const __m128i round = _mm_set1_epi32(128);
+        const __m128i wy = _mm_set1_epi32((wy1 << 16) | wy0);
+#endif
+        for (int x = 0; x < dstWidth; x++)
+        {
+            const Tap& tx = m_TapsX[x];
+            int wx1 = tx.frac;
+            int wx0 = 256 - wx1;
+
+#ifdef BLITCORE_SSE2
+            // (c0, c1) per channel straight from the converted rows
+            __m128i pt = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(top + tx.i0 * 4)),
+                                            _mm_loadl_epi64((const __m128i*)(top + tx.i1 * 4)));
+            __m128i wx = _mm_set1_epi32((wx1 << 16) | wx0);
+            __m128i v = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(pt, wx), round), 8);
+            if (wy1)
+            {
+                // (top, bottom) pairs per channel for the vertical multiply-add
+                __m128i pb = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(bottom + tx.i0 * 4)),
+                                                _mm_loadl_epi64((const __m128i*)(bottom + tx.i1 * 4)));
+                __m128i hb = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(pb, wx), round), 8);
+                __m128i pairs = _mm_unpacklo_epi16(_mm_packs_epi32(v, v), _mm_packs_epi32(hb, hb));
+                v = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(pairs, wy), round), 8);
+            }
+
+            out[x * 4 + 0] = t.toSrgb[_mm_cvtsi128_si32(v) >> 3];
+            out[x * 4 + 1] = t.toSrgb[_mm_extract_epi16(v, 2) >> 3];
+            out[x * 4 + 2] = t.toSrgb[_mm_extract_epi16(v, 4) >> 3];
+            out[x * 4 + 3] = LinearToAlpha((uint32_t)_mm_extract_epi16(v, 6));
+#else
+            for (int c = 0; c < 4; c++)
+            {
+                int h0 = (top[tx.i0 * 4 + c] * wx0 + top[tx.i1 * 4 + c] * wx1 + 128) >> 8;
+                int h1 = (bottom[tx.i0 * 4 + c] * wx0 + bottom[tx.i1 * 4 + c] * wx1 + 128) >> 8;
+                uint32_t v = (uint32_t)((h0 * wy0 + h1 * wy1 + 128) >> 8);
+                out[x * 4 + c] = c == 3 ? LinearToAlpha(v) : LinearToSrgb(t, v);
+            }
+#endif
+        }
+    }
+}
+
+struct SamplerJob
+{
+    const BilinearSampler* sampler;
+    const uint8_t* src;
+    int srcPitch;
+    uint8_t* dst;
+    int dstPitch;
+};
+
+static void ScaleRowsTask(void* context, int begin, int end)
+{
+    const SamplerJob* job = (const SamplerJob*)context;
+    job->sampler->ScaleRows(job->src, job->srcPitch, job->dst, job->dstPitch, begin, end);
+}
+
+void BilinearSampler::Scale(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch, WorkerPool* pool) const
+{
+    if (!pool)
+    {
+        ScaleRows(src, srcPitch, dst, dstPitch, 0, DstHeight());
+        return;
+    }
+
+    SamplerJob job = { this, src, srcPitch, dst, dstPitch };
+    pool->ParallelFor(DstHeight(), ScaleRowsTask, &job);
+}
@@ -0,0 +1,52 @@
+// CPU emulation of the D3D11 bilinear sampler the DXGI shader uses (platform independent)
+// Same mapping as the pixel shader (uv = (x + 0.5) / dstWidth, texel = uv * srcWidth - 0.5),
+// clamp addressing, texel coordinates snapped to 8 fractional bits like the hardware, and
+// round-to-nearest UNORM output. Matches the GPU within 1 LSB (float rounding of the
+// interpolated coordinate can land on the neighbouring 1/256 step).
+// Optionally filters in linear light instead (see linear_light.h): sharper, correct-brightness
+// text at roughly four times the cost, and no longer bit-identical to the GPU.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+class WorkerPool;
+
+class BilinearSampler
+{
+public:
+    // Precomputes the taps for this mapping; cheap when the sizes are unchanged
+    bool Configure(int srcWidth, int srcHeight, int dstWidth, int dstHeight, bool linearLight = false);
+
+    // BGRA8 in/out, pitches in bytes. Rows are split across the pool's threads when given.
+    void Scale(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch, WorkerPool* pool = nullptr) const;
+
+    // Output rows [rowBegin, rowEnd) only (a dstPitch of 0 writes each of them to dst). With streaming,
+    // each row is built in a per-thread row buffer and written out with unfenced streaming stores: the
+    // caller runs StreamFence() before the rows are read elsewhere (see stream_store.h).
+    void ScaleRows(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch, int rowBegin, int rowEnd,
+                   bool streaming = false) const;
+
+    int DstWidth() const { return (int)m_TapsX.size(); }
+    int DstHeight() const { return (int)m_TapsY.size(); }
+
+private:
+    // Two clamped texels and the 8-bit weight of the second (0..255)
+    struct Tap
+    {
+        int i0;
+        int i1;
+        int frac;
+    };
+
+    static void BuildTaps(std::vector<Tap>& taps, int srcSize, int dstSize);
+    void ScaleRowsLinear(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch, int rowBegin, int rowEnd) const;
+
+    std::vector<Tap> m_TapsX;
+    std::vector<Tap> m_TapsY;
+    int m_SrcWidth = 0;
+    int m_SrcHeight = 0;
+    bool m_LinearLight = false;
+};
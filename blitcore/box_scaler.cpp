@@ -0,0 +1,259 @@
+// Exact area-average scaler - see box_scaler.h
+//
+// With the output size reduced by the gcd (unit = dst / g), every box edge sits on a 1/unit source
+// pixel grid. The source integral at q + r/unit is (unit - r) * T[q] + r * T[q + 1] (times unit),
+// so a box sum scaled by unitX * unitY is an integer combination of table entries, and equals
+// average * (reduced box area). That value is below 2^32 by construction, which is what lets the
+// table and every intermediate wrap freely in 32-bit lanes.
+
+#include "box_scaler.h"
+#include "linear_light.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLITCORE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+static uint32_t Gcd(uint32_t a, uint32_t b)
+{
+    while (b)
+    {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+bool BoxScaler::Configure(int srcWidth, int srcHeight, int dstWidth, int dstHeight, bool linearLight)
+{
+    if (srcWidth == m_SrcWidth && srcHeight == m_SrcHeight && dstWidth == m_DstWidth && dstHeight == m_DstHeight &&
+        linearLight == m_LinearLight)
+        return true;
+    if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0)
+        return false;
+
+    uint32_t gx = Gcd((uint32_t)srcWidth, (uint32_t)dstWidth);
+    uint32_t gy = Gcd((uint32_t)srcHeight, (uint32_t)dstHeight);
+    uint64_t divisor = (uint64_t)(srcWidth / gx) * (srcHeight / gy);
+    // Box sums are average * divisor and must fit 32 bits: 8-bit or 15-bit averages
+    if (divisor >= (linearLight ? (1u << 17) : (1u << 24)))
+        return false;
+
+    m_SrcWidth = srcWidth;
+    m_SrcHeight = srcHeight;
+    m_DstWidth = dstWidth;
+    m_DstHeight = dstHeight;
+    m_UnitX = dstWidth / gx;
+    m_UnitY = dstHeight / gy;
+    m_Divisor = (uint32_t)divisor;
+    m_Reciprocal = 0xFFFFFFFFu / m_Divisor;
+    m_LinearLight = linearLight;
+
+    // Edge i is at i * src / dst = (i * src / g) / unit source pixels
+    m_EdgesX.resize(dstWidth + 1);
+    for (int i = 0; i <= dstWidth; i++)
+    {
+        uint64_t p = (uint64_t)i * (srcWidth / gx);
+        m_EdgesX[i].q = (int)(p / m_UnitX);
+        m_EdgesX[i].r = (uint32_t)(p % m_UnitX);
+    }
+    m_EdgesY.resize(dstHeight + 1);
+    for (int i = 0; i <= dstHeight; i++)
+    {
+        uint64_t p = (uint64_t)i * (srcHeight / gy);
+        m_EdgesY[i].q = (int)(p / m_UnitY);
+        m_EdgesY[i].r = (uint32_t)(p % m_UnitY);
+    }
+
+    // resize keeps the capacity of a larger earlier size. Only row 0 and column 0 have to be
+    // zero for the new stride; BuildTable overwrites everything else.
+    size_t stride = (size_t)(srcWidth + 1) * 4;
+    m_Table.resize((size_t)(srcHeight + 1) * stride);
+    memset(m_Table.data(), 0, stride * sizeof(uint32_t));
+    for (int y = 1; y <= srcHeight; y++)
+        memset(&m_Table[(size_t)y * stride], 0, 4 * sizeof(uint32_t));
+    m_Span.resize(stride);
+    m_Linear.resize(linearLight ? (size_t)(srcWidth > dstWidth ? srcWidth : dstWidth) * 4 : 0);
+    return true;
+}
+
+void BoxScaler::Reserve(int maxSrcWidth, int maxSrcHeight, int maxDstWidth, int maxDstHeight)
+{
+    size_t stride = (size_t)(maxSrcWidth + 1) * 4;
+    m_EdgesX.reserve(maxDstWidth + 1);
+    m_EdgesY.reserve(maxDstHeight + 1);
+    m_Table.reserve((size_t)(maxSrcHeight + 1) * stride);
+    m_Span.reserve(stride);
+    m_Linear.reserve((size_t)(maxSrcWidth > maxDstWidth ? maxSrcWidth : maxDstWidth) * 4);
+}
+
+void BoxScaler::BuildTable(const uint8_t* src, int srcPitch)
+{
+    size_t stride = (size_t)(m_SrcWidth + 1) * 4;
+
+    // Row 0 and column 0 stay zero from Configure
+    for (int y = 0; y < m_SrcHeight; y++)
+    {
+        const uint8_t* s = src + (intptr_t)y * srcPitch;
+        const uint32_t* prev = &m_Table[(size_t)y * stride + 4];
+        uint32_t* cur = &m_Table[(size_t)(y + 1) * stride + 4];
+
+        if (m_LinearLight)
+        {
+            const uint16_t* lin = m_Linear.data();
+            SrgbRowToLinear(s, m_Linear.data(), m_SrcWidth);
+#ifdef BLITCORE_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            __m128i run = zero;
+            for (int x = 0; x < m_SrcWidth; x++)
+            {
+                __m128i px = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(lin + x * 4)), zero);
+                run = _mm_add_epi32(run, px);
+                _mm_storeu_si128((__m128i*)(cur + x * 4),
+                                 _mm_add_epi32(_mm_loadu_si128((const __m128i*)(prev + x * 4)), run));
+            }
+#else
+            uint32_t run[4] = {};
+            for (int x = 0; x < m_SrcWidth; x++)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    run[c] += lin[x * 4 + c];
+                    cur[x * 4 + c] = prev[x * 4 + c] + run[c];
+                }
+            }
+#endif
+            continue;
+        }
+
+#ifdef BLITCORE_SSE2
+        // Running row sum of all four channels in one register, added onto the row above
+        const __m128i zero = _mm_setzero_si128();
+        __m128i run = zero;
+        for (int x = 0; x < m_SrcWidth; x++)
+        {
+            int bits;
+            memcpy(&bits, s + x * 4, 4);
+            __m128i px = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero), zero);
+            run = _mm_add_epi32(run, px);
+            _mm_storeu_si128((__m128i*)(cur + x * 4),
+                             _mm_add_epi32(_mm_loadu_si128((const __m128i*)(prev + x * 4)), run));
+        }
+#else
+        uint32_t run[4] = {};
+        for (int x = 0; x < m_SrcWidth; x++)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                run[c] += s[x * 4 + c];
+                cur[x * 4 + c] = prev[x * 4 + c] + run[c];
+            }
+        }
+#endif
+    }
+}
+
+#ifdef BLITCORE_SSE2
+// Low 32 bits of each lane times a scalar (SSE2 has no pmulld)
+static inline __m128i MulLo(__m128i v, __m128i w)
+{
+    __m128i even = _mm_mul_epu32(v, w);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(v, 32), w);
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+#endif
+
+void BoxScaler::Scale(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch)
+{
+    if (m_SrcWidth <= 0)
+        return;
+
+    BuildTable(src, srcPitch);
+
+    size_t stride = (size_t)(m_SrcWidth + 1) * 4;
+    int spanCount = (m_SrcWidth + 1) * 4;
+    uint32_t half = m_Divisor / 2;
+
+    for (int oy = 0; oy < m_DstHeight; oy++)
+    {
+        // Vertical extent of this output row, scaled by unitY, for every table column:
+        // span = (uY - rb) * T[qb] + rb * T[qb + 1] - (uY - ra) * T[qa] - ra * T[qa + 1]
+        const Edge& top = m_EdgesY[oy];
+        const Edge& bottom = m_EdgesY[oy + 1];
+        const uint32_t* ta = &m_Table[(size_t)top.q * stride];
+        const uint32_t* tb = &m_Table[(size_t)bottom.q * stride];
+        uint32_t wa = m_UnitY - top.r;
+        uint32_t wb = m_UnitY - bottom.r;
+        uint32_t* span = m_Span.data();
+
+        if (m_UnitY == 1)
+        {
+            // Row edges on whole pixels (e.g. equal heights): plain difference
+            for (int i = 0; i < spanCount; i++)
+                span[i] = tb[i] - ta[i];
+        }
+        else
+        {
+            for (int i = 0; i < spanCount; i++)
+                span[i] = wb * tb[i] - wa * ta[i];
+            if (top.r)
+                for (int i = 0; i < spanCount; i++)
+                    span[i] -= top.r * ta[stride + i];
+            if (bottom.r)
+                for (int i = 0; i < spanCount; i++)
+                    span[i] += bottom.r * tb[stride + i];
+        }
+
+        uint8_t* out = dst + (intptr_t)oy * dstPitch;
+        for (int ox = 0; ox < m_DstWidth; ox++)
+        {
+            const Edge& left = m_EdgesX[ox];
+            const Edge& right = m_EdgesX[ox + 1];
+            const uint32_t* sa = span + left.q * 4;
+            const uint32_t* sb = span + right.q * 4;
+
+            uint32_t sum[4];
+#ifdef BLITCORE_SSE2
+            __m128i va = _mm_loadu_si128((const __m128i*)sa);
+            __m128i vb = _mm_loadu_si128((const __m128i*)sb);
+            __m128i acc = _mm_sub_epi32(MulLo(vb, _mm_set1_epi32((int)(m_UnitX - right.r))),
+                                        MulLo(va, _mm_set1_epi32((int)(m_UnitX - left.r))));
+            if (left.r)
+                acc = _mm_sub_epi32(acc, MulLo(_mm_loadu_si128((const __m128i*)(sa + 4)), _mm_set1_epi32((int)left.r)));
+            if (right.r)
+                acc = _mm_add_epi32(acc, MulLo(_mm_loadu_si128((const __m128i*)(sb + 4)), _mm_set1_epi32((int)right.r)));
+            _mm_storeu_si128((__m128i*)sum, acc);
+#else
+            for (int c = 0; c < 4; c++)
+            {
+                sum[c] = (m_UnitX - right.r) * sb[c] - (m_UnitX - left.r) * sa[c];
+                if (left.r)
+                    sum[c] -= left.r * sa[4 + c];
+                if (right.r)
+                    sum[c] += right.r * sb[4 + c];
+            }
+#endif
+
+            // sum = average * divisor exactly; round to nearest with a 0.32 fixed-point reciprocal
+            // (never above 1/divisor, so the estimate is low by at most one)
+            for (int c = 0; c < 4; c++)
+            {
+                uint32_t t = sum[c] + half;
+                uint32_t q = (uint32_t)(((uint64_t)t * m_Reciprocal) >> 32);
+                if (t - q * m_Divisor >= m_Divisor)
+                    q++;
+                if (m_LinearLight)
+                    m_Linear[ox * 4 + c] = (uint16_t)(q > LINEAR_LIGHT_MAX ? LINEAR_LIGHT_MAX : q);
+                else
+                    out[ox * 4 + c] = (uint8_t)(q > 255 ? 255 : q);
+            }
+        }
+
+        if (m_LinearLight)
+            LinearRowToSrgb(m_Linear.data(), out, m_DstWidth);
+    }
+}
@@ -0,0 +1,61 @@
+// Exact area-average (box) scaler for BGRA8 images (platform independent)
+// Builds a summed-area table of the source in one SSE2 pass, then evaluates every output pixel's
+// box (any non-integer ratio, fractional edge coverage included) in O(1) from the table.
+// All arithmetic is modulo 2^32: the table may wrap, the final box sums still come out exact.
+// In linear-light mode rows are converted to 15-bit linear on the way into the table and the
+// averages converted back to sRGB (see linear_light.h).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+class BoxScaler
+{
+public:
+    // Precomputes the box edges for this ratio; cheap when the sizes are unchanged.
+    // Returns false if the ratio is unsupported: the reduced source box area
+    // (srcWidth/g * srcHeight/h, g and h the gcds with the output size) must stay below 2^24,
+    // or 2^17 in linear light.
+    bool Configure(int srcWidth, int srcHeight, int dstWidth, int dstHeight, bool linearLight = false);
+
+    // Allocates for every Configure up to these sizes at once, so reconfiguring per tile never
+    // allocates (the buffers only ever grow; smaller sizes reuse them)
+    void Reserve(int maxSrcWidth, int maxSrcHeight, int maxDstWidth, int maxDstHeight);
+
+    // Scales src into dst (BGRA8, pitches in bytes). Every channel, alpha included, is
+    // averaged over the output pixel's footprint and rounded to nearest.
+    void Scale(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch);
+
+    int SrcWidth() const { return m_SrcWidth; }
+    int SrcHeight() const { return m_SrcHeight; }
+    int DstWidth() const { return m_DstWidth; }
+    int DstHeight() const { return m_DstHeight; }
+
+private:
+    // One box edge: source position q + r / unit (unit = reduced output size)
+    struct Edge
+    {
+        int q;
+        uint32_t r;
+    };
+
+    void BuildTable(const uint8_t* src, int srcPitch);
+
+    int m_SrcWidth = 0;
+    int m_SrcHeight = 0;
+    int m_DstWidth = 0;
+    int m_DstHeight = 0;
+    uint32_t m_UnitX = 1;           // Reduced output width: edges fall on 1/m_UnitX source pixels
+    uint32_t m_UnitY = 1;
+    uint32_t m_Divisor = 1;         // Reduced source box area; scaled box sums are average * divisor
+    uint32_t m_Reciprocal = 0;      // floor((2^32 - 1) / divisor)
+    bool m_LinearLight = false;
+    std::vector<Edge> m_EdgesX;     // dstWidth + 1 edges
+    std::vector<Edge> m_EdgesY;     // dstHeight + 1 edges
+    std::vector<uint32_t> m_Table;  // (srcHeight + 1) x (srcWidth + 1) x 4 channels, zero top row/column
+                                    // (stride follows srcWidth; may be larger than that from an earlier size)
+    std::vector<uint32_t> m_Span;   // Table rows at the box's bottom edge minus its top edge
+    std::vector<uint16_t> m_Linear; // Linear-light mode: one source row in, one output row out
+};
@@ -0,0 +1,107 @@
+// Cache size detection - see cache_info.h
+
+#include "cache_info.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+#include <vector>
+#else
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+static CacheInfo DetectCaches()
+{
+    CacheInfo info;
+
+#ifdef _WIN32
+    DWORD bytes = 0;
+    GetLogicalProcessorInformation(nullptr, &bytes);
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> entries(bytes / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (!entries.empty() && GetLogicalProcessorInformation(entries.data(), &bytes))
+    {
+        for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& entry : entries)
+        {
+            if (entry.Relationship != RelationCache)
+                continue;
+
+            const CACHE_DESCRIPTOR& cache = entry.Cache;
+            if (cache.Level == 1 && cache.Type != CacheInstruction && !info.l1Data)
+                info.l1Data = cache.Size;
+            else if (cache.Level == 2 && !info.l2)
+                info.l2 = cache.Size;
+            else if (cache.Level == 3 && !info.l3)
+                info.l3 = cache.Size;
+        }
+    }
+#else
+    // sysfs first (works on any libc and on ARM), then glibc's sysconf names
+    for (int index = 0; index < 8; index++)
+    {
+        char path[96];
+        int level = 0;
+        char type[32] = {};
+        unsigned long size = 0;
+        char unit = 0;
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+        FILE* f = fopen(path, "r");
+        if (!f)
+            break;
+        bool ok = fscanf(f, "%d", &level) == 1;
+        fclose(f);
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", index);
+        if ((f = fopen(path, "r")) != nullptr)
+        {
+            ok = ok && fscanf(f, "%31s", type) == 1;
+            fclose(f);
+        }
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+        if ((f = fopen(path, "r")) != nullptr)
+        {
+            ok = ok && fscanf(f, "%lu%c", &size, &unit) >= 1;
+            fclose(f);
+        }
+        if (!ok)
+            continue;
+
+        size_t sizeBytes = size * (unit == 'K' ? 1024 : unit == 'M' ? 1024 * 1024 : 1);
+        bool instruction = type[0] == 'I';
+        if (level == 1 && !instruction && !info.l1Data)
+            info.l1Data = sizeBytes;
+        else if (level == 2 && !info.l2)
+            info.l2 = sizeBytes;
+        else if (level == 3 && !info.l3)
+            info.l3 = sizeBytes;
+    }
+
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+    long value;
+    if (!info.l1Data && (value = sysconf(_SC_LEVEL1_DCACHE_SIZE)) > 0)
+        info.l1Data = (size_t)value;
+    if (!info.l2 && (value = sysconf(_SC_LEVEL2_CACHE_SIZE)) > 0)
+        info.l2 = (size_t)value;
+    if (!info.l3 && (value = sysconf(_SC_LEVEL3_CACHE_SIZE)) > 0)
+        info.l3 = (size_t)value;
+#endif
+#endif
+
+    return info;
+}
+
+const CacheInfo& GetCacheInfo()
+{
+    static const CacheInfo info = DetectCaches();
+    return info;
+}
+
+size_t PlanningL2Size()
+{
+    size_t l2 = GetCacheInfo().l2;
+    return l2 ? l2 : 256 * 1024;
+}
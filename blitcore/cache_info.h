@@ -0,0 +1,20 @@
+// Data cache sizes of the CPU we run on (platform independent interface)
+// Used to size working sets: strips that stay in L2 between stages, and the point past
+// which output buffers are written with streaming stores.
+
+#pragma once
+
+#include <stddef.h>
+
+struct CacheInfo
+{
+    size_t l1Data = 0;      // Bytes per core; 0 when the OS does not report it
+    size_t l2 = 0;
+    size_t l3 = 0;          // Shared last level
+};
+
+// Detected once on first use
+const CacheInfo& GetCacheInfo();
+
+// L2 size to plan with: the detected value, else a conservative 256 KB
+size_t PlanningL2Size();
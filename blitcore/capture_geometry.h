@@ -0,0 +1,43 @@
+// Capture and output geometry shared by every front-end (platform independent)
+// The constants are the default layout: the first monitor (1920x1080 at the origin) is captured,
+// scaled to 1440x1080 on the left of a 1920x1080 output, and the remaining 480 columns are black
+// padding. The layout actually used is planned from the display topology (display_topology.h).
+
+#pragma once
+
+constexpr int SOURCE_WIDTH = 1920;   // Full first monitor width to capture
+constexpr int SOURCE_HEIGHT = 1080;  // Full first monitor height to capture
+constexpr int RENDER_WIDTH = 1440;   // Scaled-down width for display
+constexpr int RENDER_HEIGHT = 1080;  // Height stays the same
+constexpr int OUTPUT_WIDTH = 1920;
+constexpr int OUTPUT_HEIGHT = 1080;
+
+// First monitor at origin (both capture source and output destination)
+constexpr int FIRST_MONITOR_X = 0;
+constexpr int FIRST_MONITOR_Y = 0;
+
+constexpr int DEFAULT_FPS = 60;      // Fallback when the display refresh rate cannot be queried
+
+// Desktop rect that is captured and how it lands on the output (desktop pixels). The source is
+// scaled to renderWidth x renderHeight at the output's top left; the rest is padding.
+struct MirrorGeometry
+{
+    int sourceX = FIRST_MONITOR_X;
+    int sourceY = FIRST_MONITOR_Y;
+    int sourceWidth = SOURCE_WIDTH;
+    int sourceHeight = SOURCE_HEIGHT;
+    int renderWidth = RENDER_WIDTH;
+    int renderHeight = RENDER_HEIGHT;
+    int outputWidth = OUTPUT_WIDTH;
+    int outputHeight = OUTPUT_HEIGHT;
+
+    bool IsValid() const
+    {
+        return sourceWidth > 0 && sourceHeight > 0 && renderWidth > 0 && renderHeight > 0 &&
+               renderWidth <= outputWidth && renderHeight <= outputHeight;
+    }
+
+    // Source-relative pixel -> render pixel (truncates toward zero, the cursor placement every front-end uses)
+    int ToRenderX(int x) const { return (int)((long long)x * renderWidth / sourceWidth); }
+    int ToRenderY(int y) const { return (int)((long long)y * renderHeight / sourceHeight); }
+};
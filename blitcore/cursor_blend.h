@@ -0,0 +1,60 @@
+// Cursor sprite compositing over any image view (platform independent, header only)
+// dest = pixels + dest * (255 - alpha) / 255, then dest ^= invert, evaluated in BGRA8 for every
+// format (see image_view.h); for BGRA8/BGRX8 the conversions are no-ops and compile away.
+// Shared by the DXGI cursor pass and the CPU frame composer, so both blend identically.
+
+#pragma once
+
+#include "cursor_shape.h"
+#include "image_view.h"
+#include "linear_light.h"
+
+// One premultiplied sprite pixel over an opaque destination pixel (both BGRA8)
+inline uint32_t BlendCursorPixel(uint32_t src, uint32_t inv, uint32_t dest, bool linearLight)
+{
+    uint32_t srcA = src >> 24;
+    if (srcA != 255 && linearLight)
+    {
+        src = BlendPremultipliedLinear(src, dest);
+    }
+    else if (srcA != 255)
+    {
+        uint32_t k = 255 - srcA;
+        uint32_t b = (src & 0xFF) + (((dest & 0xFF) * k + 128) * 257 >> 16);
+        uint32_t g = ((src >> 8) & 0xFF) + ((((dest >> 8) & 0xFF) * k + 128) * 257 >> 16);
+        uint32_t r = ((src >> 16) & 0xFF) + ((((dest >> 16) & 0xFF) * k + 128) * 257 >> 16);
+        src = 0xFF000000 | (r << 16) | (g << 8) | b;
+    }
+
+    // Inverted pixels (monochrome AND=1/XOR=1, masked color) XOR the screen
+    return src ^ inv;
+}
+
+// Sprite with its top-left at (x, y) in view coordinates, clipped to the view
+template <typename Format>
+void BlendCursor(const ImageView<Format>& view, const CursorSprite& cursor, int x, int y, bool linearLight)
+{
+    int begin = x < 0 ? -x : 0;
+    int end = x + cursor.width < view.Width() ? cursor.width : view.Width() - x;
+    int top = y < 0 ? -y : 0;
+    int bottom = y + cursor.height < view.Height() ? cursor.height : view.Height() - y;
+
+    for (int sy = top; sy < bottom; sy++)
+    {
+        const uint32_t* pixels = &cursor.pixels[(size_t)sy * cursor.width];
+        const uint32_t* invert = &cursor.invert[(size_t)sy * cursor.width];
+        typename Format::Pixel* row = view.Row(y + sy) + x;
+
+        for (int sx = begin; sx < end; sx++)
+        {
+            uint32_t src = pixels[sx];
+            uint32_t inv = invert[sx];
+            if (src == 0 && inv == 0)
+                continue;
+
+            // Opaque pixels replace the destination without reading it
+            uint32_t dest = (src >> 24) != 255 ? Format::ToBgra8(row[sx]) : 0;
+            row[sx] = Format::FromBgra8(BlendCursorPixel(src, inv, dest, linearLight));
+        }
+    }
+}
@@ -0,0 +1,230 @@
+// Cursor shape decoding - see cursor_shape.h
+
+#include "cursor_shape.h"
+#include "image_view.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLITCORE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Expands one mask byte into 8 pixel-wide lane masks (MSB = leftmost pixel)
+struct BitExpandTable
+{
+    uint32_t lanes[256][8];
+
+    BitExpandTable()
+    {
+        for (int b = 0; b < 256; b++)
+        {
+            for (int i = 0; i < 8; i++)
+            {
+                lanes[b][i] = ((b >> (7 - i)) & 1) ? 0xFFFFFFFFu : 0u;
+            }
+        }
+    }
+};
+
+static const BitExpandTable& GetBitExpandTable()
+{
+    static const BitExpandTable table;
+    return table;
+}
+
+// Monochrome truth table (AND, XOR):
+//   0,0 -> opaque black    0,1 -> opaque white
+//   1,0 -> transparent     1,1 -> invert destination
+static inline void DecodeMonochromeGroup(uint8_t andBits, uint8_t xorBits, int count,
+                                         uint32_t* dst, uint32_t* inv, uint32_t& anyInvert)
+{
+    const BitExpandTable& table = GetBitExpandTable();
+    const uint32_t* andLanes = table.lanes[andBits];
+    const uint32_t* xorLanes = table.lanes[xorBits];
+
+    for (int i = 0; i < count; i++)
+    {
+        uint32_t a = andLanes[i];
+        uint32_t x = xorLanes[i];
+        dst[i] = ~a & (0xFF000000u | (x & 0x00FFFFFFu));
+        inv[i] = a & x & 0x00FFFFFFu;
+        anyInvert |= inv[i];
+    }
+}
+
+static void DecodeMonochrome(int width, int height, int pitch, const uint8_t* shapeBuffer,
+                             CursorSprite* sprite)
+{
+    const int fullGroups = width / 8;
+    const int tail = width % 8;
+    uint32_t anyInvert = 0;
+
+#ifdef BLITCORE_SSE2
+    const __m128i bitsLo = _mm_setr_epi32(0x80, 0x40, 0x20, 0x10);
+    const __m128i bitsHi = _mm_setr_epi32(0x08, 0x04, 0x02, 0x01);
+    const __m128i alphaOnly = _mm_set1_epi32((int)0xFF000000u);
+    const __m128i colorOnly = _mm_set1_epi32(0x00FFFFFF);
+    __m128i invAccum = _mm_setzero_si128();
+#endif
+
+    for (int y = 0; y < height; y++)
+    {
+        const uint8_t* andRow = shapeBuffer + y * pitch;
+        const uint8_t* xorRow = shapeBuffer + (y + height) * pitch;
+        uint32_t* dst = sprite->pixels.data() + y * width;
+        uint32_t* inv = sprite->invert.data() + y * width;
+
+        int g = 0;
+#ifdef BLITCORE_SSE2
+        for (; g < fullGroups; g++)
+        {
+            __m128i a = _mm_set1_epi32(andRow[g]);
+            __m128i x = _mm_set1_epi32(xorRow[g]);
+
+            __m128i a0 = _mm_cmpeq_epi32(_mm_and_si128(a, bitsLo), bitsLo);
+            __m128i a1 = _mm_cmpeq_epi32(_mm_and_si128(a, bitsHi), bitsHi);
+            __m128i x0 = _mm_cmpeq_epi32(_mm_and_si128(x, bitsLo), bitsLo);
+            __m128i x1 = _mm_cmpeq_epi32(_mm_and_si128(x, bitsHi), bitsHi);
+
+            __m128i p0 = _mm_andnot_si128(a0, _mm_or_si128(alphaOnly, _mm_and_si128(x0, colorOnly)));
+            __m128i p1 = _mm_andnot_si128(a1, _mm_or_si128(alphaOnly, _mm_and_si128(x1, colorOnly)));
+            __m128i i0 = _mm_and_si128(_mm_and_si128(a0, x0), colorOnly);
+            __m128i i1 = _mm_and_si128(_mm_and_si128(a1, x1), colorOnly);
+
+            _mm_storeu_si128((__m128i*)(dst + g * 8), p0);
+            _mm_storeu_si128((__m128i*)(dst + g * 8 + 4), p1);
+            _mm_storeu_si128((__m128i*)(inv + g * 8), i0);
+            _mm_storeu_si128((__m128i*)(inv + g * 8 + 4), i1);
+            invAccum = _mm_or_si128(invAccum, _mm_or_si128(i0, i1));
+        }
+#endif
+        for (; g < fullGroups; g++)
+        {
+            DecodeMonochromeGroup(andRow[g], xorRow[g], 8, dst + g * 8, inv + g * 8, anyInvert);
+        }
+
+        if (tail)
+        {
+            DecodeMonochromeGroup(andRow[fullGroups], xorRow[fullGroups], tail,
+                                  dst + fullGroups * 8, inv + fullGroups * 8, anyInvert);
+        }
+    }
+
+#ifdef BLITCORE_SSE2
+    anyInvert |= (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(invAccum, _mm_setzero_si128())) ^ 0xFFFF;
+#endif
+    sprite->hasInvert = anyInvert != 0;
+}
+
+// 32-bit BGRA with straight alpha -> premultiplied
+static void DecodeColor(const ImageView<const FormatBGRA8>& shape, CursorSprite* sprite)
+{
+    ImageView<FormatBGRA8> pixels(sprite->pixels.data(), shape.Width(), shape.Height(), shape.Width() * 4);
+    for (int y = 0; y < shape.Height(); y++)
+    {
+        const uint32_t* src = shape.Row(y);
+        uint32_t* dst = pixels.Row(y);
+
+        for (int x = 0; x < shape.Width(); x++)
+        {
+            uint32_t a = src[x] >> 24;
+            uint32_t b = ((src[x] & 0xFF) * a + 128) * 257 >> 16;
+            uint32_t g = (((src[x] >> 8) & 0xFF) * a + 128) * 257 >> 16;
+            uint32_t r = (((src[x] >> 16) & 0xFF) * a + 128) * 257 >> 16;
+            dst[x] = (a << 24) | (r << 16) | (g << 8) | b;
+        }
+    }
+
+    sprite->invert.assign(sprite->invert.size(), 0);
+    sprite->hasInvert = false;
+}
+
+// Masked color: mask byte 0 -> opaque RGB, mask byte 0xFF -> XOR RGB with destination
+static void DecodeMaskedColor(const ImageView<const FormatBGRA8>& shape, CursorSprite* sprite)
+{
+    int width = shape.Width();
+    ImageView<FormatBGRA8> pixels(sprite->pixels.data(), width, shape.Height(), width * 4);
+    ImageView<FormatBGRA8> invert(sprite->invert.data(), width, shape.Height(), width * 4);
+
+    uint32_t anyInvert = 0;
+
+#ifdef BLITCORE_SSE2
+    const __m128i alphaOnly = _mm_set1_epi32((int)0xFF000000u);
+    const __m128i colorOnly = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i invAccum = zero;
+#endif
+
+    for (int y = 0; y < shape.Height(); y++)
+    {
+        const uint32_t* src = shape.Row(y);
+        uint32_t* dst = pixels.Row(y);
+        uint32_t* inv = invert.Row(y);
+
+        int x = 0;
+#ifdef BLITCORE_SSE2
+        for (; x + 4 <= width; x += 4)
+        {
+            __m128i p = _mm_loadu_si128((const __m128i*)(src + x));
+            __m128i opaque = _mm_cmpeq_epi32(_mm_and_si128(p, alphaOnly), zero);
+            __m128i rgb = _mm_and_si128(p, colorOnly);
+            __m128i i = _mm_andnot_si128(opaque, rgb);
+            _mm_storeu_si128((__m128i*)(dst + x), _mm_and_si128(opaque, _mm_or_si128(rgb, alphaOnly)));
+            _mm_storeu_si128((__m128i*)(inv + x), i);
+            invAccum = _mm_or_si128(invAccum, i);
+        }
+#endif
+        for (; x < width; x++)
+        {
+            uint32_t rgb = src[x] & 0x00FFFFFFu;
+            bool opaque = (src[x] >> 24) == 0;
+            dst[x] = opaque ? (rgb | 0xFF000000u) : 0u;
+            inv[x] = opaque ? 0u : rgb;
+            anyInvert |= inv[x];
+        }
+    }
+
+#ifdef BLITCORE_SSE2
+    anyInvert |= (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(invAccum, zero)) ^ 0xFFFF;
+#endif
+    sprite->hasInvert = anyInvert != 0;
+}
+
+void ReserveCursorSprite(CursorSprite* sprite, int maxWidth, int maxHeight)
+{
+    sprite->pixels.reserve((size_t)maxWidth * maxHeight);
+    sprite->invert.reserve((size_t)maxWidth * maxHeight);
+}
+
+bool DecodeCursorShape(CursorShapeType type, int width, int height, int pitch,
+                       const uint8_t* shapeBuffer, CursorSprite* sprite)
+{
+    if (!shapeBuffer || width <= 0 || height <= 0)
+        return false;
+
+    // Monochrome height covers the AND mask followed by the XOR mask
+    int spriteHeight = (type == CURSOR_SHAPE_MONOCHROME) ? height / 2 : height;
+    if (spriteHeight <= 0)
+        return false;
+
+    sprite->width = width;
+    sprite->height = spriteHeight;
+    sprite->pixels.resize((size_t)width * spriteHeight);
+    sprite->invert.resize((size_t)width * spriteHeight);
+
+    switch (type)
+    {
+    case CURSOR_SHAPE_MONOCHROME:
+        DecodeMonochrome(width, spriteHeight, pitch, shapeBuffer, sprite);
+        return true;
+    case CURSOR_SHAPE_COLOR:
+        DecodeColor(ImageView<const FormatBGRA8>(shapeBuffer, width, spriteHeight, pitch), sprite);
+        return true;
+    case CURSOR_SHAPE_MASKED_COLOR:
+        DecodeMaskedColor(ImageView<const FormatBGRA8>(shapeBuffer, width, spriteHeight, pitch), sprite);
+        return true;
+    }
+
+    sprite->width = 0;
+    sprite->height = 0;
+    return false;
+}
@@ -0,0 +1,45 @@
+// Cursor shape decoding (platform independent)
+// Converts DXGI pointer shape buffers into a premultiplied BGRA sprite plus a per-pixel XOR mask
+// Monochrome and masked-color shapes are expanded 8 mask bits at a time (lookup table / SSE2)
+// Invert pixels (monochrome AND=1 XOR=1, masked-color mask set) are a true XOR of the destination,
+// as Windows draws them. The per-pixel decoder this replaced drew them as semi-transparent
+// white (monochrome) or the shape colour at alpha 128 (masked color); every other pixel is
+// unchanged apart from being premultiplied. tests/test_cursor_shape.cpp checks both.
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+// Matches DXGI_OUTDUPL_POINTER_SHAPE_TYPE values so the DXGI front-end can pass Type straight through
+enum CursorShapeType
+{
+    CURSOR_SHAPE_MONOCHROME = 1,
+    CURSOR_SHAPE_COLOR = 2,
+    CURSOR_SHAPE_MASKED_COLOR = 4
+};
+
+// Decoded cursor, ready to composite:
+//   dest = pixels + dest * (255 - alpha) / 255, then dest ^= invert
+struct CursorSprite
+{
+    int width = 0;
+    int height = 0;
+    int hotspotX = 0;
+    int hotspotY = 0;
+    std::vector<uint32_t> pixels;   // Premultiplied BGRA, width * height
+    std::vector<uint32_t> invert;   // XOR applied to destination BGR, width * height
+    bool hasInvert = false;         // False when every invert entry is zero (skip the XOR pass)
+};
+
+// Largest pointer shape Windows hands out (cursor size slider at maximum)
+constexpr int CURSOR_MAX_SIZE = 256;
+
+// Sizes the sprite's buffers once so shape changes up to maxWidth x maxHeight never reallocate
+void ReserveCursorSprite(CursorSprite* sprite, int maxWidth = CURSOR_MAX_SIZE, int maxHeight = CURSOR_MAX_SIZE);
+
+// Decode a pointer shape buffer into sprite (storage is reused across calls).
+// height is the height reported by the shape info (for monochrome it covers both AND and XOR masks).
+// Returns false for an unknown type or empty shape.
+bool DecodeCursorShape(CursorShapeType type, int width, int height, int pitch,
+                       const uint8_t* shapeBuffer, CursorSprite* sprite);
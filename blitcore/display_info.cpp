@@ -0,0 +1,140 @@
+// Process DPI awareness and display topology queries - see display_info.h
+
+#include "display_info.h"
+#include "capture_geometry.h"
+
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+#include <string.h>
+
+// Function pointer types for DPI functions (not in older MinGW headers)
+typedef BOOL (WINAPI *PFN_SetProcessDPIAware)(void);
+typedef HRESULT (WINAPI *PFN_SetProcessDpiAwareness)(int);
+typedef BOOL (WINAPI *PFN_SetProcessDpiAwarenessContext)(HANDLE);
+
+#ifndef DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2
+#define DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2 ((HANDLE)-4)
+#endif
+#define PROCESS_PER_MONITOR_DPI_AWARE 2
+
+void EnableDPIAwareness()
+{
+    // Try SetProcessDpiAwarenessContext first (Windows 10 1703+)
+    HMODULE hUser32 = GetModuleHandleA("user32.dll");
+    if (hUser32)
+    {
+        auto pSetProcessDpiAwarenessContext = (PFN_SetProcessDpiAwarenessContext)
+            GetProcAddress(hUser32, "SetProcessDpiAwarenessContext");
+        if (pSetProcessDpiAwarenessContext)
+        {
+            if (pSetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2))
+                return;
+        }
+    }
+    
+    // Try SetProcessDpiAwareness (Windows 8.1+)
+    HMODULE hShcore = LoadLibraryA("shcore.dll");
+    if (hShcore)
+    {
+        auto pSetProcessDpiAwareness = (PFN_SetProcessDpiAwareness)
+            GetProcAddress(hShcore, "SetProcessDpiAwareness");
+        if (pSetProcessDpiAwareness)
+        {
+            if (SUCCEEDED(pSetProcessDpiAwareness(PROCESS_PER_MONITOR_DPI_AWARE)))
+            {
+                FreeLibrary(hShcore);
+                return;
+            }
+        }
+        FreeLibrary(hShcore);
+    }
+    
+    // Fall back to SetProcessDPIAware (Windows Vista+)
+    if (hUser32)
+    {
+        auto pSetProcessDPIAware = (PFN_SetProcessDPIAware)
+            GetProcAddress(hUser32, "SetProcessDPIAware");
+        if (pSetProcessDPIAware)
+        {
+            pSetProcessDPIAware();
+        }
+    }
+}
+
+// GetDpiForMonitor (Windows 8.1+, shcore.dll); MDT_EFFECTIVE_DPI is 0
+typedef HRESULT (WINAPI *PFN_GetDpiForMonitor)(HMONITOR, int, UINT*, UINT*);
+
+struct MonitorEnumContext
+{
+    DisplayTopology topology;
+    PFN_GetDpiForMonitor getDpiForMonitor;
+};
+
+static BOOL CALLBACK AddMonitor(HMONITOR hMonitor, HDC, LPRECT, LPARAM data)
+{
+    MonitorEnumContext* context = (MonitorEnumContext*)data;
+
+    MONITORINFOEXA mi = {};
+    mi.cbSize = sizeof(MONITORINFOEXA);
+    if (!GetMonitorInfoA(hMonitor, (MONITORINFO*)&mi))
+        return TRUE;
+
+    DisplayMonitor monitor;
+    monitor.x = mi.rcMonitor.left;
+    monitor.y = mi.rcMonitor.top;
+    monitor.width = mi.rcMonitor.right - mi.rcMonitor.left;
+    monitor.height = mi.rcMonitor.bottom - mi.rcMonitor.top;
+    monitor.primary = (mi.dwFlags & MONITORINFOF_PRIMARY) != 0;
+    strncpy(monitor.name, mi.szDevice, sizeof(monitor.name) - 1);
+
+    DEVMODEA dm = {};
+    dm.dmSize = sizeof(DEVMODEA);
+    if (EnumDisplaySettingsA(mi.szDevice, ENUM_CURRENT_SETTINGS, &dm) && dm.dmDisplayFrequency > 1)
+        monitor.rate = FrameRateFromHz(dm.dmDisplayFrequency);
+    else
+        monitor.rate = FrameRateFromHz(DEFAULT_FPS);
+
+    UINT dpiX = 0;
+    UINT dpiY = 0;
+    if (context->getDpiForMonitor && SUCCEEDED(context->getDpiForMonitor(hMonitor, 0, &dpiX, &dpiY)) && dpiX)
+        monitor.dpi = (int)dpiX;
+
+    context->topology.monitors.push_back(monitor);
+    return TRUE;
+}
+
+bool QueryDisplayTopology(DisplayTopology* topology)
+{
+    MonitorEnumContext context;
+    context.getDpiForMonitor = nullptr;
+    HMODULE hShcore = LoadLibraryA("shcore.dll");
+    if (hShcore)
+        context.getDpiForMonitor = (PFN_GetDpiForMonitor)GetProcAddress(hShcore, "GetDpiForMonitor");
+
+    EnumDisplayMonitors(NULL, NULL, AddMonitor, (LPARAM)&context);
+    if (hShcore)
+        FreeLibrary(hShcore);
+
+    if (context.topology.monitors.empty())
+        return false;
+    *topology = context.topology;
+    return true;
+}
+
+#else
+
+void EnableDPIAwareness()
+{
+}
+
+bool QueryDisplayTopology(DisplayTopology* topology)
+{
+    *topology = DefaultDisplayTopology();
+    return true;
+}
+
+#endif
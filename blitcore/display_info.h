@@ -0,0 +1,15 @@
+// Process DPI awareness and display topology queries (platform independent interface)
+// Windows: per-monitor-v2 awareness with fallbacks for older systems, and every monitor's rect,
+// current refresh rate and effective DPI. Elsewhere the process is left as is and the topology is
+// DefaultDisplayTopology() (Linux builds are for profiling the core, not presenting).
+
+#pragma once
+
+#include "display_topology.h"
+
+// Must run before any window or GDI call
+void EnableDPIAwareness();
+
+// Every monitor in desktop order; false (topology untouched) if none could be enumerated.
+// Call again after WM_DISPLAYCHANGE / WM_DPICHANGED.
+bool QueryDisplayTopology(DisplayTopology* topology);
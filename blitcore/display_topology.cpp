@@ -0,0 +1,131 @@
+// Monitor layout and capture planning - see display_topology.h
+
+#include "display_topology.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int DisplayTopology::IndexAt(int x, int y) const
+{
+    for (size_t i = 0; i < monitors.size(); i++)
+        if (monitors[i].Contains(x, y))
+            return (int)i;
+    return -1;
+}
+
+int DisplayTopology::PrimaryIndex() const
+{
+    for (size_t i = 0; i < monitors.size(); i++)
+        if (monitors[i].primary)
+            return (int)i;
+    return monitors.empty() ? -1 : 0;
+}
+
+DisplayTopology DefaultDisplayTopology()
+{
+    DisplayMonitor monitor;
+    monitor.x = FIRST_MONITOR_X;
+    monitor.y = FIRST_MONITOR_Y;
+    monitor.width = SOURCE_WIDTH;
+    monitor.height = SOURCE_HEIGHT;
+    monitor.rate = FrameRateFromHz(DEFAULT_FPS);
+    monitor.primary = true;
+    strcpy(monitor.name, "default");
+
+    DisplayTopology topology;
+    topology.monitors.push_back(monitor);
+    return topology;
+}
+
+// "--<name>=<n>" with n >= 1, stored 0-based
+static void ParseMonitorOption(const char* cmdLine, const char* name, int* index)
+{
+    size_t nameLen = strlen(name);
+    for (const char* p = strstr(cmdLine, "--"); p; p = strstr(p + 2, "--"))
+    {
+        if (strncmp(p + 2, name, nameLen) != 0 || p[2 + nameLen] != '=')
+            continue;
+
+        char* end = nullptr;
+        long n = strtol(p + 3 + nameLen, &end, 10);
+        if (end != p + 3 + nameLen && n >= 1 && n <= 64)
+            *index = (int)n - 1;
+        return;
+    }
+}
+
+void ParseCapturePlanOptions(const char* cmdLine, CapturePlanOptions* options)
+{
+    if (!cmdLine)
+        return;
+    ParseMonitorOption(cmdLine, "source-monitor", &options->sourceMonitor);
+    ParseMonitorOption(cmdLine, "output-monitor", &options->outputMonitor);
+}
+
+bool CapturePlan::SameAs(const CapturePlan& other) const
+{
+    const MirrorGeometry& a = geometry;
+    const MirrorGeometry& b = other.geometry;
+    return a.sourceX == b.sourceX && a.sourceY == b.sourceY &&
+           a.sourceWidth == b.sourceWidth && a.sourceHeight == b.sourceHeight &&
+           a.renderWidth == b.renderWidth && a.renderHeight == b.renderHeight &&
+           a.outputWidth == b.outputWidth && a.outputHeight == b.outputHeight &&
+           outputX == other.outputX && outputY == other.outputY &&
+           sourceRate.num == other.sourceRate.num && sourceRate.den == other.sourceRate.den &&
+           outputRate.num == other.outputRate.num && outputRate.den == other.outputRate.den;
+}
+
+bool PlanCapture(const DisplayTopology& topology, const CapturePlanOptions& options, CapturePlan* plan)
+{
+    int count = (int)topology.monitors.size();
+    int source = options.sourceMonitor;
+    if (source < 0)
+    {
+        source = topology.IndexAt(0, 0);
+        if (source < 0)
+            source = topology.PrimaryIndex();
+    }
+    int output = options.outputMonitor < 0 ? source : options.outputMonitor;
+    if (source < 0 || source >= count || output >= count)
+        return false;
+
+    const DisplayMonitor& src = topology.monitors[source];
+    const DisplayMonitor& out = topology.monitors[output];
+
+    CapturePlan next;
+    next.sourceIndex = source;
+    next.outputIndex = output;
+
+    MirrorGeometry& g = next.geometry;
+    g.sourceX = src.x;
+    g.sourceY = src.y;
+    g.sourceWidth = src.width;
+    g.sourceHeight = src.height;
+    g.outputWidth = out.width;
+    g.outputHeight = out.height;
+    g.renderWidth = out.width;
+    g.renderHeight = out.height;
+    if (options.aspectNum > 0 && options.aspectDen > 0)
+    {
+        long long width = (long long)out.height * options.aspectNum / options.aspectDen;
+        if (width < g.renderWidth)
+            g.renderWidth = (int)width;
+    }
+    if (!g.IsValid())
+        return false;
+
+    next.outputX = out.x;
+    next.outputY = out.y;
+    next.sourceRate = src.rate.IsValid() ? src.rate : FrameRateFromHz(DEFAULT_FPS);
+    next.outputRate = out.rate.IsValid() ? out.rate : FrameRateFromHz(DEFAULT_FPS);
+    next.sourceDpi = src.dpi;
+    next.outputDpi = out.dpi;
+
+    next.renderU = (float)g.renderWidth / (float)g.outputWidth;
+    next.renderV = (float)g.renderHeight / (float)g.outputHeight;
+    next.scaleX = (float)g.renderWidth / (float)g.sourceWidth;
+    next.scaleY = (float)g.renderHeight / (float)g.sourceHeight;
+
+    *plan = next;
+    return true;
+}
@@ -0,0 +1,78 @@
+// Monitor layout and the capture plan derived from it (platform independent)
+// QueryDisplayTopology (display_info.h) lists the monitors at startup and after every display
+// change. PlanCapture turns the topology into a source rect, an output placement and the scale
+// parameters the shader, magnifier transform and cursor math use, so nothing assumes one 1920x1080
+// monitor at the origin. Planning is pure and can be driven with hand-built topologies.
+
+#pragma once
+
+#include <vector>
+
+#include "capture_geometry.h"
+#include "frame_rate.h"
+
+constexpr int DISPLAY_DEFAULT_DPI = 96;    // 100% scaling
+
+struct DisplayMonitor
+{
+    int x = 0;                  // Desktop rect, physical pixels
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    FrameRate rate;             // Current refresh rate
+    int dpi = DISPLAY_DEFAULT_DPI;
+    bool primary = false;
+    char name[32] = {};         // OS device name (e.g. \\.\DISPLAY1), for logs
+
+    bool Contains(int px, int py) const { return px >= x && px < x + width && py >= y && py < y + height; }
+};
+
+struct DisplayTopology
+{
+    std::vector<DisplayMonitor> monitors;   // Enumeration order
+
+    // Monitor containing the desktop point, -1 if none
+    int IndexAt(int x, int y) const;
+    // Primary monitor, else the first one; -1 when there are none
+    int PrimaryIndex() const;
+};
+
+// One monitor with the compile-time default geometry (capture_geometry.h)
+DisplayTopology DefaultDisplayTopology();
+
+struct CapturePlanOptions
+{
+    int sourceMonitor = -1;     // Topology index; -1 = the monitor at the desktop origin (else primary)
+    int outputMonitor = -1;     // -1 = same monitor as the source
+    int aspectNum = 4;          // Render area aspect at the output's full height, left aligned
+    int aspectDen = 3;          // (0 = fill the output); the rest of the output is padding
+};
+
+// Reads --source-monitor=<n> / --output-monitor=<n> (1-based, as Windows numbers displays).
+// Options that are absent or malformed are left untouched.
+void ParseCapturePlanOptions(const char* cmdLine, CapturePlanOptions* options);
+
+struct CapturePlan
+{
+    int sourceIndex = -1;
+    int outputIndex = -1;
+    MirrorGeometry geometry;
+    int outputX = FIRST_MONITOR_X;  // Output window's desktop position
+    int outputY = FIRST_MONITOR_Y;
+    FrameRate sourceRate;
+    FrameRate outputRate;
+    int sourceDpi = DISPLAY_DEFAULT_DPI;
+    int outputDpi = DISPLAY_DEFAULT_DPI;
+
+    // Precomputed once per geometry
+    float renderU = 0.75f;          // renderWidth / outputWidth: output texture coordinate of the padding edge
+    float renderV = 1.0f;
+    float scaleX = 0.75f;           // renderWidth / sourceWidth
+    float scaleY = 1.0f;
+
+    // Same rects and rates: nothing to rebuild after a display change
+    bool SameAs(const CapturePlan& other) const;
+};
+
+// Fails (plan untouched) when the topology is empty or an option names a missing monitor
+bool PlanCapture(const DisplayTopology& topology, const CapturePlanOptions& options, CapturePlan* plan);
@@ -0,0 +1,310 @@
+// Event-driven main loop wait - see event_loop.h
+
+#include "event_loop.h"
+
+#include <stdio.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+EventLoop::EventLoop(FrameClock* clock)
+    : m_Clock(clock ? clock : GetSystemFrameClock())
+{
+    // High-resolution timer (Windows 10 1803+) does not depend on timeBeginPeriod
+    m_Timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!m_Timer)
+        m_Timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    m_PostEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    m_Valid = m_Timer && m_PostEvent;
+    m_ReportStartNs = m_Clock->NowNs();
+}
+
+EventLoop::~EventLoop()
+{
+    if (m_Timer)
+        CloseHandle(m_Timer);
+    if (m_PostEvent)
+        CloseHandle(m_PostEvent);
+}
+
+int EventLoop::AddSource(EventHandle handle)
+{
+    for (int i = 0; i < EVENT_LOOP_MAX_SOURCES; i++)
+    {
+        if (!m_Sources[i])
+        {
+            m_Sources[i] = handle;
+            return i;
+        }
+    }
+    return -1;
+}
+
+void EventLoop::RemoveSource(int index)
+{
+    if (index >= 0 && index < EVENT_LOOP_MAX_SOURCES)
+        m_Sources[index] = nullptr;
+}
+
+void EventLoop::Post()
+{
+    SetEvent(m_PostEvent);
+}
+
+EventWake EventLoop::WaitPlatform(int64_t timeoutNs, int* source)
+{
+    // [timer, post, sources...]; the message queue is the implicit last slot
+    HANDLE handles[2 + EVENT_LOOP_MAX_SOURCES];
+    int sourceOf[2 + EVENT_LOOP_MAX_SOURCES];
+    DWORD count = 0;
+    handles[count++] = m_Timer;
+    handles[count++] = m_PostEvent;
+    for (int i = 0; i < EVENT_LOOP_MAX_SOURCES; i++)
+    {
+        if (m_Sources[i])
+        {
+            sourceOf[count] = i;
+            handles[count++] = m_Sources[i];
+        }
+    }
+
+    if (timeoutNs >= 0)
+    {
+        // Negative due time = relative, in 100 ns units (at least one unit, so it is not absolute 0)
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -(timeoutNs / 100 > 0 ? timeoutNs / 100 : 1);
+        if (!SetWaitableTimer(m_Timer, &dueTime, 0, nullptr, nullptr, FALSE))
+            return WAKE_ERROR;
+    }
+    else
+    {
+        CancelWaitableTimer(m_Timer);
+    }
+
+    // MWMO_INPUTAVAILABLE: messages that arrived before this call (but were not read) also wake it
+    DWORD result = MsgWaitForMultipleObjectsEx(count, handles, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+    if (result == WAIT_OBJECT_0)
+        return WAKE_DEADLINE;
+    if (timeoutNs >= 0)
+        CancelWaitableTimer(m_Timer);
+    if (result == WAIT_OBJECT_0 + 1)
+        return WAKE_POSTED;
+    if (result >= WAIT_OBJECT_0 + 2 && result < WAIT_OBJECT_0 + count)
+    {
+        if (source)
+            *source = sourceOf[result - WAIT_OBJECT_0];
+        return WAKE_SOURCE;
+    }
+    if (result == WAIT_OBJECT_0 + count)
+        return WAKE_MESSAGE;
+    return WAKE_ERROR;
+}
+
+#else
+
+EventLoop::EventLoop(FrameClock* clock)
+    : m_Clock(clock ? clock : GetSystemFrameClock())
+{
+    for (int i = 0; i < EVENT_LOOP_MAX_SOURCES; i++)
+        m_Sources[i] = -1;
+
+    m_Epoll = epoll_create1(EPOLL_CLOEXEC);
+    m_TimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    m_PostFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_ReportStartNs = m_Clock->NowNs();
+    if (m_Epoll < 0 || m_TimerFd < 0 || m_PostFd < 0)
+        return;
+
+    // Event data: 0 = timer, 1 = post, 2 + i = source i
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.u32 = 0;
+    bool ok = epoll_ctl(m_Epoll, EPOLL_CTL_ADD, m_TimerFd, &ev) == 0;
+    ev.data.u32 = 1;
+    ok = ok && epoll_ctl(m_Epoll, EPOLL_CTL_ADD, m_PostFd, &ev) == 0;
+    m_Valid = ok;
+}
+
+EventLoop::~EventLoop()
+{
+    if (m_PostFd >= 0)
+        close(m_PostFd);
+    if (m_TimerFd >= 0)
+        close(m_TimerFd);
+    if (m_Epoll >= 0)
+        close(m_Epoll);
+}
+
+int EventLoop::AddSource(EventHandle handle)
+{
+    for (int i = 0; i < EVENT_LOOP_MAX_SOURCES; i++)
+    {
+        if (m_Sources[i] < 0)
+        {
+            epoll_event ev = {};
+            ev.events = EPOLLIN;
+            ev.data.u32 = 2 + (uint32_t)i;
+            if (epoll_ctl(m_Epoll, EPOLL_CTL_ADD, handle, &ev) != 0)
+                return -1;
+            m_Sources[i] = handle;
+            return i;
+        }
+    }
+    return -1;
+}
+
+void EventLoop::RemoveSource(int index)
+{
+    if (index < 0 || index >= EVENT_LOOP_MAX_SOURCES || m_Sources[index] < 0)
+        return;
+    epoll_ctl(m_Epoll, EPOLL_CTL_DEL, m_Sources[index], nullptr);
+    m_Sources[index] = -1;
+}
+
+void EventLoop::Post()
+{
+    uint64_t one = 1;
+    ssize_t written = write(m_PostFd, &one, sizeof(one));
+    (void)written;
+}
+
+EventWake EventLoop::WaitPlatform(int64_t timeoutNs, int* source)
+{
+    // Relative, so an injected clock works too; zero would disarm the timer
+    itimerspec spec = {};
+    if (timeoutNs >= 0)
+    {
+        int64_t ns = timeoutNs > 0 ? timeoutNs : 1;
+        spec.it_value.tv_sec = (time_t)(ns / 1000000000);
+        spec.it_value.tv_nsec = (long)(ns % 1000000000);
+    }
+    if (timerfd_settime(m_TimerFd, 0, &spec, nullptr) != 0)
+        return WAKE_ERROR;
+
+    epoll_event events[2 + EVENT_LOOP_MAX_SOURCES];
+    int n;
+    do
+    {
+        n = epoll_wait(m_Epoll, events, 2 + EVENT_LOOP_MAX_SOURCES, -1);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0)
+        return WAKE_ERROR;
+
+    // Posts (shutdown, commands) first, then sources, then the deadline
+    bool timer = false;
+    int signalled = -1;
+    for (int i = 0; i < n; i++)
+    {
+        uint32_t id = events[i].data.u32;
+        if (id == 1)
+        {
+            uint64_t value;
+            ssize_t got = read(m_PostFd, &value, sizeof(value));
+            (void)got;
+            return WAKE_POSTED;
+        }
+        if (id == 0)
+            timer = true;
+        else if (signalled < 0)
+            signalled = (int)id - 2;
+    }
+    if (signalled >= 0)
+    {
+        if (source)
+            *source = signalled;
+        return WAKE_SOURCE;
+    }
+    if (timer)
+    {
+        uint64_t expirations;
+        ssize_t got = read(m_TimerFd, &expirations, sizeof(expirations));
+        (void)got;
+        return WAKE_DEADLINE;
+    }
+    return WAKE_ERROR;
+}
+
+#endif
+
+EventWake EventLoop::Wait(int64_t deadlineNs, int* source)
+{
+    int64_t startNs = m_Clock->NowNs();
+    if (deadlineNs >= 0 && deadlineNs <= startNs)
+    {
+        m_Stats.immediate++;
+        return WAKE_DEADLINE;
+    }
+    if (!m_Valid)
+        return WAKE_ERROR;
+
+    EventWake wake = WaitPlatform(deadlineNs >= 0 ? deadlineNs - startNs : -1, source);
+    m_Stats.wakeups[wake]++;
+    m_Stats.sleptNs += m_Clock->NowNs() - startNs;
+    return wake;
+}
+
+bool EventLoop::SleepUntilNs(int64_t deadlineNs)
+{
+    for (;;)
+    {
+        int source = -1;
+        EventWake wake = Wait(deadlineNs, &source);
+        if (wake == WAKE_DEADLINE)
+            return true;
+        if (wake == WAKE_ERROR)
+        {
+            // Sleep it out as the pacer would without a waiter
+            m_Clock->SleepUntilNs(deadlineNs);
+            return true;
+        }
+        if (m_Handler && !m_Handler->OnEvent(wake, source))
+            return false;
+    }
+}
+
+void EventLoop::FormatWakeupReport(int64_t nowNs, char* buffer, size_t size)
+{
+    static const char* s_Names[WAKE_REASONS] = { "deadline", "source", "message", "posted", "error" };
+
+    double seconds = (nowNs - m_ReportStartNs) / 1e9;
+    if (seconds <= 0)
+        seconds = 1e-9;
+
+    uint64_t total = 0;
+    for (int i = 0; i < WAKE_REASONS; i++)
+        total += m_Stats.wakeups[i] - m_ReportBase.wakeups[i];
+
+    int written = snprintf(buffer, size, "%.1f wakeups/s (", total / seconds);
+    bool first = true;
+    for (int i = 0; i < WAKE_REASONS && written > 0 && (size_t)written < size; i++)
+    {
+        uint64_t count = m_Stats.wakeups[i] - m_ReportBase.wakeups[i];
+        if (!count)
+            continue;
+        written += snprintf(buffer + written, size - written, "%s%s %.1f", first ? "" : ", ", s_Names[i], count / seconds);
+        first = false;
+    }
+    if (written > 0 && (size_t)written < size)
+    {
+        snprintf(buffer + written, size - written, "), asleep %.0f%%",
+            100.0 * (m_Stats.sleptNs - m_ReportBase.sleptNs) / (seconds * 1e9));
+    }
+
+    m_ReportBase = m_Stats;
+    m_ReportStartNs = nowNs;
+}
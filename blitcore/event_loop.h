@@ -0,0 +1,102 @@
+// Event-driven main loop wait (platform independent interface)
+// One blocking wait wakes on whichever comes first: the frame deadline, a registered wait object
+// (frame-available or damage event, control command), a Post from another thread (shutdown) or,
+// on Windows, a message for the thread (hotkeys, input, display changes). Between events the
+// thread sleeps instead of draining and polling; every wakeup is counted by reason so the idle
+// CPU cost can be reported.
+// Windows: MsgWaitForMultipleObjectsEx with a high-resolution waitable timer for the deadline.
+// Elsewhere: epoll over a timerfd (deadline), an eventfd (Post) and the registered descriptors.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "frame_pacer.h"
+
+#ifdef _WIN32
+typedef void* EventHandle;      // HANDLE (event, waitable timer, ...)
+#else
+typedef int EventHandle;        // File descriptor, waited on for readability
+#endif
+
+constexpr int EVENT_LOOP_MAX_SOURCES = 8;
+
+enum EventWake
+{
+    WAKE_DEADLINE,              // The deadline arrived
+    WAKE_SOURCE,                // A registered wait object is signalled
+    WAKE_MESSAGE,               // Windows: input in the thread's message queue
+    WAKE_POSTED,                // Post from any thread
+    WAKE_ERROR,                 // The wait itself failed; callers fall back to sleeping
+    WAKE_REASONS
+};
+
+struct EventLoopStats
+{
+    uint64_t wakeups[WAKE_REASONS] = {};   // Waits that blocked, by what ended them
+    uint64_t immediate = 0;                 // Waits whose deadline had already passed (no sleep)
+    int64_t sleptNs = 0;                    // Time blocked in Wait
+};
+
+// Events other than the deadline, for EventLoop::SleepUntilNs
+class EventHandler
+{
+public:
+    virtual ~EventHandler() {}
+    // Return true to keep sleeping, false to end the wait (a frame is due now, or shutting down)
+    virtual bool OnEvent(EventWake wake, int source) = 0;
+};
+
+class EventLoop : public FrameWaiter
+{
+public:
+    explicit EventLoop(FrameClock* clock = nullptr);
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool IsValid() const { return m_Valid; }
+
+    // Wait objects stay owned by the caller. Returns the source index, -1 when full or on failure.
+    int AddSource(EventHandle handle);
+    void RemoveSource(int index);
+
+    // Any thread: ends the current (or next) Wait with WAKE_POSTED
+    void Post();
+
+    // Blocks until deadlineNs on the clock (negative: no deadline) or the first event. Posts are
+    // consumed; signalled sources and queued messages are left for the caller to drain.
+    EventWake Wait(int64_t deadlineNs, int* source = nullptr);
+
+    // FrameWaiter: waits until the deadline, passing every other wake to the handler
+    void SetHandler(EventHandler* handler) { m_Handler = handler; }
+    bool SleepUntilNs(int64_t deadlineNs) override;
+
+    const EventLoopStats& Stats() const { return m_Stats; }
+
+    // "61.9 wakeups/s (deadline 60.0, message 1.9), asleep 93%" since the previous report
+    void FormatWakeupReport(int64_t nowNs, char* buffer, size_t size);
+
+private:
+    EventWake WaitPlatform(int64_t timeoutNs, int* source);
+
+    FrameClock* m_Clock;
+    EventHandler* m_Handler = nullptr;
+    bool m_Valid = false;
+    EventLoopStats m_Stats;
+    EventLoopStats m_ReportBase;
+    int64_t m_ReportStartNs = 0;
+
+#ifdef _WIN32
+    void* m_Timer = nullptr;
+    void* m_PostEvent = nullptr;
+    void* m_Sources[EVENT_LOOP_MAX_SOURCES] = {};
+#else
+    int m_Epoll = -1;
+    int m_TimerFd = -1;
+    int m_PostFd = -1;
+    int m_Sources[EVENT_LOOP_MAX_SOURCES];
+#endif
+};
@@ -0,0 +1,74 @@
+// Per-frame bump allocator - see frame_arena.h
+
+#include "frame_arena.h"
+
+#include <stdlib.h>
+
+static inline size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+FrameArena::FrameArena(size_t initialBytes)
+{
+    m_Block = (uint8_t*)malloc(initialBytes);
+    m_Capacity = m_Block ? initialBytes : 0;
+}
+
+FrameArena::~FrameArena()
+{
+    FreeSpills();
+    free(m_Block);
+}
+
+void FrameArena::FreeSpills()
+{
+    while (m_SpillList)
+    {
+        Spill* next = m_SpillList->next;
+        free(m_SpillList);
+        m_SpillList = next;
+    }
+}
+
+void* FrameArena::Allocate(size_t bytes, size_t alignment)
+{
+    // Offsets are aligned relative to the block; malloc already gives 16 bytes
+    size_t offset = AlignUp((size_t)(uintptr_t)(m_Block + m_Offset), alignment) - (size_t)(uintptr_t)m_Block;
+    m_FrameBytes += bytes;
+    if (m_Block && offset + bytes <= m_Capacity)
+    {
+        m_Offset = offset + bytes;
+        return m_Block + offset;
+    }
+
+    // Overflow: a separate block for this allocation, folded into the main block at Reset
+    size_t header = AlignUp(sizeof(Spill), alignment);
+    Spill* spill = (Spill*)malloc(header + bytes + alignment);
+    if (!spill)
+        return nullptr;
+    spill->next = m_SpillList;
+    m_SpillList = spill;
+    return (void*)AlignUp((uintptr_t)spill + header, alignment);
+}
+
+void FrameArena::Reset()
+{
+    if (m_FrameBytes > m_HighWater)
+        m_HighWater = m_FrameBytes;
+
+    if (m_SpillList)
+    {
+        FreeSpills();
+
+        // Room for the peak frame plus alignment padding, rounded to 4 KB
+        size_t capacity = AlignUp(m_HighWater + m_HighWater / 8 + 4096, 4096);
+        free(m_Block);
+        m_Block = (uint8_t*)malloc(capacity);
+        m_Capacity = m_Block ? capacity : 0;
+        m_Spills++;
+    }
+
+    m_Offset = 0;
+    m_FrameBytes = 0;
+}
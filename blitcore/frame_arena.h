@@ -0,0 +1,53 @@
+// Per-frame bump allocator for scratch memory that dies with the frame (platform independent)
+// Allocate moves a pointer; Reset at the end of the frame releases everything at once. A frame
+// that outgrows the block spills into extra blocks, and the next Reset replaces them with one
+// block of the frame's peak size, so after the first large frame the arena never allocates.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t initialBytes = 64 * 1024);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Uninitialized memory valid until the next Reset; alignment is a power of two
+    void* Allocate(size_t bytes, size_t alignment = 16);
+
+    // Trivially-constructible element arrays only: no constructors or destructors run
+    template <typename T>
+    T* AllocateArray(size_t count)
+    {
+        return (T*)Allocate(count * sizeof(T), alignof(T) > 16 ? alignof(T) : 16);
+    }
+
+    // End of frame: every pointer handed out since the last Reset becomes invalid
+    void Reset();
+
+    size_t Used() const { return m_FrameBytes; }
+    size_t Capacity() const { return m_Capacity; }
+    size_t HighWater() const { return m_HighWater; }
+    int Spills() const { return m_Spills; }   // Frames that outgrew the block (heap allocations)
+
+private:
+    struct Spill
+    {
+        Spill* next;
+    };
+
+    void FreeSpills();
+
+    uint8_t* m_Block = nullptr;
+    size_t m_Capacity = 0;
+    size_t m_Offset = 0;
+    Spill* m_SpillList = nullptr;
+    size_t m_FrameBytes = 0;
+    size_t m_HighWater = 0;
+    int m_Spills = 0;
+};
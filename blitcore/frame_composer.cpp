@@ -0,0 +1,142 @@
+// Single-pass CPU frame composition - see frame_composer.h
+
+#include "frame_composer.h"
+#include "cache_info.h"
+#include "cursor_blend.h"
+#include "worker_pool.h"
+
+bool FrameComposer::Configure(int srcWidth, int srcHeight, int renderWidth, int renderHeight,
+                              int outputWidth, int outputHeight, bool linearLight)
+{
+    if (renderWidth > outputWidth || renderHeight > outputHeight)
+        return false;
+    if (!m_Sampler.Configure(srcWidth, srcHeight, renderWidth, renderHeight, linearLight))
+        return false;
+
+    // Planar path gives the same pixels faster wherever the ratio allows it
+    m_UsePlanar = !linearLight && m_Planar.Configure(srcWidth, srcHeight, renderWidth, renderHeight);
+    m_LinearLight = linearLight;
+    m_RenderWidth = renderWidth;
+    m_RenderHeight = renderHeight;
+    m_OutputWidth = outputWidth;
+    m_OutputHeight = outputHeight;
+
+    // Downscaling reads srcHeight / renderHeight source rows per output row (plus one for the blend)
+    int srcRowsPerRow = (srcHeight + renderHeight - 1) / renderHeight + 1;
+    m_SrcBytesPerRow = srcWidth * 4 * srcRowsPerRow;
+    SetStripRows(m_RequestedStripRows);
+    SetStoreMode(m_StoreMode);
+    return true;
+}
+
+void FrameComposer::SetStoreMode(StoreMode mode)
+{
+    m_StoreMode = mode;
+    m_Streaming = UseStreamingStores((size_t)m_OutputWidth * m_OutputHeight * 4, mode);
+}
+
+void FrameComposer::SetStripRows(int rows)
+{
+    m_RequestedStripRows = rows;
+    if (rows <= 0)
+    {
+        // Half the L2 for the strip's source rows and output, the rest for everything else
+        size_t bytesPerRow = (size_t)m_SrcBytesPerRow + (size_t)m_OutputWidth * 4;
+        rows = bytesPerRow ? (int)(PlanningL2Size() / 2 / bytesPerRow) : 1;
+    }
+    m_StripRows = rows < 1 ? 1 : (rows > 256 ? 256 : rows);
+}
+
+void FrameComposer::ScaleRows(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch,
+                              int rowBegin, int rowEnd, bool streaming) const
+{
+    if (rowBegin >= rowEnd)
+        return;
+    if (m_UsePlanar)
+        m_Planar.ScaleRows(src, srcPitch, dst, dstPitch, rowBegin, rowEnd, streaming);
+    else
+        m_Sampler.ScaleRows(src, srcPitch, dst, dstPitch, rowBegin, rowEnd, streaming);
+}
+
+void FrameComposer::ComposeRows(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch,
+                                const CursorSprite* cursor, int cursorX, int cursorY, int rowBegin, int rowEnd) const
+{
+    bool hasCursor = cursor && cursor->width > 0 && cursor->height > 0 &&
+                     cursorX < m_RenderWidth && cursorX + cursor->width > 0;
+
+    for (int y0 = rowBegin; y0 < rowEnd; y0 += m_StripRows)
+    {
+        int y1 = y0 + m_StripRows < rowEnd ? y0 + m_StripRows : rowEnd;
+        int scaledEnd = y1 < m_RenderHeight ? y1 : m_RenderHeight;
+
+        if (y0 < scaledEnd)
+        {
+            // Scale straight into the frame rows. Streaming frames bypass the cache except on the
+            // cursor's rows, which the blend below reads back.
+            int cursor0 = scaledEnd, cursor1 = scaledEnd;
+            if (hasCursor && cursorY < scaledEnd && cursorY + cursor->height > y0)
+            {
+                cursor0 = cursorY > y0 ? cursorY : y0;
+                cursor1 = cursorY + cursor->height < scaledEnd ? cursorY + cursor->height : scaledEnd;
+            }
+            ScaleRows(src, srcPitch, dst, dstPitch, y0, cursor0, m_Streaming);
+            ScaleRows(src, srcPitch, dst, dstPitch, cursor0, cursor1, false);
+            ScaleRows(src, srcPitch, dst, dstPitch, cursor1, scaledEnd, m_Streaming);
+
+            // Cursor rows inside this strip (clipped to the scaled image), blended in place
+            if (hasCursor)
+            {
+                ImageView<FormatBGRA8> image(dst + (intptr_t)y0 * dstPitch, m_RenderWidth, scaledEnd - y0, dstPitch);
+                BlendCursor(image, *cursor, cursorX, cursorY - y0, m_LinearLight);
+            }
+        }
+
+        // Padding: right of the image, and whole rows below it
+        for (int y = y0; y < y1; y++)
+        {
+            int x0 = y < m_RenderHeight ? m_RenderWidth : 0;
+            uint32_t* row = (uint32_t*)(dst + (intptr_t)y * dstPitch) + x0;
+            if (m_Streaming)
+                FillPixelsUnfenced(row, (size_t)(m_OutputWidth - x0), m_Padding);
+            else
+                for (int x = x0; x < m_OutputWidth; x++)
+                    *row++ = m_Padding;
+        }
+    }
+
+    // Each thread fences its own stores before the frame is handed on
+    if (m_Streaming)
+        StreamFence();
+}
+
+struct ComposeJob
+{
+    const FrameComposer* composer;
+    const uint8_t* src;
+    int srcPitch;
+    uint8_t* dst;
+    int dstPitch;
+    const CursorSprite* cursor;
+    int cursorX;
+    int cursorY;
+};
+
+static void ComposeRowsTask(void* context, int begin, int end)
+{
+    const ComposeJob* job = (const ComposeJob*)context;
+    job->composer->ComposeRows(job->src, job->srcPitch, job->dst, job->dstPitch,
+                               job->cursor, job->cursorX, job->cursorY, begin, end);
+}
+
+void FrameComposer::Compose(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch,
+                            const CursorSprite* cursor, int cursorX, int cursorY, WorkerPool* pool) const
+{
+    if (!pool)
+    {
+        ComposeRows(src, srcPitch, dst, dstPitch, cursor, cursorX, cursorY, 0, m_OutputHeight);
+        return;
+    }
+
+    ComposeJob job = { this, src, srcPitch, dst, dstPitch, cursor, cursorX, cursorY };
+    pool->ParallelFor(m_OutputHeight, ComposeRowsTask, &job);
+}
@@ -0,0 +1,65 @@
+// Single-pass CPU frame composition (platform independent)
+// Produces each output row exactly once, a strip of rows at a time: the scaler writes straight into
+// the frame rows, the cursor span crossing the strip is blended in place while those rows are still
+// in cache, and the right-hand padding is filled. Frames larger than the cache are written with
+// streaming stores (see stream_store.h), image and padding alike, so they do not evict the source
+// still being read; only the cursor's rows, which the blend reads back, stay cached. Per frame that
+// is one read of the source and one write of the output, with no intermediate frame buffer or copy.
+// Strips are sized so their source rows and output rows fit in half the L2 (see cache_info.h).
+
+#pragma once
+
+#include <stdint.h>
+
+#include "bilinear_sampler.h"
+#include "planar_resampler.h"
+#include "stream_store.h"
+
+struct CursorSprite;
+class WorkerPool;
+
+class FrameComposer
+{
+public:
+    // The source is scaled to renderWidth x renderHeight at the top left of an
+    // outputWidth x outputHeight frame; everything else is padding
+    bool Configure(int srcWidth, int srcHeight, int renderWidth, int renderHeight,
+                   int outputWidth, int outputHeight, bool linearLight = false);
+
+    void SetPadding(uint32_t color) { m_Padding = color; }
+
+    // Frame writes; STORE_AUTO (the default) streams when the frame exceeds the cache threshold
+    void SetStoreMode(StoreMode mode);
+
+    // Rows per strip; 0 (the default) derives it from the detected L2 size
+    void SetStripRows(int rows);
+    int StripRows() const { return m_StripRows; }
+
+    // BGRA8 in/out, pitches in bytes. cursor may be null; cursorX/Y is the sprite's top-left
+    // in output pixels (hotspot already subtracted). Rows are split across the pool's threads when given.
+    void Compose(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch,
+                 const CursorSprite* cursor, int cursorX, int cursorY, WorkerPool* pool = nullptr) const;
+
+    // Output rows [rowBegin, rowEnd) only
+    void ComposeRows(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch,
+                     const CursorSprite* cursor, int cursorX, int cursorY, int rowBegin, int rowEnd) const;
+
+private:
+    void ScaleRows(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch, int rowBegin, int rowEnd,
+                   bool streaming) const;
+
+    BilinearSampler m_Sampler;
+    PlanarResampler m_Planar;
+    bool m_UsePlanar = false;
+    bool m_LinearLight = false;
+    int m_RenderWidth = 0;
+    int m_RenderHeight = 0;
+    int m_OutputWidth = 0;
+    int m_OutputHeight = 0;
+    uint32_t m_Padding = 0xFF000000;
+    StoreMode m_StoreMode = STORE_AUTO;
+    bool m_Streaming = false;
+    int m_StripRows = 1;
+    int m_RequestedStripRows = 0;
+    int m_SrcBytesPerRow = 0;   // Source bytes read per output row, for strip sizing
+};
@@ -0,0 +1,212 @@
+// Frame buffer memory - see frame_memory.h
+
+#include "frame_memory.h"
+#include "frame_pacer.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+constexpr int CACHE_LINE_SIZE = 64;
+
+int AlignedFramePitch(int width, int bytesPerPixel)
+{
+    int lines = (width * bytesPerPixel + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE;
+    if ((lines & 1) == 0)
+        lines++;
+    return lines * CACHE_LINE_SIZE;
+}
+
+uint64_t ProcessPageFaults()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters = {};
+    counters.cb = sizeof(counters);
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PageFaultCount;
+    return 0;
+#else
+    struct rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return (uint64_t)usage.ru_minflt + (uint64_t)usage.ru_majflt;
+    return 0;
+#endif
+}
+
+#ifdef _WIN32
+// Large pages need SeLockMemoryPrivilege enabled in the token (granted by policy, off by default)
+static bool EnableLockMemoryPrivilege()
+{
+    static int enabled = -1;
+    if (enabled >= 0)
+        return enabled != 0;
+
+    enabled = 0;
+    HANDLE token;
+    if (OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+    {
+        TOKEN_PRIVILEGES privileges = {};
+        privileges.PrivilegeCount = 1;
+        privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+        if (LookupPrivilegeValueA(nullptr, "SeLockMemoryPrivilege", &privileges.Privileges[0].Luid) &&
+            AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) &&
+            GetLastError() == ERROR_SUCCESS)
+        {
+            enabled = 1;
+        }
+        CloseHandle(token);
+    }
+    return enabled != 0;
+}
+#endif
+
+static size_t RoundUp(size_t value, size_t multiple)
+{
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+bool FrameMemory::Allocate(FrameBuffer* buffer, int width, int height, int bytesPerPixel)
+{
+    if (!buffer || width <= 0 || height <= 0 || bytesPerPixel <= 0)
+        return false;
+
+    int pitch = AlignedFramePitch(width, bytesPerPixel);
+    size_t size = (size_t)pitch * height;
+    void* data = nullptr;
+    size_t pageSize = 0;
+
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    size_t smallPage = info.dwPageSize;
+
+    size_t largePage = GetLargePageMinimum();
+    if (largePage && EnableLockMemoryPrivilege())
+    {
+        // Large pages are always resident: committing them is the prefault and the lock
+        size_t bytes = RoundUp(size, largePage);
+        data = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        if (data)
+        {
+            pageSize = largePage;
+            size = bytes;
+        }
+    }
+    if (!data)
+    {
+        size = RoundUp(size, smallPage);
+        data = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (!data)
+            return false;
+        pageSize = smallPage;
+    }
+#else
+    size_t smallPage = (size_t)sysconf(_SC_PAGESIZE);
+
+#ifdef MAP_HUGETLB
+    // Explicit 2 MB pages from the hugetlbfs pool (only if the admin reserved some)
+    {
+        size_t bytes = RoundUp(size, FRAME_LARGE_PAGE_SIZE);
+        void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (mapped != MAP_FAILED)
+        {
+            data = mapped;
+            pageSize = FRAME_LARGE_PAGE_SIZE;
+            size = bytes;
+        }
+    }
+#endif
+    if (!data)
+    {
+        // Regular mapping rounded to 2 MB so transparent huge pages can back all of it
+        size_t bytes = RoundUp(size, FRAME_LARGE_PAGE_SIZE);
+        void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED)
+            return false;
+#ifdef MADV_HUGEPAGE
+        madvise(mapped, bytes, MADV_HUGEPAGE);
+#endif
+        data = mapped;
+        pageSize = smallPage;
+        size = bytes;
+    }
+#endif
+
+    // Touch every page now: faults happen here instead of in the first frames
+    FrameClock* clock = GetSystemFrameClock();
+    uint64_t faultsBefore = ProcessPageFaults();
+    int64_t startNs = clock->NowNs();
+    volatile uint8_t* bytes = (volatile uint8_t*)data;
+    for (size_t offset = 0; offset < size; offset += smallPage)
+        bytes[offset] = 0;
+
+#ifdef _WIN32
+    bool locked = pageSize >= FRAME_LARGE_PAGE_SIZE;
+    if (!locked)
+    {
+        // Grow the working set enough to pin the frame, then lock it
+        SIZE_T minimum, maximum;
+        HANDLE process = GetCurrentProcess();
+        if (GetProcessWorkingSetSize(process, &minimum, &maximum))
+            SetProcessWorkingSetSize(process, minimum + size, maximum + size);
+        locked = VirtualLock(data, size) != 0;
+    }
+#else
+    bool locked = mlock(data, size) == 0;
+#endif
+
+    m_Stats.prefaultNs += clock->NowNs() - startNs;
+    m_Stats.prefaultFaults += ProcessPageFaults() - faultsBefore;
+
+    buffer->data = (uint8_t*)data;
+    buffer->width = width;
+    buffer->height = height;
+    buffer->pitch = pitch;
+    buffer->bytes = size;
+    buffer->pageSize = pageSize;
+    buffer->locked = locked;
+
+    m_Stats.buffers++;
+    if (pageSize >= FRAME_LARGE_PAGE_SIZE)
+        m_Stats.largePageBytes += size;
+    else
+        m_Stats.smallPageBytes += size;
+    if (locked)
+        m_Stats.lockedBytes += size;
+    m_Stats.tlbEntries += size / pageSize;
+    return true;
+}
+
+void FrameMemory::Free(FrameBuffer* buffer)
+{
+    if (!buffer || !buffer->data)
+        return;
+
+#ifdef _WIN32
+    if (buffer->locked && buffer->pageSize < FRAME_LARGE_PAGE_SIZE)
+        VirtualUnlock(buffer->data, buffer->bytes);
+    VirtualFree(buffer->data, 0, MEM_RELEASE);
+#else
+    if (buffer->locked)
+        munlock(buffer->data, buffer->bytes);
+    munmap(buffer->data, buffer->bytes);
+#endif
+
+    m_Stats.buffers--;
+    if (buffer->pageSize >= FRAME_LARGE_PAGE_SIZE)
+        m_Stats.largePageBytes -= buffer->bytes;
+    else
+        m_Stats.smallPageBytes -= buffer->bytes;
+    if (buffer->locked)
+        m_Stats.lockedBytes -= buffer->bytes;
+    m_Stats.tlbEntries -= buffer->bytes / buffer->pageSize;
+    *buffer = FrameBuffer();
+}
@@ -0,0 +1,62 @@
+// Frame buffer memory: large pages, prefaulted, locked, alias-free pitch (platform independent interface)
+// Frames are mapped with 2 MB pages where the OS allows it (MAP_HUGETLB, then transparent huge pages
+// on Linux; MEM_LARGE_PAGES with SeLockMemoryPrivilege on Windows), touched and locked at allocation
+// so the first frames take no page faults, and given a row pitch that is an odd number of cache
+// lines so vertically adjacent pixels do not compete for the same cache sets (7680 -> 7744 bytes
+// for 1920 BGRA pixels).
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+constexpr size_t FRAME_LARGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+struct FrameBuffer
+{
+    uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    int pitch = 0;              // Bytes per row (>= width * bytesPerPixel)
+    size_t bytes = 0;           // Mapped size, a whole number of pages
+    size_t pageSize = 0;        // 2 MB when large pages were granted, else the base page size
+                                // (transparent huge pages may still back it; the kernel decides)
+    bool locked = false;        // Pinned in RAM (mlock / VirtualLock)
+};
+
+struct FrameMemoryStats
+{
+    int buffers = 0;            // Live buffers
+    size_t largePageBytes = 0;
+    size_t smallPageBytes = 0;
+    size_t lockedBytes = 0;
+    size_t tlbEntries = 0;      // Pages covering all live buffers: TLB entries a full sweep needs
+    uint64_t prefaultFaults = 0;// Page faults taken while prefaulting (paid at startup, not per frame)
+    int64_t prefaultNs = 0;
+};
+
+// Row pitch for width pixels: rounded up to a cache line, then to an odd number of lines
+int AlignedFramePitch(int width, int bytesPerPixel);
+
+// Page faults (minor + major) taken by this process so far; difference two readings to
+// check that steady-state frames fault nothing
+uint64_t ProcessPageFaults();
+
+class FrameMemory
+{
+public:
+    FrameMemory() = default;
+
+    FrameMemory(const FrameMemory&) = delete;
+    FrameMemory& operator=(const FrameMemory&) = delete;
+
+    // Maps, prefaults and locks a frame; large pages are best effort. Returns false only
+    // if no memory could be mapped at all.
+    bool Allocate(FrameBuffer* buffer, int width, int height, int bytesPerPixel = 4);
+    void Free(FrameBuffer* buffer);
+
+    const FrameMemoryStats& Stats() const { return m_Stats; }
+
+private:
+    FrameMemoryStats m_Stats;
+};
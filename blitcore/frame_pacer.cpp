@@ -0,0 +1,211 @@
+// Frame pacing - see frame_pacer.h
+
+#include "frame_pacer.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#include <errno.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define BLITCORE_CPU_PAUSE() _mm_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define BLITCORE_CPU_PAUSE() __asm__ __volatile__("yield")
+#else
+#define BLITCORE_CPU_PAUSE() ((void)0)
+#endif
+
+#ifdef _WIN32
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+class SystemFrameClock : public FrameClock
+{
+public:
+    SystemFrameClock()
+    {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        m_Frequency = frequency.QuadPart;
+
+        // High-resolution timer (Windows 10 1803+) does not depend on timeBeginPeriod
+        m_Timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (!m_Timer)
+            m_Timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    }
+
+    ~SystemFrameClock()
+    {
+        if (m_Timer)
+            CloseHandle(m_Timer);
+    }
+
+    int64_t NowNs() override
+    {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        // Split to avoid overflowing counter * 1e9
+        int64_t seconds = counter.QuadPart / m_Frequency;
+        int64_t remainder = counter.QuadPart % m_Frequency;
+        return seconds * 1000000000 + remainder * 1000000000 / m_Frequency;
+    }
+
+    void SleepUntilNs(int64_t deadlineNs) override
+    {
+        int64_t remainingNs = deadlineNs - NowNs();
+        if (remainingNs <= 0)
+            return;
+
+        if (m_Timer)
+        {
+            // Negative due time = relative, in 100 ns units
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -(remainingNs / 100);
+            if (SetWaitableTimer(m_Timer, &dueTime, 0, nullptr, nullptr, FALSE))
+            {
+                WaitForSingleObject(m_Timer, INFINITE);
+                return;
+            }
+        }
+
+        Sleep((DWORD)(remainingNs / 1000000));
+    }
+
+    void Relax() override
+    {
+        BLITCORE_CPU_PAUSE();
+    }
+
+private:
+    int64_t m_Frequency = 1;
+    HANDLE m_Timer = nullptr;
+};
+
+#else
+
+class SystemFrameClock : public FrameClock
+{
+public:
+    int64_t NowNs() override
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    }
+
+    void SleepUntilNs(int64_t deadlineNs) override
+    {
+        timespec ts;
+        ts.tv_sec = (time_t)(deadlineNs / 1000000000);
+        ts.tv_nsec = (long)(deadlineNs % 1000000000);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+    }
+
+    void Relax() override
+    {
+        BLITCORE_CPU_PAUSE();
+    }
+};
+
+#endif
+
+FrameClock* GetSystemFrameClock()
+{
+    static SystemFrameClock clock;
+    return &clock;
+}
+
+FramePacer::FramePacer(int64_t periodNumNs, int64_t periodDen, FrameClock* clock)
+    : m_Clock(clock ? clock : GetSystemFrameClock())
+    , m_PeriodNumNs(periodNumNs)
+    , m_PeriodDen(periodDen > 0 ? periodDen : 1)
+{
+    Reset();
+}
+
+void FramePacer::SetPeriod(int64_t periodNumNs, int64_t periodDen)
+{
+    m_PeriodNumNs = periodNumNs;
+    m_PeriodDen = periodDen > 0 ? periodDen : 1;
+    Reset();
+}
+
+void FramePacer::Reset()
+{
+    m_OriginNs = m_Clock->NowNs();
+    m_FrameIndex = 0;
+}
+
+int64_t FramePacer::WaitForNextFrame(int framesToAdvance)
+{
+    int64_t now = m_Clock->NowNs();
+    int64_t next = m_FrameIndex + (framesToAdvance > 0 ? framesToAdvance : 1);
+
+    // Skip deadlines that have already passed instead of bursting to catch up
+    if (DeadlineAt(next) <= now)
+    {
+        int64_t elapsed = now - m_OriginNs;
+        int64_t behind = (elapsed / m_PeriodNumNs) * m_PeriodDen
+            + (elapsed % m_PeriodNumNs) * m_PeriodDen / m_PeriodNumNs + 1;
+        while (DeadlineAt(behind) <= now)
+            behind++;
+        m_Stats.missed += (uint64_t)(behind - next);
+        next = behind;
+    }
+
+    int64_t deadline = DeadlineAt(next);
+    m_FrameIndex = next;
+
+    now = WaitUntil(deadline);
+    if (m_Interrupted)
+    {
+        // Pulled in by an event: this frame runs now and the grid continues from it
+        m_OriginNs = now;
+        m_FrameIndex = 0;
+        return now;
+    }
+
+    int64_t lateness = now - deadline;
+    m_Stats.frames++;
+    m_Stats.lastLatenessNs = lateness;
+    m_Stats.sumLatenessNs += lateness;
+    if (lateness > m_Stats.maxLatenessNs)
+        m_Stats.maxLatenessNs = lateness;
+
+    return deadline;
+}
+
+int64_t FramePacer::WaitUntil(int64_t deadlineNs)
+{
+    int64_t now = m_Clock->NowNs();
+    m_Interrupted = false;
+
+    // Coarse sleep up to the spin window, then spin for the remainder
+    if (deadlineNs - now > m_SpinWindowNs)
+    {
+        if (m_Waiter && !m_Waiter->SleepUntilNs(deadlineNs - m_SpinWindowNs))
+        {
+            m_Interrupted = true;
+            m_Stats.interrupted++;
+            return m_Clock->NowNs();
+        }
+        if (!m_Waiter)
+            m_Clock->SleepUntilNs(deadlineNs - m_SpinWindowNs);
+        now = m_Clock->NowNs();
+    }
+
+    while (now < deadlineNs)
+    {
+        m_Clock->Relax();
+        now = m_Clock->NowNs();
+    }
+
+    return now;
+}
@@ -0,0 +1,105 @@
+// Frame pacing against absolute deadlines (platform independent)
+// Deadlines are origin + n * period on a monotonic clock, so sleep overshoot never accumulates.
+// Each wait sleeps coarsely, then spin-waits with pause for the last part of the interval.
+// The coarse sleep can be handed to a FrameWaiter (an event loop) so events end it early.
+
+#pragma once
+
+#include <stdint.h>
+
+// Monotonic time source; injectable so pacing logic can be driven by a fake clock
+class FrameClock
+{
+public:
+    virtual ~FrameClock() {}
+    virtual int64_t NowNs() = 0;
+    // Block until roughly deadlineNs (may wake early or late)
+    virtual void SleepUntilNs(int64_t deadlineNs) = 0;
+    // Called once per spin iteration while waiting out the last part of an interval
+    virtual void Relax() = 0;
+};
+
+// Coarse sleep that events can cut short (see event_loop.h)
+class FrameWaiter
+{
+public:
+    virtual ~FrameWaiter() {}
+    // Sleep until roughly deadlineNs; false when an event ended the wait early
+    virtual bool SleepUntilNs(int64_t deadlineNs) = 0;
+};
+
+// QueryPerformanceCounter + high-resolution waitable timer on Windows,
+// CLOCK_MONOTONIC + clock_nanosleep(TIMER_ABSTIME) elsewhere
+FrameClock* GetSystemFrameClock();
+
+// Power/precision trade-off: how much of each interval is spent spinning instead of sleeping
+constexpr int64_t PACER_SPIN_NONE_NS = 0;             // Pure sleep, lowest power, ~1 ms jitter on Windows
+constexpr int64_t PACER_SPIN_BALANCED_NS = 500000;    // Default: tens of microseconds of jitter
+constexpr int64_t PACER_SPIN_PRECISE_NS = 2000000;    // Covers worst-case Sleep() overshoot
+
+struct FramePacerStats
+{
+    uint64_t frames = 0;         // Deadlines waited on
+    uint64_t missed = 0;         // Deadlines already passed when the frame finished (skipped)
+    int64_t lastLatenessNs = 0;  // Wake time minus deadline for the last frame
+    int64_t maxLatenessNs = 0;
+    int64_t sumLatenessNs = 0;
+    uint64_t interrupted = 0;    // Waits an event ended early (the frame ran at once)
+};
+
+class FramePacer
+{
+public:
+    // Period is periodNumNs / periodDen nanoseconds (e.g. 1e9 / 60), kept exact via the frame index
+    FramePacer(int64_t periodNumNs, int64_t periodDen, FrameClock* clock = nullptr);
+
+    static FramePacer FromRate(int framesPerSecond, FrameClock* clock = nullptr)
+    {
+        return FramePacer(1000000000, framesPerSecond, clock);
+    }
+
+    void SetSpinWindowNs(int64_t spinWindowNs) { m_SpinWindowNs = spinWindowNs; }
+
+    // Coarse sleeps go through waiter (null = the clock). When an event ends one early the wait
+    // returns at once and WaitForNextFrame restarts the deadline grid from there.
+    void SetWaiter(FrameWaiter* waiter) { m_Waiter = waiter; }
+    // The last wait was cut short by an event
+    bool WasInterrupted() const { return m_Interrupted; }
+    void SetPeriod(int64_t periodNumNs, int64_t periodDen);
+
+    // Re-anchor the deadline grid at the current time
+    void Reset();
+
+    // Wait for the next deadline. If one or more deadlines already passed, they are
+    // skipped (counted as missed) rather than run back-to-back to catch up.
+    // framesToAdvance > 1 deliberately sleeps through that many periods (idle throttling).
+    // Returns the deadline that was waited for.
+    int64_t WaitForNextFrame(int framesToAdvance = 1);
+
+    // Hybrid sleep/spin wait for an arbitrary absolute deadline (does not touch the frame grid).
+    // Returns the wake time (before the deadline when WasInterrupted).
+    int64_t WaitUntil(int64_t deadlineNs);
+
+    int64_t NextDeadlineNs() const { return DeadlineAt(m_FrameIndex + 1); }
+    int64_t PeriodNs() const { return m_PeriodNumNs / m_PeriodDen; }
+    const FramePacerStats& Stats() const { return m_Stats; }
+    FrameClock* Clock() const { return m_Clock; }
+
+private:
+    // origin + index * num / den without overflowing index * num on long runs
+    int64_t DeadlineAt(int64_t index) const
+    {
+        return m_OriginNs + (index / m_PeriodDen) * m_PeriodNumNs
+            + (index % m_PeriodDen) * m_PeriodNumNs / m_PeriodDen;
+    }
+
+    FrameClock* m_Clock;
+    int64_t m_PeriodNumNs;
+    int64_t m_PeriodDen;
+    int64_t m_OriginNs = 0;
+    int64_t m_FrameIndex = 0;
+    int64_t m_SpinWindowNs = PACER_SPIN_BALANCED_NS;
+    FrameWaiter* m_Waiter = nullptr;
+    bool m_Interrupted = false;
+    FramePacerStats m_Stats;
+};
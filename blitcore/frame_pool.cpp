@@ -0,0 +1,310 @@
+// Reference-counted frame buffer pool - see frame_pool.h
+
+#include "frame_pool.h"
+
+#include <chrono>
+
+bool FrameMemoryAllocator::Allocate(int width, int height, FrameBuffer* buffer, void** user)
+{
+    *user = nullptr;
+    return m_Memory.Allocate(buffer, width, height);
+}
+
+void FrameMemoryAllocator::Free(FrameBuffer* buffer, void*)
+{
+    m_Memory.Free(buffer);
+}
+
+FrameRef::FrameRef(const FrameRef& other) : m_Frame(other.m_Frame)
+{
+    if (m_Frame)
+        m_Frame->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+FrameRef& FrameRef::operator=(const FrameRef& other)
+{
+    if (this != &other)
+    {
+        FrameRef copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+FrameRef& FrameRef::operator=(FrameRef&& other) noexcept
+{
+    if (this != &other)
+    {
+        Reset();
+        m_Frame = other.m_Frame;
+        other.m_Frame = nullptr;
+    }
+    return *this;
+}
+
+void FrameRef::Reset()
+{
+    Release();
+}
+
+bool FrameRef::Release()
+{
+    // acq_rel: the last holder sees every other holder's reads finish before the buffer is reused
+    bool last = m_Frame && m_Frame->refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    if (last)
+        m_Frame->pool->Recycle(m_Frame);
+    m_Frame = nullptr;
+    return last;
+}
+
+bool FramePool::Create(const FramePoolConfig& config, FrameAllocator* allocator)
+{
+    Destroy();
+    if (config.width <= 0 || config.height <= 0 || config.buffers <= 0)
+        return false;
+
+    m_Config = config;
+    if (m_Config.maxBuffers < m_Config.buffers)
+        m_Config.maxBuffers = m_Config.buffers;
+    m_Allocator = allocator ? allocator : &m_DefaultAllocator;
+    m_Stats = FramePoolStats();
+
+    // Sized once so releases and growth never reallocate the bookkeeping
+    m_Frames.reserve(m_Config.maxBuffers);
+    m_Free.reserve(m_Config.maxBuffers);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (int i = 0; i < m_Config.buffers; i++)
+    {
+        PooledFrame* frame = AddFrame();
+        if (!frame)
+            return false;
+        m_Free.push_back(frame);
+    }
+    return true;
+}
+
+void FramePool::Destroy()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (PooledFrame* frame : m_Frames)
+    {
+        m_Allocator->Free(&frame->buffer, frame->user);
+        delete frame;
+    }
+    m_Frames.clear();
+    m_Free.clear();
+}
+
+// Called with m_Mutex held
+PooledFrame* FramePool::AddFrame()
+{
+    PooledFrame* frame = new PooledFrame;
+    if (!m_Allocator->Allocate(m_Config.width, m_Config.height, &frame->buffer, &frame->user))
+    {
+        delete frame;
+        return nullptr;
+    }
+    frame->pool = this;
+    m_Frames.push_back(frame);
+    return frame;
+}
+
+FrameRef FramePool::Acquire(int64_t timeoutNs)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(timeoutNs > 0 ? timeoutNs : 0);
+    bool waited = false;
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    for (;;)
+    {
+        PooledFrame* frame = nullptr;
+        if (!m_Free.empty())
+        {
+            frame = m_Free.back();
+            m_Free.pop_back();
+        }
+        else if (m_Config.policy == POOL_GROW && (int)m_Frames.size() < m_Config.maxBuffers)
+        {
+            frame = AddFrame();
+            if (frame)
+                m_Stats.grown++;
+        }
+
+        if (frame)
+        {
+            frame->refs.store(1, std::memory_order_relaxed);
+            m_Stats.acquired++;
+            if (waited)
+                m_Stats.waited++;
+            return FrameRef(frame);
+        }
+
+        if (m_Config.policy == POOL_DROP_OLDEST)
+        {
+            // Queue locks come before the pool's; the reclaimed frame recycles through m_Mutex
+            lock.unlock();
+            bool dropped = DropOldestQueued();
+            lock.lock();
+            if (dropped)
+            {
+                m_Stats.dropped++;
+                continue;
+            }
+        }
+
+        if (timeoutNs == 0)
+            break;
+        waited = true;
+        if (timeoutNs < 0)
+            m_Released.wait(lock);
+        else if (m_Released.wait_until(lock, deadline) == std::cv_status::timeout && m_Free.empty())
+            break;
+    }
+
+    m_Stats.failed++;
+    return FrameRef();
+}
+
+void FramePool::Recycle(PooledFrame* frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Free.push_back(frame);
+    }
+    m_Released.notify_one();
+}
+
+// Takes the oldest reclaimable frame (lowest sequence among queue heads that only their queue
+// references) out of its queue. True only when that returned a buffer to the pool: a frame a
+// consumer still holds, or another queue still has, is left queued, since dropping it frees nothing.
+bool FramePool::DropOldestQueued()
+{
+    FrameRef dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_QueueMutex);
+        while (!dropped)
+        {
+            FrameQueue* oldest = nullptr;
+            uint64_t oldestSequence = 0;
+            for (FrameQueue* queue : m_Queues)
+            {
+                uint64_t sequence;
+                if (queue->OldestReclaimable(&sequence) && (!oldest || sequence < oldestSequence))
+                {
+                    oldest = queue;
+                    oldestSequence = sequence;
+                }
+            }
+            if (!oldest)
+                return false;
+            // Empty if its consumer popped the frame meanwhile; look again
+            dropped = oldest->TakeOldest(oldestSequence);
+        }
+    }
+    return dropped.Release();
+}
+
+int FramePool::Capacity() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return (int)m_Frames.size();
+}
+
+int FramePool::FreeCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return (int)m_Free.size();
+}
+
+FramePoolStats FramePool::Stats() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+FrameQueue::FrameQueue(FramePool* pool, int capacity) : m_Pool(pool)
+{
+    m_Ring.resize(capacity > 0 ? capacity : 1);
+    std::lock_guard<std::mutex> lock(m_Pool->m_QueueMutex);
+    m_Pool->m_Queues.push_back(this);
+}
+
+FrameQueue::~FrameQueue()
+{
+    std::lock_guard<std::mutex> lock(m_Pool->m_QueueMutex);
+    for (size_t i = 0; i < m_Pool->m_Queues.size(); i++)
+    {
+        if (m_Pool->m_Queues[i] == this)
+        {
+            m_Pool->m_Queues.erase(m_Pool->m_Queues.begin() + i);
+            break;
+        }
+    }
+}
+
+bool FrameQueue::Push(const FrameRef& frame)
+{
+    // Dropped frames are released after the lock: the last release takes the pool's lock
+    FrameRef dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        int size = (int)m_Ring.size();
+        if (m_Count == size)
+        {
+            dropped = std::move(m_Ring[m_Head]);
+            m_Head = (m_Head + 1) % size;
+            m_Count--;
+        }
+        m_Ring[(m_Head + m_Count) % size] = frame;
+        m_Count++;
+    }
+    m_Pushed.notify_one();
+    return !dropped;
+}
+
+FrameRef FrameQueue::Pop(int64_t timeoutNs)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    auto ready = [this] { return m_Count > 0; };
+    if (timeoutNs < 0)
+        m_Pushed.wait(lock, ready);
+    else if (timeoutNs > 0)
+        m_Pushed.wait_for(lock, std::chrono::nanoseconds(timeoutNs), ready);
+    if (m_Count == 0)
+        return FrameRef();
+
+    FrameRef frame = std::move(m_Ring[m_Head]);
+    m_Head = (m_Head + 1) % (int)m_Ring.size();
+    m_Count--;
+    return frame;
+}
+
+int FrameQueue::Size() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Count;
+}
+
+// Under the queue's lock a frame only the ring references cannot gain a holder, so it stays
+// reclaimable until popped
+bool FrameQueue::OldestReclaimable(uint64_t* sequence) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Count == 0 || !m_Ring[m_Head].Unique())
+        return false;
+    *sequence = m_Ring[m_Head].Sequence();
+    return true;
+}
+
+FrameRef FrameQueue::TakeOldest(uint64_t sequence)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Count == 0 || m_Ring[m_Head].Sequence() != sequence || !m_Ring[m_Head].Unique())
+        return FrameRef();
+
+    FrameRef frame = std::move(m_Ring[m_Head]);
+    m_Head = (m_Head + 1) % (int)m_Ring.size();
+    m_Count--;
+    return frame;
+}
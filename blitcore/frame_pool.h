@@ -0,0 +1,211 @@
+// Reference-counted pool of preallocated frame buffers (platform independent)
+// A frame is written once and then shared by reference with any number of consumers (present,
+// recorder, snapshot, a second display), never copied per consumer. Every buffer carries an
+// intrusive atomic count and returns to the pool when its last FrameRef lets go.
+// When every buffer is in use, Acquire follows the pool's exhaustion policy:
+//   POOL_BLOCK        wait for a consumer to release one
+//   POOL_DROP_OLDEST  take back the oldest frame still waiting, unread, in a FrameQueue and
+//                     referenced nowhere else (dropping a shared one would free nothing)
+//   POOL_GROW         allocate another buffer, up to maxBuffers
+// and waits (up to the caller's timeout) when its policy cannot free anything.
+
+#pragma once
+
+#include "frame_memory.h"
+#include "image_view.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+class FramePool;
+class FrameQueue;
+
+enum FramePoolPolicy
+{
+    POOL_BLOCK,
+    POOL_DROP_OLDEST,
+    POOL_GROW
+};
+
+struct FramePoolConfig
+{
+    int width = 0;
+    int height = 0;
+    int buffers = 3;            // Allocated by Create
+    int maxBuffers = 3;         // POOL_GROW ceiling
+    FramePoolPolicy policy = POOL_BLOCK;
+};
+
+struct FramePoolStats
+{
+    uint64_t acquired = 0;
+    uint64_t waited = 0;        // Acquires that had to wait for a release
+    uint64_t dropped = 0;       // Queued frames reclaimed under POOL_DROP_OLDEST
+    uint64_t grown = 0;         // Buffers added under POOL_GROW
+    uint64_t failed = 0;        // Acquires that timed out
+};
+
+// Backing store for pooled pixels. The default is FrameMemory (large pages, prefaulted,
+// alias-free pitch); front-ends that must draw with a graphics API supply their own.
+class FrameAllocator
+{
+public:
+    virtual ~FrameAllocator() {}
+    // Fills buffer and may keep per-buffer state (e.g. a device context) in *user
+    virtual bool Allocate(int width, int height, FrameBuffer* buffer, void** user) = 0;
+    virtual void Free(FrameBuffer* buffer, void* user) = 0;
+};
+
+class FrameMemoryAllocator : public FrameAllocator
+{
+public:
+    bool Allocate(int width, int height, FrameBuffer* buffer, void** user) override;
+    void Free(FrameBuffer* buffer, void* user) override;
+
+    const FrameMemoryStats& Stats() const { return m_Memory.Stats(); }
+
+private:
+    FrameMemory m_Memory;
+};
+
+// One pooled buffer; owned by its FramePool
+struct PooledFrame
+{
+    FrameBuffer buffer;
+    void* user = nullptr;
+    uint64_t sequence = 0;      // Producer's frame number for the pixels it holds (0 = never written)
+    std::atomic<int> refs{0};
+    FramePool* pool = nullptr;
+};
+
+// Counted reference to a pooled frame: copies share the buffer, the last one returns it
+class FrameRef
+{
+public:
+    FrameRef() = default;
+    FrameRef(const FrameRef& other);
+    FrameRef(FrameRef&& other) noexcept : m_Frame(other.m_Frame) { other.m_Frame = nullptr; }
+    FrameRef& operator=(const FrameRef& other);
+    FrameRef& operator=(FrameRef&& other) noexcept;
+    ~FrameRef() { Reset(); }
+
+    void Reset();
+
+    explicit operator bool() const { return m_Frame != nullptr; }
+    bool SameBuffer(const FrameRef& other) const { return m_Frame == other.m_Frame; }
+
+    // Sole holder: the only state in which the buffer may be written
+    bool Unique() const { return m_Frame && m_Frame->refs.load(std::memory_order_acquire) == 1; }
+
+    int Width() const { return m_Frame->buffer.width; }
+    int Height() const { return m_Frame->buffer.height; }
+    int Pitch() const { return m_Frame->buffer.pitch; }
+    void* User() const { return m_Frame->user; }
+
+    uint64_t Sequence() const { return m_Frame->sequence; }
+    void SetSequence(uint64_t sequence) { m_Frame->sequence = sequence; }
+
+    // Typed views of the pixels; pitch is in bytes
+    template <typename T>
+    T* Row(int y) const { return (T*)(m_Frame->buffer.data + (intptr_t)y * m_Frame->buffer.pitch); }
+    template <typename T>
+    T* Pixels() const { return (T*)m_Frame->buffer.data; }
+    template <typename Format>
+    ImageView<Format> View() const
+    {
+        return ImageView<Format>(m_Frame->buffer.data, m_Frame->buffer.width, m_Frame->buffer.height, m_Frame->buffer.pitch);
+    }
+
+private:
+    friend class FramePool;
+
+    // Adopts a reference the pool already counted
+    explicit FrameRef(PooledFrame* frame) : m_Frame(frame) {}
+
+    // Reset that reports whether this was the last reference, i.e. the buffer went back to the pool
+    bool Release();
+
+    PooledFrame* m_Frame = nullptr;
+};
+
+class FramePool
+{
+public:
+    FramePool() = default;
+    ~FramePool() { Destroy(); }
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // Allocates config.buffers frames; allocator defaults to FrameMemory and must outlive the pool
+    bool Create(const FramePoolConfig& config, FrameAllocator* allocator = nullptr);
+
+    // Every FrameRef and FrameQueue must be gone first
+    void Destroy();
+
+    // A buffer no one references, holding whatever it last held (see Sequence()).
+    // timeoutNs < 0 waits indefinitely, 0 never waits. Empty on timeout.
+    FrameRef Acquire(int64_t timeoutNs = -1);
+
+    int Capacity() const;
+    int FreeCount() const;
+    FramePoolStats Stats() const;
+
+private:
+    friend class FrameRef;
+    friend class FrameQueue;
+
+    PooledFrame* AddFrame();
+    void Recycle(PooledFrame* frame);
+    bool DropOldestQueued();
+
+    FramePoolConfig m_Config;
+    FrameAllocator* m_Allocator = nullptr;
+    FrameMemoryAllocator m_DefaultAllocator;
+    std::vector<PooledFrame*> m_Frames;
+    std::vector<PooledFrame*> m_Free;       // LIFO: the buffer just released is the warmest
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_Released;
+    FramePoolStats m_Stats;
+
+    std::mutex m_QueueMutex;                // Taken before any FrameQueue's own lock
+    std::vector<FrameQueue*> m_Queues;
+};
+
+// Bounded FIFO of frames for one asynchronous consumer. Push adds a reference, not a copy;
+// a full queue drops its oldest frame, and under POOL_DROP_OLDEST the pool may reclaim the
+// oldest frame at the head of any queue that only the queue still references.
+class FrameQueue
+{
+public:
+    FrameQueue(FramePool* pool, int capacity);
+    ~FrameQueue();
+
+    FrameQueue(const FrameQueue&) = delete;
+    FrameQueue& operator=(const FrameQueue&) = delete;
+
+    // Returns false when an older frame was dropped to make room
+    bool Push(const FrameRef& frame);
+
+    // Oldest frame; waits up to timeoutNs (< 0 indefinitely). Empty on timeout.
+    FrameRef Pop(int64_t timeoutNs = 0);
+
+    int Size() const;
+
+private:
+    friend class FramePool;
+
+    bool OldestReclaimable(uint64_t* sequence) const;
+    FrameRef TakeOldest(uint64_t sequence);
+
+    FramePool* m_Pool;
+    std::vector<FrameRef> m_Ring;
+    int m_Head = 0;
+    int m_Count = 0;
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_Pushed;
+};
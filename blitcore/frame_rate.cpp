@@ -0,0 +1,106 @@
+// Capture/present rate handling - see frame_rate.h
+
+#include "frame_rate.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+bool ParseFrameRateOption(const char* cmdLine, const char* name, FrameRate* rate)
+{
+    if (!cmdLine || !name)
+        return false;
+
+    size_t nameLen = strlen(name);
+    for (const char* p = strstr(cmdLine, "--"); p; p = strstr(p + 2, "--"))
+    {
+        if (strncmp(p + 2, name, nameLen) != 0 || p[2 + nameLen] != '=')
+            continue;
+
+        char* end = nullptr;
+        double hz = strtod(p + 3 + nameLen, &end);
+        if (end == p + 3 + nameLen || hz <= 0.0 || hz > 1000.0)
+            return false;
+
+        // Millihertz precision covers 59.94 / 143.856 style rates exactly enough
+        rate->num = (uint32_t)(hz * 1000.0 + 0.5);
+        rate->den = 1000;
+        return true;
+    }
+    return false;
+}
+
+FrameRate FrameRateFromHz(uint32_t hz)
+{
+    FrameRate rate;
+    if (hz <= 1)
+        return rate;
+
+    if (hz == 23 || hz == 29 || hz == 59 || hz == 119 || hz == 143 || hz == 239)
+    {
+        rate.num = (hz + 1) * 1000;
+        rate.den = 1001;
+    }
+    else
+    {
+        rate.num = hz;
+        rate.den = 1;
+    }
+    return rate;
+}
+
+RateConverter::RateConverter(FrameRate captureRate, FrameRate presentRate)
+    : m_CaptureRate(captureRate.IsValid() ? captureRate : FrameRate())
+    , m_PresentRate(presentRate.IsValid() ? presentRate : FrameRate())
+{
+}
+
+void RateConverter::Reset(int64_t originNs)
+{
+    m_OriginNs = originNs;
+    m_LastCaptureIndex = -1;
+    m_Started = true;
+}
+
+bool RateConverter::OnPresentTick(int64_t presentTimeNs)
+{
+    if (!m_Started)
+        Reset(presentTimeNs);
+
+    m_Stats.presentTicks++;
+
+    // Index of the latest capture tick at or before this present:
+    // floor(elapsed * num / (den * 1e9)), split per whole second so days of uptime cannot overflow
+    int64_t elapsed = presentTimeNs - m_OriginNs;
+    int64_t captureIndex = -1;
+    if (elapsed >= 0)
+    {
+        int64_t seconds = elapsed / 1000000000;
+        int64_t remainderNs = elapsed % 1000000000;
+        int64_t wholeTicks = seconds * m_CaptureRate.num;
+        captureIndex = wholeTicks / m_CaptureRate.den
+            + ((wholeTicks % m_CaptureRate.den) * 1000000000 + remainderNs * m_CaptureRate.num)
+              / ((int64_t)m_CaptureRate.den * 1000000000);
+    }
+
+    if (captureIndex <= m_LastCaptureIndex)
+    {
+        m_Stats.repeated++;
+        return false;
+    }
+
+    if (m_LastCaptureIndex >= 0)
+        m_Stats.dropped += (uint64_t)(captureIndex - m_LastCaptureIndex - 1);
+    m_LastCaptureIndex = captureIndex;
+    m_Stats.captures++;
+    return true;
+}
+
+bool BudgetMonitor::AddFrame(int64_t workNs)
+{
+    m_Work.AddSample(workNs);
+    if (m_Reported || !OverBudget())
+        return false;
+
+    m_Reported = true;
+    return true;
+}
@@ -0,0 +1,84 @@
+// Capture/present rate handling (platform independent)
+// Capture and present run on independent clocks; RateConverter decides per present tick, from
+// timestamps alone, whether a new capture is due (otherwise the previous frame repeats).
+
+#pragma once
+
+#include <stdint.h>
+
+#include "vsync_scheduler.h"
+
+// Rational refresh rate in Hz (matches DXGI_RATIONAL, e.g. 60000/1001)
+struct FrameRate
+{
+    uint32_t num = 60;
+    uint32_t den = 1;
+
+    double Hz() const { return den ? (double)num / den : 0.0; }
+    int64_t PeriodNs() const { return num ? (int64_t)den * 1000000000 / num : 0; }
+    bool IsValid() const { return num > 0 && den > 0; }
+};
+
+// Reads "--<name>=<hz>" (e.g. --capture-hz=143.856) from a command line.
+// Returns false and leaves rate untouched if the option is absent or malformed.
+bool ParseFrameRateOption(const char* cmdLine, const char* name, FrameRate* rate);
+
+// Integer Hz from display settings (dmDisplayFrequency); 59/119/143 style values are the
+// fractional NTSC-derived modes and map to N*1000/1001
+FrameRate FrameRateFromHz(uint32_t hz);
+
+struct RateConverterStats
+{
+    uint64_t presentTicks = 0;
+    uint64_t captures = 0;
+    uint64_t repeated = 0;     // Present ticks that showed the previous capture again
+    uint64_t dropped = 0;      // Capture ticks that fell between two present ticks (never shown)
+};
+
+class RateConverter
+{
+public:
+    RateConverter(FrameRate captureRate, FrameRate presentRate);
+
+    void Reset(int64_t originNs);
+
+    // Called once per present tick; returns true if a capture is due before presenting.
+    // Capture ticks are origin + n * capturePeriod; the latest tick not after presentTimeNs wins,
+    // so repeats and drops follow a fixed cadence (e.g. 60->144: shown 3,2,3,2,2...; 144->60: drop 1,1,2,1,2...).
+    bool OnPresentTick(int64_t presentTimeNs);
+
+    FrameRate CaptureRate() const { return m_CaptureRate; }
+    FrameRate PresentRate() const { return m_PresentRate; }
+    const RateConverterStats& Stats() const { return m_Stats; }
+
+private:
+    FrameRate m_CaptureRate;
+    FrameRate m_PresentRate;
+    int64_t m_OriginNs = 0;
+    int64_t m_LastCaptureIndex = -1;
+    bool m_Started = false;
+    RateConverterStats m_Stats;
+};
+
+// Watches per-frame processing time against the present period and reports once
+// when the configuration cannot sustain its rate on this machine
+class BudgetMonitor
+{
+public:
+    explicit BudgetMonitor(int64_t budgetNs) : m_BudgetNs(budgetNs) {}
+
+    void SetBudget(int64_t budgetNs) { m_BudgetNs = budgetNs; m_Reported = false; }
+
+    // Returns true exactly once, when p99 work time first exceeds the budget
+    // after a full sample window (so start-up hitches are not reported)
+    bool AddFrame(int64_t workNs);
+
+    int64_t BudgetNs() const { return m_BudgetNs; }
+    int64_t PredictedWorkNs() const { return m_Work.PredictedNs(); }
+    bool OverBudget() const { return m_Work.Count() >= WorkTimeEstimator::WINDOW && m_Work.PredictedNs() > m_BudgetNs; }
+
+private:
+    int64_t m_BudgetNs;
+    WorkTimeEstimator m_Work;
+    bool m_Reported = false;
+};
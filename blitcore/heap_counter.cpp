@@ -0,0 +1,68 @@
+// Debug operator new counting hook - see heap_counter.h
+
+#include "heap_counter.h"
+
+#ifdef BLITCORE_COUNT_ALLOCATIONS
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <new>
+
+static std::atomic<uint64_t> g_HeapAllocations(0);
+
+void* operator new(size_t size)
+{
+    g_HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    g_HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { free(p); }
+
+uint64_t HeapAllocationCount()
+{
+    return g_HeapAllocations.load(std::memory_order_relaxed);
+}
+
+bool HeapAllocationCountingEnabled()
+{
+    return true;
+}
+
+#else
+
+uint64_t HeapAllocationCount()
+{
+    return 0;
+}
+
+bool HeapAllocationCountingEnabled()
+{
+    return false;
+}
+
+#endif
@@ -0,0 +1,14 @@
+// Debug count of global operator new calls, for checking that steady-state frames do not
+// allocate (platform independent)
+// Only active when the library is built with BLITCORE_COUNT_ALLOCATIONS (CMakeLists.txt defines it
+// in Debug builds): heap_counter.cpp then replaces the global new/delete operators with
+// malloc/free wrappers that bump one relaxed atomic. Over-aligned new is not counted.
+
+#pragma once
+
+#include <stdint.h>
+
+// Global operator new calls since startup (all threads); always 0 when counting is compiled out
+uint64_t HeapAllocationCount();
+
+bool HeapAllocationCountingEnabled();
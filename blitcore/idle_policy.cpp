@@ -0,0 +1,103 @@
+// Idle policy - see idle_policy.h
+
+#include "idle_policy.h"
+
+#include <string.h>
+
+IdlePolicy::IdlePolicy(const IdlePolicyConfig& config)
+    : m_Config(config)
+{
+}
+
+void IdlePolicy::OnInput(int64_t nowNs)
+{
+    m_LastActivityNs = nowNs;
+    m_Divisor = 1;
+    m_ForcePresent = true;
+}
+
+void IdlePolicy::Reset(int64_t nowNs)
+{
+    // Same effect as input: the throttle restarts its quiet period from the rebuild
+    OnInput(nowNs);
+}
+
+bool IdlePolicy::Update(bool contentChanged, bool cursorChanged, int64_t nowNs)
+{
+    if (!m_Started)
+    {
+        m_Started = true;
+        m_LastActivityNs = nowNs;
+        m_LastUpdateNs = nowNs;
+    }
+
+    if (m_Divisor > 1)
+        m_Stats.throttledNs += nowNs - m_LastUpdateNs;
+    m_LastUpdateNs = nowNs;
+
+    if (contentChanged || cursorChanged || m_ForcePresent)
+    {
+        if (contentChanged || cursorChanged)
+            m_LastActivityNs = nowNs;
+        m_ForcePresent = false;
+        m_Divisor = 1;
+        m_Stats.presented++;
+        return true;
+    }
+
+    m_Stats.skipped++;
+
+    // Gradual ramp: 1/2 rate after the quiet period, then halve again every step period
+    int64_t quietNs = nowNs - m_LastActivityNs;
+    if (quietNs < m_Config.quietPeriodNs)
+    {
+        m_Divisor = 1;
+        return false;
+    }
+
+    int64_t steps = 1;
+    if (m_Config.stepPeriodNs > 0)
+        steps += (quietNs - m_Config.quietPeriodNs) / m_Config.stepPeriodNs;
+
+    int divisor = 1;
+    while (steps-- > 0 && divisor < m_Config.maxDivisor)
+        divisor *= 2;
+    m_Divisor = divisor < m_Config.maxDivisor ? divisor : m_Config.maxDivisor;
+    return false;
+}
+
+uint64_t HashFrameRegion(const void* pixels, int widthBytes, int height, int pitchBytes)
+{
+    const uint64_t prime = 0x9E3779B97F4A7C15ull;
+    uint64_t h0 = 1, h1 = 2, h2 = 3, h3 = 4;
+
+    for (int y = 0; y < height; y++)
+    {
+        const uint8_t* row = (const uint8_t*)pixels + (intptr_t)y * pitchBytes;
+        int x = 0;
+
+        for (; x + 32 <= widthBytes; x += 32)
+        {
+            uint64_t v[4];
+            memcpy(v, row + x, sizeof(v));
+            h0 = (h0 ^ v[0]) * prime;
+            h1 = (h1 ^ v[1]) * prime;
+            h2 = (h2 ^ v[2]) * prime;
+            h3 = (h3 ^ v[3]) * prime;
+        }
+
+        for (; x < widthBytes; x++)
+        {
+            h0 = (h0 ^ row[x]) * prime;
+        }
+
+        // Fold row boundaries in so equal bytes shifted between rows still differ
+        h1 ^= (uint64_t)y;
+    }
+
+    uint64_t h = h0;
+    h = (h ^ h1) * prime;
+    h = (h ^ h2) * prime;
+    h = (h ^ h3) * prime;
+    return h ^ (h >> 32);
+}
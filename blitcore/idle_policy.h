@@ -0,0 +1,55 @@
+// Idle policy (platform independent)
+// Skips composite + present when neither content nor cursor changed, and after a quiet period
+// lowers the polling rate step by step. Any change or input snaps straight back to full rate.
+
+#pragma once
+
+#include <stdint.h>
+
+struct IdlePolicyConfig
+{
+    int64_t quietPeriodNs = 2000000000;    // No changes for this long before slowing down
+    int64_t stepPeriodNs = 1000000000;     // Each further quiet interval halves the rate again
+    int maxDivisor = 16;                   // Slowest poll = base rate / maxDivisor (~4 Hz at 60 Hz)
+};
+
+struct IdlePolicyStats
+{
+    uint64_t presented = 0;
+    uint64_t skipped = 0;          // Polls where nothing changed (no composite, no present)
+    int64_t throttledNs = 0;       // Total time spent below full rate
+};
+
+class IdlePolicy
+{
+public:
+    explicit IdlePolicy(const IdlePolicyConfig& config = IdlePolicyConfig());
+
+    // Record one poll. Returns true when the frame must be composited and presented.
+    bool Update(bool contentChanged, bool cursorChanged, int64_t nowNs);
+
+    // Input or control event: back to full rate immediately, present on the next poll
+    void OnInput(int64_t nowNs);
+
+    // The output surface was rebuilt (device, swap chain, staging texture, frame buffers): what is on
+    // screen no longer matches the last present, so the next poll presents whatever changed
+    void Reset(int64_t nowNs);
+
+    // Number of base frame periods until the next poll (1 = full rate)
+    int PollDivisor() const { return m_Divisor; }
+    bool IsThrottled() const { return m_Divisor > 1; }
+    const IdlePolicyStats& Stats() const { return m_Stats; }
+
+private:
+    IdlePolicyConfig m_Config;
+    int64_t m_LastActivityNs = 0;
+    int64_t m_LastUpdateNs = 0;
+    int m_Divisor = 1;
+    bool m_ForcePresent = true;    // First frame (and after input) always presents
+    bool m_Started = false;
+    IdlePolicyStats m_Stats;
+};
+
+// Fast 64-bit signature of a pixel region, for sources without damage information (GDI).
+// Reads every byte; four independent multiply lanes keep it memory bound.
+uint64_t HashFrameRegion(const void* pixels, int widthBytes, int height, int pitchBytes);
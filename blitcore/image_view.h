@@ -0,0 +1,316 @@
+// Typed, non-owning views of pixel memory (platform independent, header only)
+// One description of a layout instead of hand-rolled index math at every call site: a pointer,
+// a size and a pitch in bytes. The pitch may be negative (bottom-up DIBs: the view starts at the
+// last row in memory), and Sub() slices a rectangle without copying.
+// The format is a compile-time traits type, so kernels templated over ImageView<Format> compile
+// to straight loads and stores for each layout; HAS_ALPHA is a constant, so alpha handling folds
+// away for X formats. A const format (ImageView<const FormatBGRA8>) gives a read-only view.
+//
+// Formats (Pixel = one stored pixel, BGRA8 conversions for kernels that work in 8-bit BGRA):
+//   FormatBGRA8        B, G, R, A bytes               DXGI_FORMAT_B8G8R8A8_UNORM, 32-bit DIBs
+//   FormatBGRX8        B, G, R, unused                DXGI_FORMAT_B8G8R8X8_UNORM
+//   FormatRGB565       R5 G6 B5 in 16 bits            DXGI_FORMAT_B5G6R5_UNORM, 16-bit DIBs
+//   FormatR10G10B10A2  R10 G10 B10 A2, R lowest       DXGI_FORMAT_R10G10B10A2_UNORM
+//   FormatRGBA16F      four halfs, scRGB linear       DXGI_FORMAT_R16G16B16A16_FLOAT (HDR desktops)
+//   FormatNV12Y / FormatNV12UV  luma plane, then interleaved half-resolution chroma (see Nv12Image)
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <type_traits>
+
+#include "linear_light.h"
+
+// IEEE half <-> float (round to nearest even; no signalling NaNs in pixel data)
+inline float HalfToFloat(uint16_t h)
+{
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1F;
+    uint32_t mantissa = h & 0x3FF;
+    uint32_t bits;
+    if (exponent == 0x1F)
+    {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else if (exponent)
+    {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    else
+    {
+        // Subnormal: mantissa * 2^-24
+        float f = (float)mantissa * (1.0f / 16777216.0f);
+        return sign ? -f : f;
+    }
+    float f;
+    memcpy(&f, &bits, 4);
+    return f;
+}
+
+inline uint16_t FloatToHalf(float f)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, 4);
+    uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    uint32_t absBits = bits & 0x7FFFFFFF;
+    if (absBits >= 0x7F800000)
+        return sign | 0x7C00 | (absBits > 0x7F800000 ? 0x200 : 0);  // Inf / NaN
+    if (absBits >= 0x477FF000)
+        return sign | 0x7C00;                                       // Overflow to Inf
+    if (absBits < 0x38800000)
+    {
+        // Subnormal half (or zero): round mantissa * 2^24
+        float a;
+        memcpy(&a, &absBits, 4);
+        float scaled = a * 16777216.0f;
+        uint32_t m = (uint32_t)scaled;
+        float rest = scaled - (float)m;
+        if (rest > 0.5f || (rest == 0.5f && (m & 1)))
+            m++;
+        return sign | (uint16_t)m;
+    }
+    uint32_t rounded = absBits - 0x38000000 + 0xFFF + ((absBits >> 13) & 1);
+    return sign | (uint16_t)(rounded >> 13);
+}
+
+struct FormatBGRA8
+{
+    typedef uint32_t Pixel;
+    static constexpr bool HAS_ALPHA = true;
+    static uint32_t ToBgra8(Pixel p) { return p; }
+    static Pixel FromBgra8(uint32_t c) { return c; }
+};
+
+struct FormatBGRX8
+{
+    typedef uint32_t Pixel;
+    static constexpr bool HAS_ALPHA = false;
+    static uint32_t ToBgra8(Pixel p) { return p | 0xFF000000u; }
+    static Pixel FromBgra8(uint32_t c) { return c; }   // The X byte is don't-care
+};
+
+struct FormatRGB565
+{
+    typedef uint16_t Pixel;
+    static constexpr bool HAS_ALPHA = false;
+    static uint32_t ToBgra8(Pixel p)
+    {
+        uint32_t r = (p >> 11) & 0x1F, g = (p >> 5) & 0x3F, b = p & 0x1F;
+        r = (r << 3) | (r >> 2);
+        g = (g << 2) | (g >> 4);
+        b = (b << 3) | (b >> 2);
+        return 0xFF000000u | (r << 16) | (g << 8) | b;
+    }
+    static Pixel FromBgra8(uint32_t c)
+    {
+        // Rounded: (v * max + 127) / 255
+        uint32_t r = (((c >> 16) & 0xFF) * 31 + 127) / 255;
+        uint32_t g = (((c >> 8) & 0xFF) * 63 + 127) / 255;
+        uint32_t b = ((c & 0xFF) * 31 + 127) / 255;
+        return (Pixel)((r << 11) | (g << 5) | b);
+    }
+};
+
+struct FormatR10G10B10A2
+{
+    typedef uint32_t Pixel;
+    static constexpr bool HAS_ALPHA = true;
+    static uint32_t ToBgra8(Pixel p)
+    {
+        uint32_t r = ((p & 0x3FF) * 255 + 511) / 1023;
+        uint32_t g = (((p >> 10) & 0x3FF) * 255 + 511) / 1023;
+        uint32_t b = (((p >> 20) & 0x3FF) * 255 + 511) / 1023;
+        uint32_t a = (p >> 30) * 85;
+        return (a << 24) | (r << 16) | (g << 8) | b;
+    }
+    static Pixel FromBgra8(uint32_t c)
+    {
+        uint32_t r = ((c >> 16) & 0xFF) * 1023 / 255;  // 0 -> 0, 255 -> 1023, never more than 0.02 low
+        uint32_t g = ((c >> 8) & 0xFF) * 1023 / 255;
+        uint32_t b = (c & 0xFF) * 1023 / 255;
+        uint32_t a = ((c >> 24) * 3 + 127) / 255;
+        return r | (g << 10) | (b << 20) | (a << 30);
+    }
+};
+
+struct HalfPixel
+{
+    uint16_t r, g, b, a;
+};
+
+struct FormatRGBA16F
+{
+    typedef HalfPixel Pixel;
+    static constexpr bool HAS_ALPHA = true;
+
+    // scRGB is linear with 1.0 = SDR white; values outside 0..1 clip
+    static uint32_t ToBgra8(const Pixel& p)
+    {
+        const LinearLightTables& t = GetLinearLightTables();
+        return ((uint32_t)LinearToAlpha(ToLinear(p.a)) << 24) |
+               ((uint32_t)LinearToSrgb(t, ToLinear(p.r)) << 16) |
+               ((uint32_t)LinearToSrgb(t, ToLinear(p.g)) << 8) |
+               LinearToSrgb(t, ToLinear(p.b));
+    }
+    static Pixel FromBgra8(uint32_t c)
+    {
+        const LinearLightTables& t = GetLinearLightTables();
+        const float scale = 1.0f / LINEAR_LIGHT_MAX;
+        Pixel p;
+        p.r = FloatToHalf(t.toLinear[(c >> 16) & 0xFF] * scale);
+        p.g = FloatToHalf(t.toLinear[(c >> 8) & 0xFF] * scale);
+        p.b = FloatToHalf(t.toLinear[c & 0xFF] * scale);
+        p.a = FloatToHalf((c >> 24) * (1.0f / 255.0f));
+        return p;
+    }
+
+private:
+    static uint32_t ToLinear(uint16_t h)
+    {
+        float v = HalfToFloat(h);
+        if (!(v > 0.0f))
+            return 0;   // Negatives and NaN
+        return v >= 1.0f ? LINEAR_LIGHT_MAX : (uint32_t)(v * LINEAR_LIGHT_MAX + 0.5f);
+    }
+};
+
+// NV12: width x height luma bytes, then (width / 2) x (height / 2) interleaved U, V pairs at the
+// same pitch. Video data, so there is no BGRA8 conversion here.
+struct FormatNV12Y
+{
+    typedef uint8_t Pixel;
+    static constexpr bool HAS_ALPHA = false;
+};
+
+struct ChromaPair
+{
+    uint8_t u, v;
+};
+
+struct FormatNV12UV
+{
+    typedef ChromaPair Pixel;
+    static constexpr bool HAS_ALPHA = false;
+};
+
+template <typename Format>
+class ImageView
+{
+public:
+    typedef typename std::remove_const<Format>::type Traits;
+    typedef typename std::conditional<std::is_const<Format>::value,
+                                      const typename Traits::Pixel, typename Traits::Pixel>::type Pixel;
+    typedef typename std::conditional<std::is_const<Format>::value, const uint8_t, uint8_t>::type Byte;
+
+    ImageView() = default;
+
+    // Top-down memory, or any layout once data points at row 0 and pitch steps to row 1
+    ImageView(void* data, int width, int height, ptrdiff_t pitch)
+        : m_Data((Byte*)data), m_Width(width), m_Height(height), m_Pitch(pitch) {}
+    ImageView(const void* data, int width, int height, ptrdiff_t pitch)
+        : m_Data((Byte*)data), m_Width(width), m_Height(height), m_Pitch(pitch)
+    {
+        static_assert(std::is_const<Format>::value, "read-only memory needs a const format");
+    }
+
+    // Writable views convert to read-only ones
+    template <typename Other, typename = typename std::enable_if<
+        std::is_const<Format>::value && std::is_same<const Other, Format>::value>::type>
+    ImageView(const ImageView<Other>& other)
+        : m_Data(other.Data()), m_Width(other.Width()), m_Height(other.Height()), m_Pitch(other.Pitch()) {}
+
+    // Bottom-up memory (positive-height DIBs): base is the lowest address, which holds the last row
+    static ImageView BottomUp(Byte* base, int width, int height, ptrdiff_t pitch)
+    {
+        return ImageView(base + (ptrdiff_t)(height - 1) * pitch, width, height, -pitch);
+    }
+
+    Byte* Data() const { return m_Data; }
+    int Width() const { return m_Width; }
+    int Height() const { return m_Height; }
+    ptrdiff_t Pitch() const { return m_Pitch; }
+    bool Empty() const { return m_Width <= 0 || m_Height <= 0; }
+
+    Pixel* Row(int y) const { return (Pixel*)(m_Data + (ptrdiff_t)y * m_Pitch); }
+    Pixel& At(int x, int y) const { return Row(y)[x]; }
+
+    // Rectangle clipped to the view (empty when they do not overlap); shares the pixels
+    ImageView Sub(int x, int y, int width, int height) const
+    {
+        int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+        int x1 = x + width < m_Width ? x + width : m_Width;
+        int y1 = y + height < m_Height ? y + height : m_Height;
+        if (x1 <= x0 || y1 <= y0)
+            return ImageView(m_Data, 0, 0, m_Pitch);
+        return ImageView(m_Data + (ptrdiff_t)y0 * m_Pitch + (ptrdiff_t)x0 * sizeof(Pixel), x1 - x0, y1 - y0, m_Pitch);
+    }
+
+    // Every row starts on an alignment-byte boundary (lets kernels take aligned SIMD paths)
+    bool RowsAligned(size_t alignment) const
+    {
+        return ((uintptr_t)m_Data % alignment) == 0 && ((size_t)(m_Pitch < 0 ? -m_Pitch : m_Pitch) % alignment) == 0;
+    }
+
+    // No padding between rows: the view is one run of Width() * Height() pixels
+    bool Contiguous() const { return m_Pitch == (ptrdiff_t)(m_Width * sizeof(Pixel)); }
+
+private:
+    Byte* m_Data = nullptr;
+    int m_Width = 0;
+    int m_Height = 0;
+    ptrdiff_t m_Pitch = 0;
+};
+
+// Both NV12 planes of one picture; chroma follows the luma rows at the same pitch
+template <bool Const = false>
+struct Nv12Image
+{
+    typedef typename std::conditional<Const, const FormatNV12Y, FormatNV12Y>::type LumaFormat;
+    typedef typename std::conditional<Const, const FormatNV12UV, FormatNV12UV>::type ChromaFormat;
+    typedef typename ImageView<LumaFormat>::Byte Byte;
+
+    ImageView<LumaFormat> y;
+    ImageView<ChromaFormat> uv;
+
+    Nv12Image() = default;
+    Nv12Image(Byte* base, int width, int height, ptrdiff_t pitch)
+        : y(base, width, height, pitch),
+          uv(base + (ptrdiff_t)height * pitch, width / 2, height / 2, pitch) {}
+};
+
+// Every pixel of view set to one BGRA8 colour, converted once
+template <typename Format>
+void FillView(const ImageView<Format>& view, uint32_t bgra)
+{
+    typename Format::Pixel value = Format::FromBgra8(bgra);
+    for (int y = 0; y < view.Height(); y++)
+    {
+        typename Format::Pixel* row = view.Row(y);
+        for (int x = 0; x < view.Width(); x++)
+            row[x] = value;
+    }
+}
+
+// Pixels converted through BGRA8 (a plain row copy when the formats match)
+template <typename SrcFormat, typename DstFormat>
+void ConvertView(const ImageView<SrcFormat>& src, const ImageView<DstFormat>& dst)
+{
+    typedef typename std::remove_const<SrcFormat>::type SrcTraits;
+    int width = src.Width() < dst.Width() ? src.Width() : dst.Width();
+    int height = src.Height() < dst.Height() ? src.Height() : dst.Height();
+    for (int y = 0; y < height; y++)
+    {
+        const typename SrcTraits::Pixel* in = src.Row(y);
+        typename DstFormat::Pixel* out = dst.Row(y);
+        if (std::is_same<SrcTraits, DstFormat>::value)
+        {
+            memcpy((void*)out, (const void*)in, (size_t)width * sizeof(*out));
+            continue;
+        }
+        for (int x = 0; x < width; x++)
+            out[x] = DstFormat::FromBgra8(SrcTraits::ToBgra8(in[x]));
+    }
+}
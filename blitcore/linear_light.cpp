@@ -0,0 +1,139 @@
+// Linear-light pixel conversion - see linear_light.h
+
+#include "linear_light.h"
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLITCORE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+static double SrgbDecode(double v)
+{
+    return v <= 0.04045 ? v / 12.92 : pow((v + 0.055) / 1.055, 2.4);
+}
+
+static double SrgbEncode(double v)
+{
+    return v <= 0.0031308 ? v * 12.92 : 1.055 * pow(v, 1.0 / 2.4) - 0.055;
+}
+
+static LinearLightTables BuildTables()
+{
+    LinearLightTables tables;
+    for (int i = 0; i < 256; i++)
+    {
+        tables.toLinear[i] = (uint16_t)(SrgbDecode(i / 255.0) * LINEAR_LIGHT_MAX + 0.5);
+        tables.alphaToLinear[i] = (uint16_t)((i * LINEAR_LIGHT_MAX + 127) / 255);
+    }
+
+    // Each entry covers 8 linear steps; encode the bucket centre
+    for (int i = 0; i < 4096; i++)
+    {
+        double linear = (i * 8 + 3.5) / LINEAR_LIGHT_MAX;
+        if (linear > 1.0)
+            linear = 1.0;
+        tables.toSrgb[i] = (uint8_t)(SrgbEncode(linear) * 255.0 + 0.5);
+    }
+    return tables;
+}
+
+const LinearLightTables& GetLinearLightTables()
+{
+    static const LinearLightTables tables = BuildTables();
+    return tables;
+}
+
+void SrgbRowToLinear(const uint8_t* bgra, uint16_t* linear, int pixels)
+{
+    const LinearLightTables& t = GetLinearLightTables();
+    int i = 0;
+
+#ifdef BLITCORE_SSE2
+    // No gather in SSE2: eight table loads assembled into one 128-bit store per two pixels
+    for (; i + 2 <= pixels; i += 2)
+    {
+        const uint8_t* p = bgra + i * 4;
+        __m128i v = _mm_setr_epi16((short)t.toLinear[p[0]], (short)t.toLinear[p[1]],
+                                   (short)t.toLinear[p[2]], (short)t.alphaToLinear[p[3]],
+                                   (short)t.toLinear[p[4]], (short)t.toLinear[p[5]],
+                                   (short)t.toLinear[p[6]], (short)t.alphaToLinear[p[7]]);
+        _mm_storeu_si128((__m128i*)(linear + i * 4), v);
+    }
+#endif
+    for (; i < pixels; i++)
+    {
+        const uint8_t* p = bgra + i * 4;
+        linear[i * 4 + 0] = t.toLinear[p[0]];
+        linear[i * 4 + 1] = t.toLinear[p[1]];
+        linear[i * 4 + 2] = t.toLinear[p[2]];
+        linear[i * 4 + 3] = t.alphaToLinear[p[3]];
+    }
+}
+
+void LinearRowToSrgb(const uint16_t* linear, uint8_t* bgra, int pixels)
+{
+    const LinearLightTables& t = GetLinearLightTables();
+    int i = 0;
+
+#ifdef BLITCORE_SSE2
+    // Table indices for two pixels from one shift; only the lookups are scalar
+    for (; i + 2 <= pixels; i += 2)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(linear + i * 4));
+        __m128i index = _mm_srli_epi16(v, 3);
+        uint8_t* out = bgra + i * 4;
+        out[0] = t.toSrgb[_mm_extract_epi16(index, 0)];
+        out[1] = t.toSrgb[_mm_extract_epi16(index, 1)];
+        out[2] = t.toSrgb[_mm_extract_epi16(index, 2)];
+        out[3] = LinearToAlpha((uint32_t)_mm_extract_epi16(v, 3));
+        out[4] = t.toSrgb[_mm_extract_epi16(index, 4)];
+        out[5] = t.toSrgb[_mm_extract_epi16(index, 5)];
+        out[6] = t.toSrgb[_mm_extract_epi16(index, 6)];
+        out[7] = LinearToAlpha((uint32_t)_mm_extract_epi16(v, 7));
+    }
+#endif
+    for (; i < pixels; i++)
+    {
+        const uint16_t* v = linear + i * 4;
+        uint8_t* out = bgra + i * 4;
+        out[0] = LinearToSrgb(t, v[0]);
+        out[1] = LinearToSrgb(t, v[1]);
+        out[2] = LinearToSrgb(t, v[2]);
+        out[3] = LinearToAlpha(v[3]);
+    }
+}
+
+uint32_t BlendPremultipliedLinear(uint32_t src, uint32_t dest)
+{
+    uint32_t alpha = src >> 24;
+    if (alpha == 255)
+        return src;
+    if (src == 0)
+        return dest;
+
+    // Sprites are premultiplied in sRGB: recover the colour, then mix linear values
+    const LinearLightTables& t = GetLinearLightTables();
+    uint32_t k = 255 - alpha;
+    uint32_t result = 0xFF000000;
+    for (int shift = 0; shift < 24; shift += 8)
+    {
+        uint32_t s = (src >> shift) & 0xFF;
+        uint32_t d = (dest >> shift) & 0xFF;
+        uint32_t linear;
+        if (alpha == 0)
+        {
+            // Colour with zero alpha adds onto the screen
+            linear = t.toLinear[s] + t.toLinear[d];
+        }
+        else
+        {
+            uint32_t colour = (s * 255 + alpha / 2) / alpha;
+            uint32_t sLinear = colour > 255 ? LINEAR_LIGHT_MAX : t.toLinear[colour];
+            linear = (sLinear * alpha + t.toLinear[d] * k + 127) / 255;
+        }
+        result |= (uint32_t)LinearToSrgb(t, linear > LINEAR_LIGHT_MAX ? LINEAR_LIGHT_MAX : linear) << shift;
+    }
+    return result;
+}
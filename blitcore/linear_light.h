@@ -0,0 +1,42 @@
+// Linear-light (gamma-correct) pixel conversion (platform independent)
+// Averaging sRGB-encoded bytes darkens thin text and anti-aliased edges when downscaling; the
+// scalers and the cursor blend can instead work on 15-bit linear values (0..LINEAR_LIGHT_MAX,
+// kept below 2^15 so pairs of them still multiply-add in signed 16-bit SIMD lanes).
+// sRGB -> linear is an exact 256-entry table, linear -> sRGB a 4096-entry table indexed by the top
+// 12 bits (within 1 LSB of the exact curve). Alpha is already linear and only rescaled.
+// The table lookups are scalar loads (SSE2 has no gather, and pshufb only covers 16 entries);
+// SIMD is used for packing the results, the index shifts and the arithmetic around them.
+
+#pragma once
+
+#include <stdint.h>
+
+constexpr uint32_t LINEAR_LIGHT_MAX = 32767;
+
+struct LinearLightTables
+{
+    uint16_t toLinear[256];     // sRGB byte -> linear
+    uint16_t alphaToLinear[256];// Alpha byte -> same 0..LINEAR_LIGHT_MAX scale
+    uint8_t toSrgb[4096];       // Linear >> 3 -> sRGB byte
+};
+
+// Built once on first use
+const LinearLightTables& GetLinearLightTables();
+
+inline uint8_t LinearToSrgb(const LinearLightTables& tables, uint32_t linear)
+{
+    return tables.toSrgb[linear >> 3];
+}
+
+inline uint8_t LinearToAlpha(uint32_t linear)
+{
+    return (uint8_t)((linear * 255 + LINEAR_LIGHT_MAX / 2) / LINEAR_LIGHT_MAX);
+}
+
+// BGRA8 <-> four linear values per pixel
+void SrgbRowToLinear(const uint8_t* bgra, uint16_t* linear, int pixels);
+void LinearRowToSrgb(const uint16_t* linear, uint8_t* bgra, int pixels);
+
+// Premultiplied cursor pixel over an opaque destination, blended in linear light
+// (same contract as the sRGB blend: dest = src + dest * (255 - srcAlpha) / 255)
+uint32_t BlendPremultipliedLinear(uint32_t src, uint32_t dest);
@@ -0,0 +1,302 @@
+// Source -> output mirror pipeline - see mirror_pipeline.h
+
+#include "mirror_pipeline.h"
+#include "frame_pacer.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// The builder only gets time the frame threads leave idle, so on a busy (or single) core a
+// build stretches over a few frames instead of delaying one
+static void LowerBuilderPriority()
+{
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_IDLE);
+#elif defined(SCHED_IDLE)
+    sched_param param = {};
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+}
+
+MirrorPipeline::MirrorPipeline(MirrorSource* source, MirrorSink* sink, WorkerPool* workers, FrameClock* clock)
+    : m_Source(source)
+    , m_Sink(sink)
+    , m_Workers(workers)
+    , m_Clock(clock ? clock : GetSystemFrameClock())
+{
+    ReserveCursorSprite(&m_Cursor);
+}
+
+MirrorPipeline::~MirrorPipeline()
+{
+    Stop();
+
+    if (m_Builder.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_BuildMutex);
+            m_BuildStop = true;
+        }
+        m_BuildWake.notify_one();
+        m_Builder.join();
+    }
+
+    delete m_Retired;
+    delete m_Pending.exchange(nullptr);
+    delete m_Stage;
+}
+
+const FrameBuffer& MirrorPipeline::Output() const
+{
+    static const FrameBuffer s_None;
+    return m_Stage ? m_Stage->output : s_None;
+}
+
+const FrameMemoryStats& MirrorPipeline::MemoryStats() const
+{
+    static const FrameMemoryStats s_None;
+    return m_Stage ? m_Stage->memory.Stats() : s_None;
+}
+
+MirrorPipeline::Stage* MirrorPipeline::BuildStage(const MirrorGeometry& geometry, bool linearLight)
+{
+    Stage* stage = new Stage();
+    stage->geometry = geometry;
+    if (!stage->memory.Allocate(&stage->output, geometry.outputWidth, geometry.outputHeight) ||
+        !stage->composer.Configure(geometry.sourceWidth, geometry.sourceHeight, geometry.renderWidth,
+                                   geometry.renderHeight, geometry.outputWidth, geometry.outputHeight, linearLight))
+    {
+        delete stage;
+        return nullptr;
+    }
+    return stage;
+}
+
+bool MirrorPipeline::Configure(const MirrorGeometry& geometry, bool linearLight)
+{
+    if (IsRunning() || ReconfigurePending() || !geometry.IsValid())
+        return false;
+
+    Stage* stage = BuildStage(geometry, linearLight);
+    if (!stage)
+        return false;
+
+    delete m_Stage;
+    m_Stage = stage;
+    m_Geometry = geometry;
+    m_Capture = nullptr;
+    m_CapturePitch = 0;
+    m_CaptureHash = 0;
+    m_CursorState = MirrorCursor();
+    return true;
+}
+
+bool MirrorPipeline::Reconfigure(const MirrorGeometry& geometry, bool linearLight)
+{
+    if (!geometry.IsValid())
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_BuildMutex);
+        m_BuildGeometry = geometry;
+        m_BuildLinearLight = linearLight;
+        m_BuildRequested = true;
+        m_Building = true;
+        if (!m_Builder.joinable())
+            m_Builder = std::thread(&MirrorPipeline::BuilderMain, this);
+    }
+    m_BuildWake.notify_one();
+    return true;
+}
+
+bool MirrorPipeline::ReconfigurePending() const
+{
+    // Builder first: it publishes m_Pending before clearing m_Building under the lock, so once
+    // m_Building reads false the stage it built is visible (checked the other way round, a stage
+    // published between the two reads would be missed)
+    {
+        std::lock_guard<std::mutex> lock(m_BuildMutex);
+        if (m_Building)
+            return true;
+    }
+    return m_Pending.load(std::memory_order_acquire) != nullptr;
+}
+
+void MirrorPipeline::BuilderMain()
+{
+    LowerBuilderPriority();
+
+    std::unique_lock<std::mutex> lock(m_BuildMutex);
+    for (;;)
+    {
+        m_BuildWake.wait(lock, [this] { return m_BuildStop || m_BuildRequested || m_Retired; });
+        if (m_BuildStop)
+            return;
+
+        Stage* retired = m_Retired;
+        m_Retired = nullptr;
+        bool build = m_BuildRequested;
+        MirrorGeometry geometry = m_BuildGeometry;
+        bool linearLight = m_BuildLinearLight;
+        m_BuildRequested = false;
+        lock.unlock();
+
+        // Allocation, prefaulting and coefficient tables all happen here, off the frame thread
+        delete retired;
+        if (build)
+        {
+            Stage* stage = BuildStage(geometry, linearLight);
+            if (stage)
+                delete m_Pending.exchange(stage, std::memory_order_acq_rel);  // Superseded, never seen
+            else
+                m_BuildFailures.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        lock.lock();
+        if (build && !m_BuildRequested)
+            m_Building = false;
+    }
+}
+
+void MirrorPipeline::AdoptStage(Stage* stage)
+{
+    // Only this thread ever reads m_Stage, so once swapped the old stage is unreachable (the grace
+    // period is over) and the builder can free it
+    Stage* old = m_Stage;
+    m_Stage = stage;
+    m_Stats.reconfigurations++;
+    m_ForcePresent = true;
+
+    bool sourceMoved = !old ||
+        old->geometry.sourceX != stage->geometry.sourceX || old->geometry.sourceY != stage->geometry.sourceY ||
+        old->geometry.sourceWidth != stage->geometry.sourceWidth || old->geometry.sourceHeight != stage->geometry.sourceHeight;
+    m_Geometry = stage->geometry;
+    if (sourceMoved)
+    {
+        m_Capture = nullptr;
+        m_CaptureHash = 0;
+    }
+    m_Source->OnGeometryChanged(m_Geometry);
+    m_Sink->OnGeometryChanged(m_Geometry);
+
+    if (old)
+    {
+        Stage* unreclaimed;
+        {
+            std::lock_guard<std::mutex> lock(m_BuildMutex);
+            unreclaimed = m_Retired;
+            m_Retired = old;
+        }
+        m_BuildWake.notify_one();
+        delete unreclaimed;  // Two swaps before the builder woke; rare
+    }
+}
+
+bool MirrorPipeline::RunFrame(bool captureDue)
+{
+    Stage* next = m_Pending.exchange(nullptr, std::memory_order_acquire);
+    if (next)
+        AdoptStage(next);
+    if (!m_Stage)
+        return false;
+
+    m_Stats.polls++;
+    int64_t startNs = m_Clock->NowNs();
+
+    bool contentChanged = m_ForcePresent;
+    if (captureDue || !m_Capture)
+    {
+        const uint8_t* pixels = nullptr;
+        int pitch = 0;
+        if (m_Source->Capture(m_Geometry, &pixels, &pitch) && pixels)
+        {
+            // Sources without damage information are compared by signature
+            uint64_t hash = HashFrameRegion(pixels, m_Geometry.sourceWidth * 4, m_Geometry.sourceHeight, pitch);
+            contentChanged |= hash != m_CaptureHash || pixels != m_Capture;
+            m_Capture = pixels;
+            m_CapturePitch = pitch;
+            m_CaptureHash = hash;
+        }
+        else
+        {
+            m_Stats.captureFailures++;
+        }
+    }
+    if (!m_Capture)
+        return false;
+
+    MirrorCursor cursor = m_CursorState;
+    cursor.shapeChanged = false;
+    if (!m_Source->QueryCursor(&cursor, &m_Cursor))
+        cursor.visible = false;
+    bool cursorChanged = cursor.shapeChanged || cursor.visible != m_CursorState.visible ||
+                         cursor.x != m_CursorState.x || cursor.y != m_CursorState.y;
+    m_CursorState = cursor;
+
+    if (!m_Idle.Update(contentChanged, cursorChanged, startNs))
+        return false;
+    m_ForcePresent = false;
+
+    // Hotspot on the scaled position, sprite at its native size (as the GPU path draws it)
+    int cursorX = cursor.x - m_Geometry.sourceX;
+    int cursorY = cursor.y - m_Geometry.sourceY;
+    bool drawCursor = cursor.visible && m_Cursor.width > 0 &&
+                      cursorX >= 0 && cursorX < m_Geometry.sourceWidth &&
+                      cursorY >= 0 && cursorY < m_Geometry.sourceHeight;
+
+    FrameBuffer& output = m_Stage->output;
+    m_Stage->composer.Compose(m_Capture, m_CapturePitch, output.data, output.pitch,
+                              drawCursor ? &m_Cursor : nullptr,
+                              m_Geometry.ToRenderX(cursorX) - m_Cursor.hotspotX,
+                              m_Geometry.ToRenderY(cursorY) - m_Cursor.hotspotY, m_Workers);
+
+    if (!m_Sink->Present(output.data, output.pitch, m_Geometry.outputWidth, m_Geometry.outputHeight))
+    {
+        m_Stats.presentFailures++;
+        return false;
+    }
+
+    int64_t workNs = m_Clock->NowNs() - startNs;
+    m_Stats.presented++;
+    m_Stats.workNs += workNs;
+    if (workNs > m_Stats.maxWorkNs)
+        m_Stats.maxWorkNs = workNs;
+    return true;
+}
+
+bool MirrorPipeline::Start(FrameRate rate)
+{
+    if (IsRunning() || (!m_Stage && !ReconfigurePending()) || !rate.IsValid())
+        return false;
+
+    m_Running.store(true);
+    m_Thread = std::thread(&MirrorPipeline::ThreadMain, this, rate);
+    return true;
+}
+
+void MirrorPipeline::Stop()
+{
+    if (!IsRunning())
+        return;
+
+    m_Running.store(false);
+    m_Thread.join();
+}
+
+void MirrorPipeline::ThreadMain(FrameRate rate)
+{
+    // Same deadline grid as the front-end loops; idle pipelines sleep through several periods
+    FramePacer pacer(1000000000LL * rate.den, rate.num, m_Clock);
+    while (m_Running.load(std::memory_order_relaxed))
+    {
+        RunFrame(true);
+        pacer.WaitForNextFrame(m_Idle.PollDivisor());
+        m_Stats.missedDeadlines = pacer.Stats().missed;
+    }
+}
@@ -0,0 +1,166 @@
+// One source monitor mirrored onto one output (platform independent)
+// A pipeline owns everything a single source -> output pair needs: geometry, the output frame,
+// the composer, cursor sprite and state, idle policy and pacing. Capture and present go through a
+// MirrorSource / MirrorSink, so several pipelines (monitor 1 -> 3, monitor 2 -> 4) can run side by
+// side, each on a thread of its own, sharing one WorkerPool for the pixel work.
+// Everything that depends on the geometry (output frame, composer coefficient tables, kernel) is
+// one stage. Reconfigure builds the next stage on a background thread while the current one keeps
+// presenting; the frame thread swaps it in at the start of a frame, so a switch drops no frames.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "capture_geometry.h"
+#include "cursor_shape.h"
+#include "frame_composer.h"
+#include "frame_memory.h"
+#include "frame_rate.h"
+#include "idle_policy.h"
+
+class FrameClock;
+class WorkerPool;
+
+// Pointer as a source reports it
+struct MirrorCursor
+{
+    int x = 0;                  // Hotspot position, desktop pixels
+    int y = 0;
+    bool visible = false;
+    bool shapeChanged = false;  // The source rewrote the sprite this poll
+};
+
+class MirrorSource
+{
+public:
+    virtual ~MirrorSource() {}
+
+    // Grab the geometry's source rect (BGRA8, sourceWidth x sourceHeight). The pixels stay owned
+    // by the source and must remain valid until the next Capture.
+    virtual bool Capture(const MirrorGeometry& geometry, const uint8_t** pixels, int* pitch) = 0;
+
+    // Current pointer position and visibility; decodes into sprite only when the shape changed
+    virtual bool QueryCursor(MirrorCursor* cursor, CursorSprite* sprite) = 0;
+
+    // On the pipeline's thread, at the frame where a new geometry goes live (before its first Capture)
+    virtual void OnGeometryChanged(const MirrorGeometry& geometry) { (void)geometry; }
+};
+
+class MirrorSink
+{
+public:
+    virtual ~MirrorSink() {}
+
+    // Show a composed BGRA8 frame (outputWidth x outputHeight)
+    virtual bool Present(const uint8_t* pixels, int pitch, int width, int height) = 0;
+
+    // On the pipeline's thread, at the frame where a new geometry goes live (before its first Present)
+    virtual void OnGeometryChanged(const MirrorGeometry& geometry) { (void)geometry; }
+};
+
+struct MirrorPipelineStats
+{
+    uint64_t polls = 0;
+    uint64_t presented = 0;
+    uint64_t captureFailures = 0;
+    uint64_t presentFailures = 0;
+    uint64_t reconfigurations = 0;  // Stages swapped in by Reconfigure
+    uint64_t missedDeadlines = 0;   // Poll deadlines overrun on the pipeline's own thread (Start)
+    int64_t workNs = 0;         // Capture to present, summed over presented frames
+    int64_t maxWorkNs = 0;
+};
+
+class MirrorPipeline
+{
+public:
+    // workers may be shared with other pipelines (see WorkerPool::ParallelFor); null runs single-threaded
+    MirrorPipeline(MirrorSource* source, MirrorSink* sink, WorkerPool* workers = nullptr, FrameClock* clock = nullptr);
+    ~MirrorPipeline();
+
+    MirrorPipeline(const MirrorPipeline&) = delete;
+    MirrorPipeline& operator=(const MirrorPipeline&) = delete;
+
+    // Allocates the output frame and configures the composer on the calling thread. Not while the
+    // thread runs or a Reconfigure is pending.
+    bool Configure(const MirrorGeometry& geometry, bool linearLight = false);
+
+    // Hot switch to a new geometry or kernel: built on a background thread, swapped in at the start
+    // of the next RunFrame after it is ready. Any thread, running or not; requests made while a
+    // build is in flight coalesce (the last one wins). False only for an invalid geometry.
+    bool Reconfigure(const MirrorGeometry& geometry, bool linearLight = false);
+    // A requested stage has not been swapped in yet
+    bool ReconfigurePending() const;
+    uint64_t ReconfigureFailures() const { return m_BuildFailures.load(std::memory_order_relaxed); }
+
+    // One poll on the calling thread: capture (when captureDue; otherwise the last capture is
+    // reused), cursor, and if anything changed compose and present. Returns true if presented.
+    bool RunFrame(bool captureDue = true);
+
+    // Polls at rate on a thread of its own (idle throttling included) until Stop
+    bool Start(FrameRate rate);
+    void Stop();
+    bool IsRunning() const { return m_Thread.joinable(); }
+
+    // Only consistent from the pipeline's own thread, or while it is stopped
+    const MirrorGeometry& Geometry() const { return m_Geometry; }
+    const FrameBuffer& Output() const;
+    const CursorSprite& Cursor() const { return m_Cursor; }
+    IdlePolicy& Idle() { return m_Idle; }
+    const MirrorPipelineStats& Stats() const { return m_Stats; }
+    const FrameMemoryStats& MemoryStats() const;
+
+private:
+    // Everything that depends on the geometry, built and retired as a unit
+    struct Stage
+    {
+        MirrorGeometry geometry;
+        FrameMemory memory;
+        FrameBuffer output;
+        FrameComposer composer;
+
+        ~Stage() { memory.Free(&output); }
+    };
+
+    static Stage* BuildStage(const MirrorGeometry& geometry, bool linearLight);
+    void AdoptStage(Stage* stage);
+    void ThreadMain(FrameRate rate);
+    void BuilderMain();
+
+    MirrorSource* m_Source;
+    MirrorSink* m_Sink;
+    WorkerPool* m_Workers;
+    FrameClock* m_Clock;
+
+    MirrorGeometry m_Geometry;
+    Stage* m_Stage = nullptr;                   // Current; only the frame thread touches it
+    std::atomic<Stage*> m_Pending{nullptr};     // Built, waiting for the next frame boundary
+    bool m_ForcePresent = false;                // First frame of a new stage presents even when idle
+
+    // Builder thread, started by the first Reconfigure
+    std::thread m_Builder;
+    mutable std::mutex m_BuildMutex;
+    std::condition_variable m_BuildWake;
+    MirrorGeometry m_BuildGeometry;
+    bool m_BuildLinearLight = false;
+    bool m_BuildRequested = false;
+    bool m_Building = false;                    // Requested or being built, not yet published
+    bool m_BuildStop = false;
+    Stage* m_Retired = nullptr;                 // Swapped out; freed on the builder thread
+    std::atomic<uint64_t> m_BuildFailures{0};
+
+    const uint8_t* m_Capture = nullptr;    // Last captured pixels (owned by the source)
+    int m_CapturePitch = 0;
+    uint64_t m_CaptureHash = 0;
+    CursorSprite m_Cursor;
+    MirrorCursor m_CursorState;
+    IdlePolicy m_Idle;
+
+    std::thread m_Thread;
+    std::atomic<bool> m_Running{false};
+    MirrorPipelineStats m_Stats;
+};
@@ -0,0 +1,309 @@
+// Planar bilinear resampler - see planar_resampler.h
+
+#include "planar_resampler.h"
+#include "stream_store.h"
+#include "worker_pool.h"
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLITCORE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// BilinearSampler's tap: shader mapping in single precision, snapped to 1/256 texel
+static void SamplerTap(int i, int srcSize, int dstSize, int* i0, int* frac)
+{
+    float uv = ((float)i + 0.5f) / (float)dstSize;
+    float texel = uv * (float)srcSize - 0.5f;
+    int fixed = (int)floorf(texel * 256.0f + 0.5f);
+    *i0 = fixed >> 8;
+    *frac = fixed & 255;
+}
+
+static int Gcd(int a, int b)
+{
+    while (b)
+    {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+bool PlanarResampler::Configure(int srcWidth, int srcHeight, int dstWidth, int dstHeight)
+{
+    if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0 || dstWidth > srcWidth)
+        return false;
+
+    int periods = Gcd(srcWidth, dstWidth);
+    int srcPeriod = srcWidth / periods;
+    int dstPeriod = dstWidth / periods;
+    if (srcPeriod > MAX_PERIOD)
+        return false;
+
+    std::vector<Phase> phases(dstPeriod);
+    for (int p = 0; p < dstPeriod; p++)
+    {
+        int i0, frac;
+        SamplerTap(p, srcWidth, dstWidth, &i0, &frac);
+        if (i0 < 0)
+            return false;
+        phases[p].j0 = i0 % srcPeriod;
+        phases[p].d0 = i0 / srcPeriod;
+        phases[p].j1 = (i0 + 1) % srcPeriod;
+        phases[p].d1 = (i0 + 1) / srcPeriod;
+        phases[p].frac = frac;
+    }
+
+    // The per-pixel float mapping must really repeat every period, or the output would not match
+    for (int x = dstPeriod; x < dstWidth; x++)
+    {
+        int i0, frac;
+        SamplerTap(x, srcWidth, dstWidth, &i0, &frac);
+        const Phase& phase = phases[x % dstPeriod];
+        if (i0 != (x / dstPeriod + phase.d0) * srcPeriod + phase.j0 || frac != phase.frac)
+            return false;
+    }
+
+    m_TapsY.resize(dstHeight);
+    for (int y = 0; y < dstHeight; y++)
+    {
+        int i0, frac;
+        SamplerTap(y, srcHeight, dstHeight, &i0, &frac);
+        int i1 = i0 + 1;
+        m_TapsY[y].i0 = i0 < 0 ? 0 : (i0 >= srcHeight ? srcHeight - 1 : i0);
+        m_TapsY[y].i1 = i1 < 0 ? 0 : (i1 >= srcHeight ? srcHeight - 1 : i1);
+        m_TapsY[y].frac = frac;
+    }
+
+    m_SrcWidth = srcWidth;
+    m_DstWidth = dstWidth;
+    m_SrcPeriod = srcPeriod;
+    m_DstPeriod = dstPeriod;
+    m_Periods = periods;
+    m_PlaneStride = ((periods + 1 + 7) & ~7) + 8;
+    m_Phases.swap(phases);
+    return true;
+}
+
+// planes[(c * srcPeriod + j) * stride + k] = channel c of pixel k * srcPeriod + j
+void PlanarResampler::Deinterleave(const uint8_t* row, uint16_t* planes) const
+{
+    int S = m_SrcPeriod;
+    int stride = m_PlaneStride;
+    int k = 0;
+
+#ifdef BLITCORE_SSE2
+    if (S == 4)
+    {
+        // One period is one register: a 4x4 dword transpose gives each phase's pixels,
+        // then masks and shifts split the channels
+        const __m128i mask = _mm_set1_epi32(0xFF);
+        for (; k + 8 <= m_Periods; k += 8)
+        {
+            __m128i q[2][4];
+            for (int h = 0; h < 2; h++)
+            {
+                const __m128i* s = (const __m128i*)(row + (k + h * 4) * 16);
+                __m128i x0 = _mm_loadu_si128(s + 0);
+                __m128i x1 = _mm_loadu_si128(s + 1);
+                __m128i x2 = _mm_loadu_si128(s + 2);
+                __m128i x3 = _mm_loadu_si128(s + 3);
+                __m128i t0 = _mm_unpacklo_epi32(x0, x1);
+                __m128i t1 = _mm_unpacklo_epi32(x2, x3);
+                __m128i t2 = _mm_unpackhi_epi32(x0, x1);
+                __m128i t3 = _mm_unpackhi_epi32(x2, x3);
+                q[h][0] = _mm_unpacklo_epi64(t0, t1);
+                q[h][1] = _mm_unpackhi_epi64(t0, t1);
+                q[h][2] = _mm_unpacklo_epi64(t2, t3);
+                q[h][3] = _mm_unpackhi_epi64(t2, t3);
+            }
+            for (int j = 0; j < 4; j++)
+            {
+                _mm_storeu_si128((__m128i*)(planes + (0 * 4 + j) * stride + k),
+                                 _mm_packs_epi32(_mm_and_si128(q[0][j], mask), _mm_and_si128(q[1][j], mask)));
+                _mm_storeu_si128((__m128i*)(planes + (1 * 4 + j) * stride + k),
+                                 _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(q[0][j], 8), mask),
+                                                 _mm_and_si128(_mm_srli_epi32(q[1][j], 8), mask)));
+                _mm_storeu_si128((__m128i*)(planes + (2 * 4 + j) * stride + k),
+                                 _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(q[0][j], 16), mask),
+                                                 _mm_and_si128(_mm_srli_epi32(q[1][j], 16), mask)));
+            }
+        }
+    }
+#endif
+    for (; k < m_Periods; k++)
+    {
+        for (int j = 0; j < S; j++)
+        {
+            const uint8_t* px = row + (k * S + j) * 4;
+            for (int c = 0; c < 3; c++)
+                planes[(c * S + j) * stride + k] = px[c];
+        }
+    }
+
+    // Entry m_Periods of every plane: the clamped right edge, read by the last period's second taps
+    const uint8_t* last = row + (m_SrcWidth - 1) * 4;
+    for (int c = 0; c < 3; c++)
+        for (int j = 0; j < S; j++)
+            planes[(c * S + j) * stride + m_Periods] = last[c];
+}
+
+// planes[(c * dstPeriod + p) * stride + k] -> BGRX pixel k * dstPeriod + p
+void PlanarResampler::Interleave(const uint16_t* planes, uint8_t* row) const
+{
+    int P = m_DstPeriod;
+    int stride = m_PlaneStride;
+    int k = 0;
+
+#ifdef BLITCORE_SSE2
+    if (P == 3)
+    {
+        // Build BGRX dwords per phase, then a 3-way dword interleave: 12 pixels per 3 stores
+        const __m128i opaque = _mm_set1_epi8((char)0xFF);
+        for (; k + 8 <= m_Periods; k += 8)
+        {
+            __m128i px[3][2];
+            for (int p = 0; p < 3; p++)
+            {
+                __m128i b = _mm_loadu_si128((const __m128i*)(planes + (0 * 3 + p) * stride + k));
+                __m128i g = _mm_loadu_si128((const __m128i*)(planes + (1 * 3 + p) * stride + k));
+                __m128i r = _mm_loadu_si128((const __m128i*)(planes + (2 * 3 + p) * stride + k));
+                __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(g, g));
+                __m128i ra = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), opaque);
+                px[p][0] = _mm_unpacklo_epi16(bg, ra);
+                px[p][1] = _mm_unpackhi_epi16(bg, ra);
+            }
+            for (int h = 0; h < 2; h++)
+            {
+                __m128i p0 = px[0][h];
+                __m128i p1 = px[1][h];
+                __m128i p2 = px[2][h];
+                __m128i p0n = _mm_srli_si128(p0, 4);
+                __m128i a = _mm_unpacklo_epi32(p0, p1);                         // p0[0] p1[0] p0[1] p1[1]
+                __m128i b = _mm_unpackhi_epi32(p0, p1);                         // p0[2] p1[2] p0[3] p1[3]
+                __m128i d = _mm_unpacklo_epi32(p2, p0n);                        // p2[0] p0[1] ...
+                __m128i e = _mm_unpacklo_epi32(_mm_srli_si128(p1, 4), _mm_srli_si128(p2, 4)); // p1[1] p2[1] ...
+                __m128i f = _mm_unpackhi_epi32(p2, p0n);                        // p2[2] p0[3] ...
+                __m128i g = _mm_unpackhi_epi32(p1, p2);                         // .. .. p1[3] p2[3]
+                __m128i* out = (__m128i*)(row + (k + h * 4) * 12);
+                _mm_storeu_si128(out + 0, _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(d), _MM_SHUFFLE(1, 0, 1, 0))));
+                _mm_storeu_si128(out + 1, _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(e), _mm_castsi128_ps(b), _MM_SHUFFLE(1, 0, 1, 0))));
+                _mm_storeu_si128(out + 2, _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(f), _mm_castsi128_ps(g), _MM_SHUFFLE(3, 2, 1, 0))));
+            }
+        }
+    }
+#endif
+    for (; k < m_Periods; k++)
+    {
+        for (int p = 0; p < P; p++)
+        {
+            uint8_t* px = row + (k * P + p) * 4;
+            for (int c = 0; c < 3; c++)
+                px[c] = (uint8_t)planes[(c * P + p) * stride + k];
+            px[3] = 255;
+        }
+    }
+}
+
+// (a * (256 - f) + b * f + 128) >> 8 on 8-bit values held in 16-bit lanes (never above 0xFF80)
+static void BlendPlanes(const uint16_t* a, const uint16_t* b, int frac, uint16_t* out, int count)
+{
+    int i = 0;
+#ifdef BLITCORE_SSE2
+    const __m128i w0 = _mm_set1_epi16((short)(256 - frac));
+    const __m128i w1 = _mm_set1_epi16((short)frac);
+    const __m128i round = _mm_set1_epi16(128);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(va, w0), _mm_mullo_epi16(vb, w1)), round);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_srli_epi16(sum, 8));
+    }
+#endif
+    for (; i < count; i++)
+        out[i] = (uint16_t)((a[i] * (256 - frac) + b[i] * frac + 128) >> 8);
+}
+
+void PlanarResampler::ScaleRows(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch,
+                                int rowBegin, int rowEnd, bool streaming) const
+{
+    int stride = m_PlaneStride;
+    size_t srcPlanes = (size_t)3 * m_SrcPeriod * stride;
+    size_t dstPlanes = (size_t)3 * m_DstPeriod * stride;
+    size_t rowBytes = (size_t)m_DstWidth * 4;
+
+    // Per thread: two source rows of planes, one output row of planes and the interleaved row
+    // streaming writes from
+    thread_local std::vector<uint16_t> buffer;
+    size_t entries = srcPlanes * 2 + dstPlanes + rowBytes / 2;
+    if (buffer.size() < entries)
+        buffer.assign(entries, 0);
+    uint16_t* top = buffer.data();
+    uint16_t* bottom = top + srcPlanes;
+    uint16_t* out = bottom + srcPlanes;
+    uint8_t* row = (uint8_t*)(out + dstPlanes);
+
+    // Padding lanes are computed but never stored
+    int count = (m_Periods + 7) & ~7;
+
+    for (int y = rowBegin; y < rowEnd; y++)
+    {
+        const RowTap& ty = m_TapsY[y];
+        Deinterleave(src + (intptr_t)ty.i0 * srcPitch, top);
+        if (ty.frac)
+        {
+            Deinterleave(src + (intptr_t)ty.i1 * srcPitch, bottom);
+            BlendPlanes(top, bottom, ty.frac, top, (int)srcPlanes);
+        }
+
+        for (int c = 0; c < 3; c++)
+        {
+            for (int p = 0; p < m_DstPeriod; p++)
+            {
+                const Phase& phase = m_Phases[p];
+                BlendPlanes(top + (c * m_SrcPeriod + phase.j0) * stride + phase.d0,
+                            top + (c * m_SrcPeriod + phase.j1) * stride + phase.d1,
+                            phase.frac, out + (c * m_DstPeriod + p) * stride, count);
+            }
+        }
+
+        if (streaming)
+        {
+            Interleave(out, row);
+            CopyPixelsUnfenced(dst + (intptr_t)y * dstPitch, row, rowBytes);
+        }
+        else
+            Interleave(out, dst + (intptr_t)y * dstPitch);
+    }
+}
+
+struct PlanarJob
+{
+    const PlanarResampler* resampler;
+    const uint8_t* src;
+    int srcPitch;
+    uint8_t* dst;
+    int dstPitch;
+};
+
+static void PlanarRowsTask(void* context, int begin, int end)
+{
+    const PlanarJob* job = (const PlanarJob*)context;
+    job->resampler->ScaleRows(job->src, job->srcPitch, job->dst, job->dstPitch, begin, end);
+}
+
+void PlanarResampler::Scale(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch, WorkerPool* pool) const
+{
+    if (!pool)
+    {
+        ScaleRows(src, srcPitch, dst, dstPitch, 0, DstHeight());
+        return;
+    }
+
+    PlanarJob job = { this, src, srcPitch, dst, dstPitch };
+    pool->ParallelFor(DstHeight(), PlanarRowsTask, &job);
+}
@@ -0,0 +1,64 @@
+// Planar (SoA) bilinear resampler for periodic downscale ratios such as 1920 -> 1440 (platform independent)
+// Each source row is split once into 16-bit B/G/R planes per phase of the ratio's period (for 4:3,
+// pixels 4k, 4k+1, 4k+2, 4k+3 land in four planes indexed by k). Every output phase is then a fixed
+// two-tap blend of two planes, computed 8 periods at a time with plain vertical SIMD and no shuffles;
+// alpha is dropped on input and written as 255. Same taps and rounding as BilinearSampler:
+// bit-identical on rows that need no vertical blend, within 1 LSB otherwise.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+class WorkerPool;
+
+class PlanarResampler
+{
+public:
+    // Largest reduced source period (srcWidth / gcd(srcWidth, dstWidth)) handled
+    static constexpr int MAX_PERIOD = 16;
+
+    // Returns false for upscaling or a period longer than MAX_PERIOD
+    bool Configure(int srcWidth, int srcHeight, int dstWidth, int dstHeight);
+
+    // BGRA8 in, BGRX8 out (alpha 255), pitches in bytes. Rows are split across the pool's threads when given.
+    void Scale(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch, WorkerPool* pool = nullptr) const;
+
+    // Output rows [rowBegin, rowEnd) only (a dstPitch of 0 writes each of them to dst). With streaming,
+    // each row is built in a per-thread row buffer and written out with unfenced streaming stores: the
+    // caller runs StreamFence() before the rows are read elsewhere (see stream_store.h).
+    void ScaleRows(const uint8_t* src, int srcPitch, uint8_t* dst, int dstPitch, int rowBegin, int rowEnd,
+                   bool streaming = false) const;
+
+    int DstWidth() const { return m_DstWidth; }
+    int DstHeight() const { return (int)m_TapsY.size(); }
+
+private:
+    // Output phase p of period k blends plane j0 at k + d0 with plane j1 at k + d1
+    struct Phase
+    {
+        int j0, d0;
+        int j1, d1;
+        int frac;       // Weight of the second tap, 0..255
+    };
+
+    struct RowTap
+    {
+        int i0;
+        int i1;
+        int frac;
+    };
+
+    void Deinterleave(const uint8_t* row, uint16_t* planes) const;
+    void Interleave(const uint16_t* planes, uint8_t* row) const;
+
+    int m_SrcWidth = 0;
+    int m_DstWidth = 0;
+    int m_SrcPeriod = 0;        // Source pixels per period
+    int m_DstPeriod = 0;        // Output pixels per period
+    int m_Periods = 0;          // Periods per row (the gcd)
+    int m_PlaneStride = 0;      // uint16 entries per plane: periods + clamp entry, padded for 8-wide loads
+    std::vector<Phase> m_Phases;
+    std::vector<RowTap> m_TapsY;
+};
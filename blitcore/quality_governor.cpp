@@ -0,0 +1,119 @@
+// Adaptive quality governor - see quality_governor.h
+
+#include "quality_governor.h"
+
+#include <stdio.h>
+
+static const QualitySettings g_QualityLadder[QUALITY_LEVEL_COUNT] = {
+    { "full",        false, 1 },
+    { "fast-filter", true,  1 },
+    { "half-rate",   true,  2 },
+};
+
+const QualitySettings& GetQualitySettings(QualityLevel level)
+{
+    if (level < 0 || level >= QUALITY_LEVEL_COUNT)
+        level = QUALITY_FULL;
+    return g_QualityLadder[level];
+}
+
+QualityGovernor::QualityGovernor(const QualityGovernorConfig& config)
+    : m_Config(config)
+{
+}
+
+void QualityGovernor::AccountTime(int64_t nowNs)
+{
+    if (m_Started && nowNs > m_LastAccountNs)
+        m_Stats.timeInLevelNs[m_Level] += nowNs - m_LastAccountNs;
+    m_LastAccountNs = nowNs;
+}
+
+void QualityGovernor::Flush(int64_t nowNs)
+{
+    AccountTime(nowNs);
+}
+
+void QualityGovernor::ChangeLevel(QualityLevel level, int64_t nowNs)
+{
+    AccountTime(nowNs);
+    if (level > m_Level)
+        m_Stats.stepsDown++;
+    else
+        m_Stats.stepsUp++;
+
+    m_Level = level;
+    m_LevelSinceNs = nowNs;
+    m_WindowFrames = 0;
+    m_OverFrames = 0;
+    m_WindowMaxNs = 0;
+}
+
+bool QualityGovernor::AddFrame(int64_t workNs, int64_t nowNs)
+{
+    if (!m_Started)
+    {
+        m_Started = true;
+        m_LevelSinceNs = nowNs;
+        m_LastAccountNs = nowNs;
+    }
+    AccountTime(nowNs);
+
+    // Reduced-rate levels get proportionally more time per processed frame
+    int64_t budget = m_Config.budgetNs * Settings().captureDivisor;
+
+    m_WindowFrames++;
+    if (workNs > (int64_t)(budget * m_Config.downFraction))
+        m_OverFrames++;
+    if (workNs > m_WindowMaxNs)
+        m_WindowMaxNs = workNs;
+
+    // Step down as soon as the window has seen enough blown frames (no need to wait it out)
+    if (m_OverFrames >= m_Config.overFramesToStepDown && m_Level + 1 < QUALITY_LEVEL_COUNT)
+    {
+        ChangeLevel((QualityLevel)(m_Level + 1), nowNs);
+        return true;
+    }
+
+    if (m_WindowFrames < m_Config.window)
+        return false;
+
+    // Full window evaluated: step up only with clear headroom measured against the budget of the
+    // level above, and only after dwelling here long enough (hysteresis against oscillation)
+    bool stepUp = false;
+    if (m_Level > QUALITY_FULL && m_OverFrames == 0 && nowNs - m_LevelSinceNs >= m_Config.minDwellUpNs)
+    {
+        const QualitySettings& above = GetQualitySettings((QualityLevel)(m_Level - 1));
+        int64_t aboveBudget = m_Config.budgetNs * above.captureDivisor;
+        stepUp = m_WindowMaxNs < (int64_t)(aboveBudget * m_Config.upFraction);
+    }
+
+    if (stepUp)
+    {
+        ChangeLevel((QualityLevel)(m_Level - 1), nowNs);
+        return true;
+    }
+
+    m_WindowFrames = 0;
+    m_OverFrames = 0;
+    m_WindowMaxNs = 0;
+    return false;
+}
+
+void FormatQualityReport(const QualityGovernor& governor, char* buffer, int bufferSize)
+{
+    const QualityGovernorStats& stats = governor.Stats();
+    int64_t total = 0;
+    for (int i = 0; i < QUALITY_LEVEL_COUNT; i++)
+        total += stats.timeInLevelNs[i];
+
+    int len = snprintf(buffer, bufferSize, "quality: %llu down, %llu up;",
+                       (unsigned long long)stats.stepsDown, (unsigned long long)stats.stepsUp);
+    for (int i = 0; i < QUALITY_LEVEL_COUNT && len > 0 && len < bufferSize; i++)
+    {
+        double seconds = stats.timeInLevelNs[i] / 1e9;
+        double percent = total > 0 ? 100.0 * stats.timeInLevelNs[i] / total : 0.0;
+        len += snprintf(buffer + len, bufferSize - len, " %s %.1fs (%.0f%%)",
+                        g_QualityLadder[i].name, seconds, percent);
+    }
+}
@@ -0,0 +1,78 @@
+// Adaptive quality governor (platform independent)
+// Watches per-frame processing time against the refresh budget and walks a ladder of cheaper
+// settings when the budget is blown, stepping back up with hysteresis when there is headroom.
+
+#pragma once
+
+#include <stdint.h>
+
+// One rung of the ladder; front-ends map these onto their own knobs
+// (GDI: no area-average refinement pass and a shorter tile pass, DXGI: linear -> point sampler)
+struct QualitySettings
+{
+    const char* name;
+    bool fastFilter;        // Cheap scaling filter instead of the high-quality one
+    int captureDivisor;     // Capture every Nth capture tick (1 = full rate)
+};
+
+enum QualityLevel
+{
+    QUALITY_FULL = 0,       // High-quality filter, full rate
+    QUALITY_FAST_FILTER,    // Cheap filter, full rate
+    QUALITY_HALF_RATE,      // Cheap filter, half-rate capture
+    QUALITY_LEVEL_COUNT
+};
+
+const QualitySettings& GetQualitySettings(QualityLevel level);
+
+struct QualityGovernorConfig
+{
+    int64_t budgetNs = 1000000000 / 60;    // Present period
+    double downFraction = 0.90;            // A frame is "over" above this fraction of its budget
+    double upFraction = 0.55;              // Step up only if every frame in the window is below this
+    int window = 30;                       // Frames per decision window
+    int overFramesToStepDown = 5;          // Over-budget frames in a window that force a step down
+    int64_t minDwellUpNs = 3000000000;     // Stay at least this long before stepping back up
+};
+
+struct QualityGovernorStats
+{
+    uint64_t stepsDown = 0;
+    uint64_t stepsUp = 0;
+    int64_t timeInLevelNs[QUALITY_LEVEL_COUNT] = {};
+};
+
+class QualityGovernor
+{
+public:
+    explicit QualityGovernor(const QualityGovernorConfig& config = QualityGovernorConfig());
+
+    void SetBudget(int64_t budgetNs) { m_Config.budgetNs = budgetNs; }
+
+    // Record one processed frame. Returns true if the level changed (caller applies Settings()).
+    bool AddFrame(int64_t workNs, int64_t nowNs);
+
+    QualityLevel Level() const { return m_Level; }
+    const QualitySettings& Settings() const { return GetQualitySettings(m_Level); }
+    const QualityGovernorStats& Stats() const { return m_Stats; }
+
+    // Time accounting is closed at the last AddFrame; call before reading Stats() at shutdown
+    void Flush(int64_t nowNs);
+
+private:
+    void ChangeLevel(QualityLevel level, int64_t nowNs);
+    void AccountTime(int64_t nowNs);
+
+    QualityGovernorConfig m_Config;
+    QualityLevel m_Level = QUALITY_FULL;
+    int64_t m_LevelSinceNs = 0;
+    int64_t m_LastAccountNs = 0;
+    bool m_Started = false;
+    int m_WindowFrames = 0;
+    int m_OverFrames = 0;
+    int64_t m_WindowMaxNs = 0;
+    QualityGovernorStats m_Stats;
+};
+
+// One-line summary of level changes and time spent per level, e.g. for OutputDebugString at exit
+void FormatQualityReport(const QualityGovernor& governor, char* buffer, int bufferSize);
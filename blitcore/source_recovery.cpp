@@ -0,0 +1,137 @@
+// Capture source recovery - see source_recovery.h
+
+#include "source_recovery.h"
+
+#include <chrono>
+
+SourceRecovery::SourceRecovery(RecoverableSource* source, const SourceRecoveryConfig& config)
+    : m_Source(source)
+    , m_Config(config)
+{
+}
+
+SourceRecovery::~SourceRecovery()
+{
+    if (!m_Thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Wake.notify_all();
+    m_Thread.join();
+}
+
+bool SourceRecovery::BeginFrame(int64_t nowNs)
+{
+    if (m_State == SOURCE_HEALTHY)
+        return true;
+
+    if (!m_Recovered.exchange(false, std::memory_order_acquire))
+    {
+        m_Stats.heldFrames++;
+        return false;
+    }
+
+    m_Source->Resume();
+    int64_t outageNs = nowNs - m_LostAtNs;
+    m_Stats.recoveries++;
+    m_Stats.lastOutageNs = outageNs;
+    m_Stats.totalOutageNs += outageNs;
+    if (outageNs > m_Stats.maxOutageNs)
+        m_Stats.maxOutageNs = outageNs;
+    m_State = SOURCE_HEALTHY;
+    m_TransientStreak = 0;
+    return true;
+}
+
+bool SourceRecovery::OnTransientError()
+{
+    m_Stats.transientErrors++;
+    return ++m_TransientStreak >= m_Config.transientErrorLimit;
+}
+
+void SourceRecovery::OnLost(int64_t nowNs)
+{
+    if (m_State == SOURCE_RECOVERING)
+        return;
+
+    m_State = SOURCE_RECOVERING;
+    m_LostAtNs = nowNs;
+    m_TransientStreak = 0;
+    m_Stats.outages++;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Requested = true;
+        if (!m_Thread.joinable())
+            m_Thread = std::thread(&SourceRecovery::ThreadMain, this);
+    }
+    m_Wake.notify_all();
+}
+
+void SourceRecovery::Cancel()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Generation++;
+        m_Requested = false;
+        m_Wake.notify_all();
+        m_Wake.wait(lock, [this] { return !m_Attempting; });
+    }
+    m_Recovered.store(false, std::memory_order_relaxed);
+    m_State = SOURCE_HEALTHY;
+    m_TransientStreak = 0;
+}
+
+const SourceRecoveryStats& SourceRecovery::Stats()
+{
+    m_Stats.attempts = m_Attempts.load(std::memory_order_relaxed);
+    m_Stats.failedAttempts = m_FailedAttempts.load(std::memory_order_relaxed);
+    return m_Stats;
+}
+
+void SourceRecovery::ThreadMain()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    for (;;)
+    {
+        m_Wake.wait(lock, [this] { return m_Stop || m_Requested; });
+        if (m_Stop)
+            return;
+
+        m_Requested = false;
+        uint64_t generation = m_Generation;
+        int64_t backoffNs = m_Config.initialBackoffNs;
+        for (;;)
+        {
+            m_Attempting = true;
+            lock.unlock();
+            bool ok = m_Source->Reinitialize();
+            m_Attempts.fetch_add(1, std::memory_order_relaxed);
+            lock.lock();
+            m_Attempting = false;
+            m_Wake.notify_all();    // Cancel may be waiting for this attempt
+
+            if (m_Stop)
+                return;
+            if (generation != m_Generation)
+                break;              // Cancelled; whatever was staged is the caller's to discard
+            if (ok)
+            {
+                m_Recovered.store(true, std::memory_order_release);
+                break;
+            }
+
+            m_FailedAttempts.fetch_add(1, std::memory_order_relaxed);
+            m_Wake.wait_for(lock, std::chrono::nanoseconds(backoffNs),
+                            [this, generation] { return m_Stop || generation != m_Generation; });
+            if (m_Stop)
+                return;
+            if (generation != m_Generation)
+                break;
+            backoffNs = backoffNs * 2 < m_Config.maxBackoffNs ? backoffNs * 2 : m_Config.maxBackoffNs;
+        }
+    }
+}
@@ -0,0 +1,108 @@
+// Capture source health and asynchronous re-initialization (platform independent)
+// When a source is lost (DXGI_ERROR_ACCESS_LOST on a mode change, UAC prompt or fullscreen app) the
+// frame loop keeps presenting the last good frame while a recovery thread rebuilds the source,
+// backing off exponentially between failed attempts. Errors that are not an outright loss only
+// count as one when they repeat. Each outage is timed from the frame that lost the source to the
+// frame that resumes it.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+enum SourceHealth
+{
+    SOURCE_HEALTHY,
+    SOURCE_RECOVERING,      // Lost; frames hold the last capture until a rebuild succeeds
+};
+
+class RecoverableSource
+{
+public:
+    virtual ~RecoverableSource() {}
+
+    // On the recovery thread: rebuild what was lost, reusing whatever survived. Must not touch
+    // anything the frame thread uses; stage the results for Resume. True once capture can resume.
+    virtual bool Reinitialize() = 0;
+
+    // On the frame thread, after a successful Reinitialize: swap the staged objects in
+    virtual void Resume() {}
+};
+
+struct SourceRecoveryConfig
+{
+    int transientErrorLimit = 8;            // Consecutive unexplained errors treated as a loss
+    int64_t initialBackoffNs = 16000000;    // Wait after the first failed attempt, doubled per failure
+    int64_t maxBackoffNs = 2000000000;
+};
+
+struct SourceRecoveryStats
+{
+    uint64_t outages = 0;
+    uint64_t recoveries = 0;
+    uint64_t transientErrors = 0;
+    uint64_t attempts = 0;          // Reinitialize calls
+    uint64_t failedAttempts = 0;
+    uint64_t heldFrames = 0;        // Frames that reused the last capture while recovering
+    int64_t lastOutageNs = 0;
+    int64_t maxOutageNs = 0;
+    int64_t totalOutageNs = 0;
+};
+
+class SourceRecovery
+{
+public:
+    explicit SourceRecovery(RecoverableSource* source, const SourceRecoveryConfig& config = SourceRecoveryConfig());
+    ~SourceRecovery();
+
+    SourceRecovery(const SourceRecovery&) = delete;
+    SourceRecovery& operator=(const SourceRecovery&) = delete;
+
+    // Frame thread, once per frame before capturing: completes a finished recovery (Resume, outage
+    // recorded). False while recovering: skip the capture and present the last frame.
+    bool BeginFrame(int64_t nowNs);
+
+    // Frame thread: outcome of a capture attempt. OnTransientError returns true once errors have
+    // repeated transientErrorLimit times; the caller then releases the source and calls OnLost.
+    void OnCaptureOk() { m_TransientStreak = 0; }
+    bool OnTransientError();
+    void OnLost(int64_t nowNs);     // Starts a recovery (ignored while one runs)
+
+    // Abandon a recovery: waits for an attempt in flight and returns to healthy without Resume,
+    // for callers about to rebuild the source themselves
+    void Cancel();
+
+    SourceHealth State() const { return m_State; }
+    bool IsRecovering() const { return m_State == SOURCE_RECOVERING; }
+    // Outage in progress so far, 0 when healthy
+    int64_t OutageNs(int64_t nowNs) const { return m_State == SOURCE_RECOVERING ? nowNs - m_LostAtNs : 0; }
+    const SourceRecoveryStats& Stats();
+
+private:
+    void ThreadMain();
+
+    RecoverableSource* m_Source;
+    SourceRecoveryConfig m_Config;
+
+    // Frame thread only
+    SourceHealth m_State = SOURCE_HEALTHY;
+    int64_t m_LostAtNs = 0;
+    int m_TransientStreak = 0;
+    SourceRecoveryStats m_Stats;
+
+    // Shared with the recovery thread (started by the first loss)
+    std::thread m_Thread;
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    bool m_Requested = false;
+    bool m_Attempting = false;
+    bool m_Stop = false;
+    uint64_t m_Generation = 0;              // Bumped by Cancel; stale attempts are not published
+    std::atomic<bool> m_Recovered{false};
+    std::atomic<uint64_t> m_Attempts{0};
+    std::atomic<uint64_t> m_FailedAttempts{0};
+};
@@ -0,0 +1,112 @@
+// Streaming stores - see stream_store.h
+
+#include "stream_store.h"
+#include "cache_info.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLITCORE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+size_t StreamingThreshold()
+{
+    const CacheInfo& caches = GetCacheInfo();
+    if (caches.l3)
+        return caches.l3 / 2;
+    return PlanningL2Size() * 2;
+}
+
+bool UseStreamingStores(size_t bytes, StoreMode mode)
+{
+    if (mode == STORE_AUTO)
+        return bytes > StreamingThreshold();
+    return mode == STORE_STREAMING;
+}
+
+void FillPixelsUnfenced(uint32_t* dst, size_t count, uint32_t value)
+{
+    size_t i = 0;
+#ifdef BLITCORE_SSE2
+    // Scalar head up to 16-byte alignment (pixels are 4-byte aligned), 64 bytes per iteration
+    for (; i < count && ((uintptr_t)(dst + i) & 15); i++)
+        dst[i] = value;
+    const __m128i v = _mm_set1_epi32((int)value);
+    for (; i + 16 <= count; i += 16)
+    {
+        _mm_stream_si128((__m128i*)(dst + i), v);
+        _mm_stream_si128((__m128i*)(dst + i + 4), v);
+        _mm_stream_si128((__m128i*)(dst + i + 8), v);
+        _mm_stream_si128((__m128i*)(dst + i + 12), v);
+    }
+    for (; i + 4 <= count; i += 4)
+        _mm_stream_si128((__m128i*)(dst + i), v);
+#endif
+    for (; i < count; i++)
+        dst[i] = value;
+}
+
+void CopyPixelsUnfenced(void* dst, const void* src, size_t bytes)
+{
+    uint8_t* d = (uint8_t*)dst;
+    const uint8_t* s = (const uint8_t*)src;
+    size_t i = 0;
+#ifdef BLITCORE_SSE2
+    size_t head = (16 - ((uintptr_t)d & 15)) & 15;
+    if (head <= bytes)
+    {
+        memcpy(d, s, head);
+        i = head;
+        if (((uintptr_t)(s + i) & 15) == 0)
+        {
+            for (; i + 64 <= bytes; i += 64)
+            {
+                __m128i a = _mm_load_si128((const __m128i*)(s + i));
+                __m128i b = _mm_load_si128((const __m128i*)(s + i + 16));
+                __m128i c = _mm_load_si128((const __m128i*)(s + i + 32));
+                __m128i e = _mm_load_si128((const __m128i*)(s + i + 48));
+                _mm_stream_si128((__m128i*)(d + i), a);
+                _mm_stream_si128((__m128i*)(d + i + 16), b);
+                _mm_stream_si128((__m128i*)(d + i + 32), c);
+                _mm_stream_si128((__m128i*)(d + i + 48), e);
+            }
+        }
+        for (; i + 16 <= bytes; i += 16)
+            _mm_stream_si128((__m128i*)(d + i), _mm_loadu_si128((const __m128i*)(s + i)));
+    }
+#endif
+    memcpy(d + i, s + i, bytes - i);
+}
+
+void StreamFence()
+{
+#ifdef BLITCORE_SSE2
+    _mm_sfence();
+#endif
+}
+
+void FillPixels(uint32_t* dst, size_t count, uint32_t value, StoreMode mode)
+{
+    if (!UseStreamingStores(count * 4, mode))
+    {
+        for (size_t i = 0; i < count; i++)
+            dst[i] = value;
+        return;
+    }
+
+    FillPixelsUnfenced(dst, count, value);
+    StreamFence();
+}
+
+void CopyPixels(void* dst, const void* src, size_t bytes, StoreMode mode)
+{
+    if (!UseStreamingStores(bytes, mode))
+    {
+        memcpy(dst, src, bytes);
+        return;
+    }
+
+    CopyPixelsUnfenced(dst, src, bytes);
+    StreamFence();
+}
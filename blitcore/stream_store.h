@@ -0,0 +1,34 @@
+// Streaming (non-temporal) stores for write-once output buffers (platform independent)
+// A frame that is written once and then only read by the presenter gains nothing from being
+// cached: regular stores pull it through the cache and evict the source still being read.
+// Above a threshold derived from the cache sizes, fills and copies use movntdq instead.
+// Streaming stores are weakly ordered; every call that streams ends with an sfence unless
+// the *Unfenced variant is used, in which case StreamFence() must run before the buffer is
+// handed to another thread or API.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum StoreMode
+{
+    STORE_AUTO,         // Streaming when the buffer exceeds StreamingThreshold()
+    STORE_CACHED,
+    STORE_STREAMING
+};
+
+// Bytes above which STORE_AUTO streams: half the last-level cache
+size_t StreamingThreshold();
+
+// Resolves STORE_AUTO for a buffer of this size
+bool UseStreamingStores(size_t bytes, StoreMode mode = STORE_AUTO);
+
+// count 32-bit pixels set to value; bytes copied from src
+void FillPixels(uint32_t* dst, size_t count, uint32_t value, StoreMode mode = STORE_AUTO);
+void CopyPixels(void* dst, const void* src, size_t bytes, StoreMode mode = STORE_AUTO);
+
+// Always streaming where the alignment allows, no fence (for row-by-row writers)
+void FillPixelsUnfenced(uint32_t* dst, size_t count, uint32_t value);
+void CopyPixelsUnfenced(void* dst, const void* src, size_t bytes);
+void StreamFence();
@@ -0,0 +1,161 @@
+// BilinearSampler tests: agreement with a reference model of the D3D11 linear sampler (clamp
+// addressing, 8-bit subtexel snapping, float filtering, round-to-nearest UNORM output), and its
+// streaming row stores
+
+#include "test_common.h"
+
+#include "bilinear_sampler.h"
+#include "stream_store.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <vector>
+
+// Reference tap: the texel coordinate the shader computes, snapped to the hardware's 1/256 grid
+struct ReferenceTap
+{
+    int i0, i1;
+    double weight;      // Of i1
+};
+
+static ReferenceTap ReferenceTapAt(int i, int srcSize, int dstSize)
+{
+    double texel = ((double)i + 0.5) / dstSize * srcSize - 0.5;
+    double snapped = floor(texel * 256.0 + 0.5) / 256.0;
+    int base = (int)floor(snapped);
+    ReferenceTap tap;
+    tap.i0 = base < 0 ? 0 : (base >= srcSize ? srcSize - 1 : base);
+    tap.i1 = base + 1 < 0 ? 0 : (base + 1 >= srcSize ? srcSize - 1 : base + 1);
+    tap.weight = snapped - base;
+    return tap;
+}
+
+static double Unorm(uint8_t v)
+{
+    return v / 255.0;
+}
+
+// Scales with both and returns the largest per-channel difference; counts exact matches
+static int MaxDifference(int srcWidth, int srcHeight, int dstWidth, int dstHeight, uint64_t seed, int* exact,
+                         int* total)
+{
+    std::vector<uint8_t> src((size_t)srcWidth * srcHeight * 4);
+    TestRandom random(seed);
+    for (uint8_t& v : src)
+        v = (uint8_t)random.Next();
+
+    BilinearSampler sampler;
+    CHECK(sampler.Configure(srcWidth, srcHeight, dstWidth, dstHeight));
+    std::vector<uint8_t> dst((size_t)dstWidth * dstHeight * 4);
+    sampler.Scale(src.data(), srcWidth * 4, dst.data(), dstWidth * 4);
+
+    int worst = 0;
+    for (int y = 0; y < dstHeight; y++)
+    {
+        ReferenceTap ty = ReferenceTapAt(y, srcHeight, dstHeight);
+        for (int x = 0; x < dstWidth; x++)
+        {
+            ReferenceTap tx = ReferenceTapAt(x, srcWidth, dstWidth);
+            for (int c = 0; c < 4; c++)
+            {
+                auto texel = [&](int sx, int sy) { return Unorm(src[((size_t)sy * srcWidth + sx) * 4 + c]); };
+                double top = texel(tx.i0, ty.i0) * (1 - tx.weight) + texel(tx.i1, ty.i0) * tx.weight;
+                double bottom = texel(tx.i0, ty.i1) * (1 - tx.weight) + texel(tx.i1, ty.i1) * tx.weight;
+                int expected = (int)floor((top * (1 - ty.weight) + bottom * ty.weight) * 255.0 + 0.5);
+                int diff = abs(dst[((size_t)y * dstWidth + x) * 4 + c] - expected);
+                worst = diff > worst ? diff : worst;
+                *exact += diff == 0;
+                (*total)++;
+            }
+        }
+    }
+    return worst;
+}
+
+// The mirror's own ratios and awkward ones, down and up (upscaling clamps at the edges)
+static void TestMatchesReferenceWithinOneLsb()
+{
+    const int sizes[][4] = {
+        { 1920, 1080, 1440, 1080 }, { 2560, 1440, 1440, 1080 }, { 1280, 720, 1440, 1080 },
+        { 97, 61, 13, 7 }, { 7, 5, 19, 11 }, { 3, 2, 640, 480 }, { 1, 1, 5, 3 },
+    };
+    uint64_t seed = 35;
+    for (const int* s : sizes)
+    {
+        int exact = 0, total = 0;
+        CHECK(MaxDifference(s[0], s[1], s[2], s[3], seed++, &exact, &total) <= 1);
+        // Off-by-one only where float rounding of the coordinate or the result lands on a tie
+        CHECK(exact * 100 >= total * 95);
+    }
+}
+
+// Taps themselves, including the clamped edge texels and the 1/256 snap
+static void TestTapsMatchD3DMapping()
+{
+    // 2:1 samples exactly halfway between each texel pair: (a + b + 1) / 2
+    uint8_t src[4 * 4] = { 10, 20, 30, 40, 11, 21, 31, 41, 200, 0, 255, 1, 0, 255, 0, 254 };
+    BilinearSampler sampler;
+    CHECK(sampler.Configure(4, 1, 2, 1));
+    uint8_t dst[2 * 4];
+    sampler.Scale(src, 16, dst, 8);
+    const uint8_t expected[8] = { 11, 21, 31, 41, 100, 128, 128, 128 };
+    for (int i = 0; i < 8; i++)
+        CHECK_EQ(dst[i], expected[i]);
+
+    // 1 -> 3 upscaling: every tap clamps to the single texel
+    uint8_t one[4] = { 1, 2, 3, 4 };
+    uint8_t three[12];
+    CHECK(sampler.Configure(1, 1, 3, 1));
+    sampler.Scale(one, 4, three, 12);
+    for (int i = 0; i < 12; i++)
+        CHECK_EQ(three[i], one[i % 4]);
+
+    // 2 -> 3: texel coordinates -1/6, 1/2, 7/6. The outer two blend an edge texel with its clamped
+    // copy, so they come out as that texel exactly; the middle one is halfway.
+    uint8_t pair[8] = { 0, 0, 0, 0, 255, 255, 255, 255 };
+    CHECK(sampler.Configure(2, 1, 3, 1));
+    sampler.Scale(pair, 8, three, 12);
+    CHECK_EQ(three[0], 0);
+    CHECK_EQ(three[4], 128);
+    CHECK_EQ(three[8], 255);
+
+    // 4 -> 3 (the mirror's 4:3): coordinate 1/6 snaps to 43/256, 3/2 to 128/256, 17/6 to 213/256
+    uint8_t ramp[16] = { 0, 0, 0, 0, 255, 255, 255, 255, 0, 0, 0, 0, 255, 255, 255, 255 };
+    CHECK(sampler.Configure(4, 1, 3, 1));
+    sampler.Scale(ramp, 16, three, 12);
+    CHECK_EQ(three[0], (255 * 43 + 128) >> 8);
+    CHECK_EQ(three[4], (255 * 128 + 128) >> 8);
+    CHECK_EQ(three[8], (255 * 213 + 128) >> 8);
+}
+
+// Streaming row stores give the same rows as regular ones, in both light modes, on unaligned rows
+// (odd pitch), and leave the pitch padding alone
+static void TestStreamingRowsMatch()
+{
+    const int srcWidth = 401, srcHeight = 300, dstWidth = 250, dstHeight = 190;
+    int dstPitch = dstWidth * 4 + 36;
+    std::vector<uint8_t> src((size_t)srcWidth * srcHeight * 4);
+    TestRandom random(41);
+    for (uint8_t& v : src)
+        v = (uint8_t)random.Next();
+
+    for (int linear = 0; linear < 2; linear++)
+    {
+        BilinearSampler sampler;
+        CHECK(sampler.Configure(srcWidth, srcHeight, dstWidth, dstHeight, linear != 0));
+        std::vector<uint8_t> cached((size_t)dstPitch * dstHeight, 0xCD), streamed(cached);
+        sampler.ScaleRows(src.data(), srcWidth * 4, cached.data() + 4, dstPitch, 0, dstHeight);
+        sampler.ScaleRows(src.data(), srcWidth * 4, streamed.data() + 4, dstPitch, 0, dstHeight, true);
+        StreamFence();
+        CHECK(streamed == cached);
+    }
+}
+
+int main()
+{
+    RUN_TEST(TestMatchesReferenceWithinOneLsb);
+    RUN_TEST(TestTapsMatchD3DMapping);
+    RUN_TEST(TestStreamingRowsMatch);
+    return TestExitCode();
+}
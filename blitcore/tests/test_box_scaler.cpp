@@ -0,0 +1,239 @@
+// BoxScaler tests: exactness against a brute-force box average at arbitrary ratios, 32-bit table
+// wraparound, the reciprocal division's correction step, and table reuse across sizes
+
+#include "test_common.h"
+
+#include "box_scaler.h"
+#include "linear_light.h"
+
+#include <algorithm>
+#include <vector>
+
+static uint64_t Gcd(uint64_t a, uint64_t b)
+{
+    return b ? Gcd(b, a % b) : a;
+}
+
+// Coverage of source pixel s by output pixel o along one axis, in 1/dst source pixels
+static uint64_t Overlap(int o, int s, int src, int dst)
+{
+    int64_t a = std::max((int64_t)o * src, (int64_t)s * dst);
+    int64_t b = std::min((int64_t)(o + 1) * src, (int64_t)(s + 1) * dst);
+    return b > a ? (uint64_t)(b - a) : 0;
+}
+
+// Exact weighted box sums in 64 bits for every output channel: the weights add up to srcW * srcH,
+// so the sum is average * srcW * srcH, returned reduced to average * divisor like the scaler's
+// (divisor = srcW/gx * srcH/gy)
+static void BruteForceSums(const uint32_t* values, int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+                           std::vector<uint64_t>* sums, uint64_t* divisor)
+{
+    uint64_t gx = Gcd(srcWidth, dstWidth), gy = Gcd(srcHeight, dstHeight);
+    *divisor = (srcWidth / gx) * (srcHeight / gy);
+    sums->assign((size_t)dstWidth * dstHeight * 4, 0);
+    for (int oy = 0; oy < dstHeight; oy++)
+    {
+        int y0 = (int)((int64_t)oy * srcHeight / dstHeight);
+        int y1 = (int)(((int64_t)(oy + 1) * srcHeight + dstHeight - 1) / dstHeight);
+        for (int ox = 0; ox < dstWidth; ox++)
+        {
+            int x0 = (int)((int64_t)ox * srcWidth / dstWidth);
+            int x1 = (int)(((int64_t)(ox + 1) * srcWidth + dstWidth - 1) / dstWidth);
+            uint64_t* sum = &(*sums)[((size_t)oy * dstWidth + ox) * 4];
+            for (int y = y0; y < y1; y++)
+            {
+                uint64_t wy = Overlap(oy, y, srcHeight, dstHeight);
+                for (int x = x0; x < x1; x++)
+                {
+                    uint64_t w = wy * Overlap(ox, x, srcWidth, dstWidth);
+                    for (int c = 0; c < 4; c++)
+                        sum[c] += w * values[((size_t)y * srcWidth + x) * 4 + c];
+                }
+            }
+            // Every overlap is a multiple of the gcd on its axis
+            for (int c = 0; c < 4; c++)
+                sum[c] /= gx * gy;
+        }
+    }
+}
+
+// Rounded average from a reduced sum, and whether the scaler's 0.32 reciprocal estimate of it is low
+// by one (the case the correction step exists for)
+static uint32_t RoundedAverage(uint64_t sum, uint64_t divisor, int* corrections)
+{
+    uint32_t t = (uint32_t)(sum + divisor / 2);
+    uint32_t estimate = (uint32_t)(((uint64_t)t * (0xFFFFFFFFu / (uint32_t)divisor)) >> 32);
+    uint32_t exact = t / (uint32_t)divisor;
+    *corrections += estimate != exact;
+    return exact;
+}
+
+// Checks the scaler against the brute force at one ratio; returns how many outputs needed the correction
+static int CheckExact(BoxScaler& scaler, int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+                      const std::vector<uint8_t>& src, bool linearLight)
+{
+    CHECK(scaler.Configure(srcWidth, srcHeight, dstWidth, dstHeight, linearLight));
+    std::vector<uint8_t> dst((size_t)dstWidth * dstHeight * 4);
+    scaler.Scale(src.data(), srcWidth * 4, dst.data(), dstWidth * 4);
+
+    std::vector<uint32_t> values(src.size());
+    if (linearLight)
+    {
+        std::vector<uint16_t> row((size_t)srcWidth * 4);
+        for (int y = 0; y < srcHeight; y++)
+        {
+            SrgbRowToLinear(&src[(size_t)y * srcWidth * 4], row.data(), srcWidth);
+            for (int i = 0; i < srcWidth * 4; i++)
+                values[(size_t)y * srcWidth * 4 + i] = row[i];
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < src.size(); i++)
+            values[i] = src[i];
+    }
+
+    std::vector<uint64_t> sums;
+    uint64_t divisor;
+    BruteForceSums(values.data(), srcWidth, srcHeight, dstWidth, dstHeight, &sums, &divisor);
+
+    int corrections = 0;
+    int mismatches = 0;
+    std::vector<uint16_t> linear((size_t)dstWidth * 4);
+    std::vector<uint8_t> expected((size_t)dstWidth * 4);
+    for (int oy = 0; oy < dstHeight && mismatches < 8; oy++)
+    {
+        for (int i = 0; i < dstWidth * 4; i++)
+        {
+            uint32_t average = RoundedAverage(sums[(size_t)oy * dstWidth * 4 + i], divisor, &corrections);
+            linear[i] = (uint16_t)average;
+            expected[i] = (uint8_t)average;
+        }
+        if (linearLight)
+            LinearRowToSrgb(linear.data(), expected.data(), dstWidth);
+        for (int i = 0; i < dstWidth * 4 && mismatches < 8; i++)
+        {
+            if (dst[(size_t)oy * dstWidth * 4 + i] != expected[i])
+            {
+                fprintf(stderr, "%dx%d -> %dx%d%s: byte %d of row %d is %d, expected %d\n", srcWidth, srcHeight,
+                        dstWidth, dstHeight, linearLight ? " linear" : "", i, oy,
+                        dst[(size_t)oy * dstWidth * 4 + i], expected[i]);
+                mismatches++;
+            }
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+    return corrections;
+}
+
+static std::vector<uint8_t> RandomImage(int width, int height, TestRandom& random)
+{
+    std::vector<uint8_t> image((size_t)width * height * 4);
+    for (uint8_t& v : image)
+        v = (uint8_t)random.Next();
+    return image;
+}
+
+// 2:1 in both directions is the plain 2x2 block average, rounded to nearest
+static void TestHalvingAveragesBlocks()
+{
+    const int width = 64, height = 32;
+    std::vector<uint8_t> src((size_t)width * height * 4);
+    TestRandom random;
+    for (uint8_t& v : src)
+        v = (uint8_t)random.Next();
+
+    BoxScaler scaler;
+    CHECK(scaler.Configure(width, height, width / 2, height / 2));
+    std::vector<uint8_t> dst((size_t)width / 2 * height / 2 * 4);
+    scaler.Scale(src.data(), width * 4, dst.data(), width / 2 * 4);
+
+    for (int y = 0; y < height / 2; y++)
+    {
+        for (int x = 0; x < width / 2; x++)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                int sum = src[((2 * y) * width + 2 * x) * 4 + c] + src[((2 * y) * width + 2 * x + 1) * 4 + c] +
+                          src[((2 * y + 1) * width + 2 * x) * 4 + c] + src[((2 * y + 1) * width + 2 * x + 1) * 4 + c];
+                CHECK_EQ(dst[(y * width / 2 + x) * 4 + c], (sum + 2) / 4);
+            }
+        }
+    }
+}
+
+// Non-integer ratios with fractional edge coverage on both axes, up- and downscaling, both modes
+static void TestMatchesBruteForce()
+{
+    const int sizes[][4] = {
+        { 1920, 216, 1440, 216 }, { 240, 216, 180, 162 }, { 97, 61, 13, 7 }, { 50, 50, 49, 51 },
+        { 7, 5, 19, 11 }, { 256, 3, 3, 2 }, { 1, 1, 1, 1 }, { 333, 100, 1, 1 },
+    };
+    TestRandom random(34);
+    BoxScaler scaler;
+    int corrections = 0;
+    for (const int* s : sizes)
+    {
+        std::vector<uint8_t> src = RandomImage(s[0], s[1], random);
+        corrections += CheckExact(scaler, s[0], s[1], s[2], s[3], src, false);
+        CheckExact(scaler, s[0], s[1], s[2], s[3], src, true);
+    }
+    // The reciprocal estimate was low by one somewhere, so the correction step was exercised
+    CHECK(corrections > 0);
+}
+
+// A bright 4400x4400 source sums past 2^32 in the table's lower right; the box sums still come out exact.
+// In linear light (15-bit values) 512x512 is enough.
+static void TestTableWraparound()
+{
+    TestRandom random(4400);
+    BoxScaler scaler;
+
+    std::vector<uint8_t> bright((size_t)4400 * 4400 * 4);
+    for (uint8_t& v : bright)
+        v = (uint8_t)(224 + random.Below(32));
+    CHECK((uint64_t)4400 * 4400 * 224 > 0xFFFFFFFFull);
+    CheckExact(scaler, 4400, 4400, 1100, 825, bright, false);
+
+    std::vector<uint8_t> white((size_t)512 * 512 * 4, 0xFF);
+    CheckExact(scaler, 512, 512, 384, 384, white, true);
+    CHECK((uint64_t)512 * 512 * LINEAR_LIGHT_MAX > 0xFFFFFFFFull);
+}
+
+// Per-tile reconfiguration: a smaller size reuses the larger table (new stride, stale contents) and
+// still matches a fresh scaler
+static void TestReconfigureReusesTable()
+{
+    TestRandom random(7);
+    BoxScaler reused;
+    reused.Reserve(240, 216, 180, 216);
+    std::vector<uint8_t> large = RandomImage(240, 216, random);
+    CheckExact(reused, 240, 216, 180, 216, large, false);
+
+    const int sizes[][4] = { { 239, 215, 179, 215 }, { 240, 216, 180, 216 }, { 17, 200, 5, 150 }, { 240, 1, 7, 1 } };
+    for (const int* s : sizes)
+    {
+        std::vector<uint8_t> src = RandomImage(s[0], s[1], random);
+        CheckExact(reused, s[0], s[1], s[2], s[3], src, false);
+        CheckExact(reused, s[0], s[1], s[2], s[3], src, true);
+    }
+}
+
+static void TestRejectsUnsupportedRatios()
+{
+    BoxScaler scaler;
+    CHECK(!scaler.Configure(0, 10, 5, 5));
+    // Coprime 8191 -> 1 by 4099 -> 1: reduced box area 8191 * 4099 >= 2^24
+    CHECK(!scaler.Configure(8191, 4099, 1, 1));
+    CHECK(scaler.Configure(1920, 1080, 1440, 1080));
+}
+
+int main()
+{
+    RUN_TEST(TestHalvingAveragesBlocks);
+    RUN_TEST(TestMatchesBruteForce);
+    RUN_TEST(TestTableWraparound);
+    RUN_TEST(TestReconfigureReusesTable);
+    RUN_TEST(TestRejectsUnsupportedRatios);
+    return TestExitCode();
+}
@@ -0,0 +1,112 @@
+// Minimal check macros and fakes shared by the blitcore tests (platform independent)
+// Each test is its own executable registered with ctest; a failed CHECK prints the expression
+// and its location, and the process exits non-zero if any check failed.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "frame_pacer.h"
+
+inline int g_TestFailures = 0;
+
+#define CHECK(cond)                                                                     \
+    do                                                                                  \
+    {                                                                                   \
+        if (!(cond))                                                                    \
+        {                                                                               \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);    \
+            g_TestFailures++;                                                           \
+        }                                                                               \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                  \
+    do                                                                                  \
+    {                                                                                   \
+        long long va_ = (long long)(a);                                                 \
+        long long vb_ = (long long)(b);                                                 \
+        if (va_ != vb_)                                                                 \
+        {                                                                               \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n",           \
+                    __FILE__, __LINE__, #a, #b, va_, vb_);                              \
+            g_TestFailures++;                                                           \
+        }                                                                               \
+    } while (0)
+
+#define CHECK_NEAR(a, b, tolerance)                                                     \
+    do                                                                                  \
+    {                                                                                   \
+        double va_ = (double)(a);                                                       \
+        double vb_ = (double)(b);                                                       \
+        if (va_ - vb_ > (tolerance) || vb_ - va_ > (tolerance))                         \
+        {                                                                               \
+            fprintf(stderr, "%s:%d: CHECK_NEAR(%s, %s, %s) failed: %g vs %g\n",         \
+                    __FILE__, __LINE__, #a, #b, #tolerance, va_, vb_);                  \
+            g_TestFailures++;                                                           \
+        }                                                                               \
+    } while (0)
+
+#define RUN_TEST(test)                                                                  \
+    do                                                                                  \
+    {                                                                                   \
+        int before_ = g_TestFailures;                                                   \
+        test();                                                                         \
+        printf("%s %s\n", g_TestFailures == before_ ? "PASS" : "FAIL", #test);          \
+    } while (0)
+
+inline int TestExitCode()
+{
+    if (g_TestFailures)
+        fprintf(stderr, "%d check(s) failed\n", g_TestFailures);
+    return g_TestFailures ? 1 : 0;
+}
+
+// Deterministic clock: sleeping jumps to the deadline plus a configurable overshoot,
+// each spin iteration advances time by relaxStepNs
+class FakeFrameClock : public FrameClock
+{
+public:
+    int64_t NowNs() override { return now; }
+    void SleepUntilNs(int64_t deadlineNs) override
+    {
+        sleeps++;
+        if (deadlineNs + overshootNs > now)
+            now = deadlineNs + overshootNs;
+    }
+    void Relax() override
+    {
+        relaxes++;
+        now += relaxStepNs;
+    }
+
+    void Advance(int64_t ns) { now += ns; }
+
+    int64_t now = 0;
+    int64_t overshootNs = 0;
+    int64_t relaxStepNs = 1000;
+    uint64_t sleeps = 0;
+    uint64_t relaxes = 0;
+};
+
+// Small deterministic generator so image tests are reproducible everywhere
+class TestRandom
+{
+public:
+    explicit TestRandom(uint32_t seed = 12345) : m_State(seed ? seed : 1) {}
+
+    uint32_t Next()
+    {
+        m_State ^= m_State << 13;
+        m_State ^= m_State >> 17;
+        m_State ^= m_State << 5;
+        return m_State;
+    }
+
+    // [0, range)
+    int Below(int range) { return (int)(Next() % (uint32_t)range); }
+
+private:
+    uint32_t m_State;
+};
@@ -0,0 +1,191 @@
+// Cursor shape decoding tests: monochrome truth table, premultiplied colour, and equivalence with
+// the per-pixel decoder UpdateCursorShape used before the table/SSE2 decoder
+
+#include "test_common.h"
+
+#include "cursor_shape.h"
+
+#include <string.h>
+
+#include <vector>
+
+static void TestMonochromeTruthTable()
+{
+    // 8 x 1 cursor: AND and XOR masks are one row each (height 2 covers both)
+    // pixels 0-1: AND 0 XOR 0, 2-3: AND 0 XOR 1, 4-5: AND 1 XOR 0, 6-7: AND 1 XOR 1
+    uint8_t shape[2] = { 0x0F, 0x33 };
+    CursorSprite sprite;
+    ReserveCursorSprite(&sprite);
+    CHECK(DecodeCursorShape(CURSOR_SHAPE_MONOCHROME, 8, 2, 1, shape, &sprite));
+    CHECK_EQ(sprite.width, 8);
+    CHECK_EQ(sprite.height, 1);
+
+    const uint32_t pixels[8] = { 0xFF000000, 0xFF000000, 0xFFFFFFFF, 0xFFFFFFFF, 0, 0, 0, 0 };
+    const uint32_t invert[8] = { 0, 0, 0, 0, 0, 0, 0x00FFFFFF, 0x00FFFFFF };
+    for (int x = 0; x < 8; x++)
+    {
+        CHECK_EQ(sprite.pixels[x], pixels[x]);
+        CHECK_EQ(sprite.invert[x], invert[x]);
+    }
+    CHECK(sprite.hasInvert);
+}
+
+static void TestColorIsPremultiplied()
+{
+    const uint32_t shape[4] = { 0xFF102030, 0x80FF8000, 0x00FFFFFF, 0x40404040 };
+    CursorSprite sprite;
+    CHECK(DecodeCursorShape(CURSOR_SHAPE_COLOR, 4, 1, 16, (const uint8_t*)shape, &sprite));
+
+    CHECK_EQ(sprite.pixels[0], 0xFF102030u);
+    CHECK_EQ(sprite.pixels[1], 0x80804000u);    // 255 * 128 / 255 = 128, 128 * 128 / 255 = 64
+    CHECK_EQ(sprite.pixels[2], 0u);
+    CHECK_EQ(sprite.pixels[3], 0x40101010u);
+    CHECK(!sprite.hasInvert);
+}
+
+// The original per-pixel decode (straight alpha BGRA). Invert pixels had no XOR path and came out
+// semi-transparent: white at alpha 128 for monochrome, the shape's colour at alpha 128 for masked colour.
+static void LegacyDecode(CursorShapeType type, int width, int height, int pitch, const uint8_t* shape,
+                         std::vector<uint8_t>* out)
+{
+    int spriteHeight = type == CURSOR_SHAPE_MONOCHROME ? height / 2 : height;
+    out->assign((size_t)width * spriteHeight * 4, 0);
+    uint8_t* buffer = out->data();
+
+    for (int y = 0; y < spriteHeight; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            uint8_t* d = buffer + (y * width + x) * 4;
+            if (type == CURSOR_SHAPE_MONOCHROME)
+            {
+                int byteIdx = y * pitch + x / 8;
+                int bitIdx = 7 - (x % 8);
+                int andBit = (shape[byteIdx] >> bitIdx) & 1;
+                int xorBit = (shape[byteIdx + spriteHeight * pitch] >> bitIdx) & 1;
+                uint8_t c = xorBit ? 255 : 0;
+                d[0] = d[1] = d[2] = (andBit && !xorBit) ? 0 : c;
+                d[3] = !andBit ? 255 : (xorBit ? 128 : 0);
+            }
+            else if (type == CURSOR_SHAPE_COLOR)
+            {
+                memcpy(d, shape + y * pitch + x * 4, 4);
+            }
+            else
+            {
+                const uint8_t* s = shape + y * pitch + x * 4;
+                d[0] = s[0];
+                d[1] = s[1];
+                d[2] = s[2];
+                d[3] = s[3] ? 128 : 255;
+            }
+        }
+    }
+}
+
+static uint32_t Premultiply(const uint8_t* p)
+{
+    uint32_t a = p[3];
+    uint32_t b = (p[0] * a + 127) / 255;
+    uint32_t g = (p[1] * a + 127) / 255;
+    uint32_t r = (p[2] * a + 127) / 255;
+    return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+// Every pixel the legacy decoder drew opaquely or blended comes out as the same premultiplied colour.
+// Legacy "semi-transparent" invert pixels are now a true XOR: no colour, and the legacy RGB
+// (white for monochrome, the shape colour for masked colour) as the invert mask.
+static void CheckMatchesLegacy(CursorShapeType type, int width, int height, int pitch, const uint8_t* shape)
+{
+    std::vector<uint8_t> legacy;
+    LegacyDecode(type, width, height, pitch, shape, &legacy);
+
+    CursorSprite sprite;
+    ReserveCursorSprite(&sprite);
+    CHECK(DecodeCursorShape(type, width, height, pitch, shape, &sprite));
+    CHECK_EQ(sprite.pixels.size() * 4, legacy.size());
+
+    bool anyInvert = false;
+    int mismatches = 0;
+    for (size_t i = 0; i < sprite.pixels.size() && mismatches < 8; i++)
+    {
+        const uint8_t* old = &legacy[i * 4];
+        bool invert = type != CURSOR_SHAPE_COLOR && old[3] == 128;
+        uint32_t pixel = invert ? 0 : Premultiply(old);
+        uint32_t xorMask = invert ? ((uint32_t)old[2] << 16 | (uint32_t)old[1] << 8 | old[0]) : 0;
+        if (sprite.pixels[i] != pixel || sprite.invert[i] != xorMask)
+        {
+            fprintf(stderr, "type %d %dx%d pixel %zu: %08x/%08x, expected %08x/%08x\n", (int)type, width,
+                    height, i, sprite.pixels[i], sprite.invert[i], pixel, xorMask);
+            mismatches++;
+        }
+        anyInvert |= xorMask != 0;
+    }
+    CHECK_EQ(mismatches, 0);
+    CHECK_EQ(sprite.hasInvert, anyInvert);
+}
+
+// Odd widths exercise the scalar tail after the 8-pixel (monochrome) and 4-pixel (masked) SIMD groups
+static void TestMatchesLegacyDecoder()
+{
+    const int widths[] = { 1, 3, 7, 8, 9, 13, 17, 31, 32, 33, 45, 64, 255, 256 };
+    TestRandom random(2024);
+
+    for (int width : widths)
+    {
+        int height = 1 + random.Below(40);
+
+        // Monochrome: pitch rounded to bytes plus slack, as DXGI may hand out
+        int monoPitch = (width + 7) / 8 + random.Below(3);
+        std::vector<uint8_t> mono((size_t)monoPitch * height * 2);
+        for (uint8_t& v : mono)
+            v = (uint8_t)random.Next();
+        CheckMatchesLegacy(CURSOR_SHAPE_MONOCHROME, width, height * 2, monoPitch, mono.data());
+
+        // Colour shapes: the alpha byte is the mask (masked colour) or straight alpha (colour);
+        // masked-colour masks are 0x00 or 0xFF like real shapes, colour alpha covers every value
+        int pitch = width * 4 + random.Below(3) * 4;
+        std::vector<uint8_t> masked((size_t)pitch * height), color((size_t)pitch * height);
+        for (size_t i = 0; i < masked.size(); i++)
+        {
+            masked[i] = (uint8_t)random.Next();
+            color[i] = (uint8_t)random.Next();
+            if (i % 4 == 3)
+                masked[i] = random.Below(2) ? 0xFF : 0x00;
+        }
+        CheckMatchesLegacy(CURSOR_SHAPE_MASKED_COLOR, width, height, pitch, masked.data());
+        CheckMatchesLegacy(CURSOR_SHAPE_COLOR, width, height, pitch, color.data());
+    }
+}
+
+// A shape without invert pixels clears hasInvert even when the previous shape had them
+static void TestInvertFlagResets()
+{
+    uint8_t invertShape[2] = { 0xFF, 0xFF };    // AND 1, XOR 1: all invert
+    uint8_t plainShape[2] = { 0x00, 0xFF };     // AND 0, XOR 1: all white
+    CursorSprite sprite;
+    CHECK(DecodeCursorShape(CURSOR_SHAPE_MONOCHROME, 8, 2, 1, invertShape, &sprite));
+    CHECK(sprite.hasInvert);
+    CHECK(DecodeCursorShape(CURSOR_SHAPE_MONOCHROME, 8, 2, 1, plainShape, &sprite));
+    CHECK(!sprite.hasInvert);
+    for (int x = 0; x < 8; x++)
+        CHECK_EQ(sprite.pixels[x], 0xFFFFFFFFu);
+}
+
+static void TestRejectsUnknownShapes()
+{
+    uint8_t shape[16] = {};
+    CursorSprite sprite;
+    CHECK(!DecodeCursorShape((CursorShapeType)3, 4, 1, 16, shape, &sprite));
+    CHECK(!DecodeCursorShape(CURSOR_SHAPE_COLOR, 0, 1, 16, shape, &sprite));
+}
+
+int main()
+{
+    RUN_TEST(TestMonochromeTruthTable);
+    RUN_TEST(TestColorIsPremultiplied);
+    RUN_TEST(TestMatchesLegacyDecoder);
+    RUN_TEST(TestInvertFlagResets);
+    RUN_TEST(TestRejectsUnknownShapes);
+    return TestExitCode();
+}
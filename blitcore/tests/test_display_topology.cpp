@@ -0,0 +1,255 @@
+// Capture planning tests: the default topology reproduces the compile-time layout, and
+// multi-monitor desktops (negative coordinates, mixed DPI and refresh, portrait outputs) plan
+// source rects, placements and scale factors in physical pixels
+
+#include "test_common.h"
+
+#include "display_topology.h"
+
+static DisplayMonitor Monitor(int x, int y, int width, int height, int dpi, int hz, bool primary = false)
+{
+    DisplayMonitor monitor;
+    monitor.x = x;
+    monitor.y = y;
+    monitor.width = width;
+    monitor.height = height;
+    monitor.dpi = dpi;
+    monitor.rate = FrameRateFromHz(hz);
+    monitor.primary = primary;
+    return monitor;
+}
+
+// A 4K panel at 150% left of and above a 1080p primary at 100%, plus a 1440p at 125% on the right:
+// desktop coordinates are physical pixels, so the 4K monitor spans x -3840..-1
+static DisplayTopology MixedDpiTopology()
+{
+    DisplayTopology topology;
+    topology.monitors.push_back(Monitor(1920, 0, 2560, 1440, 120, 144));
+    topology.monitors.push_back(Monitor(-3840, -1080, 3840, 2160, 144, 60));
+    topology.monitors.push_back(Monitor(0, 0, 1920, 1080, 96, 60, true));
+    return topology;
+}
+
+static void TestDefaultTopologyMatchesConstants()
+{
+    CapturePlan plan;
+    CHECK(PlanCapture(DefaultDisplayTopology(), CapturePlanOptions(), &plan));
+
+    const MirrorGeometry& g = plan.geometry;
+    CHECK_EQ(g.sourceX, FIRST_MONITOR_X);
+    CHECK_EQ(g.sourceY, FIRST_MONITOR_Y);
+    CHECK_EQ(g.sourceWidth, SOURCE_WIDTH);
+    CHECK_EQ(g.sourceHeight, SOURCE_HEIGHT);
+    CHECK_EQ(g.renderWidth, RENDER_WIDTH);
+    CHECK_EQ(g.renderHeight, RENDER_HEIGHT);
+    CHECK_EQ(g.outputWidth, OUTPUT_WIDTH);
+    CHECK_EQ(g.outputHeight, OUTPUT_HEIGHT);
+    CHECK_NEAR(plan.renderU, 0.75, 1e-6);
+    CHECK_NEAR(plan.scaleX, 0.75, 1e-6);
+    CHECK_NEAR(plan.scaleY, 1.0, 1e-6);
+    CHECK(plan.SameAs(CapturePlan()));
+}
+
+static void TestEmptyTopologyFails()
+{
+    CapturePlan plan;
+    plan.outputX = 123;
+    CHECK(!PlanCapture(DisplayTopology(), CapturePlanOptions(), &plan));
+    CHECK_EQ(plan.outputX, 123);
+}
+
+static void TestParseOptions()
+{
+    CapturePlanOptions options;
+    ParseCapturePlanOptions("app.exe --source-monitor=2 --output-monitor=x", &options);
+    CHECK_EQ(options.sourceMonitor, 1);
+    CHECK_EQ(options.outputMonitor, -1);
+}
+
+static void TestIndexAtCoversNegativeCoordinates()
+{
+    DisplayTopology topology = MixedDpiTopology();
+    CHECK_EQ(topology.IndexAt(0, 0), 2);
+    CHECK_EQ(topology.IndexAt(-1, -1), 1);
+    CHECK_EQ(topology.IndexAt(-3840, -1080), 1);
+    CHECK_EQ(topology.IndexAt(-3841, 0), -1);
+    CHECK_EQ(topology.IndexAt(-1, 1080), -1);       // Below the 4K panel, left of the primary
+    CHECK_EQ(topology.IndexAt(1919, 1079), 2);
+    CHECK_EQ(topology.IndexAt(1920, 1079), 0);
+    CHECK_EQ(topology.IndexAt(4479, 1439), 0);
+    CHECK_EQ(topology.IndexAt(4480, 0), -1);
+    CHECK_EQ(topology.PrimaryIndex(), 2);
+}
+
+// By default the monitor at the desktop origin is mirrored onto itself, whatever the enumeration order
+static void TestDefaultPicksMonitorAtOrigin()
+{
+    CapturePlan plan;
+    CHECK(PlanCapture(MixedDpiTopology(), CapturePlanOptions(), &plan));
+    CHECK_EQ(plan.sourceIndex, 2);
+    CHECK_EQ(plan.outputIndex, 2);
+    CHECK_EQ(plan.geometry.sourceX, 0);
+    CHECK_EQ(plan.geometry.renderWidth, 1440);
+
+    // No monitor at the origin: the primary
+    DisplayTopology shifted;
+    shifted.monitors.push_back(Monitor(100, 0, 1280, 1024, 96, 75));
+    shifted.monitors.push_back(Monitor(-1920, 0, 1920, 1080, 96, 60, true));
+    CHECK(PlanCapture(shifted, CapturePlanOptions(), &plan));
+    CHECK_EQ(plan.sourceIndex, 1);
+}
+
+// Mixed DPI: the 4K source at 150% onto the 1080p output at 100%. Everything is physical pixels,
+// so the scale is 1440 / 3840 across and 1080 / 2160 down, and the DPIs only ride along.
+static void TestMixedDpiSourceOntoOtherMonitor()
+{
+    CapturePlanOptions options;
+    options.sourceMonitor = 1;
+    options.outputMonitor = 2;
+    CapturePlan plan;
+    CHECK(PlanCapture(MixedDpiTopology(), options, &plan));
+
+    const MirrorGeometry& g = plan.geometry;
+    CHECK_EQ(g.sourceX, -3840);
+    CHECK_EQ(g.sourceY, -1080);
+    CHECK_EQ(g.sourceWidth, 3840);
+    CHECK_EQ(g.sourceHeight, 2160);
+    CHECK_EQ(g.renderWidth, 1440);
+    CHECK_EQ(g.renderHeight, 1080);
+    CHECK_EQ(g.outputWidth, 1920);
+    CHECK_EQ(g.outputHeight, 1080);
+    CHECK_EQ(plan.outputX, 0);
+    CHECK_EQ(plan.outputY, 0);
+    CHECK_EQ(plan.sourceDpi, 144);
+    CHECK_EQ(plan.outputDpi, 96);
+    CHECK_NEAR(plan.scaleX, 0.375, 1e-6);
+    CHECK_NEAR(plan.scaleY, 0.5, 1e-6);
+    CHECK_NEAR(plan.renderU, 0.75, 1e-6);
+    CHECK_EQ(plan.sourceRate.num, 60);
+    CHECK_EQ(plan.outputRate.num, 60);
+
+    // Cursor positions are desktop pixels relative to the source rect
+    CHECK_EQ(g.ToRenderX(-1 - g.sourceX), 1439);
+    CHECK_EQ(g.ToRenderY(1079 - g.sourceY), 1079);     // Bottom row, level with the primary's
+    CHECK_EQ(g.ToRenderY(-1 - g.sourceY), 539);
+    CHECK_EQ(g.ToRenderX(-1920 - g.sourceX), 720);
+}
+
+// The 1080p primary mirrored onto the 1440p/144 Hz monitor at 125%: upscaled, output placed at its
+// desktop position, each side keeping its own refresh rate
+static void TestUpscaleOntoHigherRefreshOutput()
+{
+    CapturePlanOptions options;
+    options.outputMonitor = 0;
+    CapturePlan plan;
+    CHECK(PlanCapture(MixedDpiTopology(), options, &plan));
+    CHECK_EQ(plan.sourceIndex, 2);
+    CHECK_EQ(plan.geometry.renderWidth, 1920);
+    CHECK_EQ(plan.geometry.renderHeight, 1440);
+    CHECK_EQ(plan.outputX, 1920);
+    CHECK_EQ(plan.outputDpi, 120);
+    CHECK_NEAR(plan.scaleX, 1.0, 1e-6);
+    CHECK_NEAR(plan.scaleY, 1440.0 / 1080.0, 1e-6);
+    CHECK_EQ(plan.sourceRate.num, 60);
+    CHECK_EQ(plan.outputRate.num, 144);
+}
+
+// A portrait output is narrower than 4:3 at its height: the render area fills it
+static void TestPortraitOutputFills()
+{
+    DisplayTopology topology;
+    topology.monitors.push_back(Monitor(0, 0, 1920, 1080, 96, 60, true));
+    topology.monitors.push_back(Monitor(1920, -420, 1080, 1920, 96, 60));
+    CapturePlanOptions options;
+    options.outputMonitor = 1;
+    CapturePlan plan;
+    CHECK(PlanCapture(topology, options, &plan));
+    CHECK_EQ(plan.geometry.renderWidth, 1080);
+    CHECK_EQ(plan.geometry.renderHeight, 1920);
+    CHECK_NEAR(plan.renderU, 1.0, 1e-6);
+    CHECK_EQ(plan.outputY, -420);
+
+    // Aspect 0 fills any output
+    options.aspectNum = 0;
+    options.outputMonitor = 0;
+    CHECK(PlanCapture(topology, options, &plan));
+    CHECK_EQ(plan.geometry.renderWidth, 1920);
+}
+
+// Missing monitors fail without touching the plan; an unknown refresh rate falls back to the default
+static void TestMissingMonitorsAndRates()
+{
+    DisplayTopology topology = MixedDpiTopology();
+    CapturePlan plan;
+    CHECK(PlanCapture(topology, CapturePlanOptions(), &plan));
+    CapturePlan before = plan;
+
+    CapturePlanOptions options;
+    options.sourceMonitor = 3;
+    CHECK(!PlanCapture(topology, options, &plan));
+    options.sourceMonitor = -1;
+    options.outputMonitor = 5;
+    CHECK(!PlanCapture(topology, options, &plan));
+    CHECK(plan.SameAs(before));
+    CHECK_EQ(plan.sourceIndex, before.sourceIndex);
+
+    topology.monitors[2].rate = FrameRate();
+    CHECK(PlanCapture(topology, CapturePlanOptions(), &plan));
+    CHECK_EQ(plan.sourceRate.num, DEFAULT_FPS);
+}
+
+// A display change that moves the output or changes a rate needs a rebuild; the same layout does not
+static void TestSameAsDetectsLayoutChanges()
+{
+    DisplayTopology topology = MixedDpiTopology();
+    CapturePlanOptions options;
+    options.outputMonitor = 0;
+    CapturePlan a, b;
+    CHECK(PlanCapture(topology, options, &a));
+    CHECK(PlanCapture(topology, options, &b));
+    CHECK(a.SameAs(b));
+
+    topology.monitors[0].x = 1921;
+    CHECK(PlanCapture(topology, options, &b));
+    CHECK(!a.SameAs(b));
+
+    topology = MixedDpiTopology();
+    topology.monitors[0].rate = FrameRateFromHz(120);
+    CHECK(PlanCapture(topology, options, &b));
+    CHECK(!a.SameAs(b));
+
+    topology = MixedDpiTopology();
+    topology.monitors[2].width = 2560;
+    topology.monitors[2].height = 1440;
+    CHECK(PlanCapture(topology, options, &b));
+    CHECK(!a.SameAs(b));
+}
+
+static void TestParseOptionBounds()
+{
+    CapturePlanOptions options;
+    ParseCapturePlanOptions("--source-monitor=0 --output-monitor=65", &options);
+    CHECK_EQ(options.sourceMonitor, -1);
+    CHECK_EQ(options.outputMonitor, -1);
+    ParseCapturePlanOptions("--output-monitor=3 --source-monitor=64", &options);
+    CHECK_EQ(options.sourceMonitor, 63);
+    CHECK_EQ(options.outputMonitor, 2);
+    ParseCapturePlanOptions(nullptr, &options);
+    CHECK_EQ(options.outputMonitor, 2);
+}
+
+int main()
+{
+    RUN_TEST(TestDefaultTopologyMatchesConstants);
+    RUN_TEST(TestEmptyTopologyFails);
+    RUN_TEST(TestParseOptions);
+    RUN_TEST(TestIndexAtCoversNegativeCoordinates);
+    RUN_TEST(TestDefaultPicksMonitorAtOrigin);
+    RUN_TEST(TestMixedDpiSourceOntoOtherMonitor);
+    RUN_TEST(TestUpscaleOntoHigherRefreshOutput);
+    RUN_TEST(TestPortraitOutputFills);
+    RUN_TEST(TestMissingMonitorsAndRates);
+    RUN_TEST(TestSameAsDetectsLayoutChanges);
+    RUN_TEST(TestParseOptionBounds);
+    return TestExitCode();
+}
@@ -0,0 +1,252 @@
+// EventLoop tests: each wake reason (deadline, registered timerfd/eventfd sources, Post), their
+// priority, what a wait consumes and what it leaves to the caller, and the per-reason counters
+
+#include "test_common.h"
+
+#include "event_loop.h"
+
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+
+constexpr int64_t MS = 1000000;
+
+static int64_t Now()
+{
+    return GetSystemFrameClock()->NowNs();
+}
+
+static void Signal(int fd)
+{
+    uint64_t one = 1;
+    CHECK_EQ(write(fd, &one, sizeof(one)), (ssize_t)sizeof(one));
+}
+
+// Reads an eventfd or timerfd; false when it was not signalled
+static bool Drain(int fd)
+{
+    uint64_t value;
+    return read(fd, &value, sizeof(value)) == (ssize_t)sizeof(value);
+}
+
+static void ArmTimer(int fd, int64_t ns)
+{
+    itimerspec spec = {};
+    spec.it_value.tv_sec = (time_t)(ns / 1000000000);
+    spec.it_value.tv_nsec = (long)(ns % 1000000000);
+    CHECK_EQ(timerfd_settime(fd, 0, &spec, nullptr), 0);
+}
+
+// The deadline wakes no earlier than requested; one already passed returns without sleeping
+static void TestDeadlineWake()
+{
+    EventLoop loop;
+    CHECK(loop.IsValid());
+
+    int64_t deadline = Now() + 5 * MS;
+    CHECK_EQ(loop.Wait(deadline), WAKE_DEADLINE);
+    CHECK(Now() >= deadline);
+    CHECK_EQ(loop.Stats().wakeups[WAKE_DEADLINE], 1u);
+    CHECK(loop.Stats().sleptNs >= 5 * MS);
+
+    CHECK_EQ(loop.Wait(Now() - 1), WAKE_DEADLINE);
+    CHECK_EQ(loop.Stats().immediate, 1u);
+    CHECK_EQ(loop.Stats().wakeups[WAKE_DEADLINE], 1u);
+}
+
+// Posts before the wait, or from another thread during it, end it; several coalesce into one wake
+// and are consumed, so the next wait runs to its deadline
+static void TestPostWakes()
+{
+    EventLoop loop;
+    loop.Post();
+    loop.Post();
+    CHECK_EQ(loop.Wait(-1), WAKE_POSTED);
+    CHECK_EQ(loop.Wait(Now() + 2 * MS), WAKE_DEADLINE);
+
+    std::thread poster([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        loop.Post();
+    });
+    int64_t start = Now();
+    CHECK_EQ(loop.Wait(Now() + 5000 * MS), WAKE_POSTED);
+    CHECK(Now() - start < 1000 * MS);
+    poster.join();
+    CHECK_EQ(loop.Stats().wakeups[WAKE_POSTED], 2u);
+    CHECK_EQ(loop.Stats().wakeups[WAKE_DEADLINE], 1u);
+}
+
+// A timerfd and an eventfd as sources: each reports its own index, and stays signalled until the
+// caller drains it
+static void TestSourceWakes()
+{
+    EventLoop loop;
+    int timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    int event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    int timerIndex = loop.AddSource(timer);
+    int eventIndex = loop.AddSource(event);
+    CHECK(timerIndex >= 0 && eventIndex >= 0 && timerIndex != eventIndex);
+
+    ArmTimer(timer, 3 * MS);
+    int source = -1;
+    int64_t start = Now();
+    CHECK_EQ(loop.Wait(Now() + 5000 * MS, &source), WAKE_SOURCE);
+    CHECK_EQ(source, timerIndex);
+    CHECK(Now() - start >= 3 * MS && Now() - start < 1000 * MS);
+    CHECK(Drain(timer));
+
+    Signal(event);
+    source = -1;
+    CHECK_EQ(loop.Wait(-1, &source), WAKE_SOURCE);
+    CHECK_EQ(source, eventIndex);
+    source = -1;
+    CHECK_EQ(loop.Wait(-1, &source), WAKE_SOURCE);     // Not drained: wakes again at once
+    CHECK_EQ(source, eventIndex);
+    CHECK(Drain(event));
+    CHECK_EQ(loop.Wait(Now() + 2 * MS), WAKE_DEADLINE);
+    CHECK_EQ(loop.Stats().wakeups[WAKE_SOURCE], 3u);
+
+    close(event);
+    close(timer);
+}
+
+// When several are ready at once a Post wins over sources, and sources over the deadline
+static void TestWakePriority()
+{
+    // The fake clock stands still, so a 1 ns deadline is armed (not immediate) and has expired by
+    // the time epoll looks
+    FakeFrameClock clock;
+    EventLoop loop(&clock);
+    int event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    int index = loop.AddSource(event);
+
+    Signal(event);
+    loop.Post();
+    CHECK_EQ(loop.Wait(1), WAKE_POSTED);
+
+    for (int i = 0; i < 100; i++)
+    {
+        int source = -1;
+        CHECK_EQ(loop.Wait(1, &source), WAKE_SOURCE);
+        CHECK_EQ(source, index);
+    }
+    CHECK(Drain(event));
+    CHECK_EQ(loop.Wait(1), WAKE_DEADLINE);
+
+    close(event);
+}
+
+// Removed sources no longer wake; the table holds EVENT_LOOP_MAX_SOURCES and rejects bad descriptors
+static void TestSourceTable()
+{
+    EventLoop loop;
+    int fds[EVENT_LOOP_MAX_SOURCES];
+    for (int i = 0; i < EVENT_LOOP_MAX_SOURCES; i++)
+    {
+        fds[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        CHECK_EQ(loop.AddSource(fds[i]), i);
+    }
+    int extra = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    CHECK_EQ(loop.AddSource(extra), -1);
+
+    loop.RemoveSource(2);
+    Signal(fds[2]);
+    CHECK_EQ(loop.Wait(Now() + 2 * MS), WAKE_DEADLINE);
+    CHECK_EQ(loop.AddSource(extra), 2);     // The freed slot is reused
+    Signal(extra);
+    int source = -1;
+    CHECK_EQ(loop.Wait(-1, &source), WAKE_SOURCE);
+    CHECK_EQ(source, 2);
+
+    loop.RemoveSource(2);
+    CHECK_EQ(loop.AddSource(-1), -1);
+    for (int i = 0; i < EVENT_LOOP_MAX_SOURCES; i++)
+        close(fds[i]);
+    close(extra);
+}
+
+// Drains the source and keeps sleeping; a Post ends the sleep
+class CountingHandler : public EventHandler
+{
+public:
+    explicit CountingHandler(int fd) : m_Fd(fd) {}
+
+    bool OnEvent(EventWake wake, int source) override
+    {
+        if (wake == WAKE_SOURCE)
+        {
+            sources++;
+            lastSource = source;
+            Drain(m_Fd);
+            return true;
+        }
+        posts += wake == WAKE_POSTED;
+        return false;
+    }
+
+    int sources = 0;
+    int posts = 0;
+    int lastSource = -1;
+
+private:
+    int m_Fd;
+};
+
+// As the pacer's waiter: events go to the handler, which decides whether the sleep continues
+static void TestSleepUntilPassesEventsToHandler()
+{
+    EventLoop loop;
+    int event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    int index = loop.AddSource(event);
+    CountingHandler handler(event);
+    loop.SetHandler(&handler);
+
+    Signal(event);
+    int64_t deadline = Now() + 10 * MS;
+    CHECK(loop.SleepUntilNs(deadline));
+    CHECK(Now() >= deadline);
+    CHECK_EQ(handler.sources, 1);
+    CHECK_EQ(handler.lastSource, index);
+
+    loop.Post();
+    CHECK(!loop.SleepUntilNs(Now() + 5000 * MS));
+    CHECK_EQ(handler.posts, 1);
+    close(event);
+}
+
+// Rates per reason over the interval on the loop's clock, and the counters restart per report
+static void TestWakeupReport()
+{
+    FakeFrameClock clock;
+    EventLoop loop(&clock);
+    loop.Post();
+    CHECK_EQ(loop.Wait(-1), WAKE_POSTED);
+    CHECK_EQ(loop.Wait(1 * MS), WAKE_DEADLINE);         // The fake clock stands still: 1 ms timer
+    CHECK_EQ(loop.Wait(1 * MS), WAKE_DEADLINE);
+    CHECK_EQ(loop.Wait(0), WAKE_DEADLINE);              // Passed: counted as immediate only
+
+    char report[128];
+    loop.FormatWakeupReport(2000 * MS, report, sizeof(report));
+    CHECK(strcmp(report, "1.5 wakeups/s (deadline 1.0, posted 0.5), asleep 0%") == 0);
+
+    loop.Post();
+    CHECK_EQ(loop.Wait(-1), WAKE_POSTED);
+    loop.FormatWakeupReport(3000 * MS, report, sizeof(report));
+    CHECK(strcmp(report, "1.0 wakeups/s (posted 1.0), asleep 0%") == 0);
+}
+
+int main()
+{
+    RUN_TEST(TestDeadlineWake);
+    RUN_TEST(TestPostWakes);
+    RUN_TEST(TestSourceWakes);
+    RUN_TEST(TestWakePriority);
+    RUN_TEST(TestSourceTable);
+    RUN_TEST(TestSleepUntilPassesEventsToHandler);
+    RUN_TEST(TestWakeupReport);
+    return TestExitCode();
+}
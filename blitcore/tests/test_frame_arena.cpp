@@ -0,0 +1,196 @@
+// FrameArena and heap counter tests: bump allocation and alignment, spills folded into one block,
+// and zero operator new calls across steady-state frames of the portable pipeline (the counting
+// hook is linked into this test whatever the build type)
+
+#include "test_common.h"
+
+#include "cursor_shape.h"
+#include "frame_arena.h"
+#include "heap_counter.h"
+#include "mirror_pipeline.h"
+#include "worker_pool.h"
+
+#include <string.h>
+
+#include <vector>
+
+static void TestAllocationsAreAlignedAndDisjoint()
+{
+    FrameArena arena(4096);
+    uint8_t* a = (uint8_t*)arena.Allocate(3);
+    uint8_t* b = (uint8_t*)arena.Allocate(10, 64);
+    uint32_t* c = arena.AllocateArray<uint32_t>(100);
+    CHECK_EQ((uintptr_t)a % 16, 0);
+    CHECK_EQ((uintptr_t)b % 64, 0);
+    CHECK_EQ((uintptr_t)c % 16, 0);
+    CHECK(b >= a + 3);
+    CHECK((uint8_t*)c >= b + 10);
+    CHECK_EQ(arena.Used(), 413);
+
+    // Reset hands the same memory out again
+    arena.Reset();
+    CHECK_EQ(arena.Used(), 0);
+    CHECK(arena.Allocate(3) == a);
+    CHECK_EQ(arena.Spills(), 0);
+}
+
+// A frame that outgrows the block spills; the next Reset replaces the block with one big enough
+// for that frame, so the same frame again fits without spilling
+static void TestSpillsFoldIntoOneBlock()
+{
+    FrameArena arena(1024);
+    for (int i = 0; i < 10; i++)
+        memset(arena.Allocate(1000), i, 1000);
+    CHECK_EQ(arena.Used(), 10000);
+    arena.Reset();
+    CHECK_EQ(arena.Spills(), 1);
+    CHECK_EQ(arena.HighWater(), 10000);
+    CHECK(arena.Capacity() >= 10000 + 10 * 16);
+    size_t capacity = arena.Capacity();
+
+    for (int frame = 0; frame < 100; frame++)
+    {
+        for (int i = 0; i < 10; i++)
+            memset(arena.Allocate(1000), i, 1000);
+        arena.Reset();
+    }
+    CHECK_EQ(arena.Spills(), 1);
+    CHECK_EQ(arena.Capacity(), capacity);
+}
+
+// Optimised builds may elide a new-expression whose result never escapes (C++14), so each one does
+static void* volatile g_Escape;
+
+static void TestCounterSeesOperatorNew()
+{
+    CHECK(HeapAllocationCountingEnabled());
+    uint64_t before = HeapAllocationCount();
+    int* one = new int(1);
+    int* many = new int[64];
+    std::vector<int> grown;
+    grown.push_back(1);
+    g_Escape = one;
+    g_Escape = many;
+    g_Escape = grown.data();
+    CHECK_EQ(HeapAllocationCount() - before, 3);
+    delete one;
+    delete[] many;
+}
+
+// Alternates two pre-filled frames (every poll is new content) and moves a visible pointer,
+// switching between a colour and a monochrome shape every 16 polls
+class CursorSource : public MirrorSource
+{
+public:
+    explicit CursorSource(const MirrorGeometry& geometry)
+        : m_Pitch(geometry.sourceWidth * 4)
+        , m_Color((size_t)48 * 48 * 4)
+        , m_Mono((size_t)4 * 32 * 2)
+    {
+        TestRandom random(7);
+        for (int i = 0; i < 2; i++)
+        {
+            m_Frames[i].resize((size_t)m_Pitch * geometry.sourceHeight);
+            for (uint8_t& v : m_Frames[i])
+                v = (uint8_t)random.Next();
+        }
+        for (uint8_t& v : m_Color)
+            v = (uint8_t)random.Next();
+        for (uint8_t& v : m_Mono)
+            v = (uint8_t)random.Next();
+        m_Width = geometry.sourceWidth;
+        m_Height = geometry.sourceHeight;
+    }
+
+    bool Capture(const MirrorGeometry&, const uint8_t** pixels, int* pitch) override
+    {
+        m_Next ^= 1;
+        *pixels = m_Frames[m_Next].data();
+        *pitch = m_Pitch;
+        return true;
+    }
+
+    bool QueryCursor(MirrorCursor* cursor, CursorSprite* sprite) override
+    {
+        m_Polls++;
+        cursor->x = (m_Polls * 37) % m_Width;
+        cursor->y = (m_Polls * 23) % m_Height;
+        cursor->visible = true;
+        if (m_Polls % 16 == 1)
+        {
+            cursor->shapeChanged = (m_Polls / 16) % 2
+                ? DecodeCursorShape(CURSOR_SHAPE_MONOCHROME, 32, 64, 4, m_Mono.data(), sprite)
+                : DecodeCursorShape(CURSOR_SHAPE_COLOR, 48, 48, 48 * 4, m_Color.data(), sprite);
+        }
+        return true;
+    }
+
+private:
+    int m_Pitch;
+    int m_Width = 0;
+    int m_Height = 0;
+    std::vector<uint8_t> m_Frames[2];
+    std::vector<uint8_t> m_Color;
+    std::vector<uint8_t> m_Mono;
+    int m_Next = 0;
+    int m_Polls = 0;
+};
+
+class NullSink : public MirrorSink
+{
+public:
+    bool Present(const uint8_t*, int, int, int) override { return true; }
+};
+
+// The portable frame loop after warm-up: MirrorPipeline::RunFrame capturing, decoding cursor
+// shapes into the reserved sprite, composing (both kernels) across a shared WorkerPool and
+// presenting, with the frame arena's scratch reset per frame as the front-ends do
+static void TestSteadyStateFramesDoNotAllocate()
+{
+    MirrorGeometry geometry;
+    geometry.sourceWidth = 960;
+    geometry.sourceHeight = 540;
+    geometry.renderWidth = 720;
+    geometry.renderHeight = 540;
+    geometry.outputWidth = 960;
+    geometry.outputHeight = 540;
+
+    WorkerPool workers(2);
+    FrameArena arena;
+    for (bool linearLight : { false, true })
+    {
+        CursorSource source(geometry);
+        NullSink sink;
+        MirrorPipeline pipeline(&source, &sink, &workers);
+        CHECK(pipeline.Configure(geometry, linearLight));
+
+        auto frame = [&]() {
+            // Spill on the first frame only: 256 KB of scratch against the 64 KB default block
+            memset(arena.Allocate(256 * 1024), 0, 256 * 1024);
+            CHECK(pipeline.RunFrame());
+            arena.Reset();
+        };
+
+        // Warm-up covers both cursor shapes and the pool's first jobs
+        for (int n = 0; n < 40; n++)
+            frame();
+        int spills = arena.Spills();
+
+        uint64_t before = HeapAllocationCount();
+        for (int n = 0; n < 120; n++)
+            frame();
+        CHECK_EQ(HeapAllocationCount() - before, 0);
+        CHECK_EQ(arena.Spills(), spills);
+        CHECK_EQ(pipeline.Stats().polls, pipeline.Stats().presented);
+        CHECK(pipeline.Cursor().width > 0);
+    }
+}
+
+int main()
+{
+    RUN_TEST(TestAllocationsAreAlignedAndDisjoint);
+    RUN_TEST(TestSpillsFoldIntoOneBlock);
+    RUN_TEST(TestCounterSeesOperatorNew);
+    RUN_TEST(TestSteadyStateFramesDoNotAllocate);
+    return TestExitCode();
+}
@@ -0,0 +1,178 @@
+// FrameComposer tests: the fused scale/cursor/padding pass against the same steps run separately,
+// for every strip height and store mode, with a pitch wider than the frame; strip sizing from the L2
+
+#include "test_common.h"
+
+#include "bilinear_sampler.h"
+#include "cache_info.h"
+#include "cursor_blend.h"
+#include "frame_composer.h"
+#include "planar_resampler.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+constexpr uint32_t PADDING = 0xFF203040;
+constexpr uint8_t UNTOUCHED = 0xCD;
+
+struct Scene
+{
+    int srcWidth, srcHeight, renderWidth, renderHeight, outputWidth, outputHeight;
+};
+
+// Scale the whole image, blend the cursor over it, fill the padding: the three sweeps the composer fuses
+static void Reference(const Scene& s, const std::vector<uint8_t>& src, const CursorSprite& cursor, int cursorX,
+                      int cursorY, bool linearLight, std::vector<uint8_t>* out)
+{
+    std::vector<uint8_t> image((size_t)s.renderWidth * s.renderHeight * 4);
+    PlanarResampler planar;
+    if (!linearLight && planar.Configure(s.srcWidth, s.srcHeight, s.renderWidth, s.renderHeight))
+    {
+        planar.Scale(src.data(), s.srcWidth * 4, image.data(), s.renderWidth * 4);
+    }
+    else
+    {
+        BilinearSampler sampler;
+        sampler.Configure(s.srcWidth, s.srcHeight, s.renderWidth, s.renderHeight, linearLight);
+        sampler.Scale(src.data(), s.srcWidth * 4, image.data(), s.renderWidth * 4);
+    }
+    BlendCursor(ImageView<FormatBGRA8>(image.data(), s.renderWidth, s.renderHeight, s.renderWidth * 4), cursor,
+                cursorX, cursorY, linearLight);
+
+    out->assign((size_t)s.outputWidth * s.outputHeight * 4, 0);
+    uint32_t* pixels = (uint32_t*)out->data();
+    for (int y = 0; y < s.outputHeight; y++)
+        for (int x = 0; x < s.outputWidth; x++)
+            pixels[(size_t)y * s.outputWidth + x] = PADDING;
+    for (int y = 0; y < s.renderHeight; y++)
+        memcpy(&(*out)[(size_t)y * s.outputWidth * 4], &image[(size_t)y * s.renderWidth * 4], (size_t)s.renderWidth * 4);
+}
+
+static void MakeCursor(CursorSprite* cursor, TestRandom& random)
+{
+    // Colour cursor with every kind of alpha (transparent, partial, opaque)
+    const int size = 48;
+    std::vector<uint8_t> shape((size_t)size * size * 4);
+    for (size_t i = 0; i < shape.size(); i++)
+        shape[i] = (uint8_t)random.Next();
+    for (size_t i = 3; i < shape.size(); i += 4)
+        shape[i] = random.Below(3) == 0 ? 0 : (random.Below(2) ? 255 : (uint8_t)random.Next());
+    ReserveCursorSprite(cursor);
+    DecodeCursorShape(CURSOR_SHAPE_COLOR, size, size, size * 4, shape.data(), cursor);
+}
+
+static void CheckScene(const Scene& s, bool linearLight, uint64_t seed)
+{
+    TestRandom random(seed);
+    std::vector<uint8_t> src((size_t)s.srcWidth * s.srcHeight * 4);
+    for (uint8_t& v : src)
+        v = (uint8_t)random.Next();
+    CursorSprite cursor;
+    MakeCursor(&cursor, random);
+
+    FrameComposer composer;
+    CHECK(composer.Configure(s.srcWidth, s.srcHeight, s.renderWidth, s.renderHeight, s.outputWidth, s.outputHeight,
+                             linearLight));
+    composer.SetPadding(PADDING);
+
+    // Cursor fully inside, across the left/top edges, and across the image's right/bottom edges
+    const int positions[][2] = {
+        { s.renderWidth / 3, s.renderHeight / 2 }, { -20, -17 }, { s.renderWidth - 30, s.renderHeight - 11 },
+    };
+    const int strips[] = { 0, 1, 3, 64, s.outputHeight };
+    const StoreMode modes[] = { STORE_CACHED, STORE_STREAMING };
+
+    int dstPitch = s.outputWidth * 4 + 36;
+    std::vector<uint8_t> dst((size_t)dstPitch * s.outputHeight);
+    std::vector<uint8_t> expected;
+    for (const int* p : positions)
+    {
+        Reference(s, src, cursor, p[0], p[1], linearLight, &expected);
+        for (int rows : strips)
+        {
+            for (StoreMode mode : modes)
+            {
+                composer.SetStripRows(rows);
+                composer.SetStoreMode(mode);
+                memset(dst.data(), UNTOUCHED, dst.size());
+                composer.Compose(src.data(), s.srcWidth * 4, dst.data(), dstPitch, &cursor, p[0], p[1]);
+
+                int mismatches = 0;
+                for (int y = 0; y < s.outputHeight; y++)
+                {
+                    const uint8_t* row = &dst[(size_t)y * dstPitch];
+                    mismatches += memcmp(row, &expected[(size_t)y * s.outputWidth * 4], (size_t)s.outputWidth * 4) != 0;
+                    for (int i = s.outputWidth * 4; i < dstPitch; i++)
+                        mismatches += row[i] != UNTOUCHED;
+                }
+                if (mismatches)
+                    fprintf(stderr, "%dx%d -> %dx%d in %dx%d%s, cursor (%d, %d), strip %d, mode %d\n", s.srcWidth,
+                            s.srcHeight, s.renderWidth, s.renderHeight, s.outputWidth, s.outputHeight,
+                            linearLight ? " linear" : "", p[0], p[1], rows, (int)mode);
+                CHECK_EQ(mismatches, 0);
+            }
+        }
+    }
+}
+
+static void TestMatchesSeparatePasses()
+{
+    // Planar 4:3 with side padding; bilinear (period too long) with padding right and below
+    CheckScene({ 480, 270, 360, 270, 480, 270 }, false, 1);
+    CheckScene({ 401, 300, 250, 190, 320, 240 }, false, 2);
+    CheckScene({ 480, 270, 360, 270, 480, 270 }, true, 3);
+}
+
+// Auto strips: the most rows whose source rows (downscale ratio + 1 for the blend) and output row
+// fit in half the L2, between 1 and 256
+static void TestStripSizingFromL2()
+{
+    const CacheInfo& cache = GetCacheInfo();
+    CHECK_EQ(PlanningL2Size(), cache.l2 ? cache.l2 : 256 * 1024);
+    size_t half = PlanningL2Size() / 2;
+
+    struct Case
+    {
+        int srcWidth, srcHeight, renderWidth, renderHeight, outputWidth, outputHeight;
+        int srcRowsPerRow;
+    };
+    const Case cases[] = {
+        { 1920, 1080, 1440, 1080, 1920, 1080, 2 },
+        { 3840, 2160, 1440, 1080, 1920, 1080, 3 },
+        { 7680, 4320, 1440, 1080, 1920, 1080, 5 },
+        { 64, 8, 48, 8, 64, 8, 2 },
+    };
+    for (const Case& c : cases)
+    {
+        FrameComposer composer;
+        CHECK(composer.Configure(c.srcWidth, c.srcHeight, c.renderWidth, c.renderHeight, c.outputWidth, c.outputHeight));
+        size_t bytesPerRow = (size_t)c.srcWidth * 4 * c.srcRowsPerRow + (size_t)c.outputWidth * 4;
+        int rows = composer.StripRows();
+        CHECK(rows >= 1 && rows <= 256);
+        if (rows > 1 && rows < 256)
+        {
+            CHECK(rows * bytesPerRow <= half);
+            CHECK((rows + 1) * bytesPerRow > half);
+        }
+        CHECK_EQ(rows, std::min<size_t>(std::max<size_t>(half / bytesPerRow, 1), 256));
+    }
+
+    // Explicit heights are kept (clamped) across reconfiguration; 0 returns to auto
+    FrameComposer composer;
+    composer.SetStripRows(7);
+    CHECK(composer.Configure(1920, 1080, 1440, 1080, 1920, 1080));
+    CHECK_EQ(composer.StripRows(), 7);
+    composer.SetStripRows(1000);
+    CHECK_EQ(composer.StripRows(), 256);
+    composer.SetStripRows(0);
+    CHECK_EQ(composer.StripRows(), (int)std::min<size_t>(std::max<size_t>(half / (1920 * 4 * 3), 1), 256));
+}
+
+int main()
+{
+    RUN_TEST(TestMatchesSeparatePasses);
+    RUN_TEST(TestStripSizingFromL2);
+    return TestExitCode();
+}
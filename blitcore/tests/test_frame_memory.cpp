@@ -0,0 +1,119 @@
+// FrameMemory tests: odd-cache-line pitch, prefaulted buffers that take no faults in steady state,
+// and stats that balance across allocate and free
+
+#include "test_common.h"
+
+#include "frame_memory.h"
+
+#include <string.h>
+
+// Rounded up to a cache line, then to an odd number of lines
+static void TestPitchIsOddCacheLines()
+{
+    CHECK_EQ(AlignedFramePitch(1920, 4), 7744);    // 120 lines -> 121
+    CHECK_EQ(AlignedFramePitch(1440, 4), 5824);    // 90 -> 91
+    CHECK_EQ(AlignedFramePitch(2560, 4), 10304);   // 160 -> 161
+    CHECK_EQ(AlignedFramePitch(1366, 4), 5568);    // 5464 bytes: 86 lines -> 87
+    CHECK_EQ(AlignedFramePitch(16, 4), 64);        // One line is already odd
+    CHECK_EQ(AlignedFramePitch(17, 4), 192);       // Two lines -> three
+    CHECK_EQ(AlignedFramePitch(1, 4), 64);
+
+    for (int width = 1; width < 4000; width += 7)
+    {
+        int pitch = AlignedFramePitch(width, 4);
+        CHECK(pitch >= width * 4);
+        CHECK_EQ(pitch % 64, 0);
+        CHECK_EQ((pitch / 64) % 2, 1);
+        CHECK(pitch - width * 4 < 128);
+    }
+}
+
+static void TestAllocateShape()
+{
+    FrameMemory memory;
+    FrameBuffer buffer;
+    CHECK(memory.Allocate(&buffer, 1920, 1080));
+    CHECK(buffer.data != nullptr);
+    CHECK_EQ(buffer.width, 1920);
+    CHECK_EQ(buffer.height, 1080);
+    CHECK_EQ(buffer.pitch, 7744);
+    CHECK(buffer.bytes >= (size_t)7744 * 1080);
+    CHECK_EQ(buffer.bytes % FRAME_LARGE_PAGE_SIZE, 0);
+    CHECK(buffer.pageSize > 0);
+    CHECK_EQ(buffer.bytes % buffer.pageSize, 0);
+
+    // Prefaulted pages read back as zero
+    bool zero = true;
+    for (size_t offset = 0; offset < buffer.bytes; offset += 4096)
+        zero &= buffer.data[offset] == 0;
+    CHECK(zero);
+
+    memory.Free(&buffer);
+    CHECK(buffer.data == nullptr);
+    memory.Free(&buffer);                          // Freeing twice is harmless
+    memory.Free(nullptr);
+}
+
+// Writing every row of a prefaulted frame, frame after frame, takes no page faults
+static void TestSteadyStateWritesDoNotFault()
+{
+    FrameMemory memory;
+    FrameBuffer frames[2];
+    CHECK(memory.Allocate(&frames[0], 1920, 1080));
+    CHECK(memory.Allocate(&frames[1], 1920, 1080));
+
+    auto render = [&](int n) {
+        FrameBuffer& frame = frames[n & 1];
+        for (int y = 0; y < frame.height; y++)
+            memset(frame.data + (size_t)y * frame.pitch, (uint8_t)(n + y), (size_t)frame.width * 4);
+    };
+
+    // One untimed pass so the test's own code and stack are resident
+    render(0);
+    uint64_t before = ProcessPageFaults();
+    for (int n = 1; n <= 60; n++)
+        render(n);
+    uint64_t faults = ProcessPageFaults() - before;
+    CHECK_EQ(faults, 0);
+
+    CHECK_EQ(frames[1].data[(size_t)1079 * frames[1].pitch + 7679], (uint8_t)(59 + 1079));
+    memory.Free(&frames[0]);
+    memory.Free(&frames[1]);
+}
+
+// Page counts, lock accounting and TLB entries add up while buffers live and return to zero
+static void TestStatsBalance()
+{
+    FrameMemory memory;
+    FrameBuffer a, b;
+    CHECK(memory.Allocate(&a, 1920, 1080));
+    CHECK(memory.Allocate(&b, 640, 480));
+
+    const FrameMemoryStats& stats = memory.Stats();
+    CHECK_EQ(stats.buffers, 2);
+    CHECK_EQ(stats.largePageBytes + stats.smallPageBytes, a.bytes + b.bytes);
+    CHECK_EQ(stats.lockedBytes, (a.locked ? a.bytes : 0) + (b.locked ? b.bytes : 0));
+    CHECK_EQ(stats.tlbEntries, a.bytes / a.pageSize + b.bytes / b.pageSize);
+    // Small pages fault once each during the prefault (huge pages may take fewer)
+    CHECK(stats.prefaultFaults > 0);
+    CHECK(stats.prefaultNs > 0);
+
+    memory.Free(&a);
+    CHECK_EQ(stats.buffers, 1);
+    CHECK_EQ(stats.tlbEntries, b.bytes / b.pageSize);
+    memory.Free(&b);
+    CHECK_EQ(stats.buffers, 0);
+    CHECK_EQ(stats.largePageBytes, 0);
+    CHECK_EQ(stats.smallPageBytes, 0);
+    CHECK_EQ(stats.lockedBytes, 0);
+    CHECK_EQ(stats.tlbEntries, 0);
+}
+
+int main()
+{
+    RUN_TEST(TestPitchIsOddCacheLines);
+    RUN_TEST(TestAllocateShape);
+    RUN_TEST(TestSteadyStateWritesDoNotFault);
+    RUN_TEST(TestStatsBalance);
+    return TestExitCode();
+}
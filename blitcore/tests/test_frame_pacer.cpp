@@ -0,0 +1,132 @@
+// FramePacer tests: deadline grid, missed-deadline skipping and interrupted waits on an injected clock
+
+#include "test_common.h"
+
+#include "frame_pacer.h"
+
+// 60 Hz is 16666666.67 ns: deadline n must be origin + n * 1e9 / 60 exactly (truncated), never drifting
+static void TestDeadlineGridHasNoDrift()
+{
+    FakeFrameClock clock;
+    clock.now = 5000;
+    FramePacer pacer = FramePacer::FromRate(60, &clock);
+
+    for (int64_t n = 1; n <= 6000; n++)
+    {
+        int64_t deadline = pacer.WaitForNextFrame();
+        CHECK_EQ(deadline, 5000 + n * 1000000000 / 60);
+        CHECK(clock.now >= deadline);
+    }
+    // 100 s at 60 Hz lands exactly on the 6000th deadline
+    CHECK_EQ(pacer.Stats().frames, 6000);
+    CHECK_EQ(pacer.Stats().missed, 0);
+}
+
+// A late-waking sleep lands inside the spin window; spinning, not sleeping, finishes the wait
+static void TestSleepThenSpin()
+{
+    FakeFrameClock clock;
+    clock.overshootNs = 100000;     // Sleep wakes 100 us late
+    clock.relaxStepNs = 2000;
+    FramePacer pacer(1000000000, 100, &clock);
+    pacer.SetSpinWindowNs(500000);
+
+    int64_t deadline = pacer.WaitForNextFrame();
+    CHECK_EQ(deadline, 10000000);
+    CHECK_EQ(clock.sleeps, 1);
+    // Slept to 9.5 ms + 100 us, then spun the remaining 400 us in 2 us steps
+    CHECK_EQ(clock.relaxes, 200);
+    CHECK(pacer.Stats().lastLatenessNs >= 0 && pacer.Stats().lastLatenessNs < 2000);
+}
+
+// A frame that overruns by 2.5 periods skips the passed deadlines instead of bursting to catch up
+static void TestMissedDeadlinesAreSkipped()
+{
+    FakeFrameClock clock;
+    FramePacer pacer(1000000000, 100, &clock);     // 10 ms
+
+    CHECK_EQ(pacer.WaitForNextFrame(), 10000000);
+    clock.Advance(25000000);                        // Work until 35 ms: 20 and 30 ms have passed
+    CHECK_EQ(pacer.WaitForNextFrame(), 40000000);
+    CHECK_EQ(pacer.Stats().missed, 2);
+    CHECK_EQ(pacer.NextDeadlineNs(), 50000000);     // Still on the original grid
+
+    // Finishing exactly on a deadline counts it as passed (50 and 60 ms here)
+    clock.now = 60000000;
+    CHECK_EQ(pacer.WaitForNextFrame(), 70000000);
+    CHECK_EQ(pacer.Stats().missed, 4);
+    CHECK_EQ(pacer.Stats().frames, 3);
+}
+
+// Idle throttling sleeps through several periods on the same grid
+static void TestFramesToAdvance()
+{
+    FakeFrameClock clock;
+    FramePacer pacer(1000000000, 100, &clock);
+    CHECK_EQ(pacer.WaitForNextFrame(4), 40000000);
+    CHECK_EQ(pacer.WaitForNextFrame(1), 50000000);
+    CHECK_EQ(pacer.Stats().missed, 0);
+}
+
+// Fractional periods (59.94 Hz) stay exact through the index arithmetic over long runs
+static void TestFractionalPeriod()
+{
+    FakeFrameClock clock;
+    FramePacer pacer(1001000000, 60000, &clock);
+    int64_t deadline = 0;
+    for (int n = 0; n < 60000; n++)
+        deadline = pacer.WaitForNextFrame();
+    CHECK_EQ(deadline, 1001000000);                 // 60000 frames at 60000/1001 Hz = 1001 ms
+}
+
+// Waiter that ends the first sleep early (an event arrived)
+class InterruptingWaiter : public FrameWaiter
+{
+public:
+    explicit InterruptingWaiter(FakeFrameClock* clock) : m_Clock(clock) {}
+    bool SleepUntilNs(int64_t deadlineNs) override
+    {
+        if (interruptAt >= 0)
+        {
+            m_Clock->now = interruptAt;
+            interruptAt = -1;
+            return false;
+        }
+        m_Clock->SleepUntilNs(deadlineNs);
+        return true;
+    }
+    int64_t interruptAt = -1;
+
+private:
+    FakeFrameClock* m_Clock;
+};
+
+// An interrupted wait returns at once and the grid restarts from the wake time
+static void TestInterruptedWaitRestartsGrid()
+{
+    FakeFrameClock clock;
+    InterruptingWaiter waiter(&clock);
+    FramePacer pacer(1000000000, 100, &clock);
+    pacer.SetWaiter(&waiter);
+
+    waiter.interruptAt = 3000000;
+    CHECK_EQ(pacer.WaitForNextFrame(), 3000000);
+    CHECK(pacer.WasInterrupted());
+    CHECK_EQ(pacer.Stats().interrupted, 1);
+    CHECK_EQ(pacer.Stats().frames, 0);
+
+    CHECK_EQ(pacer.WaitForNextFrame(), 13000000);
+    CHECK(!pacer.WasInterrupted());
+    CHECK_EQ(pacer.Stats().frames, 1);
+}
+
+int main()
+{
+    RUN_TEST(TestDeadlineGridHasNoDrift);
+    RUN_TEST(TestSleepThenSpin);
+    RUN_TEST(TestMissedDeadlinesAreSkipped);
+    RUN_TEST(TestFramesToAdvance);
+    RUN_TEST(TestFractionalPeriod);
+    RUN_TEST(TestInterruptedWaitRestartsGrid);
+    return TestExitCode();
+}
@@ -0,0 +1,313 @@
+// FramePool tests: acquire, share and recycle, single-threaded and with producer and consumer
+// threads contending for the buffers
+
+#include "test_common.h"
+
+#include "frame_pool.h"
+
+#include <thread>
+#include <vector>
+
+static FramePoolConfig SmallConfig(int buffers, int maxBuffers, FramePoolPolicy policy)
+{
+    FramePoolConfig config;
+    config.width = 64;
+    config.height = 16;
+    config.buffers = buffers;
+    config.maxBuffers = maxBuffers;
+    config.policy = policy;
+    return config;
+}
+
+// Every pixel of a frame carries its sequence number; a reader that sees a mixed frame saw the
+// buffer rewritten while it still held a reference
+static void StampFrame(FrameRef& frame, uint64_t sequence)
+{
+    frame.SetSequence(sequence);
+    for (int y = 0; y < frame.Height(); y++)
+    {
+        uint32_t* row = frame.Row<uint32_t>(y);
+        for (int x = 0; x < frame.Width(); x++)
+            row[x] = (uint32_t)sequence;
+    }
+}
+
+static bool FrameIsIntact(const FrameRef& frame)
+{
+    uint32_t expected = (uint32_t)frame.Sequence();
+    for (int y = 0; y < frame.Height(); y++)
+    {
+        const uint32_t* row = frame.Row<uint32_t>(y);
+        for (int x = 0; x < frame.Width(); x++)
+        {
+            if (row[x] != expected)
+                return false;
+        }
+    }
+    return true;
+}
+
+static void TestReferencesReturnBuffers()
+{
+    FramePoolConfig config;
+    config.width = 64;
+    config.height = 16;
+    config.buffers = 2;
+    config.maxBuffers = 2;
+    FramePool pool;
+    CHECK(pool.Create(config));
+    CHECK_EQ(pool.Capacity(), 2);
+    CHECK_EQ(pool.FreeCount(), 2);
+
+    {
+        FrameRef a = pool.Acquire(0);
+        CHECK(a);
+        CHECK(a.Unique());
+        CHECK_EQ(a.Width(), 64);
+        CHECK(a.Pitch() >= 64 * 4);
+
+        FrameRef shared = a;
+        CHECK(!a.Unique());
+        CHECK(shared.SameBuffer(a));
+
+        FrameRef b = pool.Acquire(0);
+        CHECK(b && !b.SameBuffer(a));
+        CHECK_EQ(pool.FreeCount(), 0);
+        CHECK(!pool.Acquire(0));                // POOL_BLOCK with no wait: empty
+        CHECK_EQ(pool.Stats().failed, 1);
+
+        a.Reset();
+        CHECK_EQ(pool.FreeCount(), 0);          // Still held by the copy
+        CHECK(shared.Unique());
+    }
+    CHECK_EQ(pool.FreeCount(), 2);
+}
+
+// The buffer released last is handed out first (warmest in cache)
+static void TestRecyclingIsLifo()
+{
+    FramePool pool;
+    CHECK(pool.Create(SmallConfig(3, 3, POOL_BLOCK)));
+    FrameRef a = pool.Acquire(0);
+    FrameRef b = pool.Acquire(0);
+    uint8_t* aPixels = a.Pixels<uint8_t>();
+    uint8_t* bPixels = b.Pixels<uint8_t>();
+
+    FrameRef keep = a;
+    a.Reset();
+    b.Reset();
+    CHECK(pool.Acquire(0).Pixels<uint8_t>() == bPixels);
+
+    // a returns only when its last reference goes, and is then next in line
+    keep.Reset();
+    FrameRef c = pool.Acquire(0);
+    CHECK(c.Pixels<uint8_t>() == aPixels);
+    CHECK_EQ(pool.Stats().acquired, 4);
+}
+
+// Threads copying and dropping references to one frame: it returns to the pool exactly once,
+// after the last of them, and never while any copy is alive
+static void TestConcurrentCopiesRecycleOnce()
+{
+    FramePool pool;
+    CHECK(pool.Create(SmallConfig(2, 2, POOL_BLOCK)));
+    for (int round = 0; round < 50; round++)
+    {
+        FrameRef frame = pool.Acquire(0);
+        StampFrame(frame, round + 1);
+        std::atomic<int> early(0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++)
+        {
+            threads.emplace_back([frame, &pool, &early] {
+                for (int i = 0; i < 2000; i++)
+                {
+                    FrameRef copy = frame;
+                    FrameRef moved = std::move(copy);
+                    early += pool.FreeCount() != 1;
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+        CHECK_EQ(early.load(), 0);
+        CHECK_EQ(pool.FreeCount(), 1);
+        CHECK(frame.Unique());
+        frame.Reset();
+        CHECK_EQ(pool.FreeCount(), 2);
+    }
+}
+
+// One producer, three consumers each with its own queue, sharing every frame: nobody sees a frame
+// rewritten under it, the producer only writes buffers it holds alone, and all buffers come home
+static void TestProducerAndConsumersUnderContention()
+{
+    constexpr int FRAMES = 3000;
+    constexpr int CONSUMERS = 3;
+    FramePool pool;
+    CHECK(pool.Create(SmallConfig(4, 4, POOL_BLOCK)));
+
+    std::vector<FrameQueue*> queues;
+    for (int i = 0; i < CONSUMERS; i++)
+        queues.push_back(new FrameQueue(&pool, 2));
+
+    std::vector<std::thread> consumers;
+    std::vector<int> seen(CONSUMERS, 0), torn(CONSUMERS, 0), reordered(CONSUMERS, 0);
+    for (int i = 0; i < CONSUMERS; i++)
+    {
+        consumers.emplace_back([&, i] {
+            uint64_t last = 0;
+            for (;;)
+            {
+                FrameRef frame = queues[i]->Pop(-1);
+                if (frame.Sequence() == 0)
+                    break;                          // End marker
+                torn[i] += !FrameIsIntact(frame);
+                reordered[i] += frame.Sequence() <= last;
+                last = frame.Sequence();
+                seen[i]++;
+                if (seen[i] % 7 == 0)
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    int notUnique = 0;
+    for (uint64_t sequence = 1; sequence <= FRAMES; sequence++)
+    {
+        FrameRef frame = pool.Acquire(-1);
+        notUnique += !frame.Unique();
+        StampFrame(frame, sequence);
+        for (FrameQueue* queue : queues)
+            queue->Push(frame);
+    }
+    FrameRef end = pool.Acquire(-1);
+    end.SetSequence(0);
+    for (FrameQueue* queue : queues)
+        queue->Push(end);
+    end.Reset();
+    for (std::thread& consumer : consumers)
+        consumer.join();
+
+    CHECK_EQ(notUnique, 0);
+    for (int i = 0; i < CONSUMERS; i++)
+    {
+        CHECK_EQ(torn[i], 0);
+        CHECK_EQ(reordered[i], 0);
+        CHECK(seen[i] > 0);
+    }
+    for (FrameQueue* queue : queues)
+        delete queue;
+    CHECK_EQ(pool.FreeCount(), 4);
+    CHECK_EQ(pool.Capacity(), 4);
+    CHECK_EQ(pool.Stats().acquired, FRAMES + 1);
+    CHECK_EQ(pool.Stats().failed, 0);
+}
+
+// Drop-oldest: a producer outrunning a stalled consumer reclaims queued frames instead of waiting
+static void TestDropOldestNeverBlocksProducer()
+{
+    FramePool pool;
+    CHECK(pool.Create(SmallConfig(3, 3, POOL_DROP_OLDEST)));
+    FrameQueue slow(&pool, 8);              // Deeper than the pool: only reclaiming frees buffers
+    for (uint64_t sequence = 1; sequence <= 100; sequence++)
+    {
+        FrameRef frame = pool.Acquire(0);
+        CHECK(frame && frame.Unique());
+        StampFrame(frame, sequence);
+        slow.Push(frame);
+    }
+    CHECK_EQ(pool.Stats().failed, 0);
+    CHECK_EQ(pool.Stats().dropped, 97);
+
+    // What is left is the newest frames, oldest first
+    for (uint64_t sequence = 98; sequence <= 100; sequence++)
+    {
+        FrameRef frame = slow.Pop(0);
+        CHECK_EQ(frame.Sequence(), sequence);
+        CHECK(FrameIsIntact(frame));
+    }
+    CHECK_EQ(pool.FreeCount(), 3);
+}
+
+// Drop-oldest only counts a drop that freed a buffer: queued frames a consumer still holds, or
+// another queue still has, stay queued, and a younger sole-referenced frame is reclaimed instead
+static void TestDropOldestSkipsSharedFrames()
+{
+    FramePool pool;
+    CHECK(pool.Create(SmallConfig(3, 3, POOL_DROP_OLDEST)));
+    FrameQueue first(&pool, 4), second(&pool, 4);
+
+    FrameRef held = pool.Acquire(0);        // 1: queued and held by a consumer
+    StampFrame(held, 1);
+    first.Push(held);
+    {
+        FrameRef frame = pool.Acquire(0);   // 2: in both queues
+        StampFrame(frame, 2);
+        first.Push(frame);
+        second.Push(frame);
+    }
+    {
+        FrameRef frame = pool.Acquire(0);   // 3: only the second queue has it, behind 2
+        StampFrame(frame, 3);
+        second.Push(frame);
+    }
+
+    // No queue head is reclaimable: nothing is dropped and the acquire fails
+    CHECK(!pool.Acquire(0));
+    CHECK_EQ(pool.Stats().dropped, 0);
+    CHECK_EQ(first.Size(), 2);
+    CHECK_EQ(second.Size(), 2);
+
+    // Once the first queue's consumer has read 1 and 2, the second queue's 2 is the only
+    // reference left and is reclaimed, though 1 is older and still held
+    CHECK_EQ(first.Pop(0).Sequence(), 1);
+    CHECK_EQ(first.Pop(0).Sequence(), 2);
+    FrameRef frame = pool.Acquire(0);
+    CHECK(frame && frame.Unique());
+    CHECK_EQ(frame.Sequence(), 2);
+    CHECK_EQ(pool.Stats().dropped, 1);
+    CHECK_EQ(second.Size(), 1);
+    CHECK_EQ(second.Pop(0).Sequence(), 3);
+    CHECK_EQ(held.Sequence(), 1);
+    CHECK(FrameIsIntact(held));
+}
+
+// Growth up to the ceiling, then a blocked Acquire that another thread's release wakes
+static void TestGrowThenWaitForRelease()
+{
+    FramePool pool;
+    CHECK(pool.Create(SmallConfig(1, 3, POOL_GROW)));
+    std::vector<FrameRef> held;
+    for (int i = 0; i < 3; i++)
+        held.push_back(pool.Acquire(0));
+    CHECK_EQ(pool.Capacity(), 3);
+    CHECK_EQ(pool.Stats().grown, 2);
+    CHECK(!pool.Acquire(0));
+
+    std::thread releaser([&held] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        held[1].Reset();
+    });
+    FrameRef frame = pool.Acquire(5000000000);
+    releaser.join();
+    CHECK(frame);
+    CHECK_EQ(pool.Stats().waited, 1);
+    CHECK_EQ(pool.Capacity(), 3);
+
+    // A timed wait that nobody satisfies fails cleanly
+    CHECK(!pool.Acquire(10000000));
+    CHECK_EQ(pool.Stats().failed, 2);
+}
+
+int main()
+{
+    RUN_TEST(TestReferencesReturnBuffers);
+    RUN_TEST(TestRecyclingIsLifo);
+    RUN_TEST(TestConcurrentCopiesRecycleOnce);
+    RUN_TEST(TestProducerAndConsumersUnderContention);
+    RUN_TEST(TestDropOldestNeverBlocksProducer);
+    RUN_TEST(TestDropOldestSkipsSharedFrames);
+    RUN_TEST(TestGrowThenWaitForRelease);
+    return TestExitCode();
+}
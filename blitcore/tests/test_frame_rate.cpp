@@ -0,0 +1,210 @@
+// Frame rate tests: command-line rate options, display frequency mapping, the capture/present
+// rate converter's repeat and drop cadence (including multi-day uptimes), and the budget monitor
+
+#include "test_common.h"
+
+#include "frame_rate.h"
+
+#include <vector>
+
+// Present ticks land shortly after each vblank, as real presents do
+constexpr int64_t PRESENT_OFFSET_NS = 100000;
+
+static int64_t TickNs(int64_t n, FrameRate rate)
+{
+    return n * 1000000000 * rate.den / rate.num + PRESENT_OFFSET_NS;
+}
+
+static FrameRate Rate(uint32_t num, uint32_t den = 1)
+{
+    FrameRate rate;
+    rate.num = num;
+    rate.den = den;
+    return rate;
+}
+
+static void TestParsesRateOptions()
+{
+    FrameRate rate;
+    CHECK(ParseFrameRateOption("app.exe --capture-hz=59.94 --present-hz=144", "capture-hz", &rate));
+    CHECK_EQ(rate.num, 59940u);
+    CHECK_EQ(rate.den, 1000u);
+    CHECK(ParseFrameRateOption("app.exe --capture-hz=59.94 --present-hz=144", "present-hz", &rate));
+    CHECK_EQ(rate.num, 144000u);
+    CHECK_EQ(rate.den, 1000u);
+    CHECK(ParseFrameRateOption("--present-hz=143.856", "present-hz", &rate));
+    CHECK_EQ(rate.num, 143856u);
+    CHECK_NEAR(rate.Hz(), 143.856, 1e-9);
+}
+
+// Absent or malformed options fail and leave the rate as it was
+static void TestRejectsMalformedOptions()
+{
+    const char* bad[] = {
+        "app.exe",
+        "--present-hz=75",
+        "--capture-hz",
+        "--capture-hz 60",
+        "--capture-hz=",
+        "--capture-hz=abc",
+        "--capture-hz=0",
+        "--capture-hz=-60",
+        "--capture-hz=1000.5",
+        "--capture-hzz=60",
+        "-capture-hz=60",
+    };
+    for (const char* cmdLine : bad)
+    {
+        FrameRate rate = Rate(75);
+        CHECK(!ParseFrameRateOption(cmdLine, "capture-hz", &rate));
+        CHECK_EQ(rate.num, 75u);
+        CHECK_EQ(rate.den, 1u);
+    }
+    FrameRate rate = Rate(75);
+    CHECK(!ParseFrameRateOption(nullptr, "capture-hz", &rate));
+    CHECK(!ParseFrameRateOption("--capture-hz=60", nullptr, &rate));
+    CHECK_EQ(rate.num, 75u);
+}
+
+// 59/119/143 style display frequencies are the N*1000/1001 modes
+static void TestFrameRateFromHz()
+{
+    FrameRate rate = FrameRateFromHz(59);
+    CHECK_EQ(rate.num, 60000u);
+    CHECK_EQ(rate.den, 1001u);
+    CHECK_EQ(rate.PeriodNs(), 16683333);
+    CHECK_EQ(FrameRateFromHz(143).num, 144000u);
+    CHECK_EQ(FrameRateFromHz(60).num, 60u);
+    CHECK_EQ(FrameRateFromHz(60).den, 1u);
+    CHECK_EQ(FrameRateFromHz(75).num, 75u);
+    CHECK_EQ(FrameRateFromHz(1).num, 60u);       // 0/1 mean "hardware default": 60 Hz
+    CHECK_EQ(FrameRateFromHz(0).num, 60u);
+}
+
+// 60 -> 144: every capture is shown for 3,2,3,2,2 present ticks (2.4 on average), over and over
+static void TestUpconversionRepeatCadence()
+{
+    FrameRate capture = Rate(60), present = Rate(144);
+    RateConverter converter(capture, present);
+    converter.Reset(0);
+
+    std::vector<int> shown;
+    for (int64_t n = 0; n < 144 * 10; n++)
+    {
+        if (converter.OnPresentTick(TickNs(n, present)))
+            shown.push_back(0);
+        shown.back()++;
+    }
+    shown.pop_back();       // The last capture's run is cut off by the end of the loop
+
+    const int cadence[5] = { 3, 2, 3, 2, 2 };
+    CHECK_EQ(shown.size(), (size_t)599);
+    for (size_t i = 0; i < shown.size(); i++)
+        CHECK_EQ(shown[i], cadence[i % 5]);
+
+    const RateConverterStats& stats = converter.Stats();
+    CHECK_EQ(stats.presentTicks, 1440u);
+    CHECK_EQ(stats.captures, 600u);
+    CHECK_EQ(stats.repeated, 840u);
+    CHECK_EQ(stats.dropped, 0u);
+}
+
+// 144 -> 60: every present captures, dropping 1 or 2 ticks in between, evenly spread (1,1,2,1,2)
+static void TestDownconversionDropsEvenly()
+{
+    FrameRate capture = Rate(144), present = Rate(60);
+    RateConverter converter(capture, present);
+    converter.Reset(0);
+
+    const int cadence[5] = { 1, 1, 2, 1, 2 };
+    CHECK(converter.OnPresentTick(TickNs(0, present)));
+    for (int64_t n = 1; n <= 600; n++)
+    {
+        uint64_t before = converter.Stats().dropped;
+        CHECK(converter.OnPresentTick(TickNs(n, present)));
+        CHECK_EQ((int)(converter.Stats().dropped - before), cadence[(n - 1) % 5]);
+    }
+    CHECK_EQ(converter.Stats().repeated, 0u);
+    CHECK_EQ(converter.Stats().dropped, 840u);     // 10 s: 1440 capture ticks, 601 shown
+}
+
+// 60000/1001 captures on a 60 Hz present: exactly one repeat per 1001 presents, no drift
+static void TestFractionalCaptureRate()
+{
+    FrameRate capture = FrameRateFromHz(59), present = Rate(60);
+    RateConverter converter(capture, present);
+    converter.Reset(0);
+    for (int64_t n = 0; n < 60060; n++)
+        converter.OnPresentTick(TickNs(n, present));
+    CHECK_EQ(converter.Stats().captures, 60000u);
+    CHECK_EQ(converter.Stats().repeated, 60u);
+    CHECK_EQ(converter.Stats().dropped, 0u);
+}
+
+// Elapsed nanoseconds times the rate numerator (143856 for millihertz 143.856) overflow int64 after
+// about 18 hours of uptime; the per-second split keeps the capture index exact for days and years
+static void TestMultiDayElapsedTime()
+{
+    FrameRate capture;
+    CHECK(ParseFrameRateOption("--capture-hz=143.856", "capture-hz", &capture));
+    const int64_t elapsedNs[] = {
+        3LL * 86400 * 1000000000 + 123456789,
+        40LL * 86400 * 1000000000 + 999999999,
+        365LL * 86400 * 1000000000 + 7,
+    };
+    for (int64_t elapsed : elapsedNs)
+    {
+        RateConverter converter(capture, Rate(60));
+        converter.Reset(0);
+        CHECK(converter.OnPresentTick(0));
+        CHECK(converter.OnPresentTick(elapsed));
+
+        __int128 expected = (__int128)elapsed * capture.num / ((__int128)capture.den * 1000000000);
+        CHECK_EQ(converter.Stats().dropped, (uint64_t)(expected - 1));
+        CHECK(!converter.OnPresentTick(elapsed + 1));
+    }
+
+    // A present timestamped before the origin repeats rather than capturing
+    RateConverter converter(capture, Rate(60));
+    converter.Reset(1000000000);
+    CHECK(!converter.OnPresentTick(999999999));
+    CHECK_EQ(converter.Stats().repeated, 1u);
+}
+
+// Reports exactly once, and only once a full window shows the p99 over budget
+static void TestBudgetMonitorReportsOnce()
+{
+    BudgetMonitor monitor(16000000);
+    for (int i = 0; i < WorkTimeEstimator::WINDOW - 1; i++)
+        CHECK(!monitor.AddFrame(20000000));
+    CHECK(!monitor.OverBudget());
+    CHECK(monitor.AddFrame(20000000));
+    CHECK(monitor.OverBudget());
+    for (int i = 0; i < 1000; i++)
+        CHECK(!monitor.AddFrame(20000000));
+
+    // A new budget re-arms it; under budget nothing is reported however long it runs
+    monitor.SetBudget(25000000);
+    for (int i = 0; i < 1000; i++)
+        CHECK(!monitor.AddFrame(20000000));
+    monitor.SetBudget(16000000);
+    CHECK(monitor.AddFrame(20000000));
+
+    // One slow frame per window is below p99 (rank 126 of 128)
+    BudgetMonitor spikes(16000000);
+    for (int i = 0; i < 10 * WorkTimeEstimator::WINDOW; i++)
+        CHECK(!spikes.AddFrame(i % WorkTimeEstimator::WINDOW == 0 ? 50000000 : 8000000));
+}
+
+int main()
+{
+    RUN_TEST(TestParsesRateOptions);
+    RUN_TEST(TestRejectsMalformedOptions);
+    RUN_TEST(TestFrameRateFromHz);
+    RUN_TEST(TestUpconversionRepeatCadence);
+    RUN_TEST(TestDownconversionDropsEvenly);
+    RUN_TEST(TestFractionalCaptureRate);
+    RUN_TEST(TestMultiDayElapsedTime);
+    RUN_TEST(TestBudgetMonitorReportsOnce);
+    return TestExitCode();
+}
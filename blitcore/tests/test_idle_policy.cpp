@@ -0,0 +1,87 @@
+// IdlePolicy tests: skip when unchanged, gradual throttling, snap back on input or surface rebuild
+
+#include "test_common.h"
+
+#include "idle_policy.h"
+
+constexpr int64_t MS = 1000000;
+
+static void TestSkipsUnchangedFrames()
+{
+    IdlePolicy idle;
+    CHECK(idle.Update(false, false, 0));            // First poll always presents
+    CHECK(!idle.Update(false, false, 16 * MS));
+    CHECK(idle.Update(true, false, 33 * MS));
+    CHECK(idle.Update(false, true, 50 * MS));
+    CHECK(!idle.Update(false, false, 66 * MS));
+    CHECK_EQ(idle.Stats().presented, 3);
+    CHECK_EQ(idle.Stats().skipped, 2);
+}
+
+// Half rate after the quiet period, halving again every step period down to maxDivisor
+static void TestThrottlesGradually()
+{
+    IdlePolicy idle;
+    idle.Update(true, false, 0);
+    CHECK(!idle.Update(false, false, 1999 * MS));
+    CHECK_EQ(idle.PollDivisor(), 1);
+    idle.Update(false, false, 2000 * MS);
+    CHECK_EQ(idle.PollDivisor(), 2);
+    idle.Update(false, false, 3000 * MS);
+    CHECK_EQ(idle.PollDivisor(), 4);
+    idle.Update(false, false, 60000 * MS);
+    CHECK_EQ(idle.PollDivisor(), 16);
+    CHECK(idle.IsThrottled());
+
+    CHECK(idle.Update(true, false, 60100 * MS));
+    CHECK_EQ(idle.PollDivisor(), 1);
+}
+
+// Input and surface rebuilds both restore full rate and present the next poll, content unchanged
+static void TestInputAndResetForcePresent()
+{
+    IdlePolicy idle;
+    idle.Update(true, false, 0);
+    idle.Update(false, false, 5000 * MS);
+    CHECK(idle.IsThrottled());
+
+    idle.OnInput(5001 * MS);
+    CHECK_EQ(idle.PollDivisor(), 1);
+    CHECK(idle.Update(false, false, 5002 * MS));
+    CHECK(!idle.Update(false, false, 5003 * MS));
+
+    idle.Update(false, false, 9000 * MS);
+    CHECK(idle.IsThrottled());
+    idle.Reset(9001 * MS);
+    CHECK(!idle.IsThrottled());
+    CHECK(idle.Update(false, false, 9002 * MS));
+    // The quiet period restarts from the rebuild
+    idle.Update(false, false, 10000 * MS);
+    CHECK_EQ(idle.PollDivisor(), 1);
+}
+
+static void TestHashSeesEveryByte()
+{
+    uint8_t pixels[64 * 3] = {};
+    uint64_t base = HashFrameRegion(pixels, 64, 3, 64);
+    for (int i = 0; i < 64 * 3; i += 7)
+    {
+        pixels[i] ^= 1;
+        CHECK(HashFrameRegion(pixels, 64, 3, 64) != base);
+        pixels[i] ^= 1;
+    }
+    // Bytes outside widthBytes (row padding) are ignored
+    pixels[63] = 9;
+    uint64_t padded = HashFrameRegion(pixels, 60, 3, 64);
+    pixels[63] = 0;
+    CHECK_EQ(HashFrameRegion(pixels, 60, 3, 64), padded);
+}
+
+int main()
+{
+    RUN_TEST(TestSkipsUnchangedFrames);
+    RUN_TEST(TestThrottlesGradually);
+    RUN_TEST(TestInputAndResetForcePresent);
+    RUN_TEST(TestHashSeesEveryByte);
+    return TestExitCode();
+}
@@ -0,0 +1,234 @@
+// ImageView tests: sub-rectangles and clipping, padded and negative (bottom-up) pitches, NV12 plane
+// layout, and the format conversions FillView and ConvertView go through
+
+#include "test_common.h"
+
+#include "image_view.h"
+
+#include <vector>
+
+// 10 x 6 BGRA with 8 bytes of padding per row; each pixel holds (y << 8) | x
+struct PaddedImage
+{
+    static constexpr int WIDTH = 10;
+    static constexpr int HEIGHT = 6;
+    static constexpr int PITCH = WIDTH * 4 + 8;
+
+    std::vector<uint8_t> bytes = std::vector<uint8_t>(PITCH * HEIGHT, 0xEE);
+
+    PaddedImage()
+    {
+        ImageView<FormatBGRA8> view = View();
+        for (int y = 0; y < HEIGHT; y++)
+        {
+            for (int x = 0; x < WIDTH; x++)
+                view.At(x, y) = (uint32_t)(y << 8 | x);
+        }
+    }
+    ImageView<FormatBGRA8> View() { return ImageView<FormatBGRA8>(bytes.data(), WIDTH, HEIGHT, PITCH); }
+};
+
+static void TestRowsFollowPitch()
+{
+    PaddedImage image;
+    ImageView<FormatBGRA8> view = image.View();
+    CHECK_EQ(view.Pitch(), PaddedImage::PITCH);
+    CHECK((uint8_t*)view.Row(3) == image.bytes.data() + 3 * PaddedImage::PITCH);
+    CHECK_EQ(view.At(9, 5), 0x509u);
+    CHECK(!view.Contiguous());
+    CHECK(!view.Empty());
+    // Padding is never touched
+    CHECK_EQ(image.bytes[PaddedImage::WIDTH * 4], 0xEE);
+    CHECK_EQ(image.bytes[2 * PaddedImage::PITCH - 1], 0xEE);
+
+    ImageView<FormatBGRA8> tight(image.bytes.data(), 12, 6, 48);
+    CHECK(tight.Contiguous());
+}
+
+static void TestSubRectangles()
+{
+    PaddedImage image;
+    ImageView<FormatBGRA8> view = image.View();
+
+    ImageView<FormatBGRA8> sub = view.Sub(3, 2, 4, 3);
+    CHECK_EQ(sub.Width(), 4);
+    CHECK_EQ(sub.Height(), 3);
+    CHECK_EQ(sub.Pitch(), view.Pitch());
+    CHECK_EQ(sub.At(0, 0), 0x203u);
+    CHECK_EQ(sub.At(3, 2), 0x406u);
+
+    // Nested subs compose, and writes land in the parent
+    ImageView<FormatBGRA8> inner = sub.Sub(1, 1, 2, 1);
+    CHECK_EQ(inner.At(0, 0), 0x304u);
+    inner.At(1, 0) = 0xDEADBEEF;
+    CHECK_EQ(view.At(5, 3), 0xDEADBEEFu);
+
+    // Clipped at every edge
+    ImageView<FormatBGRA8> clipped = view.Sub(-2, -1, 5, 4);
+    CHECK_EQ(clipped.Width(), 3);
+    CHECK_EQ(clipped.Height(), 3);
+    CHECK_EQ(clipped.At(0, 0), 0x000u);
+    clipped = view.Sub(8, 4, 10, 10);
+    CHECK_EQ(clipped.Width(), 2);
+    CHECK_EQ(clipped.Height(), 2);
+    CHECK_EQ(clipped.At(1, 1), 0x509u);
+
+    // No overlap: empty
+    CHECK(view.Sub(10, 0, 5, 5).Empty());
+    CHECK(view.Sub(0, -5, 5, 5).Empty());
+    CHECK(view.Sub(2, 2, 0, 3).Empty());
+}
+
+// A fill through a sub-view touches exactly that rectangle
+static void TestFillSubRectangle()
+{
+    PaddedImage image;
+    ImageView<FormatBGRA8> view = image.View();
+    FillView(view.Sub(2, 1, 5, 3), 0xFF00FF00);
+    for (int y = 0; y < PaddedImage::HEIGHT; y++)
+    {
+        for (int x = 0; x < PaddedImage::WIDTH; x++)
+        {
+            bool inside = x >= 2 && x < 7 && y >= 1 && y < 4;
+            CHECK_EQ(view.At(x, y), inside ? 0xFF00FF00u : (uint32_t)(y << 8 | x));
+        }
+    }
+    for (int y = 0; y < PaddedImage::HEIGHT; y++)
+        CHECK_EQ(image.bytes[y * PaddedImage::PITCH + PaddedImage::WIDTH * 4], 0xEE);
+}
+
+// Bottom-up DIBs: row 0 is the last row in memory and the pitch is negative
+static void TestBottomUpPitch()
+{
+    PaddedImage image;
+    // Memory row r holds logical row HEIGHT - 1 - r
+    ImageView<FormatBGRA8> view = ImageView<FormatBGRA8>::BottomUp(image.bytes.data(), PaddedImage::WIDTH,
+                                                                   PaddedImage::HEIGHT, PaddedImage::PITCH);
+    CHECK_EQ(view.Pitch(), -PaddedImage::PITCH);
+    CHECK((uint8_t*)view.Row(0) == image.bytes.data() + 5 * PaddedImage::PITCH);
+    CHECK_EQ(view.At(4, 0), 0x504u);
+    CHECK_EQ(view.At(4, 5), 0x004u);
+
+    ImageView<FormatBGRA8> sub = view.Sub(1, 1, 3, 2);
+    CHECK_EQ(sub.Pitch(), -PaddedImage::PITCH);
+    CHECK_EQ(sub.At(0, 0), 0x401u);
+    CHECK_EQ(sub.At(2, 1), 0x303u);
+
+    // Copying a bottom-up view into a top-down one flips it
+    std::vector<uint32_t> flipped(PaddedImage::WIDTH * PaddedImage::HEIGHT);
+    ImageView<FormatBGRA8> out(flipped.data(), PaddedImage::WIDTH, PaddedImage::HEIGHT, PaddedImage::WIDTH * 4);
+    ConvertView(ImageView<const FormatBGRA8>(view), out);
+    CHECK_EQ(flipped[0], 0x500u);
+    CHECK_EQ(flipped[PaddedImage::WIDTH * 5 + 9], 0x009u);
+}
+
+static void TestAlignmentQueries()
+{
+    alignas(64) uint8_t bytes[64 * 4];
+    CHECK(ImageView<FormatBGRA8>(bytes, 16, 4, 64).RowsAligned(16));
+    CHECK(ImageView<FormatBGRA8>(bytes, 16, 4, 64).RowsAligned(64));
+    CHECK(!ImageView<FormatBGRA8>(bytes, 10, 4, 40).RowsAligned(16));       // Pitch breaks it
+    CHECK(!ImageView<FormatBGRA8>(bytes, 16, 4, 64).Sub(1, 0, 4, 4).RowsAligned(16));
+    CHECK(ImageView<FormatBGRA8>(bytes, 16, 4, 64).Sub(4, 1, 4, 2).RowsAligned(16));
+    CHECK(ImageView<FormatBGRA8>::BottomUp(bytes, 16, 4, 64).RowsAligned(64));
+}
+
+// Chroma follows the luma rows at the same pitch, at half resolution
+static void TestNv12Planes()
+{
+    std::vector<uint8_t> bytes(32 * 12, 0);
+    Nv12Image<> image(bytes.data(), 30, 8, 32);
+    CHECK_EQ(image.y.Width(), 30);
+    CHECK_EQ(image.uv.Width(), 15);
+    CHECK_EQ(image.uv.Height(), 4);
+    CHECK((uint8_t*)image.uv.Row(0) == bytes.data() + 8 * 32);
+    image.uv.At(2, 1).v = 77;
+    CHECK_EQ(bytes[9 * 32 + 5], 77);
+
+    Nv12Image<true> readOnly(bytes.data(), 30, 8, 32);
+    CHECK_EQ(readOnly.uv.At(2, 1).v, 77);
+}
+
+// Formats convert to and from BGRA8: exact where the format holds 8 bits, rounded otherwise
+static void TestFormatConversions()
+{
+    // 565 keeps the top bits; extremes and mid-grey survive the round trip
+    CHECK_EQ(FormatRGB565::FromBgra8(0xFFFFFFFF), 0xFFFF);
+    CHECK_EQ(FormatRGB565::ToBgra8(0xFFFF), 0xFFFFFFFFu);
+    CHECK_EQ(FormatRGB565::ToBgra8(0x0000), 0xFF000000u);
+    CHECK_EQ(FormatRGB565::ToBgra8(FormatRGB565::FromBgra8(0xFF808080)), 0xFF848284u);
+    for (uint32_t v = 0; v < 256; v++)
+    {
+        uint32_t back = FormatRGB565::ToBgra8(FormatRGB565::FromBgra8(v << 16 | v << 8 | v));
+        CHECK_NEAR((int)((back >> 16) & 0xFF), (int)v, 4);
+        CHECK_NEAR((int)((back >> 8) & 0xFF), (int)v, 2);
+    }
+
+    // X formats read back opaque
+    CHECK_EQ(FormatBGRX8::ToBgra8(0x00123456), 0xFF123456u);
+
+    // 10-bit: every 8-bit value survives the round trip exactly
+    for (uint32_t v = 0; v < 256; v++)
+    {
+        uint32_t c = 0xFF000000u | v << 16 | (255 - v) << 8 | (v ^ 0x55);
+        CHECK_EQ(FormatR10G10B10A2::ToBgra8(FormatR10G10B10A2::FromBgra8(c)), c);
+    }
+    CHECK_EQ(FormatR10G10B10A2::FromBgra8(0xFFFFFFFF), 0xFFFFFFFFu);
+
+    // Halfs: exact values, subnormals, overflow
+    CHECK_EQ(FloatToHalf(1.0f), 0x3C00);
+    CHECK_EQ(FloatToHalf(-2.0f), 0xC000);
+    CHECK_EQ(FloatToHalf(65520.0f), 0x7C00);
+    CHECK_EQ(FloatToHalf(5.9604645e-8f), 0x0001);
+    CHECK(HalfToFloat(0x3555) > 0.333f && HalfToFloat(0x3555) < 0.334f);
+    for (uint32_t h = 0; h < 0x7C00; h++)
+        CHECK_EQ(FloatToHalf(HalfToFloat((uint16_t)h)), h);
+
+    // scRGB: sRGB white and black are 1.0 and 0.0, and 8-bit values survive the round trip
+    FormatRGBA16F::Pixel white = FormatRGBA16F::FromBgra8(0xFFFFFFFF);
+    CHECK_EQ(white.r, 0x3C00);
+    CHECK_EQ(white.a, 0x3C00);
+    for (uint32_t v = 0; v < 256; v++)
+    {
+        uint32_t c = 0xFF000000u | v << 16 | v << 8 | v;
+        CHECK_EQ(FormatRGBA16F::ToBgra8(FormatRGBA16F::FromBgra8(c)), c);
+    }
+}
+
+// Conversion between views of different pixel sizes and pitches, through a sub-rectangle
+static void TestConvertBetweenFormats()
+{
+    PaddedImage image;
+    ImageView<FormatBGRA8> source = image.View();
+    FillView(source, 0xFF204060);
+    source.At(1, 1) = 0xFFFFFFFF;
+
+    std::vector<uint16_t> rgb565(8 * 4, 0xABCD);
+    ImageView<FormatRGB565> dst(rgb565.data(), 6, 3, 16);          // Pitch of 8 pixels, width 6
+    ConvertView(ImageView<const FormatBGRA8>(source.Sub(1, 1, 6, 3)), dst);
+    CHECK_EQ(dst.At(0, 0), 0xFFFF);
+    CHECK_EQ(dst.At(1, 0), FormatRGB565::FromBgra8(0xFF204060));
+    CHECK_EQ(dst.At(5, 2), FormatRGB565::FromBgra8(0xFF204060));
+    CHECK_EQ(rgb565[6], 0xABCD);                                  // Row padding untouched
+    CHECK_EQ(rgb565[7], 0xABCD);
+    CHECK_EQ(rgb565[3 * 8], 0xABCD);                              // Nothing past the last row
+
+    // Sizes differ: only the overlap is converted
+    std::vector<uint32_t> small(4, 0);
+    ConvertView(ImageView<const FormatRGB565>(dst), ImageView<FormatBGRX8>(small.data(), 2, 2, 8));
+    CHECK_EQ(small[0], 0xFFFFFFFFu);
+    CHECK_EQ(small[3], FormatRGB565::ToBgra8(FormatRGB565::FromBgra8(0xFF204060)));
+}
+
+int main()
+{
+    RUN_TEST(TestRowsFollowPitch);
+    RUN_TEST(TestSubRectangles);
+    RUN_TEST(TestFillSubRectangle);
+    RUN_TEST(TestBottomUpPitch);
+    RUN_TEST(TestAlignmentQueries);
+    RUN_TEST(TestNv12Planes);
+    RUN_TEST(TestFormatConversions);
+    RUN_TEST(TestConvertBetweenFormats);
+    return TestExitCode();
+}
@@ -0,0 +1,256 @@
+// MirrorPipeline tests: hot reconfiguration under load with a synthetic source whose content
+// changes every poll. A dropped frame is a poll that did not present; a stale or mis-sized frame is
+// one composed for the wrong geometry or from an older capture.
+
+#include "test_common.h"
+
+#include "mirror_pipeline.h"
+#include "worker_pool.h"
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Source rect, render area, output size (source position moves with the layout too)
+static MirrorGeometry Layout(int index)
+{
+    static const int layouts[][6] = {
+        { 960, 540, 720, 540, 960, 540 },
+        { 640, 480, 640, 480, 800, 480 },
+        { 1280, 720, 960, 720, 1280, 720 },
+    };
+    const int* l = layouts[index % 3];
+    MirrorGeometry g;
+    g.sourceX = (index % 3) * 1920;
+    g.sourceY = 0;
+    g.sourceWidth = l[0];
+    g.sourceHeight = l[1];
+    g.renderWidth = l[2];
+    g.renderHeight = l[3];
+    g.outputWidth = l[4];
+    g.outputHeight = l[5];
+    return g;
+}
+
+static bool SameGeometry(const MirrorGeometry& a, const MirrorGeometry& b)
+{
+    return a.sourceX == b.sourceX && a.sourceY == b.sourceY && a.sourceWidth == b.sourceWidth &&
+           a.sourceHeight == b.sourceHeight && a.renderWidth == b.renderWidth && a.renderHeight == b.renderHeight &&
+           a.outputWidth == b.outputWidth && a.outputHeight == b.outputHeight;
+}
+
+// Solid frames, a new colour every capture, so any scaler reproduces it in the render area
+class CountingSource : public MirrorSource
+{
+public:
+    CountingSource() : m_Pixels((size_t)1280 * 720 * 4) {}
+
+    bool Capture(const MirrorGeometry& geometry, const uint8_t** pixels, int* pitch) override
+    {
+        if (!SameGeometry(geometry, live))
+            wrongGeometry++;
+        captures++;
+        color = 0xFF400000u | (uint32_t)(captures & 0xFFFF);
+        uint32_t* p = (uint32_t*)m_Pixels.data();
+        for (int y = 0; y < geometry.sourceHeight; y++)
+            for (int x = 0; x < geometry.sourceWidth; x++)
+                p[(size_t)y * 1280 + x] = color;
+        *pixels = m_Pixels.data();
+        *pitch = 1280 * 4;
+        return true;
+    }
+
+    bool QueryCursor(MirrorCursor* cursor, CursorSprite*) override
+    {
+        cursor->visible = false;
+        return true;
+    }
+
+    void OnGeometryChanged(const MirrorGeometry& geometry) override { live = geometry; }
+
+    MirrorGeometry live;
+    uint32_t color = 0;
+    uint64_t captures = 0;
+    uint64_t wrongGeometry = 0;
+
+private:
+    std::vector<uint8_t> m_Pixels;
+};
+
+class CheckingSink : public MirrorSink
+{
+public:
+    explicit CheckingSink(const CountingSource* source) : m_Source(source) {}
+
+    bool Present(const uint8_t* pixels, int pitch, int width, int height) override
+    {
+        presents++;
+        if (width != live.outputWidth || height != live.outputHeight)
+            wrongSize++;
+        // Centre of the render area: the capture this poll made, within a rounding step
+        const uint8_t* c = pixels + (size_t)(live.renderHeight / 2) * pitch + (size_t)(live.renderWidth / 2) * 4;
+        uint32_t expected = m_Source->color;
+        for (int i = 0; i < 3; i++)
+        {
+            if (abs(c[i] - (int)((expected >> (8 * i)) & 0xFF)) > 1)
+            {
+                stale++;
+                break;
+            }
+        }
+        return true;
+    }
+
+    void OnGeometryChanged(const MirrorGeometry& geometry) override
+    {
+        live = geometry;
+        swaps++;
+    }
+
+    MirrorGeometry live;
+    uint64_t presents = 0;
+    uint64_t swaps = 0;
+    uint64_t wrongSize = 0;
+    uint64_t stale = 0;
+
+private:
+    const CountingSource* m_Source;
+};
+
+// Competing CPU load at normal priority: each thread spins spinMs, sleeps sleepMs, until stopped
+class CpuLoad
+{
+public:
+    CpuLoad(int threads, int spinMs, int sleepMs)
+    {
+        for (int i = 0; i < threads; i++)
+        {
+            m_Threads.emplace_back([this, spinMs, sleepMs] {
+                volatile uint64_t sink = 0;
+                while (!m_Stop.load(std::memory_order_relaxed))
+                {
+                    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(spinMs);
+                    while (std::chrono::steady_clock::now() < until)
+                        sink = sink * 6364136223846793005ull + 1;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs));
+                }
+            });
+        }
+    }
+
+    ~CpuLoad()
+    {
+        m_Stop.store(true);
+        for (std::thread& thread : m_Threads)
+            thread.join();
+    }
+
+private:
+    std::atomic<bool> m_Stop{false};
+    std::vector<std::thread> m_Threads;
+};
+
+// Polls until the last requested stage is live (the builder runs at idle priority)
+static void SettleReconfigure(MirrorPipeline& pipeline)
+{
+    for (int i = 0; i < 2000 && pipeline.ReconfigurePending(); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        pipeline.RunFrame();
+    }
+}
+
+// Frame loop on the test thread: a reconfigure every 7 polls, 400 polls, not one dropped or stale
+static void TestReconfigureDropsNoFrames()
+{
+    WorkerPool workers(2);
+    CountingSource source;
+    CheckingSink sink(&source);
+    MirrorPipeline pipeline(&source, &sink, &workers);
+    CHECK(pipeline.Configure(Layout(0)));
+    source.live = sink.live = Layout(0);     // Configure is synchronous and does not notify
+    uint64_t configured = pipeline.Stats().reconfigurations;
+
+    int requests = 0;
+    for (int i = 0; i < 400; i++)
+    {
+        if (i % 7 == 3)
+            CHECK(pipeline.Reconfigure(Layout(++requests)));
+        CHECK(pipeline.RunFrame());
+    }
+    SettleReconfigure(pipeline);
+    CHECK(!pipeline.ReconfigurePending());
+
+    const MirrorPipelineStats& stats = pipeline.Stats();
+    CHECK_EQ(stats.polls - stats.presented, 0u);     // Dropped frames
+    CHECK_EQ(stats.captureFailures, 0u);
+    CHECK_EQ(stats.presentFailures, 0u);
+    CHECK_EQ(pipeline.ReconfigureFailures(), 0u);
+    CHECK_EQ(sink.presents, stats.presented);
+    CHECK_EQ(source.wrongGeometry, 0u);
+    CHECK_EQ(sink.wrongSize, 0u);
+    CHECK_EQ(sink.stale, 0u);
+
+    // Requests made while a build was in flight coalesce, so fewer swaps than requests, but at
+    // least one, and the last request is what ends up live
+    uint64_t swapped = stats.reconfigurations - configured;
+    CHECK(swapped >= 1 && swapped <= (uint64_t)requests);
+    CHECK_EQ(sink.swaps, swapped);
+    CHECK(SameGeometry(pipeline.Geometry(), Layout(requests)));
+    CHECK_EQ(pipeline.Output().width, Layout(requests).outputWidth);
+}
+
+// Paced on the pipeline's own thread at 30 Hz (unoptimised test builds take up to 15 ms a frame
+// here) while another thread reconfigures every 100 ms, against at least two normal-priority
+// threads spinning 3 ms of every 4. The stage builder runs at idle priority, so under load it only
+// gets the gaps; every poll must still present, none stale or mis-sized. Missed deadlines are
+// counted too: the load takes some (up to 5 of 40 polls here), the swaps must not add a run of them.
+static void TestReconfigureWhileRunning()
+{
+    WorkerPool workers(2);
+    CountingSource source;
+    CheckingSink sink(&source);
+    MirrorPipeline pipeline(&source, &sink, &workers);
+    CHECK(pipeline.Configure(Layout(0)));
+    source.live = sink.live = Layout(0);     // Configure is synchronous and does not notify
+    uint64_t configured = pipeline.Stats().reconfigurations;
+
+    FrameRate rate;
+    rate.num = 30;
+    int cores = (int)std::thread::hardware_concurrency();
+    int requests = 0;
+    {
+        CpuLoad load(cores > 2 ? cores : 2, 3, 1);
+        CHECK(pipeline.Start(rate));
+        for (int i = 0; i < 12; i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            CHECK(pipeline.Reconfigure(Layout(++requests)));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        pipeline.Stop();
+    }
+    SettleReconfigure(pipeline);
+
+    const MirrorPipelineStats& stats = pipeline.Stats();
+    CHECK(stats.polls >= 30);
+    CHECK_EQ(stats.polls - stats.presented, 0u);
+    CHECK(stats.missedDeadlines <= stats.polls / 4);
+    CHECK_EQ(stats.captureFailures, 0u);
+    CHECK_EQ(stats.presentFailures, 0u);
+    CHECK_EQ(source.wrongGeometry, 0u);
+    CHECK_EQ(sink.wrongSize, 0u);
+    CHECK_EQ(sink.stale, 0u);
+    CHECK(stats.reconfigurations - configured >= 2);
+    CHECK(SameGeometry(pipeline.Geometry(), Layout(requests)));
+}
+
+int main()
+{
+    RUN_TEST(TestReconfigureDropsNoFrames);
+    RUN_TEST(TestReconfigureWhileRunning);
+    return TestExitCode();
+}
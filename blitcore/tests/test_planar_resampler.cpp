@@ -0,0 +1,103 @@
+// PlanarResampler tests: agreement with BilinearSampler (same taps and rounding) at periodic ratios,
+// odd widths and pitches, streaming row stores, and rejection of what it does not handle
+
+#include "test_common.h"
+
+#include "bilinear_sampler.h"
+#include "planar_resampler.h"
+#include "stream_store.h"
+
+#include <stdlib.h>
+
+#include <vector>
+
+// Compares BGR against the sampler (alpha is always 255 in the planar output); returns the largest
+// difference and whether rows without a vertical blend were bit-identical
+static int MaxDifference(int srcWidth, int srcHeight, int dstWidth, int dstHeight, int pitchSlack,
+                         uint64_t seed, bool* alignedRowsExact)
+{
+    int srcPitch = srcWidth * 4 + pitchSlack * 4;
+    int dstPitch = dstWidth * 4 + pitchSlack * 4;
+    std::vector<uint8_t> src((size_t)srcPitch * srcHeight);
+    TestRandom random(seed);
+    for (uint8_t& v : src)
+        v = (uint8_t)random.Next();
+
+    PlanarResampler planar;
+    BilinearSampler sampler;
+    CHECK(planar.Configure(srcWidth, srcHeight, dstWidth, dstHeight));
+    CHECK(sampler.Configure(srcWidth, srcHeight, dstWidth, dstHeight));
+    std::vector<uint8_t> fast((size_t)dstPitch * dstHeight, 0xCD), reference((size_t)dstPitch * dstHeight, 0xCD);
+    planar.Scale(src.data(), srcPitch, fast.data(), dstPitch);
+    sampler.Scale(src.data(), srcPitch, reference.data(), dstPitch);
+
+    // Streaming row stores write exactly what regular ones do
+    std::vector<uint8_t> streamed((size_t)dstPitch * dstHeight, 0xCD);
+    planar.ScaleRows(src.data(), srcPitch, streamed.data(), dstPitch, 0, dstHeight, true);
+    StreamFence();
+    CHECK(streamed == fast);
+
+    int worst = 0;
+    *alignedRowsExact = true;
+    for (int y = 0; y < dstHeight; y++)
+    {
+        // Texel-aligned rows: the vertical coordinate (y + 0.5) * src / dst - 0.5 is whole
+        bool aligned = (((2 * (int64_t)y + 1) * srcHeight - dstHeight) % (2 * (int64_t)dstHeight)) == 0;
+        for (int x = 0; x < dstWidth; x++)
+        {
+            const uint8_t* f = &fast[(size_t)y * dstPitch + x * 4];
+            const uint8_t* r = &reference[(size_t)y * dstPitch + x * 4];
+            for (int c = 0; c < 3; c++)
+            {
+                int diff = abs(f[c] - r[c]);
+                worst = diff > worst ? diff : worst;
+                if (aligned && diff)
+                    *alignedRowsExact = false;
+            }
+            CHECK_EQ(f[3], 255);
+        }
+        // Pitch padding is never written
+        for (int i = dstWidth * 4; i < dstPitch; i++)
+            CHECK_EQ(fast[(size_t)y * dstPitch + i], 0xCD);
+    }
+    return worst;
+}
+
+static void TestMatchesBilinearSampler()
+{
+    const int sizes[][4] = {
+        { 1920, 1080, 1440, 1080 },     // 4:3, the mirror's ratio
+        { 2560, 1440, 1440, 1080 },     // 16:9 -> period 16
+        { 1920, 1080, 1440, 810 },      // Vertical blend on every row
+        { 1000, 5, 750, 5 },            // 250 periods: 8-wide blocks plus a tail
+        { 36, 3, 27, 3 },               // Fewer than 8 periods: the scalar tail only
+        { 300, 9, 100, 4 },             // 3:1
+        { 1600, 4, 1600, 4 },           // 1:1
+    };
+    uint64_t seed = 37;
+    for (const int* s : sizes)
+    {
+        for (int slack = 0; slack < 2; slack++)
+        {
+            bool alignedExact;
+            CHECK(MaxDifference(s[0], s[1], s[2], s[3], slack * 3, seed++, &alignedExact) <= 1);
+            CHECK(alignedExact);
+        }
+    }
+}
+
+static void TestRejectsUnsupported()
+{
+    PlanarResampler planar;
+    CHECK(!planar.Configure(1440, 1080, 1920, 1080));   // Upscaling
+    CHECK(!planar.Configure(1921, 1080, 1440, 1080));   // Period 1921
+    CHECK(!planar.Configure(0, 1080, 1440, 1080));
+    CHECK(planar.Configure(1920, 1080, 1440, 1080));
+}
+
+int main()
+{
+    RUN_TEST(TestMatchesBilinearSampler);
+    RUN_TEST(TestRejectsUnsupported);
+    return TestExitCode();
+}
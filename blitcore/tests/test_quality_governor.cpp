@@ -0,0 +1,159 @@
+// QualityGovernor tests: step down on blown budgets, step up only with headroom after the dwell
+// time, and no oscillation in the band between the two thresholds (simulated frame times)
+
+#include "test_common.h"
+
+#include "quality_governor.h"
+
+#include <string.h>
+
+constexpr int64_t BUDGET_NS = 16000000;
+constexpr int64_t FRAME_NS = 16000000;
+
+// Feeds count frames of workNs at the frame rate; returns how many changed the level
+static int Run(QualityGovernor& governor, int64_t& now, int count, int64_t workNs)
+{
+    int changes = 0;
+    for (int i = 0; i < count; i++)
+    {
+        now += FRAME_NS;
+        changes += governor.AddFrame(workNs, now) ? 1 : 0;
+    }
+    return changes;
+}
+
+static QualityGovernor MakeGovernor()
+{
+    QualityGovernorConfig config;
+    config.budgetNs = BUDGET_NS;
+    return QualityGovernor(config);
+}
+
+// Five frames over 90% of the budget step down at once, without waiting out the window
+static void TestStepsDownOnBlownBudget()
+{
+    QualityGovernor governor = MakeGovernor();
+    int64_t now = 0;
+    CHECK_EQ(Run(governor, now, 4, 15000000), 0);
+    CHECK_EQ(governor.Level(), QUALITY_FULL);
+    CHECK(governor.AddFrame(15000000, now += FRAME_NS));
+    CHECK_EQ(governor.Level(), QUALITY_FAST_FILTER);
+    CHECK(governor.Settings().fastFilter);
+    CHECK_EQ(governor.Settings().captureDivisor, 1);
+
+    CHECK_EQ(Run(governor, now, 5, 15000000), 1);
+    CHECK_EQ(governor.Level(), QUALITY_HALF_RATE);
+    CHECK_EQ(governor.Settings().captureDivisor, 2);
+
+    // Bottom of the ladder: nothing further to give up
+    CHECK_EQ(Run(governor, now, 100, 40000000), 0);
+    CHECK_EQ(governor.Stats().stepsDown, 2);
+}
+
+// Occasional slow frames (fewer than five per window) are tolerated
+static void TestIsolatedSpikesDoNotStepDown()
+{
+    QualityGovernor governor = MakeGovernor();
+    int64_t now = 0;
+    for (int window = 0; window < 20; window++)
+    {
+        Run(governor, now, 4, 20000000);
+        Run(governor, now, 26, 5000000);
+    }
+    CHECK_EQ(governor.Level(), QUALITY_FULL);
+}
+
+// Between 55% and 90% of the budget the level holds in either direction
+static void TestHysteresisBandHolds()
+{
+    QualityGovernor governor = MakeGovernor();
+    int64_t now = 0;
+    Run(governor, now, 5, 20000000);
+    CHECK_EQ(governor.Level(), QUALITY_FAST_FILTER);
+
+    CHECK_EQ(Run(governor, now, 3000, 11000000), 0);     // 69%: no headroom to go up, not over
+    CHECK_EQ(governor.Level(), QUALITY_FAST_FILTER);
+}
+
+// Stepping up needs a clean window below 55% of the level above's budget, and 3 s at this level
+static void TestStepsUpAfterDwellWithHeadroom()
+{
+    QualityGovernor governor = MakeGovernor();
+    int64_t now = 0;
+    Run(governor, now, 5, 20000000);
+    int64_t downAt = now;
+
+    // Clean windows, but the dwell has not passed: stays down
+    Run(governor, now, 150, 4000000);
+    CHECK(now - downAt < 3000000000);
+    CHECK_EQ(governor.Level(), QUALITY_FAST_FILTER);
+
+    // After 3 s the next full clean window steps up, at its end
+    int changes = Run(governor, now, 60, 4000000);
+    CHECK_EQ(changes, 1);
+    CHECK_EQ(governor.Level(), QUALITY_FULL);
+    CHECK(now - downAt >= 3000000000);
+    CHECK_EQ(governor.Stats().stepsUp, 1);
+}
+
+// A window with one frame just above the up threshold does not step up
+static void TestOneSlowFrameBlocksStepUp()
+{
+    QualityGovernor governor = MakeGovernor();
+    int64_t now = 0;
+    Run(governor, now, 5, 20000000);
+    for (int window = 0; window < 20; window++)
+    {
+        Run(governor, now, 29, 4000000);
+        Run(governor, now, 1, 9000000);                    // 56% of the budget
+    }
+    CHECK_EQ(governor.Level(), QUALITY_FAST_FILTER);
+}
+
+// Half-rate capture has twice the budget per processed frame, but stepping back up to full rate
+// is judged against the full-rate budget
+static void TestHalfRateBudget()
+{
+    QualityGovernor governor = MakeGovernor();
+    int64_t now = 0;
+    Run(governor, now, 10, 20000000);
+    CHECK_EQ(governor.Level(), QUALITY_HALF_RATE);
+
+    CHECK_EQ(Run(governor, now, 300, 24000000), 0);      // 75% of 32 ms: fine at half rate
+    CHECK_EQ(Run(governor, now, 300, 10000000), 0);      // 31% of 32 ms, but 62% of 16 ms
+    CHECK_EQ(governor.Level(), QUALITY_HALF_RATE);
+    CHECK_EQ(Run(governor, now, 60, 8000000), 1);        // 50% of 16 ms
+    CHECK_EQ(governor.Level(), QUALITY_FAST_FILTER);
+}
+
+static void TestTimeInLevelReport()
+{
+    QualityGovernor governor = MakeGovernor();
+    int64_t now = 0;
+    governor.AddFrame(1000000, now);
+    Run(governor, now, 5, 20000000);                      // 80 ms at full
+    now += 1000000000;
+    governor.Flush(now);                                  // 1 s at fast-filter
+
+    const QualityGovernorStats& stats = governor.Stats();
+    CHECK_EQ(stats.timeInLevelNs[QUALITY_FULL], 80000000);
+    CHECK_EQ(stats.timeInLevelNs[QUALITY_FAST_FILTER], 1000000000);
+    CHECK_EQ(stats.timeInLevelNs[QUALITY_HALF_RATE], 0);
+
+    char report[256];
+    FormatQualityReport(governor, report, sizeof(report));
+    CHECK(strstr(report, "1 down, 0 up") != nullptr);
+    CHECK(strstr(report, "fast-filter 1.0s (93%)") != nullptr);
+}
+
+int main()
+{
+    RUN_TEST(TestStepsDownOnBlownBudget);
+    RUN_TEST(TestIsolatedSpikesDoNotStepDown);
+    RUN_TEST(TestHysteresisBandHolds);
+    RUN_TEST(TestStepsUpAfterDwellWithHeadroom);
+    RUN_TEST(TestOneSlowFrameBlocksStepUp);
+    RUN_TEST(TestHalfRateBudget);
+    RUN_TEST(TestTimeInLevelReport);
+    return TestExitCode();
+}
@@ -0,0 +1,232 @@
+// SourceRecovery tests: a fault-injecting source whose Reinitialize fails N times before it
+// succeeds, checking the backoff schedule, held frames, Resume on the frame thread, outage timing
+// and Cancel against an attempt in flight
+
+#include "test_common.h"
+
+#include "source_recovery.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock SteadyClock;
+
+static int64_t ElapsedNs(SteadyClock::time_point from, SteadyClock::time_point to)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+}
+
+class FaultySource : public RecoverableSource
+{
+public:
+    explicit FaultySource(int failures) : m_Failures(failures) {}
+
+    bool Reinitialize() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_AttemptTimes.push_back(SteadyClock::now());
+        }
+        inAttempt = true;
+        while (blockAttempts.load())
+            std::this_thread::yield();
+        bool ok = m_Attempts.fetch_add(1) >= m_Failures;
+        inAttempt = false;
+        return ok;
+    }
+
+    void Resume() override
+    {
+        resumes++;
+        resumeThread = std::this_thread::get_id();
+    }
+
+    int Attempts() const { return m_Attempts.load(); }
+    std::vector<SteadyClock::time_point> AttemptTimes()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_AttemptTimes;
+    }
+
+    std::atomic<bool> blockAttempts{false};     // Holds attempts inside Reinitialize
+    std::atomic<bool> inAttempt{false};
+    int resumes = 0;
+    std::thread::id resumeThread;
+
+private:
+    int m_Failures;
+    std::atomic<int> m_Attempts{0};
+    std::mutex m_Mutex;
+    std::vector<SteadyClock::time_point> m_AttemptTimes;
+};
+
+constexpr int64_t FRAME_NS = 16666667;
+
+// Runs frames on a fake timeline (one period each, pausing a millisecond of real time) until the
+// source resumes; returns the frame index of the resume, -1 if it never did
+static int RunUntilResumed(SourceRecovery& recovery, int firstFrame, int maxFrames)
+{
+    for (int frame = firstFrame; frame < firstFrame + maxFrames; frame++)
+    {
+        if (recovery.BeginFrame(frame * FRAME_NS))
+            return frame;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return -1;
+}
+
+// Failed attempts are spaced by the backoff, doubled each time until it reaches the maximum.
+// The waits are real (condition variable timeouts), so only lower bounds are exact; the upper
+// bounds only need to tell a clamped wait from a doubled one.
+static void TestBackoffDoublesAndClamps()
+{
+    SourceRecoveryConfig config;
+    config.initialBackoffNs = 4000000;
+    config.maxBackoffNs = 32000000;
+    FaultySource source(7);
+    SourceRecovery recovery(&source, config);
+
+    recovery.OnLost(0);
+    CHECK(recovery.IsRecovering());
+    CHECK(RunUntilResumed(recovery, 1, 5000) > 0);
+
+    std::vector<SteadyClock::time_point> times = source.AttemptTimes();
+    CHECK_EQ((int)times.size(), 8);
+    const int64_t expected[] = { 4000000, 8000000, 16000000, 32000000, 32000000, 32000000, 32000000 };
+    for (size_t i = 1; i < times.size() && i <= 7; i++)
+    {
+        int64_t gap = ElapsedNs(times[i - 1], times[i]);
+        CHECK(gap >= expected[i - 1]);
+        if (i >= 5)
+            CHECK(gap < 2 * config.maxBackoffNs);     // Clamped, not 64, 128 ms
+    }
+
+    const SourceRecoveryStats& stats = recovery.Stats();
+    CHECK_EQ(stats.attempts, 8);
+    CHECK_EQ(stats.failedAttempts, 7);
+    CHECK_EQ(stats.recoveries, 1);
+}
+
+// Every frame while recovering holds the last capture; the outage runs from the frame that lost
+// the source to the frame that resumed it, and Resume runs once, on the frame thread
+static void TestHeldFramesAndOutageDuration()
+{
+    SourceRecoveryConfig config;
+    config.initialBackoffNs = 2000000;
+    FaultySource source(3);
+    SourceRecovery recovery(&source, config);
+
+    CHECK(recovery.BeginFrame(0));
+    const int lostFrame = 10;
+    recovery.OnLost(lostFrame * FRAME_NS);
+    recovery.OnLost(lostFrame * FRAME_NS + 5);        // Ignored while recovering
+    CHECK_EQ(recovery.OutageNs((lostFrame + 4) * FRAME_NS), 4 * FRAME_NS);
+
+    int resumedFrame = RunUntilResumed(recovery, lostFrame + 1, 5000);
+    CHECK(resumedFrame > lostFrame);
+    CHECK_EQ(source.resumes, 1);
+    CHECK(source.resumeThread == std::this_thread::get_id());
+    CHECK(!recovery.IsRecovering());
+    CHECK_EQ(recovery.OutageNs(resumedFrame * FRAME_NS), 0);
+
+    const SourceRecoveryStats& stats = recovery.Stats();
+    CHECK_EQ(stats.outages, 1);
+    CHECK_EQ(stats.heldFrames, (uint64_t)(resumedFrame - lostFrame - 1));
+    CHECK_EQ(stats.lastOutageNs, (resumedFrame - lostFrame) * FRAME_NS);
+    CHECK_EQ(stats.maxOutageNs, stats.lastOutageNs);
+    CHECK_EQ(stats.totalOutageNs, stats.lastOutageNs);
+    CHECK_EQ(stats.attempts, 4);
+
+    // A second, shorter outage: totals add, the maximum stays
+    int64_t firstOutage = stats.lastOutageNs;
+    int lostAgain = resumedFrame + 100;
+    recovery.OnLost(lostAgain * FRAME_NS);
+    int resumedAgain = RunUntilResumed(recovery, lostAgain + 1, 5000);
+    CHECK(resumedAgain > lostAgain);
+    CHECK_EQ(recovery.Stats().outages, 2);
+    CHECK_EQ(recovery.Stats().recoveries, 2);
+    CHECK_EQ(recovery.Stats().totalOutageNs, firstOutage + (resumedAgain - lostAgain) * FRAME_NS);
+}
+
+// Transient errors become a loss only when they repeat; a good capture resets the streak
+static void TestTransientErrorsNeedToRepeat()
+{
+    SourceRecoveryConfig config;
+    config.transientErrorLimit = 3;
+    FaultySource source(0);
+    SourceRecovery recovery(&source, config);
+    CHECK(!recovery.OnTransientError());
+    CHECK(!recovery.OnTransientError());
+    recovery.OnCaptureOk();
+    CHECK(!recovery.OnTransientError());
+    CHECK(!recovery.OnTransientError());
+    CHECK(recovery.OnTransientError());
+    CHECK_EQ(recovery.Stats().transientErrors, 5);
+}
+
+// Cancel returns only after the attempt in flight has finished, and that attempt's success is
+// never published: no Resume, back to healthy at once
+static void TestCancelWaitsForAttemptInFlight()
+{
+    FaultySource source(0);
+    SourceRecovery recovery(&source);
+    source.blockAttempts = true;
+    recovery.OnLost(0);
+    while (!source.inAttempt.load())
+        std::this_thread::yield();
+
+    std::atomic<bool> released(false);
+    std::thread releaser([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        released = true;
+        source.blockAttempts = false;
+    });
+    recovery.Cancel();
+    CHECK(released.load());
+    CHECK(!source.inAttempt.load());
+    releaser.join();
+
+    CHECK(!recovery.IsRecovering());
+    CHECK(recovery.BeginFrame(FRAME_NS));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(recovery.BeginFrame(2 * FRAME_NS));
+    CHECK_EQ(source.resumes, 0);
+    CHECK_EQ(source.Attempts(), 1);
+    CHECK_EQ(recovery.Stats().recoveries, 0);
+
+    // A later loss recovers normally on the same thread
+    recovery.OnLost(10 * FRAME_NS);
+    CHECK(RunUntilResumed(recovery, 11, 5000) > 10);
+    CHECK_EQ(source.resumes, 1);
+}
+
+// Cancel during the backoff wait ends it without another attempt
+static void TestCancelDuringBackoff()
+{
+    SourceRecoveryConfig config;
+    config.initialBackoffNs = 10000000000;
+    FaultySource source(100);
+    SourceRecovery recovery(&source, config);
+    recovery.OnLost(0);
+    while (recovery.Stats().failedAttempts == 0)
+        std::this_thread::yield();
+
+    SteadyClock::time_point start = SteadyClock::now();
+    recovery.Cancel();
+    CHECK(ElapsedNs(start, SteadyClock::now()) < 1000000000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK_EQ(source.Attempts(), 1);
+}
+
+int main()
+{
+    RUN_TEST(TestBackoffDoublesAndClamps);
+    RUN_TEST(TestHeldFramesAndOutageDuration);
+    RUN_TEST(TestTransientErrorsNeedToRepeat);
+    RUN_TEST(TestCancelWaitsForAttemptInFlight);
+    RUN_TEST(TestCancelDuringBackoff);
+    return TestExitCode();
+}
@@ -0,0 +1,198 @@
+// TileScheduler tests: tile grid, priority order (cursor > changed > stale oldest first > rest)
+// and carrying under overload, on simulated tile costs
+
+#include "test_common.h"
+
+#include "tile_scheduler.h"
+
+#include <vector>
+
+// Source and destination tiles partition both images with no gaps or overlap
+static void TestTilesPartitionBothImages()
+{
+    TileScheduler scheduler(1920, 1080, 1440, 1080);
+    CHECK_EQ(scheduler.TileCount(), 40);
+
+    std::vector<int> srcCover(1920 * 1080), dstCover(1440 * 1080);
+    for (int i = 0; i < scheduler.TileCount(); i++)
+    {
+        const TileRect& t = scheduler.Tile(i);
+        for (int y = t.srcY; y < t.srcY + t.srcHeight; y++)
+            for (int x = t.srcX; x < t.srcX + t.srcWidth; x++)
+                srcCover[y * 1920 + x]++;
+        for (int y = t.dstY; y < t.dstY + t.dstHeight; y++)
+            for (int x = t.dstX; x < t.dstX + t.dstWidth; x++)
+                dstCover[y * 1440 + x]++;
+    }
+    for (int c : srcCover)
+        CHECK_EQ(c, 1);
+    for (int c : dstCover)
+        CHECK_EQ(c, 1);
+}
+
+// With time to spare, every tile is handed out once and the cursor's neighbourhood comes first
+static void TestCursorTilesComeFirst()
+{
+    TileScheduler scheduler(1920, 1080, 1440, 1080);
+    scheduler.BeginFrame(1000, 500, 1000000000);    // Cursor in column 4, row 2
+
+    std::vector<int> seen(scheduler.TileCount());
+    int tile;
+    TileMode mode;
+    int handed = 0;
+    while (scheduler.NextTile(0, &tile, &mode))
+    {
+        int col = tile % 8, row = tile / 8;
+        bool near = col >= 3 && col <= 5 && row >= 1 && row <= 3;
+        CHECK_EQ(near, handed < 9);
+        CHECK_EQ(mode, TILE_CHEAP);                 // Progressive: cheap first, refined later
+        seen[tile]++;
+        handed++;
+        scheduler.EndTile(tile, mode, 1000, false);
+    }
+    CHECK_EQ(handed, 40);
+    for (int s : seen)
+        CHECK_EQ(s, 1);
+}
+
+constexpr int64_t TILE_COST_NS = 1000;
+
+// Runs one frame on a simulated clock where every tile costs TILE_COST_NS; returns the tiles handed
+// out in order and keeps carried[] (consecutive frames each tile was skipped) as the test's own model
+static std::vector<int> RunFrame(TileScheduler& scheduler, int cursorX, int cursorY, int64_t deadlineNs,
+                                 std::vector<int>* carried)
+{
+    scheduler.BeginFrame(cursorX, cursorY, deadlineNs);
+    std::vector<int> handed;
+    std::vector<bool> done(scheduler.TileCount());
+    int64_t now = 0;
+    int tile;
+    TileMode mode;
+    while (scheduler.NextTile(now, &tile, &mode))
+    {
+        handed.push_back(tile);
+        done[tile] = true;
+        now += TILE_COST_NS;
+        scheduler.EndTile(tile, mode, TILE_COST_NS, false);
+    }
+    for (int i = 0; i < scheduler.TileCount(); i++)
+        (*carried)[i] = done[i] ? 0 : (*carried)[i] + 1;
+    return handed;
+}
+
+// Priorities never decrease along the hand-out order, and stale tiles come oldest first
+static void CheckOrder(const TileScheduler& scheduler, const std::vector<int>& handed,
+                       const std::vector<int>& carriedBefore)
+{
+    for (size_t i = 1; i < handed.size(); i++)
+    {
+        TilePriority prev = scheduler.Priority(handed[i - 1]);
+        TilePriority cur = scheduler.Priority(handed[i]);
+        CHECK(prev <= cur);
+        if (prev == TILE_PRIORITY_STALE && cur == TILE_PRIORITY_STALE)
+            CHECK(carriedBefore[handed[i - 1]] >= carriedBefore[handed[i]]);
+    }
+    for (int i = 0; i < scheduler.TileCount(); i++)
+        CHECK_EQ(scheduler.Priority(i) == TILE_PRIORITY_STALE,
+                 scheduler.Priority(i) != TILE_PRIORITY_CURSOR && scheduler.Priority(i) != TILE_PRIORITY_CHANGED &&
+                 carriedBefore[i] > 0);
+}
+
+static void TestPriorityOrderUnderOverload()
+{
+    TileSchedulerConfig config;
+    config.reserveNs = 0;
+    TileScheduler scheduler(1920, 1080, 1440, 1080, config);
+    std::vector<int> carried(scheduler.TileCount());
+
+    // Frame 1 learns the cost: no cursor, all 40 tiles fit
+    CHECK_EQ(RunFrame(scheduler, -1, -1, 1000000000, &carried).size(), 40u);
+
+    // Frame 2: room for 11.5 tiles. The 9 cursor tiles (around tile 20), then the changed tile 0,
+    // then the nearest remaining tile; the other 29 are carried.
+    scheduler.MarkChanged(0, 0, 100, 100);
+    std::vector<int> before = carried;
+    std::vector<int> handed = RunFrame(scheduler, 1000, 500, 11500, &carried);
+    CHECK_EQ(handed.size(), 11u);
+    CheckOrder(scheduler, handed, before);
+    for (int i = 0; i < 9; i++)
+        CHECK_EQ(scheduler.Priority(handed[i]), TILE_PRIORITY_CURSOR);
+    CHECK_EQ(handed[9], 0);
+    CHECK_EQ(scheduler.Priority(0), TILE_PRIORITY_CHANGED);
+    CHECK_EQ(handed[10], 4);                                // Two rows up: lowest index at distance 4
+    CHECK_EQ(scheduler.Stats().carried, 29u);
+
+    // Frame 3: no time at all. The cursor moved to tile 0; its neighbourhood and the previous
+    // cursor's are still refreshed (13 tiles, cheap, past the deadline), nothing else is.
+    before = carried;
+    handed = RunFrame(scheduler, 100, 100, 0, &carried);
+    CHECK_EQ(handed.size(), 13u);
+    CheckOrder(scheduler, handed, before);
+    for (int tile : handed)
+        CHECK_EQ(scheduler.Priority(tile), TILE_PRIORITY_CURSOR);
+    CHECK_EQ(scheduler.Stats().overrunFrames, 1u);
+
+    // Frame 4: time for everything. Stale tiles follow the cursor and changed classes, oldest first:
+    // the 26 carried in frames 2 and 3, then tile 4 (refreshed in frame 2, carried in frame 3)
+    before = carried;
+    handed = RunFrame(scheduler, 100, 100, 1000000000, &carried);
+    CHECK_EQ(handed.size(), 40u);
+    CheckOrder(scheduler, handed, before);
+    size_t firstStale = 0;
+    while (scheduler.Priority(handed[firstStale]) != TILE_PRIORITY_STALE)
+        firstStale++;
+    CHECK_EQ(before[handed[firstStale]], 2);
+    CHECK_EQ(before[handed[firstStale + 25]], 2);
+    CHECK_EQ(handed[firstStale + 26], 4);
+    CHECK_EQ(before[4], 1);
+    for (int c : carried)
+        CHECK_EQ(c, 0);
+}
+
+// Settled tiles (refineAfterFrames unchanged frames) are refined once, within the caller's window
+static void TestRefinementWaitsForSettledTiles()
+{
+    TileSchedulerConfig config;
+    config.reserveNs = 0;
+    TileScheduler scheduler(1920, 1080, 1440, 1080, config);
+    std::vector<int> carried(scheduler.TileCount());
+    int tile;
+
+    for (int frame = 0; frame < config.refineAfterFrames; frame++)
+    {
+        scheduler.MarkChanged(0, 0, 100, 100);     // Tile 0 keeps changing
+        RunFrame(scheduler, -1, -1, 1000000000, &carried);
+        CHECK_EQ(scheduler.NextRefinement(0, 1000000000, &tile), frame + 1 == config.refineAfterFrames);
+    }
+
+    // Learn the full-filter cost (4x cheap), then refine with room for three tiles
+    scheduler.EndRefinement(tile, 4 * TILE_COST_NS);
+    int first = tile;
+    int refined = 1;
+    int64_t now = 0;
+    while (scheduler.NextRefinement(now, 13000, &tile))
+    {
+        CHECK(tile != 0);
+        CHECK(!scheduler.IsRefined(tile));
+        now += 4 * TILE_COST_NS;
+        scheduler.EndRefinement(tile, 4 * TILE_COST_NS);
+        refined++;
+    }
+    CHECK_EQ(refined, 4);
+    CHECK_EQ(scheduler.Stats().refined, 4u);
+
+    // A damaged tile is no longer refined and has to settle again
+    CHECK(scheduler.IsRefined(first));
+    const TileRect& t = scheduler.Tile(first);
+    scheduler.MarkChanged(t.srcX, t.srcY, 1, 1);
+    CHECK(!scheduler.IsRefined(first));
+}
+
+int main()
+{
+    RUN_TEST(TestTilesPartitionBothImages);
+    RUN_TEST(TestCursorTilesComeFirst);
+    RUN_TEST(TestPriorityOrderUnderOverload);
+    RUN_TEST(TestRefinementWaitsForSettledTiles);
+    return TestExitCode();
+}
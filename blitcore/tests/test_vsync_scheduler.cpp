@@ -0,0 +1,164 @@
+// Vsync scheduling tests: least-squares refresh fit, p99 work estimate and margin adaptation,
+// driven with simulated vblank sequences
+
+#include "test_common.h"
+
+#include "vsync_scheduler.h"
+
+// 59.94 Hz with a 3.2 ms phase and +-200 us timestamp jitter
+constexpr int64_t TRUE_PERIOD_NS = 16683350;
+constexpr int64_t TRUE_PHASE_NS = 3200000;
+
+static int64_t TrueVblank(int64_t n)
+{
+    return TRUE_PHASE_NS + n * TRUE_PERIOD_NS;
+}
+
+static int64_t Jitter(TestRandom& random)
+{
+    return random.Below(400001) - 200000;
+}
+
+static void TestFitRecoversPeriodAndPhase()
+{
+    VsyncEstimator vsync(1000000000 / 60);
+    TestRandom random(7);
+    for (int64_t n = 1000; n < 1200; n++)
+    {
+        vsync.AddVblank(n, TrueVblank(n) + Jitter(random));
+        CHECK_EQ(vsync.IsLocked(), n - 1000 + 1 >= VsyncEstimator::MIN_SAMPLES);
+    }
+
+    // Slope error of a 120-sample fit with 115 us rms jitter is a few hundred ns
+    CHECK_NEAR(vsync.PeriodNs(), TRUE_PERIOD_NS, 1500);
+    // Phase: predictions land on the true grid, well inside the jitter
+    int64_t now = TrueVblank(1199) + 5000000;
+    CHECK_NEAR(vsync.NextVblankAfter(now), TrueVblank(1200), 100000);
+    CHECK_NEAR(vsync.NextVblankAfter(TrueVblank(1210) + 1000000), TrueVblank(1211), 100000);
+}
+
+// Without a refresh counter the count is inferred from the period; dropped samples must not shift it
+static void TestInferredCountsSurviveGaps()
+{
+    VsyncEstimator vsync(1000000000 / 60);
+    TestRandom random(11);
+    for (int64_t n = 0; n < 400; n++)
+    {
+        if (n % 7 == 3 || (n > 100 && n < 104))
+            continue;
+        vsync.AddVblankTime(TrueVblank(n) + Jitter(random) / 4);
+    }
+    CHECK_NEAR(vsync.PeriodNs(), TRUE_PERIOD_NS, 1000);
+    CHECK_NEAR(vsync.NextVblankAfter(TrueVblank(399) + 1000), TrueVblank(400), 60000);
+}
+
+// A refresh counter that goes backwards (mode change) restarts the fit
+static void TestCounterResetRestartsFit()
+{
+    VsyncEstimator vsync(1000000000 / 60);
+    for (int64_t n = 100; n < 120; n++)
+        vsync.AddVblank(n, TrueVblank(n));
+    CHECK(vsync.IsLocked());
+
+    // Now 75 Hz from counter 0 (fits outside half to twice the nominal period are rejected)
+    int64_t base = TrueVblank(120);
+    vsync.AddVblank(0, base);
+    CHECK(!vsync.IsLocked());
+    for (int64_t n = 1; n < 20; n++)
+        vsync.AddVblank(n, base + n * 13333333);
+    CHECK(vsync.IsLocked());
+    CHECK_NEAR(vsync.PeriodNs(), 13333333, 10);
+}
+
+// p99 of a 128-sample window: rank 126, so one outlier is ignored but two are not.
+// Below 100 samples the estimate is the window maximum.
+static void TestWorkEstimateIsP99()
+{
+    WorkTimeEstimator work;
+    work.AddSample(5000000);
+    for (int i = 0; i < 49; i++)
+        work.AddSample(1000000);
+    CHECK_EQ(work.PredictedNs(), 5000000);
+
+    WorkTimeEstimator full;
+    for (int i = 0; i < 127; i++)
+        full.AddSample(1000000 + i);
+    full.AddSample(9000000);
+    CHECK_EQ(full.Count(), 128);
+    CHECK_EQ(full.PredictedNs(), 1000126);
+
+    full.AddSample(8000000);     // Replaces the oldest sample: two outliers now
+    CHECK_EQ(full.PredictedNs(), 8000000);
+
+    // Outliers age out of the window
+    for (int i = 0; i < 128; i++)
+        full.AddSample(2000000);
+    CHECK_EQ(full.PredictedNs(), 2000000);
+}
+
+// Start = target vblank - p99 work - margin, always the earliest vblank still reachable
+static void TestPlanStartsJustInTime()
+{
+    VsyncScheduler scheduler;
+    int64_t start, target;
+    CHECK(!scheduler.PlanNextFrame(0, &start, &target));
+
+    for (int64_t n = 0; n < 20; n++)
+        scheduler.Vsync().AddVblank(n, TrueVblank(n));
+    for (int i = 0; i < 10; i++)
+        scheduler.AddWorkSample(4000000);
+
+    int64_t lead = 4000000 + scheduler.MarginNs();
+    int64_t now = TrueVblank(19) + 2000000;
+    CHECK(scheduler.PlanNextFrame(now, &start, &target));
+    CHECK_NEAR(target, TrueVblank(20), 1000);
+    CHECK_EQ(start, target - lead);
+    CHECK(start >= now);
+
+    // Too late for vblank 20: targets 21
+    now = TrueVblank(20) - lead + 1000;
+    CHECK(scheduler.PlanNextFrame(now, &start, &target));
+    CHECK_NEAR(target, TrueVblank(21), 1000);
+    CHECK_EQ(start, target - lead);
+}
+
+// Misses grow the margin by half (at least one step), clean runs shrink it a step; both clamp
+static void TestMarginAdaptsToMisses()
+{
+    VsyncSchedulerConfig config;
+    VsyncScheduler scheduler(config);
+    for (int64_t n = 0; n < 20; n++)
+        scheduler.Vsync().AddVblank(n, TrueVblank(n));
+
+    int64_t target = TrueVblank(20);
+    scheduler.OnPresented(target, target + TRUE_PERIOD_NS);
+    CHECK_EQ(scheduler.MarginNs(), 1500000);
+    scheduler.OnPresented(target, target + TRUE_PERIOD_NS);
+    CHECK_EQ(scheduler.MarginNs(), 2250000);
+    for (int i = 0; i < 10; i++)
+        scheduler.OnPresented(target, target + TRUE_PERIOD_NS);
+    CHECK_EQ(scheduler.MarginNs(), config.maxMarginNs);
+    CHECK_EQ(scheduler.Stats().missed, 12);
+
+    // A hit (within half a period) 119 times changes nothing; the 120th shrinks by one step
+    for (int i = 0; i < config.hitsBeforeDecrease - 1; i++)
+        scheduler.OnPresented(target, target + 100000);
+    CHECK_EQ(scheduler.MarginNs(), config.maxMarginNs);
+    scheduler.OnPresented(target, target);
+    CHECK_EQ(scheduler.MarginNs(), config.maxMarginNs - config.marginStepNs);
+
+    for (int i = 0; i < 100 * config.hitsBeforeDecrease; i++)
+        scheduler.OnPresented(target, target);
+    CHECK_EQ(scheduler.MarginNs(), config.minMarginNs);
+}
+
+int main()
+{
+    RUN_TEST(TestFitRecoversPeriodAndPhase);
+    RUN_TEST(TestInferredCountsSurviveGaps);
+    RUN_TEST(TestCounterResetRestartsFit);
+    RUN_TEST(TestWorkEstimateIsP99);
+    RUN_TEST(TestPlanStartsJustInTime);
+    RUN_TEST(TestMarginAdaptsToMisses);
+    return TestExitCode();
+}
@@ -0,0 +1,134 @@
+// WorkerPool tests: every item processed exactly once, several callers submitting at once, and
+// each caller waiting only for its own job
+
+#include "test_common.h"
+
+#include "worker_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+struct CountJob
+{
+    std::vector<std::atomic<int>>* hits;
+    std::atomic<int> calls{0};
+};
+
+static void CountTask(void* context, int begin, int end)
+{
+    CountJob* job = (CountJob*)context;
+    job->calls++;
+    for (int i = begin; i < end; i++)
+        (*job->hits)[i]++;
+}
+
+static bool EachOnce(const std::vector<std::atomic<int>>& hits)
+{
+    for (const std::atomic<int>& hit : hits)
+    {
+        if (hit.load() != 1)
+            return false;
+    }
+    return true;
+}
+
+static void TestEveryItemOnce()
+{
+    WorkerPool pool(4);
+    const int counts[] = { 0, 1, 3, 4, 5, 1080, 1081 };
+    for (int count : counts)
+    {
+        std::vector<std::atomic<int>> hits(count);
+        CountJob job;
+        job.hits = &hits;
+        pool.ParallelFor(count, CountTask, &job);
+        CHECK(EachOnce(hits));
+        // Fewer items than threads runs as one range on the caller
+        CHECK_EQ(job.calls.load(), count < 4 ? 1 : 4);
+    }
+    CHECK_EQ(pool.SharedJobs(), 0);
+}
+
+// Several threads submitting at once: every job complete when its ParallelFor returns
+static void TestConcurrentSubmitters()
+{
+    WorkerPool pool(3);
+    std::atomic<int> incomplete(0);
+    std::vector<std::thread> submitters;
+    for (int t = 0; t < 4; t++)
+    {
+        submitters.emplace_back([&pool, &incomplete, t] {
+            for (int round = 0; round < 300; round++)
+            {
+                int count = 16 + (round * 7 + t * 13) % 500;
+                std::vector<std::atomic<int>> hits(count);
+                CountJob job;
+                job.hits = &hits;
+                pool.ParallelFor(count, CountTask, &job);
+                incomplete += !EachOnce(hits) || job.calls.load() != 3;
+            }
+        });
+    }
+    for (std::thread& submitter : submitters)
+        submitter.join();
+    CHECK_EQ(incomplete.load(), 0);
+}
+
+struct StallJob
+{
+    std::atomic<bool> started{false};
+    std::atomic<bool>* otherDone;
+    std::atomic<int> timedOut{0};
+};
+
+// Range 0 holds until the other caller's job has finished
+static void StallTask(void* context, int begin, int)
+{
+    StallJob* job = (StallJob*)context;
+    if (begin != 0)
+        return;
+    job->started = true;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!job->otherDone->load())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            job->timedOut++;
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
+// A job stuck in one slow range does not hold up a second caller: its job queues behind the first,
+// gets the idle workers, and returns first
+static void TestCallersWaitOnlyForTheirOwnJob()
+{
+    WorkerPool pool(4);
+    std::atomic<bool> otherDone(false);
+    StallJob stall;
+    stall.otherDone = &otherDone;
+    std::thread first([&] { pool.ParallelFor(4, StallTask, &stall); });
+    while (!stall.started.load())
+        std::this_thread::yield();
+
+    std::vector<std::atomic<int>> hits(100);
+    CountJob job;
+    job.hits = &hits;
+    pool.ParallelFor(100, CountTask, &job);
+    CHECK(EachOnce(hits));
+    CHECK_EQ(pool.SharedJobs(), 1);
+    otherDone = true;
+    first.join();
+    CHECK_EQ(stall.timedOut.load(), 0);
+}
+
+int main()
+{
+    RUN_TEST(TestEveryItemOnce);
+    RUN_TEST(TestConcurrentSubmitters);
+    RUN_TEST(TestCallersWaitOnlyForTheirOwnJob);
+    return TestExitCode();
+}
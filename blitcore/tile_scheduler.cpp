@@ -0,0 +1,240 @@
+// Intra-frame deadline scheduling - see tile_scheduler.h
+
+#include "tile_scheduler.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+TileScheduler::TileScheduler(int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+                             const TileSchedulerConfig& config)
+    : m_Config(config)
+    , m_SrcWidth(srcWidth)
+    , m_SrcHeight(srcHeight)
+{
+    if (m_Config.columns < 1) m_Config.columns = 1;
+    if (m_Config.rows < 1) m_Config.rows = 1;
+
+    // Edges at i * size / count in both spaces, so source and destination tiles line up exactly
+    for (int row = 0; row < m_Config.rows; row++)
+    {
+        for (int col = 0; col < m_Config.columns; col++)
+        {
+            TileRect t;
+            t.srcX = col * srcWidth / m_Config.columns;
+            t.srcY = row * srcHeight / m_Config.rows;
+            t.srcWidth = (col + 1) * srcWidth / m_Config.columns - t.srcX;
+            t.srcHeight = (row + 1) * srcHeight / m_Config.rows - t.srcY;
+            t.dstX = col * dstWidth / m_Config.columns;
+            t.dstY = row * dstHeight / m_Config.rows;
+            t.dstWidth = (col + 1) * dstWidth / m_Config.columns - t.dstX;
+            t.dstHeight = (row + 1) * dstHeight / m_Config.rows - t.dstY;
+            m_Tiles.push_back(t);
+        }
+    }
+
+    int count = (int)m_Tiles.size();
+    m_Order.resize(count);
+    m_Priority.assign(count, TILE_PRIORITY_REST);
+    m_LastChangedFrame.assign(count, -(int64_t)m_Config.changedFrames - 1);
+    m_CarriedFrames.assign(count, 0);
+    m_StableFrames.assign(count, 0);
+    m_Refined.assign(count, false);
+}
+
+int TileScheduler::TileAt(int srcX, int srcY) const
+{
+    if (srcX < 0 || srcY < 0 || srcX >= m_SrcWidth || srcY >= m_SrcHeight)
+        return -1;
+    int col = (int)((int64_t)srcX * m_Config.columns / m_SrcWidth);
+    int row = (int)((int64_t)srcY * m_Config.rows / m_SrcHeight);
+    return row * m_Config.columns + col;
+}
+
+bool TileScheduler::NearTile(int tileIndex, int centerTile) const
+{
+    if (centerTile < 0)
+        return false;
+    int dx = tileIndex % m_Config.columns - centerTile % m_Config.columns;
+    int dy = tileIndex / m_Config.columns - centerTile / m_Config.columns;
+    return std::max(std::abs(dx), std::abs(dy)) <= m_Config.cursorRadius;
+}
+
+void TileScheduler::MarkChanged(int srcX, int srcY, int width, int height)
+{
+    int x0 = std::max(srcX, 0);
+    int y0 = std::max(srcY, 0);
+    int x1 = std::min(srcX + width, m_SrcWidth) - 1;
+    int y1 = std::min(srcY + height, m_SrcHeight) - 1;
+    if (x0 > x1 || y0 > y1)
+        return;
+
+    int first = TileAt(x0, y0);
+    int last = TileAt(x1, y1);
+    for (int row = first / m_Config.columns; row <= last / m_Config.columns; row++)
+    {
+        for (int col = first % m_Config.columns; col <= last % m_Config.columns; col++)
+        {
+            int tile = row * m_Config.columns + col;
+            m_LastChangedFrame[tile] = m_Frame;
+            m_StableFrames[tile] = 0;
+            m_Refined[tile] = false;
+        }
+    }
+}
+
+int64_t TileScheduler::EstimateNs(int tileIndex, TileMode mode) const
+{
+    const TileRect& t = m_Tiles[tileIndex];
+    return (int64_t)(m_NsPerPixel[mode] * t.srcWidth * t.srcHeight);
+}
+
+void TileScheduler::BeginFrame(int cursorX, int cursorY, int64_t deadlineNs)
+{
+    m_Frame++;
+    m_Stats.frames++;
+    m_DeadlineNs = deadlineNs - m_Config.reserveNs;
+    m_Next = 0;
+    m_NextRefine = 0;
+
+    // The previous cursor tile stays mandatory so the old cursor image never survives in a carried tile
+    m_PrevCursorTile = m_CursorTile;
+    m_CursorTile = TileAt(cursorX, cursorY);
+
+    m_RemainingCheapNs = 0;
+    for (int i = 0; i < TileCount(); i++)
+    {
+        m_Order[i] = i;
+        if (NearTile(i, m_CursorTile) || NearTile(i, m_PrevCursorTile))
+            m_Priority[i] = TILE_PRIORITY_CURSOR;
+        else if (m_Frame - m_LastChangedFrame[i] <= m_Config.changedFrames)
+            m_Priority[i] = TILE_PRIORITY_CHANGED;
+        else if (m_CarriedFrames[i] > 0)
+            m_Priority[i] = TILE_PRIORITY_STALE;
+        else
+            m_Priority[i] = TILE_PRIORITY_REST;
+        m_RemainingCheapNs += EstimateNs(i, TILE_CHEAP);
+    }
+
+    // Within a class: stale tiles oldest first, everything else nearest the cursor first
+    int cursorTile = m_CursorTile >= 0 ? m_CursorTile : m_PrevCursorTile;
+    int cols = m_Config.columns;
+    auto distance = [cursorTile, cols](int tile)
+    {
+        if (cursorTile < 0)
+            return 0;
+        int dx = tile % cols - cursorTile % cols;
+        int dy = tile / cols - cursorTile / cols;
+        return dx * dx + dy * dy;
+    };
+    // Ties fall back to the tile index: the stable order without stable_sort's per-frame buffer
+    std::sort(m_Order.begin(), m_Order.end(), [&](int a, int b)
+    {
+        if (m_Priority[a] != m_Priority[b])
+            return m_Priority[a] < m_Priority[b];
+        if (m_Priority[a] == TILE_PRIORITY_STALE && m_CarriedFrames[a] != m_CarriedFrames[b])
+            return m_CarriedFrames[a] > m_CarriedFrames[b];
+        int da = distance(a);
+        int db = distance(b);
+        if (da != db)
+            return da < db;
+        return a < b;
+    });
+}
+
+bool TileScheduler::NextTile(int64_t nowNs, int* tileIndex, TileMode* mode)
+{
+    while (m_Next < TileCount())
+    {
+        int tile = m_Order[m_Next++];
+        int64_t full = EstimateNs(tile, TILE_FULL);
+        int64_t cheap = EstimateNs(tile, TILE_CHEAP);
+        m_RemainingCheapNs -= cheap;
+
+        if (m_Priority[tile] == TILE_PRIORITY_CURSOR)
+        {
+            // Always refreshed; only the filter degrades
+            *tileIndex = tile;
+            *mode = !m_Config.progressive && nowNs + full <= m_DeadlineNs ? TILE_FULL : TILE_CHEAP;
+            return true;
+        }
+
+        // Full quality only while the rest of the frame could still be finished cheaply
+        // (progressive mode gets its quality from refinement instead)
+        if (!m_Config.progressive && nowNs + full + m_RemainingCheapNs <= m_DeadlineNs)
+        {
+            *tileIndex = tile;
+            *mode = TILE_FULL;
+            return true;
+        }
+        if (nowNs + cheap <= m_DeadlineNs)
+        {
+            *tileIndex = tile;
+            *mode = TILE_CHEAP;
+            return true;
+        }
+
+        m_CarriedFrames[tile]++;
+        m_Stats.carried++;
+    }
+
+    if (m_Next == TileCount() && nowNs > m_DeadlineNs)
+        m_Stats.overrunFrames++;
+    m_Next = TileCount() + 1;    // Count an overrun once even if called again
+    return false;
+}
+
+void TileScheduler::EndTile(int tileIndex, TileMode mode, int64_t costNs, bool changed)
+{
+    m_CarriedFrames[tileIndex] = 0;
+    if (changed)
+    {
+        m_LastChangedFrame[tileIndex] = m_Frame;
+        m_StableFrames[tileIndex] = 0;
+        m_Refined[tileIndex] = mode == TILE_FULL;
+    }
+    else
+    {
+        m_StableFrames[tileIndex]++;
+    }
+    m_Stats.tiles[mode]++;
+    UpdateCost(tileIndex, mode, costNs);
+}
+
+bool TileScheduler::NextRefinement(int64_t nowNs, int64_t untilNs, int* tileIndex)
+{
+    if (!m_Config.progressive)
+        return false;
+
+    // Same order as the first pass, so settled tiles near the cursor sharpen first
+    while (m_NextRefine < TileCount())
+    {
+        int tile = m_Order[m_NextRefine++];
+        if (m_Refined[tile] || m_CarriedFrames[tile] > 0 || m_StableFrames[tile] < m_Config.refineAfterFrames)
+            continue;
+        if (nowNs + EstimateNs(tile, TILE_FULL) > untilNs - m_Config.reserveNs)
+            continue;
+
+        *tileIndex = tile;
+        return true;
+    }
+    return false;
+}
+
+void TileScheduler::EndRefinement(int tileIndex, int64_t costNs)
+{
+    m_Refined[tileIndex] = true;
+    m_Stats.refined++;
+    UpdateCost(tileIndex, TILE_FULL, costNs);
+}
+
+void TileScheduler::UpdateCost(int tileIndex, TileMode mode, int64_t costNs)
+{
+    // Per-pixel cost, smoothed (1/8) so one slow tile does not flip the whole next frame to cheap
+    const TileRect& t = m_Tiles[tileIndex];
+    double nsPerPixel = (double)costNs / ((double)t.srcWidth * t.srcHeight);
+    if (m_NsPerPixel[mode] == 0.0)
+        m_NsPerPixel[mode] = nsPerPixel;
+    else
+        m_NsPerPixel[mode] += (nsPerPixel - m_NsPerPixel[mode]) * 0.125;
+}
@@ -0,0 +1,116 @@
+// Intra-frame deadline scheduling (platform independent)
+// Splits the scale pass into a grid of tiles and hands them out most-important first: tiles around
+// the cursor, then recently changed tiles, then tiles carried over from earlier frames, then the rest.
+// Near the deadline remaining tiles fall back to the cheap filter or keep last frame's pixels, so an
+// overloaded frame still presents on time with the region the user is looking at fresh.
+// In progressive mode every tile takes the cheap filter first; tiles that have settled are re-scaled
+// with the high-quality filter in idle time the caller hands out after the frame (refinement).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+// Source rectangle and the destination rectangle it scales into
+struct TileRect
+{
+    int srcX, srcY, srcWidth, srcHeight;
+    int dstX, dstY, dstWidth, dstHeight;
+};
+
+enum TileMode
+{
+    TILE_FULL = 0,      // High-quality filter
+    TILE_CHEAP,         // Nearest/box filter
+    TILE_MODE_COUNT
+};
+
+// Priority classes, most important first
+enum TilePriority
+{
+    TILE_PRIORITY_CURSOR = 0,   // Around the current or previous cursor position (never carried)
+    TILE_PRIORITY_CHANGED,      // Content changed within the last few frames
+    TILE_PRIORITY_STALE,        // Carried over from an earlier frame, oldest first
+    TILE_PRIORITY_REST
+};
+
+struct TileSchedulerConfig
+{
+    int columns = 8;                    // 1920x1080 -> 240x216 source tiles
+    int rows = 5;
+    int cursorRadius = 1;               // Tiles (Chebyshev distance) around the cursor's tile
+    int changedFrames = 8;              // A tile stays "recently changed" this many frames
+    int64_t reserveNs = 1000000;        // Kept free before the deadline for compositing/present
+    bool progressive = true;            // Cheap pass for every tile, high quality only once settled
+    int refineAfterFrames = 4;          // Unchanged frames before a tile is refined
+};
+
+struct TileSchedulerStats
+{
+    uint64_t frames = 0;
+    uint64_t tiles[TILE_MODE_COUNT] = {};
+    uint64_t carried = 0;               // Tiles left showing an earlier frame's pixels
+    uint64_t refined = 0;               // High-quality re-scales of settled tiles
+    uint64_t overrunFrames = 0;         // Frames whose tiles finished past the deadline
+};
+
+class TileScheduler
+{
+public:
+    TileScheduler(int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+                  const TileSchedulerConfig& config = TileSchedulerConfig());
+
+    int TileCount() const { return (int)m_Tiles.size(); }
+    const TileRect& Tile(int index) const { return m_Tiles[index]; }
+
+    // Damage hint in source coordinates (e.g. DXGI dirty rects); front-ends without damage
+    // information report per-tile changes through EndTile instead
+    void MarkChanged(int srcX, int srcY, int width, int height);
+
+    // Orders this frame's tiles. Cursor is in source coordinates (outside = no cursor tiles).
+    void BeginFrame(int cursorX, int cursorY, int64_t deadlineNs);
+
+    // Next tile to scale and the filter to use; tiles that no longer fit are carried
+    // (skipped, keeping their old pixels). Returns false when the frame is done.
+    bool NextTile(int64_t nowNs, int* tileIndex, TileMode* mode);
+
+    // Measured cost of a tile, and whether its output differs from the previous frame
+    void EndTile(int tileIndex, TileMode mode, int64_t costNs, bool changed);
+
+    // Progressive mode, after NextTile returns false: next settled tile to re-scale with the
+    // high-quality filter, while one still fits before untilNs (e.g. the next frame's start)
+    bool NextRefinement(int64_t nowNs, int64_t untilNs, int* tileIndex);
+    void EndRefinement(int tileIndex, int64_t costNs);
+
+    bool IsRefined(int tileIndex) const { return m_Refined[tileIndex]; }
+
+    int64_t EstimateNs(int tileIndex, TileMode mode) const;
+    TilePriority Priority(int tileIndex) const { return m_Priority[tileIndex]; }
+    const TileSchedulerStats& Stats() const { return m_Stats; }
+
+private:
+    int TileAt(int srcX, int srcY) const;
+    bool NearTile(int tileIndex, int centerTile) const;
+    void UpdateCost(int tileIndex, TileMode mode, int64_t costNs);
+
+    TileSchedulerConfig m_Config;
+    int m_SrcWidth;
+    int m_SrcHeight;
+    std::vector<TileRect> m_Tiles;
+    std::vector<int> m_Order;
+    std::vector<TilePriority> m_Priority;
+    std::vector<int64_t> m_LastChangedFrame;
+    std::vector<int> m_CarriedFrames;       // Consecutive frames a tile has been carried
+    std::vector<int> m_StableFrames;        // Consecutive frames a tile came out unchanged
+    std::vector<bool> m_Refined;            // Tile currently shows a high-quality scale of its content
+    double m_NsPerPixel[TILE_MODE_COUNT] = {};
+    int64_t m_Frame = 0;
+    int64_t m_DeadlineNs = 0;
+    int64_t m_RemainingCheapNs = 0;         // Cheap-path estimate of the tiles not yet handed out
+    int m_Next = 0;
+    int m_NextRefine = 0;
+    int m_CursorTile = -1;
+    int m_PrevCursorTile = -1;
+    TileSchedulerStats m_Stats;
+};
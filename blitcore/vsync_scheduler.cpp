@@ -0,0 +1,168 @@
+// Vsync phase-locked scheduling - see vsync_scheduler.h
+
+#include "vsync_scheduler.h"
+
+#include <algorithm>
+#include <math.h>
+
+VsyncEstimator::VsyncEstimator(int64_t nominalPeriodNs)
+    : m_NominalPeriodNs(nominalPeriodNs > 0 ? nominalPeriodNs : 1000000000 / 60)
+    , m_PeriodNs((double)m_NominalPeriodNs)
+{
+}
+
+void VsyncEstimator::Reset()
+{
+    m_Head = 0;
+    m_Count = 0;
+    m_PeriodNs = (double)m_NominalPeriodNs;
+    m_HasLast = false;
+}
+
+void VsyncEstimator::AddVblank(int64_t refreshCount, int64_t timestampNs)
+{
+    if (m_HasLast)
+    {
+        if (refreshCount == m_Last.refreshCount)
+            return;
+        // Counter went backwards (mode change, device reset): start over
+        if (refreshCount < m_Last.refreshCount || timestampNs <= m_Last.timestampNs)
+            Reset();
+    }
+
+    m_Samples[m_Head] = { refreshCount, timestampNs };
+    m_Head = (m_Head + 1) % WINDOW;
+    if (m_Count < WINDOW)
+        m_Count++;
+
+    m_Last = { refreshCount, timestampNs };
+    m_HasLast = true;
+    Refit();
+}
+
+void VsyncEstimator::AddVblankTime(int64_t timestampNs)
+{
+    int64_t count = 0;
+    if (m_HasLast)
+    {
+        count = m_Last.refreshCount + llround((double)(timestampNs - m_Last.timestampNs) / m_PeriodNs);
+    }
+    AddVblank(count, timestampNs);
+}
+
+void VsyncEstimator::Refit()
+{
+    const Sample& newest = m_Last;
+
+    if (m_Count < 2)
+    {
+        m_RefTimeNs = (double)newest.timestampNs;
+        return;
+    }
+
+    // Regress relative to the newest sample to keep the doubles small
+    double sumK = 0.0, sumT = 0.0;
+    for (int i = 0; i < m_Count; i++)
+    {
+        sumK += (double)(m_Samples[i].refreshCount - newest.refreshCount);
+        sumT += (double)(m_Samples[i].timestampNs - newest.timestampNs);
+    }
+    double meanK = sumK / m_Count;
+    double meanT = sumT / m_Count;
+
+    double sumKK = 0.0, sumKT = 0.0;
+    for (int i = 0; i < m_Count; i++)
+    {
+        double dk = (double)(m_Samples[i].refreshCount - newest.refreshCount) - meanK;
+        double dt = (double)(m_Samples[i].timestampNs - newest.timestampNs) - meanT;
+        sumKK += dk * dk;
+        sumKT += dk * dt;
+    }
+    if (sumKK <= 0.0)
+        return;
+
+    // Reject fits far from the nominal rate (bad timestamps, wrong counter inference)
+    double period = sumKT / sumKK;
+    if (period < m_NominalPeriodNs * 0.5 || period > m_NominalPeriodNs * 2.0)
+        return;
+
+    m_PeriodNs = period;
+    m_RefTimeNs = (double)newest.timestampNs + meanT - period * meanK;
+}
+
+int64_t VsyncEstimator::NextVblankAfter(int64_t timeNs) const
+{
+    double offset = (double)timeNs - m_RefTimeNs;
+    double n = floor(offset / m_PeriodNs) + 1.0;
+    int64_t vblank = (int64_t)(m_RefTimeNs + n * m_PeriodNs);
+    if (vblank <= timeNs)
+        vblank = (int64_t)(m_RefTimeNs + (n + 1.0) * m_PeriodNs);
+    return vblank;
+}
+
+void WorkTimeEstimator::AddSample(int64_t workNs)
+{
+    m_Samples[m_Head] = workNs;
+    m_Head = (m_Head + 1) % WINDOW;
+    if (m_Count < WINDOW)
+        m_Count++;
+
+    // 128 samples: a copy + nth_element per frame is cheaper than maintaining a sorted window
+    int64_t sorted[WINDOW];
+    std::copy(m_Samples, m_Samples + m_Count, sorted);
+    int rank = (m_Count * 99 + 99) / 100 - 1;
+    std::nth_element(sorted, sorted + rank, sorted + m_Count);
+    m_Predicted = sorted[rank];
+}
+
+VsyncScheduler::VsyncScheduler(const VsyncSchedulerConfig& config)
+    : m_Config(config)
+    , m_Vsync(config.nominalPeriodNs)
+    , m_MarginNs(config.initialMarginNs)
+{
+}
+
+bool VsyncScheduler::PlanNextFrame(int64_t nowNs, int64_t* startNs, int64_t* targetVblankNs) const
+{
+    if (!m_Vsync.IsLocked())
+        return false;
+
+    int64_t lead = m_Work.PredictedNs() + m_MarginNs;
+
+    // Earliest vblank we can still make if we start right now (start is always within one period)
+    int64_t vblank = m_Vsync.NextVblankAfter(nowNs + lead);
+
+    *startNs = vblank - lead;
+    *targetVblankNs = vblank;
+    return true;
+}
+
+void VsyncScheduler::OnPresented(int64_t targetVblankNs, int64_t actualVblankNs)
+{
+    m_Presented++;
+
+    int64_t halfPeriod = m_Vsync.PeriodNs() / 2;
+    if (actualVblankNs > targetVblankNs + halfPeriod)
+    {
+        m_Missed++;
+        m_ConsecutiveHits = 0;
+        m_MarginNs = std::min(m_Config.maxMarginNs, m_MarginNs + std::max(m_Config.marginStepNs, m_MarginNs / 2));
+        return;
+    }
+
+    if (++m_ConsecutiveHits >= m_Config.hitsBeforeDecrease)
+    {
+        m_ConsecutiveHits = 0;
+        m_MarginNs = std::max(m_Config.minMarginNs, m_MarginNs - m_Config.marginStepNs);
+    }
+}
+
+VsyncSchedulerStats VsyncScheduler::Stats() const
+{
+    VsyncSchedulerStats stats;
+    stats.presented = m_Presented;
+    stats.missed = m_Missed;
+    stats.marginNs = m_MarginNs;
+    stats.predictedWorkNs = m_Work.PredictedNs();
+    return stats;
+}
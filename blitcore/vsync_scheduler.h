@@ -0,0 +1,115 @@
+// Vsync phase-locked scheduling (platform independent)
+// Learns the display's refresh period/phase from vblank timestamps and the pipeline's p99 work time,
+// then starts each frame at next_vblank - predicted_work - margin so it lands just before scanout.
+
+#pragma once
+
+#include <stdint.h>
+
+// Least-squares fit of vblank timestamps against refresh count over a sliding window
+class VsyncEstimator
+{
+public:
+    explicit VsyncEstimator(int64_t nominalPeriodNs);
+
+    // Vblank with a known refresh counter (e.g. DXGI_FRAME_STATISTICS SyncRefreshCount / SyncQPCTime)
+    void AddVblank(int64_t refreshCount, int64_t timestampNs);
+    // Vblank without a counter; the count is inferred from the current period estimate
+    void AddVblankTime(int64_t timestampNs);
+
+    void Reset();
+
+    bool IsLocked() const { return m_Count >= MIN_SAMPLES; }
+    int64_t PeriodNs() const { return (int64_t)m_PeriodNs; }
+    // First predicted vblank strictly after timeNs
+    int64_t NextVblankAfter(int64_t timeNs) const;
+
+    static constexpr int WINDOW = 120;
+    static constexpr int MIN_SAMPLES = 8;
+
+private:
+    void Refit();
+
+    struct Sample
+    {
+        int64_t refreshCount;
+        int64_t timestampNs;
+    };
+
+    Sample m_Samples[WINDOW];
+    int m_Head = 0;
+    int m_Count = 0;
+    int64_t m_NominalPeriodNs;
+    double m_PeriodNs;
+    double m_RefTimeNs = 0.0;    // Fitted time of the newest vblank
+    bool m_HasLast = false;
+    Sample m_Last = {};
+};
+
+// Rolling high percentile of recent processing times
+class WorkTimeEstimator
+{
+public:
+    void AddSample(int64_t workNs);
+    // p99 over the window (max over the window while it holds fewer than 100 samples)
+    int64_t PredictedNs() const { return m_Predicted; }
+    int Count() const { return m_Count; }
+
+    static constexpr int WINDOW = 128;
+
+private:
+    int64_t m_Samples[WINDOW] = {};
+    int m_Head = 0;
+    int m_Count = 0;
+    int64_t m_Predicted = 0;
+};
+
+struct VsyncSchedulerConfig
+{
+    int64_t nominalPeriodNs = 1000000000 / 60;
+    int64_t minMarginNs = 200000;        // 0.2 ms
+    int64_t maxMarginNs = 4000000;       // 4 ms
+    int64_t initialMarginNs = 1000000;
+    int64_t marginStepNs = 100000;       // Decrease step after a clean window
+    int hitsBeforeDecrease = 120;        // Consecutive on-time frames before shrinking the margin
+};
+
+struct VsyncSchedulerStats
+{
+    uint64_t presented = 0;
+    uint64_t missed = 0;       // Presented after the targeted vblank
+    int64_t marginNs = 0;
+    int64_t predictedWorkNs = 0;
+};
+
+class VsyncScheduler
+{
+public:
+    explicit VsyncScheduler(const VsyncSchedulerConfig& config = VsyncSchedulerConfig());
+
+    VsyncEstimator& Vsync() { return m_Vsync; }
+    const VsyncEstimator& Vsync() const { return m_Vsync; }
+
+    // Start time for the next frame and the vblank it targets.
+    // Returns false until the vsync estimator has locked; callers fall back to plain pacing.
+    bool PlanNextFrame(int64_t nowNs, int64_t* startNs, int64_t* targetVblankNs) const;
+
+    // Processing time of a frame, measured from its start until Present returned
+    void AddWorkSample(int64_t workNs) { m_Work.AddSample(workNs); }
+
+    // Presented frame feedback: the vblank it targeted vs. the vblank it actually hit.
+    // Misses grow the margin multiplicatively; long runs of hits shrink it additively.
+    void OnPresented(int64_t targetVblankNs, int64_t actualVblankNs);
+
+    int64_t MarginNs() const { return m_MarginNs; }
+    VsyncSchedulerStats Stats() const;
+
+private:
+    VsyncSchedulerConfig m_Config;
+    VsyncEstimator m_Vsync;
+    WorkTimeEstimator m_Work;
+    int64_t m_MarginNs;
+    int m_ConsecutiveHits = 0;
+    uint64_t m_Presented = 0;
+    uint64_t m_Missed = 0;
+};
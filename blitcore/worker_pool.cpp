@@ -0,0 +1,152 @@
+// Persistent worker threads - see worker_pool.h
+
+#include "worker_pool.h"
+
+WorkerPool::WorkerPool(int threadCount)
+{
+    if (threadCount <= 0)
+        threadCount = (int)std::thread::hardware_concurrency();
+    if (threadCount <= 0)
+        threadCount = 1;
+
+    m_ThreadCount = threadCount;
+    for (int i = 1; i < threadCount; i++)
+        m_Threads.emplace_back(&WorkerPool::WorkerMain, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Exit = true;
+    }
+    m_Queued.notify_all();
+    for (std::thread& thread : m_Threads)
+        thread.join();
+}
+
+// Range i of n over [0, count): boundaries at i * count / n
+static inline int RangeBegin(int index, int count, int ranges)
+{
+    return (int)((long long)index * count / ranges);
+}
+
+bool WorkerPool::ClaimRange(Job* job, int* begin, int* end)
+{
+    if (job->nextRange == job->ranges)
+        return false;
+
+    int index = job->nextRange++;
+    *begin = RangeBegin(index, job->count, job->ranges);
+    *end = RangeBegin(index + 1, job->count, job->ranges);
+
+    // Fully handed out: unlink so the workers move on to the next job
+    if (job->nextRange == job->ranges)
+    {
+        Job** link = &m_Head;
+        Job* previous = nullptr;
+        while (*link != job)
+        {
+            previous = *link;
+            link = &(*link)->next;
+        }
+        *link = job->next;
+        if (m_Tail == job)
+            m_Tail = previous;
+    }
+    return true;
+}
+
+void WorkerPool::FinishRange(Job* job)
+{
+    bool last;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        last = --job->unfinished == 0;
+        if (last)
+            m_InFlight--;
+    }
+    // Several callers may be waiting, each for its own job
+    if (last)
+        m_Finished.notify_all();
+}
+
+void WorkerPool::ParallelFor(int count, WorkerTask task, void* context)
+{
+    int ranges = ThreadCount();
+    if (ranges == 1 || count < ranges)
+    {
+        task(context, 0, count);
+        return;
+    }
+
+    Job job;
+    job.task = task;
+    job.context = context;
+    job.count = count;
+    job.ranges = ranges;
+    job.nextRange = 0;
+    job.unfinished = ranges;
+    job.next = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_InFlight > 0)
+            m_SharedJobs++;
+        m_InFlight++;
+        if (m_Tail)
+            m_Tail->next = &job;
+        else
+            m_Head = &job;
+        m_Tail = &job;
+    }
+    m_Queued.notify_all();
+
+    // The caller works on its own job until every range is handed out
+    for (;;)
+    {
+        int begin, end;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (!ClaimRange(&job, &begin, &end))
+                break;
+        }
+        task(context, begin, end);
+        FinishRange(&job);
+    }
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Finished.wait(lock, [&job] { return job.unfinished == 0; });
+}
+
+uint64_t WorkerPool::SharedJobs() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_SharedJobs;
+}
+
+void WorkerPool::WorkerMain()
+{
+    for (;;)
+    {
+        Job* job = nullptr;
+        int begin = 0, end = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Queued.wait(lock, [this] { return m_Exit || m_Head; });
+            if (m_Exit)
+                return;
+            // Fully handed-out jobs are unlinked by ClaimRange, so this is normally the head; any
+            // queued job with a range left will do
+            for (Job* queued = m_Head; queued && !job; queued = queued->next)
+            {
+                if (ClaimRange(queued, &begin, &end))
+                    job = queued;
+            }
+        }
+        if (!job)
+            continue;
+
+        job->task(job->context, begin, end);
+        FinishRange(job);
+    }
+}
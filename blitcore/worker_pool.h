@@ -0,0 +1,69 @@
+// Persistent worker threads for splitting per-frame pixel work across cores (platform independent)
+// ParallelFor splits a job into one contiguous range per thread and queues it; the caller works
+// through its own job's ranges while idle workers take the rest, so a frame costs one wake-up per
+// worker and no allocation (the job lives on the caller's stack).
+// One pool can be shared by several callers (e.g. mirror pipelines on their own threads): jobs
+// queue in submission order, each with its own count of unfinished ranges, and every caller waits
+// only for its own job. Workers drain the queue front to back, so a second job gets them as soon
+// as the first has no ranges left to hand out.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Processes items [begin, end)
+typedef void (*WorkerTask)(void* context, int begin, int end);
+
+class WorkerPool
+{
+public:
+    // threadCount includes the calling thread; 0 = one per hardware thread
+    explicit WorkerPool(int threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Splits [0, count) into ThreadCount() ranges and returns when all are done.
+    // Safe to call from several threads at once; their jobs share the workers.
+    void ParallelFor(int count, WorkerTask task, void* context);
+
+    // Jobs submitted while another caller's job was still queued or running
+    uint64_t SharedJobs() const;
+
+    int ThreadCount() const { return m_ThreadCount; }
+
+private:
+    // One ParallelFor call; on the caller's stack, linked into the queue until its last range is claimed
+    struct Job
+    {
+        WorkerTask task;
+        void* context;
+        int count;
+        int ranges;
+        int nextRange;          // Next range to hand out
+        int unfinished;         // Ranges handed out or not, that have not completed
+        Job* next;
+    };
+
+    void WorkerMain();
+    // Claims the next range of the job at the front of the queue; called with m_Mutex held
+    bool ClaimRange(Job* job, int* begin, int* end);
+    void FinishRange(Job* job);
+
+    int m_ThreadCount;
+    std::vector<std::thread> m_Threads;
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_Queued;
+    std::condition_variable m_Finished;     // Some job's last range completed
+    Job* m_Head = nullptr;
+    Job* m_Tail = nullptr;
+    int m_InFlight = 0;                     // Jobs submitted and not yet finished
+    uint64_t m_SharedJobs = 0;
+    bool m_Exit = false;
+};